@@ -292,6 +292,7 @@ def envoy_dependencies(path = "@envoy_deps//", skip_targets = []):
     _com_github_tencent_rapidjson()
     _com_google_googletest()
     _com_google_protobuf()
+    _com_googlesource_code_re2()
 
     # Used for bundling gcovr into a relocatable .par file.
     _repository_impl("subpar")
@@ -447,6 +448,10 @@ def _com_google_absl():
         name = "abseil_strings",
         actual = "@com_google_absl//absl/strings:strings",
     )
+    native.bind(
+        name = "abseil_inlined_vector",
+        actual = "@com_google_absl//absl/container:inlined_vector",
+    )
     native.bind(
         name = "abseil_int128",
         actual = "@com_google_absl//absl/numeric:int128",
@@ -481,6 +486,13 @@ def _com_google_protobuf():
         actual = "@com_google_protobuf_cc//:protoc",
     )
 
+def _com_googlesource_code_re2():
+    _repository_impl("com_googlesource_code_re2")
+    native.bind(
+        name = "re2",
+        actual = "@com_googlesource_code_re2//:re2",
+    )
+
 def _com_github_grpc_grpc():
     _repository_impl("com_github_grpc_grpc")
 
@@ -114,6 +114,13 @@ REPOSITORY_LOCATIONS = dict(
         commit = "6a4fec616ec4b20f54d5fb530808b855cb664390",
         remote = "https://github.com/google/protobuf",
     ),
+    com_googlesource_code_re2 = dict(
+        # TODO: this sha256 hasn't been checked against a fetched archive yet. Confirm it with
+        # `curl -sL <url> | sha256sum` before relying on it.
+        sha256 = "b885bb965ab4b6cf8718bbb8154d8f6474cd00331481b6d3e390babb3532263e",
+        strip_prefix = "re2-2018-10-01",
+        urls = ["https://github.com/google/re2/archive/2018-10-01.tar.gz"],
+    ),
     grpc_httpjson_transcoding = dict(
         commit = "05a15e4ecd0244a981fdf0348a76658def62fa9c",  # 2018-05-30
         remote = "https://github.com/grpc-ecosystem/grpc-httpjson-transcoding",
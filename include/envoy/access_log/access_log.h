@@ -80,6 +80,20 @@ public:
                              const Http::HeaderMap& response_headers,
                              const Http::HeaderMap& response_trailers,
                              const RequestInfo::RequestInfo& request_info) const PURE;
+
+  /**
+   * Append the formatted output to a buffer, which avoids the intermediate strings of format()
+   * when the output of several formatters is put together or a buffer is reused across logs.
+   * @param output supplies the buffer to append to.
+   * @param request_headers supplies the incoming request headers after filtering.
+   * @param response_headers supplies response headers.
+   * @param response_trailers supplies response trailers.
+   * @param request_info supplies additional information about the request.
+   */
+  virtual void formatInto(std::string& output, const Http::HeaderMap& request_headers,
+                          const Http::HeaderMap& response_headers,
+                          const Http::HeaderMap& response_trailers,
+                          const RequestInfo::RequestInfo& request_info) const PURE;
 };
 
 typedef std::unique_ptr<Formatter> FormatterPtr;
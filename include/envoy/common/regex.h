@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "envoy/common/pure.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * A compiled regular expression. Compiled matchers are immutable and may be shared by any number
+ * of threads.
+ */
+class CompiledMatcher {
+public:
+  virtual ~CompiledMatcher() {}
+
+  /**
+   * @param value supplies the value to match.
+   * @return bool whether the regular expression matches all of value.
+   */
+  virtual bool match(absl::string_view value) const PURE;
+
+  /**
+   * @return const std::string& the regular expression the matcher was compiled from.
+   */
+  virtual const std::string& pattern() const PURE;
+};
+
+typedef std::shared_ptr<const CompiledMatcher> CompiledMatcherSharedPtr;
+
+} // namespace Regex
+} // namespace Envoy
@@ -55,6 +55,12 @@ public:
    * stream object and no further callbacks will be invoked.
    */
   virtual void resetStream() PURE;
+
+  /**
+   * @return bool whether messages sent on the stream are backed up above the high watermark of the
+   *         stream's write buffer. Messages can still be sent, but will be buffered.
+   */
+  virtual bool isAboveWriteBufferHighWatermark() const PURE;
 };
 
 class AsyncRequestCallbacks {
@@ -127,6 +127,12 @@ public:
      * Reset the stream.
      */
     virtual void reset() PURE;
+
+    /***
+     * @return bool whether data sent on the stream is backed up above the high watermark of the
+     *         upstream connection's write buffer.
+     */
+    virtual bool isAboveWriteBufferHighWatermark() const PURE;
   };
 
   virtual ~AsyncClient() {}
@@ -95,6 +95,12 @@ public:
    */
   virtual void drainConnections() PURE;
 
+  /**
+   * Open connections ahead of demand as configured by the cluster's prefetch policy, e.g. to
+   * pre-warm a pool for a newly added host. This is a no-op if the cluster doesn't prefetch.
+   */
+  virtual void prefetch() PURE;
+
   /**
    * Create a new stream on the pool.
    * @param response_decoder supplies the decoder events to fire when the response is
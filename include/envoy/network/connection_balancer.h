@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/network/listen_socket.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A connection handler that can be balanced across. Each worker has a handler for every listener,
+ * and all the handlers of a listener share the listener's balancer.
+ */
+class BalancedConnectionHandler {
+public:
+  virtual ~BalancedConnectionHandler() {}
+
+  /**
+   * @return uint64_t the number of connections of the listener on this handler, including accepted
+   *         sockets that have not become connections yet. This may be called from any thread.
+   */
+  virtual uint64_t numConnections() const PURE;
+
+  /**
+   * Account for a socket that has been assigned to this handler. The count is released by the
+   * handler once the socket or the connection made from it goes away. This may be called from any
+   * thread.
+   */
+  virtual void incNumConnections() PURE;
+
+  /**
+   * Move an accepted socket to this handler. The socket is processed on the thread of the handler,
+   * starting with the listener filters.
+   * @param socket supplies the socket that is moved into the handler.
+   */
+  virtual void post(ConnectionSocketPtr&& socket) PURE;
+};
+
+/**
+ * Picks the handler that processes a socket accepted by one of a listener's handlers. This is
+ * used to move connections away from busy workers before any filter chain is created, as a worker
+ * keeps a connection for as long as the connection lives.
+ */
+class ConnectionBalancer {
+public:
+  virtual ~ConnectionBalancer() {}
+
+  /**
+   * Register a handler of the listener to balance across.
+   * @param handler supplies the handler, which must stay valid until it is unregistered.
+   */
+  virtual void registerHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Unregister a handler that was registered with registerHandler().
+   * @param handler supplies the handler.
+   */
+  virtual void unregisterHandler(BalancedConnectionHandler& handler) PURE;
+
+  /**
+   * Pick the handler for a newly accepted socket. The connection count of the returned handler
+   * has already been incremented with incNumConnections().
+   * @param current_handler supplies the handler that accepted the socket.
+   * @return BalancedConnectionHandler& the handler that should process the socket. If it is not
+   *         current_handler, the socket must be moved to it with post().
+   */
+  virtual BalancedConnectionHandler&
+  pickTargetHandler(BalancedConnectionHandler& current_handler) PURE;
+};
+
+typedef std::unique_ptr<ConnectionBalancer> ConnectionBalancerPtr;
+
+} // namespace Network
+} // namespace Envoy
@@ -6,6 +6,7 @@
 
 #include "envoy/common/exception.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/ssl/context.h"
@@ -39,6 +40,18 @@ public:
    */
   virtual Socket& socket() PURE;
 
+  /**
+   * @param worker_index supplies the index of the worker that accepts connections on the socket.
+   * @return Socket& the listen socket of the worker. This is socket() unless the listener has a
+   *         separate SO_REUSEPORT socket for each worker.
+   */
+  virtual Socket& workerSocket(uint32_t worker_index) PURE;
+
+  /**
+   * @return bool whether the listener has a separate SO_REUSEPORT socket for each worker.
+   */
+  virtual bool reusePort() const PURE;
+
   /**
    * @return bool specifies whether the listener should actually listen on the port.
    *         A listener that doesn't listen on a port can only receive connections
@@ -74,6 +87,11 @@ public:
    * @return const std::string& the listener's name.
    */
   virtual const std::string& name() const PURE;
+
+  /**
+   * @return ConnectionBalancer& the balancer that picks the worker of each accepted connection.
+   */
+  virtual ConnectionBalancer& connectionBalancer() PURE;
 };
 
 /**
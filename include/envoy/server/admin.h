@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "envoy/buffer/buffer.h"
@@ -17,6 +18,24 @@
 namespace Envoy {
 namespace Server {
 
+/**
+ * A response body that is produced a chunk at a time, so that large responses are not built up in
+ * memory before being written to the client.
+ */
+class AdminChunkedResponse {
+public:
+  virtual ~AdminChunkedResponse() {}
+
+  /**
+   * Append the next chunk of the response body.
+   * @param response supplies the buffer to append the chunk to.
+   * @return bool true if there are more chunks to follow, false if this was the last one.
+   */
+  virtual bool nextChunk(Buffer::Instance& response) PURE;
+};
+
+typedef std::unique_ptr<AdminChunkedResponse> AdminChunkedResponsePtr;
+
 class AdminStream {
 public:
   virtual ~AdminStream() {}
@@ -27,6 +46,14 @@ public:
    */
   virtual void setEndStreamOnComplete(bool end_stream) PURE;
 
+  /**
+   * Set the rest of the response body to be produced by a chunked response once the handler
+   * completes. The chunks are written after anything the handler added to the response buffer, as
+   * fast as the client reads them, and the last chunk ends the stream.
+   * @param response supplies the chunked response.
+   */
+  virtual void setChunkedResponse(AdminChunkedResponsePtr&& response) PURE;
+
   /**
    * @param cb callback to be added to the list of callbacks invoked by onDestroy() when stream
    * is closed.
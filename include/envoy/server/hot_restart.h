@@ -5,6 +5,7 @@
 
 #include "envoy/common/pure.h"
 #include "envoy/event/dispatcher.h"
+#include "envoy/ssl/session_cache.h"
 #include "envoy/stats/stat_data_allocator.h"
 #include "envoy/thread/thread.h"
 
@@ -41,9 +42,16 @@ public:
    * Retrieve a listening socket on the specified address from the parent process. The socket will
    * be duplicated across process boundaries.
    * @param address supplies the address of the socket to duplicate, e.g. tcp://127.0.0.1:5000.
+   * @param worker_index supplies the index of the worker whose socket to duplicate, for listeners
+   *        with a socket per worker. The parent returns its shared socket for any worker index
+   *        that it has a worker for if its listener has a single socket.
+   * @param reuse_port supplies whether the listener has a SO_REUSEPORT socket per worker.
    * @return int the fd or -1 if there is no bound listen port in the parent.
+   * @throw EnvoyException if the parent's listener has a different reuse_port setting, since its
+   *        sockets can't be taken over then.
    */
-  virtual int duplicateParentListenSocket(const std::string& address) PURE;
+  virtual int duplicateParentListenSocket(const std::string& address, uint32_t worker_index,
+                                          bool reuse_port) PURE;
 
   /**
    * Retrieve stats from our parent process.
@@ -95,6 +103,12 @@ public:
    * @returns an allocator for stats.
    */
   virtual Stats::StatDataAllocator& statsAllocator() PURE;
+
+  /**
+   * @return Ssl::SessionCache& the TLS session resumption state shared by all server contexts,
+   *         which survives a hot restart when it is kept in shared memory.
+   */
+  virtual Ssl::SessionCache& sslSessionCache() PURE;
 };
 
 } // namespace Server
@@ -46,11 +46,16 @@ public:
    * @param address supplies the socket's address.
    * @param options to be set on the created socket just before calling 'bind()'.
    * @param bind_to_port supplies whether to actually bind the socket.
+   * @param reuse_port supplies whether the listener has a SO_REUSEPORT socket per worker. A socket
+   *        taken over from the parent process during a hot restart must have the same setting.
+   * @param worker_index supplies the index of the worker the socket is for if the listener has a
+   *        socket per worker, and 0 if the socket is shared by all workers.
    * @return Network::SocketSharedPtr an initialized and potentially bound socket.
    */
   virtual Network::SocketSharedPtr
   createListenSocket(Network::Address::InstanceConstSharedPtr address,
-                     const Network::Socket::OptionsSharedPtr& options, bool bind_to_port) PURE;
+                     const Network::Socket::OptionsSharedPtr& options, bool bind_to_port,
+                     bool reuse_port, uint32_t worker_index) PURE;
 
   /**
    * Creates a list of filter factories.
@@ -159,6 +159,12 @@ public:
    * @return bool indicating whether the hot restart functionality has been disabled via cli flags.
    */
   virtual bool hotRestartDisabled() const PURE;
+
+  /**
+   * @return bool indicating whether buffers should use the libevent evbuffer implementation
+   *         rather than the native slice-based implementation.
+   */
+  virtual bool libeventBufferEnabled() const PURE;
 };
 
 } // namespace Server
@@ -82,9 +82,10 @@ public:
   virtual ~WorkerFactory() {}
 
   /**
+   * @param index supplies the index of the worker, from 0 up to the number of workers.
    * @return WorkerPtr a new worker.
    */
-  virtual WorkerPtr createWorker() PURE;
+  virtual WorkerPtr createWorker(uint32_t index) PURE;
 };
 
 } // namespace Server
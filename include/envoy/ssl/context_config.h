@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -82,6 +83,12 @@ public:
    */
   virtual const std::string& privateKeyPath() const PURE;
 
+  /**
+   * @return The number of threads that perform the private key operations of handshakes, or 0 to
+   * perform them on the thread of the connection.
+   */
+  virtual uint32_t privateKeyThreadPoolSize() const PURE;
+
   /**
    * @return The subject alt names to be verified, if enabled. Otherwise, ""
    */
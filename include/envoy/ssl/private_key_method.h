@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/common/pure.h"
+#include "envoy/event/dispatcher.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Callbacks of a connection whose private key operations are performed asynchronously.
+ */
+class PrivateKeyConnectionCallbacks {
+public:
+  virtual ~PrivateKeyConnectionCallbacks() {}
+
+  /**
+   * Called on the connection's dispatcher when a pending private key operation has completed, so
+   * that the handshake can be resumed.
+   */
+  virtual void onPrivateKeyMethodComplete() PURE;
+};
+
+/**
+ * Performs the private key operations of TLS handshakes, i.e. signing and RSA decryption, through
+ * BoringSSL's SSL_PRIVATE_KEY_METHOD. Operations may complete asynchronously, in which case the
+ * handshake returns SSL_ERROR_WANT_PRIVATE_KEY_OPERATION until the connection is told to resume.
+ */
+class PrivateKeyMethodProvider {
+public:
+  virtual ~PrivateKeyMethodProvider() {}
+
+  /**
+   * Prepare a connection for private key operations. Must be called before the handshake starts,
+   * on the thread of the connection's dispatcher.
+   * @param ssl supplies the connection's SSL.
+   * @param callbacks supplies the callbacks to notify when an operation completes.
+   * @param dispatcher supplies the dispatcher of the connection, which the callbacks are called on.
+   */
+  virtual void registerPrivateKeyMethod(SSL* ssl, PrivateKeyConnectionCallbacks& callbacks,
+                                        Event::Dispatcher& dispatcher) PURE;
+
+  /**
+   * Release the state of a connection. No callbacks are called for the connection afterwards, even
+   * if an operation is still pending. Must be called on the thread of the connection's dispatcher.
+   * @param ssl supplies the connection's SSL.
+   */
+  virtual void unregisterPrivateKeyMethod(SSL* ssl) PURE;
+
+  /**
+   * @return SSL_PRIVATE_KEY_METHOD* the method to set on the SSL_CTX of the connections.
+   */
+  virtual SSL_PRIVATE_KEY_METHOD* getBoringSslPrivateKeyMethod() PURE;
+};
+
+typedef std::shared_ptr<PrivateKeyMethodProvider> PrivateKeyMethodProviderSharedPtr;
+
+} // namespace Ssl
+} // namespace Envoy
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/common/pure.h"
+#include "envoy/ssl/context_config.h"
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Server side TLS session resumption state that is shared by all server contexts of the process.
+ * It supplies session ticket keys to contexts that have none configured, and stores sessions for
+ * resumption by session ID. An implementation may share this state across hot restarts so that
+ * clients can resume their sessions with the new process. All methods may be called from any
+ * thread.
+ */
+class SessionCache {
+public:
+  virtual ~SessionCache() {}
+
+  /**
+   * Fetch the keys for encrypting and decrypting session tickets. The keys are rotated by the
+   * cache.
+   * @param keys supplies the vector to fill with the keys. The first key is used for encrypting
+   *        new tickets, and all keys are candidates for decrypting received tickets.
+   * @return uint64_t the generation of the keys, @see ticketKeysGeneration().
+   */
+  virtual uint64_t ticketKeys(std::vector<ServerContextConfig::SessionTicketKey>& keys) PURE;
+
+  /**
+   * @return uint64_t a counter that changes whenever the ticket keys do, e.g. when they are
+   *         rotated. This is cheaper than ticketKeys(), so callers can keep the keys it returned
+   *         until the generation changes.
+   */
+  virtual uint64_t ticketKeysGeneration() PURE;
+
+  /**
+   * Store a session, replacing any session with the same ID.
+   * @param id supplies the session ID.
+   * @param session supplies the serialized session.
+   * @return bool whether the session was stored. Sessions that are too large for the cache are
+   *         not stored.
+   */
+  virtual bool insertSession(absl::string_view id, absl::string_view session) PURE;
+
+  /**
+   * Look up a session.
+   * @param id supplies the session ID.
+   * @param session supplies the string to fill with the serialized session if it is found.
+   * @return bool whether the session was found.
+   */
+  virtual bool lookupSession(absl::string_view id, std::string& session) PURE;
+
+  /**
+   * Remove a session, e.g. because it has expired.
+   * @param id supplies the session ID.
+   */
+  virtual void removeSession(absl::string_view id) PURE;
+};
+
+} // namespace Ssl
+} // namespace Envoy
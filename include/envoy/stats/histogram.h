@@ -30,6 +30,27 @@ public:
    * Returns computed quantile values during the period.
    */
   virtual const std::vector<double>& computedQuantiles() const PURE;
+
+  /**
+   * Returns supported buckets, as the inclusive upper bounds of the values they count.
+   */
+  virtual const std::vector<double>& supportedBuckets() const PURE;
+
+  /**
+   * Returns the computed cumulative bucket counts during the period, i.e. for each supported
+   * bucket the number of values that are less than or equal to its upper bound.
+   */
+  virtual const std::vector<uint64_t>& computedBuckets() const PURE;
+
+  /**
+   * Returns the number of values recorded during the period.
+   */
+  virtual uint64_t sampleCount() const PURE;
+
+  /**
+   * Returns the approximate sum of the values recorded during the period.
+   */
+  virtual double sampleSum() const PURE;
 };
 
 /**
@@ -46,7 +46,28 @@ public:
   virtual const std::vector<ParentHistogramSharedPtr>& cachedHistograms() PURE;
 
   /**
-   * Resets the cache so that any future calls to get cached metrics will refresh the set.
+   * Returns the counters that have been written since the previous clearCache(), i.e. since the
+   * previous flush. Sinks that only report changes should use this rather than walking all
+   * counters. Will use cached values if already accessed and clearCache() hasn't been called
+   * since.
+   * @return std::vector<CounterSharedPtr>& the changed counters. Note: reference may not be valid
+   * after clearCache() is called.
+   */
+  virtual const std::vector<CounterSharedPtr>& cachedChangedCounters() PURE;
+
+  /**
+   * Returns the gauges that have been written since the previous clearCache(), i.e. since the
+   * previous flush. A gauge that was written with its current value is included. Will use cached
+   * values if already accessed and clearCache() hasn't been called since.
+   * @return std::vector<GaugeSharedPtr>& the changed gauges. Note: reference may not be valid
+   * after clearCache() is called.
+   */
+  virtual const std::vector<GaugeSharedPtr>& cachedChangedGauges() PURE;
+
+  /**
+   * Resets the cache so that any future calls to get cached metrics will refresh the set. This
+   * also starts a new interval for cachedChangedCounters() and cachedChangedGauges(), whether or
+   * not they were called.
    */
   virtual void clearCache() PURE;
 };
@@ -47,6 +47,16 @@ public:
   virtual GaugeSharedPtr makeGauge(absl::string_view name, std::string&& tag_extracted_name,
                                    std::vector<Tag>&& tags) PURE;
 
+  /**
+   * Moves the counters and gauges made by this allocator that have been written since the previous
+   * call into the given vectors. Stats that are destroyed in the meantime are left out. A stat
+   * written while this runs may also be returned by the next call.
+   * @param counters supplies the vector to append the changed counters to.
+   * @param gauges supplies the vector to append the changed gauges to.
+   */
+  virtual void latchChanged(std::vector<CounterSharedPtr>& counters,
+                            std::vector<GaugeSharedPtr>& gauges) PURE;
+
   /**
    * Determines whether this stats allocator requires bounded stat-name size.
    */
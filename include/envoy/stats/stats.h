@@ -21,19 +21,22 @@ class Metric {
 public:
   virtual ~Metric() {}
   /**
-   * Returns the full name of the Metric.
+   * Returns the full name of the Metric. The name may be stored in a compact form and built on
+   * each call.
    */
-  virtual const std::string& name() const PURE;
+  virtual std::string name() const PURE;
 
   /**
-   * Returns a vector of configurable tags to identify this Metric.
+   * Returns a vector of configurable tags to identify this Metric. Like name(), the tags may be
+   * built on each call.
    */
-  virtual const std::vector<Tag>& tags() const PURE;
+  virtual std::vector<Tag> tags() const PURE;
 
   /**
-   * Returns the name of the Metric with the portions designated as tags removed.
+   * Returns the name of the Metric with the portions designated as tags removed. Like name(), this
+   * may be built on each call.
    */
-  virtual const std::string& tagExtractedName() const PURE;
+  virtual std::string tagExtractedName() const PURE;
 
   /**
    * Indicates whether this metric has been updated since the server was started.
@@ -42,6 +42,16 @@ public:
    * @return a list of all known histograms.
    */
   virtual std::vector<ParentHistogramSharedPtr> histograms() const PURE;
+
+  /**
+   * Moves the counters and gauges that have been written since the previous call into the given
+   * vectors, with one stat per name. This only costs as much as the number of changed stats, so
+   * callers that only care about changes should prefer it to counters() and gauges().
+   * @param counters supplies the vector to append the changed counters to.
+   * @param gauges supplies the vector to append the changed gauges to.
+   */
+  virtual void latchChanged(std::vector<CounterSharedPtr>& counters,
+                            std::vector<GaugeSharedPtr>& gauges) PURE;
 };
 
 typedef std::unique_ptr<Store> StorePtr;
@@ -140,6 +140,12 @@ public:
    */
   virtual void drainConnections() PURE;
 
+  /**
+   * Open connections ahead of demand as configured by the cluster's prefetch policy, e.g. to
+   * pre-warm a pool for a newly added host. This is a no-op if the cluster doesn't prefetch.
+   */
+  virtual void prefetch() PURE;
+
   /**
    * Create a new connection on the pool.
    * @param cb supplies the callbacks to invoke when the connection is ready or has failed. The
@@ -311,11 +311,14 @@ public:
   GAUGE    (upstream_cx_active)                                                                    \
   COUNTER  (upstream_cx_http1_total)                                                               \
   COUNTER  (upstream_cx_http2_total)                                                               \
+  HISTOGRAM(upstream_cx_http2_streams)                                                             \
+  HISTOGRAM(upstream_cx_http2_active_streams)                                                      \
   COUNTER  (upstream_cx_connect_fail)                                                              \
   COUNTER  (upstream_cx_connect_timeout)                                                           \
   COUNTER  (upstream_cx_idle_timeout)                                                              \
   COUNTER  (upstream_cx_connect_attempts_exceeded)                                                 \
   COUNTER  (upstream_cx_overflow)                                                                  \
+  COUNTER  (upstream_cx_prefetch)                                                                  \
   HISTOGRAM(upstream_cx_connect_ms)                                                                \
   HISTOGRAM(upstream_cx_length_ms)                                                                 \
   COUNTER  (upstream_cx_destroy)                                                                   \
@@ -339,6 +342,7 @@ public:
   COUNTER  (upstream_rq_pending_failure_eject)                                                     \
   GAUGE    (upstream_rq_pending_active)                                                            \
   COUNTER  (upstream_rq_cancelled)                                                                 \
+  COUNTER  (upstream_rq_forwarded)                                                                 \
   COUNTER  (upstream_rq_maintenance_mode)                                                          \
   COUNTER  (upstream_rq_timeout)                                                                   \
   COUNTER  (upstream_rq_per_try_timeout)                                                           \
@@ -402,6 +406,8 @@ public:
     static const uint64_t USE_DOWNSTREAM_PROTOCOL = 0x2;
     // Whether connections should be immediately closed upon health failure.
     static const uint64_t CLOSE_CONNECTIONS_ON_HOST_HEALTH_FAILURE = 0x4;
+    // Whether HTTP/2 connection pools are shared across workers.
+    static const uint64_t SHARE_HTTP2_CONNECTION_POOLS = 0x8;
   };
 
   virtual ~ClusterInfo() {}
@@ -483,6 +489,12 @@ public:
    */
   virtual uint64_t maxRequestsPerConnection() const PURE;
 
+  /**
+   * @return float how many connections each connection pool keeps open relative to its demand, as
+   *         configured by the cluster's prefetch policy. 1 indicates no prefetching.
+   */
+  virtual float perUpstreamPrefetchRatio() const PURE;
+
   /**
    * @return the human readable name of the cluster.
    */
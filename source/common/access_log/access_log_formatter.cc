@@ -1,5 +1,6 @@
 #include "common/access_log/access_log_formatter.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -45,6 +46,22 @@ std::string AccessLogFormatUtils::durationToString(const std::chrono::nanosecond
   return fmt::FormatInt(std::chrono::duration_cast<std::chrono::milliseconds>(time).count()).str();
 }
 
+void AccessLogFormatUtils::appendDuration(std::string& output,
+                                          const absl::optional<std::chrono::nanoseconds>& time) {
+  if (time) {
+    appendDuration(output, time.value());
+  } else {
+    output += UnspecifiedValueString;
+  }
+}
+
+void AccessLogFormatUtils::appendDuration(std::string& output,
+                                          const std::chrono::nanoseconds& time) {
+  const fmt::FormatInt duration(
+      std::chrono::duration_cast<std::chrono::milliseconds>(time).count());
+  output.append(duration.data(), duration.size());
+}
+
 const std::string&
 AccessLogFormatUtils::protocolToString(const absl::optional<Http::Protocol>& protocol) {
   if (protocol) {
@@ -53,6 +70,15 @@ AccessLogFormatUtils::protocolToString(const absl::optional<Http::Protocol>& pro
   return UnspecifiedValueString;
 }
 
+std::string FormatterBase::format(const Http::HeaderMap& request_headers,
+                                  const Http::HeaderMap& response_headers,
+                                  const Http::HeaderMap& response_trailers,
+                                  const RequestInfo::RequestInfo& request_info) const {
+  std::string output;
+  formatInto(output, request_headers, response_headers, response_trailers, request_info);
+  return output;
+}
+
 FormatterImpl::FormatterImpl(const std::string& format) {
   formatters_ = AccessLogFormatParser::parse(format);
 }
@@ -63,13 +89,93 @@ std::string FormatterImpl::format(const Http::HeaderMap& request_headers,
                                   const RequestInfo::RequestInfo& request_info) const {
   std::string log_line;
   log_line.reserve(256);
+  formatInto(log_line, request_headers, response_headers, response_trailers, request_info);
+  return log_line;
+}
 
+void FormatterImpl::formatInto(std::string& output, const Http::HeaderMap& request_headers,
+                               const Http::HeaderMap& response_headers,
+                               const Http::HeaderMap& response_trailers,
+                               const RequestInfo::RequestInfo& request_info) const {
   for (const FormatterPtr& formatter : formatters_) {
-    log_line +=
-        formatter->format(request_headers, response_headers, response_trailers, request_info);
+    formatter->formatInto(output, request_headers, response_headers, response_trailers,
+                          request_info);
+  }
+}
+
+JsonFormatterImpl::JsonFormatterImpl(const std::map<std::string, std::string>& format_mapping) {
+  for (const auto& mapping : format_mapping) {
+    Field field;
+    field.prefix_ = fields_.empty() ? "{\"" : ",\"";
+    const size_t key_start = field.prefix_.size();
+    field.prefix_ += mapping.first;
+    escapeFrom(field.prefix_, key_start);
+    field.prefix_ += "\":\"";
+    field.formatters_ = AccessLogFormatParser::parse(mapping.second);
+    fields_.push_back(std::move(field));
   }
+}
 
-  return log_line;
+void JsonFormatterImpl::formatInto(std::string& output, const Http::HeaderMap& request_headers,
+                                   const Http::HeaderMap& response_headers,
+                                   const Http::HeaderMap& response_trailers,
+                                   const RequestInfo::RequestInfo& request_info) const {
+  if (fields_.empty()) {
+    output += "{}\n";
+    return;
+  }
+
+  for (const Field& field : fields_) {
+    output += field.prefix_;
+    const size_t value_start = output.size();
+    for (const FormatterPtr& formatter : field.formatters_) {
+      formatter->formatInto(output, request_headers, response_headers, response_trailers,
+                            request_info);
+    }
+    escapeFrom(output, value_start);
+    output += '"';
+  }
+  output += "}\n";
+}
+
+void JsonFormatterImpl::escapeFrom(std::string& output, size_t start) {
+  const auto needs_escape = [](char c) -> bool {
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+  };
+  // Values rarely need escaping, so only copy them when they do.
+  const auto first = std::find_if(output.begin() + start, output.end(), needs_escape);
+  if (first == output.end()) {
+    return;
+  }
+
+  const size_t escape_start = first - output.begin();
+  const std::string raw = output.substr(escape_start);
+  output.resize(escape_start);
+  for (const char c : raw) {
+    switch (c) {
+    case '"':
+      output += "\\\"";
+      break;
+    case '\\':
+      output += "\\\\";
+      break;
+    case '\n':
+      output += "\\n";
+      break;
+    case '\r':
+      output += "\\r";
+      break;
+    case '\t':
+      output += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        output += fmt::format("\\u{:04x}", static_cast<unsigned int>(c));
+      } else {
+        output += c;
+      }
+    }
+  }
 }
 
 void AccessLogFormatParser::parseCommandHeader(const std::string& token, const size_t start,
@@ -216,89 +322,94 @@ std::vector<FormatterPtr> AccessLogFormatParser::parse(const std::string& format
 RequestInfoFormatter::RequestInfoFormatter(const std::string& field_name) {
 
   if (field_name == "REQUEST_DURATION") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return AccessLogFormatUtils::durationToString(request_info.lastDownstreamRxByteReceived());
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      AccessLogFormatUtils::appendDuration(output, request_info.lastDownstreamRxByteReceived());
     };
   } else if (field_name == "RESPONSE_DURATION") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return AccessLogFormatUtils::durationToString(request_info.firstUpstreamRxByteReceived());
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      AccessLogFormatUtils::appendDuration(output, request_info.firstUpstreamRxByteReceived());
     };
   } else if (field_name == "RESPONSE_TX_DURATION") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
       auto downstream = request_info.lastDownstreamTxByteSent();
       auto upstream = request_info.firstUpstreamRxByteReceived();
 
       if (downstream && upstream) {
         auto val = downstream.value() - upstream.value();
-        return AccessLogFormatUtils::durationToString(val);
+        AccessLogFormatUtils::appendDuration(output, val);
+        return;
       }
 
-      return UnspecifiedValueString;
+      output += UnspecifiedValueString;
     };
   } else if (field_name == "BYTES_RECEIVED") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return fmt::FormatInt(request_info.bytesReceived()).str();
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      const fmt::FormatInt bytes(request_info.bytesReceived());
+      output.append(bytes.data(), bytes.size());
     };
   } else if (field_name == "PROTOCOL") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return AccessLogFormatUtils::protocolToString(request_info.protocol());
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      output += AccessLogFormatUtils::protocolToString(request_info.protocol());
     };
   } else if (field_name == "RESPONSE_CODE") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return request_info.responseCode() ? fmt::FormatInt(request_info.responseCode().value()).str()
-                                         : "0";
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      const fmt::FormatInt code(request_info.responseCode() ? request_info.responseCode().value()
+                                                            : 0);
+      output.append(code.data(), code.size());
     };
   } else if (field_name == "BYTES_SENT") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return fmt::FormatInt(request_info.bytesSent()).str();
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      const fmt::FormatInt bytes(request_info.bytesSent());
+      output.append(bytes.data(), bytes.size());
     };
   } else if (field_name == "DURATION") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return AccessLogFormatUtils::durationToString(request_info.requestComplete());
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      AccessLogFormatUtils::appendDuration(output, request_info.requestComplete());
     };
   } else if (field_name == "RESPONSE_FLAGS") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return RequestInfo::ResponseFlagUtils::toShortString(request_info);
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      output += RequestInfo::ResponseFlagUtils::toShortString(request_info);
     };
   } else if (field_name == "UPSTREAM_HOST") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
       if (request_info.upstreamHost()) {
-        return request_info.upstreamHost()->address()->asString();
+        output += request_info.upstreamHost()->address()->asString();
       } else {
-        return UnspecifiedValueString;
+        output += UnspecifiedValueString;
       }
     };
   } else if (field_name == "UPSTREAM_CLUSTER") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      std::string upstream_cluster_name;
-      if (nullptr != request_info.upstreamHost()) {
-        upstream_cluster_name = request_info.upstreamHost()->cluster().name();
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      if (nullptr != request_info.upstreamHost() &&
+          !request_info.upstreamHost()->cluster().name().empty()) {
+        output += request_info.upstreamHost()->cluster().name();
+      } else {
+        output += UnspecifiedValueString;
       }
-
-      return upstream_cluster_name.empty() ? UnspecifiedValueString : upstream_cluster_name;
     };
   } else if (field_name == "UPSTREAM_LOCAL_ADDRESS") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return request_info.upstreamLocalAddress() != nullptr
-                 ? request_info.upstreamLocalAddress()->asString()
-                 : UnspecifiedValueString;
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      output += request_info.upstreamLocalAddress() != nullptr
+                    ? request_info.upstreamLocalAddress()->asString()
+                    : UnspecifiedValueString;
     };
   } else if (field_name == "DOWNSTREAM_LOCAL_ADDRESS") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return request_info.downstreamLocalAddress()->asString();
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      output += request_info.downstreamLocalAddress()->asString();
     };
   } else if (field_name == "DOWNSTREAM_LOCAL_ADDRESS_WITHOUT_PORT") {
-    field_extractor_ = [](const Envoy::RequestInfo::RequestInfo& request_info) {
-      return RequestInfo::Utility::formatDownstreamAddressNoPort(
+    field_extractor_ = [](std::string& output,
+                          const Envoy::RequestInfo::RequestInfo& request_info) {
+      output += RequestInfo::Utility::formatDownstreamAddressNoPort(
           *request_info.downstreamLocalAddress());
     };
   } else if (field_name == "DOWNSTREAM_REMOTE_ADDRESS") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return request_info.downstreamRemoteAddress()->asString();
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      output += request_info.downstreamRemoteAddress()->asString();
     };
   } else if (field_name == "DOWNSTREAM_REMOTE_ADDRESS_WITHOUT_PORT") {
-    field_extractor_ = [](const RequestInfo::RequestInfo& request_info) {
-      return RequestInfo::Utility::formatDownstreamAddressNoPort(
+    field_extractor_ = [](std::string& output, const RequestInfo::RequestInfo& request_info) {
+      output += RequestInfo::Utility::formatDownstreamAddressNoPort(
           *request_info.downstreamRemoteAddress());
     };
   } else {
@@ -306,10 +417,10 @@ RequestInfoFormatter::RequestInfoFormatter(const std::string& field_name) {
   }
 }
 
-std::string RequestInfoFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                         const Http::HeaderMap&,
-                                         const RequestInfo::RequestInfo& request_info) const {
-  return field_extractor_(request_info);
+void RequestInfoFormatter::formatInto(std::string& output, const Http::HeaderMap&,
+                                      const Http::HeaderMap&, const Http::HeaderMap&,
+                                      const RequestInfo::RequestInfo& request_info) const {
+  field_extractor_(output, request_info);
 }
 
 PlainStringFormatter::PlainStringFormatter(const std::string& str) : str_(str) {}
@@ -320,30 +431,34 @@ std::string PlainStringFormatter::format(const Http::HeaderMap&, const Http::Hea
   return str_;
 }
 
+void PlainStringFormatter::formatInto(std::string& output, const Http::HeaderMap&,
+                                      const Http::HeaderMap&, const Http::HeaderMap&,
+                                      const RequestInfo::RequestInfo&) const {
+  output += str_;
+}
+
 HeaderFormatter::HeaderFormatter(const std::string& main_header,
                                  const std::string& alternative_header,
                                  absl::optional<size_t> max_length)
     : main_header_(main_header), alternative_header_(alternative_header), max_length_(max_length) {}
 
-std::string HeaderFormatter::format(const Http::HeaderMap& headers) const {
+void HeaderFormatter::formatInto(std::string& output, const Http::HeaderMap& headers) const {
   const Http::HeaderEntry* header = headers.get(main_header_);
 
   if (!header && !alternative_header_.get().empty()) {
     header = headers.get(alternative_header_);
   }
 
-  std::string header_value_string;
   if (!header) {
-    header_value_string = UnspecifiedValueString;
-  } else {
-    header_value_string = header->value().c_str();
+    output += UnspecifiedValueString;
+    return;
   }
 
-  if (max_length_ && header_value_string.length() > max_length_.value()) {
-    return header_value_string.substr(0, max_length_.value());
+  size_t length = header->value().size();
+  if (max_length_ && length > max_length_.value()) {
+    length = max_length_.value();
   }
-
-  return header_value_string;
+  output.append(header->value().c_str(), length);
 }
 
 ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
@@ -351,11 +466,11 @@ ResponseHeaderFormatter::ResponseHeaderFormatter(const std::string& main_header,
                                                  absl::optional<size_t> max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string ResponseHeaderFormatter::format(const Http::HeaderMap&,
-                                            const Http::HeaderMap& response_headers,
-                                            const Http::HeaderMap&,
-                                            const RequestInfo::RequestInfo&) const {
-  return HeaderFormatter::format(response_headers);
+void ResponseHeaderFormatter::formatInto(std::string& output, const Http::HeaderMap&,
+                                         const Http::HeaderMap& response_headers,
+                                         const Http::HeaderMap&,
+                                         const RequestInfo::RequestInfo&) const {
+  HeaderFormatter::formatInto(output, response_headers);
 }
 
 RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
@@ -363,10 +478,11 @@ RequestHeaderFormatter::RequestHeaderFormatter(const std::string& main_header,
                                                absl::optional<size_t> max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string RequestHeaderFormatter::format(const Http::HeaderMap& request_headers,
-                                           const Http::HeaderMap&, const Http::HeaderMap&,
-                                           const RequestInfo::RequestInfo&) const {
-  return HeaderFormatter::format(request_headers);
+void RequestHeaderFormatter::formatInto(std::string& output,
+                                        const Http::HeaderMap& request_headers,
+                                        const Http::HeaderMap&, const Http::HeaderMap&,
+                                        const RequestInfo::RequestInfo&) const {
+  HeaderFormatter::formatInto(output, request_headers);
 }
 
 ResponseTrailerFormatter::ResponseTrailerFormatter(const std::string& main_header,
@@ -374,10 +490,11 @@ ResponseTrailerFormatter::ResponseTrailerFormatter(const std::string& main_heade
                                                    absl::optional<size_t> max_length)
     : HeaderFormatter(main_header, alternative_header, max_length) {}
 
-std::string ResponseTrailerFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                             const Http::HeaderMap& response_trailers,
-                                             const RequestInfo::RequestInfo&) const {
-  return HeaderFormatter::format(response_trailers);
+void ResponseTrailerFormatter::formatInto(std::string& output, const Http::HeaderMap&,
+                                          const Http::HeaderMap&,
+                                          const Http::HeaderMap& response_trailers,
+                                          const RequestInfo::RequestInfo&) const {
+  HeaderFormatter::formatInto(output, response_trailers);
 }
 
 MetadataFormatter::MetadataFormatter(const std::string& filter_namespace,
@@ -385,18 +502,21 @@ MetadataFormatter::MetadataFormatter(const std::string& filter_namespace,
                                      absl::optional<size_t> max_length)
     : filter_namespace_(filter_namespace), path_(path), max_length_(max_length) {}
 
-std::string MetadataFormatter::format(const envoy::api::v2::core::Metadata& metadata) const {
+void MetadataFormatter::formatInto(std::string& output,
+                                   const envoy::api::v2::core::Metadata& metadata) const {
   const Protobuf::Message* data;
   if (path_.empty()) {
     const auto filter_it = metadata.filter_metadata().find(filter_namespace_);
     if (filter_it == metadata.filter_metadata().end()) {
-      return UnspecifiedValueString;
+      output += UnspecifiedValueString;
+      return;
     }
     data = &(filter_it->second);
   } else {
     const ProtobufWkt::Value& val = Metadata::metadataValue(metadata, filter_namespace_, path_);
     if (val.kind_case() == ProtobufWkt::Value::KindCase::KIND_NOT_SET) {
-      return UnspecifiedValueString;
+      output += UnspecifiedValueString;
+      return;
     }
     data = &val;
   }
@@ -404,9 +524,10 @@ std::string MetadataFormatter::format(const envoy::api::v2::core::Metadata& meta
   const auto status = Protobuf::util::MessageToJsonString(*data, &json);
   RELEASE_ASSERT(status.ok(), "");
   if (max_length_ && json.length() > max_length_.value()) {
-    return json.substr(0, max_length_.value());
+    output.append(json, 0, max_length_.value());
+    return;
   }
-  return json;
+  output += json;
 }
 
 // TODO(glicht): Consider adding support for route/listener/cluster metadata as suggested by @htuch.
@@ -416,21 +537,21 @@ DynamicMetadataFormatter::DynamicMetadataFormatter(const std::string& filter_nam
                                                    absl::optional<size_t> max_length)
     : MetadataFormatter(filter_namespace, path, max_length) {}
 
-std::string DynamicMetadataFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                             const Http::HeaderMap&,
-                                             const RequestInfo::RequestInfo& request_info) const {
-  return MetadataFormatter::format(request_info.dynamicMetadata());
+void DynamicMetadataFormatter::formatInto(std::string& output, const Http::HeaderMap&,
+                                          const Http::HeaderMap&, const Http::HeaderMap&,
+                                          const RequestInfo::RequestInfo& request_info) const {
+  MetadataFormatter::formatInto(output, request_info.dynamicMetadata());
 }
 
 StartTimeFormatter::StartTimeFormatter(const std::string& format) : date_formatter_(format) {}
 
-std::string StartTimeFormatter::format(const Http::HeaderMap&, const Http::HeaderMap&,
-                                       const Http::HeaderMap&,
-                                       const RequestInfo::RequestInfo& request_info) const {
+void StartTimeFormatter::formatInto(std::string& output, const Http::HeaderMap&,
+                                    const Http::HeaderMap&, const Http::HeaderMap&,
+                                    const RequestInfo::RequestInfo& request_info) const {
   if (date_formatter_.formatString().empty()) {
-    return AccessLogDateTimeFormatter::fromTime(request_info.startTime());
+    output += AccessLogDateTimeFormatter::fromTime(request_info.startTime());
   } else {
-    return date_formatter_.fromTime(request_info.startTime());
+    output += date_formatter_.fromTime(request_info.startTime());
   }
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -74,6 +75,9 @@ public:
   static const std::string& protocolToString(const absl::optional<Http::Protocol>& protocol);
   static std::string durationToString(const absl::optional<std::chrono::nanoseconds>& time);
   static std::string durationToString(const std::chrono::nanoseconds& time);
+  static void appendDuration(std::string& output,
+                             const absl::optional<std::chrono::nanoseconds>& time);
+  static void appendDuration(std::string& output, const std::chrono::nanoseconds& time);
 
 private:
   AccessLogFormatUtils();
@@ -81,10 +85,22 @@ private:
   static const std::string DEFAULT_FORMAT;
 };
 
+/**
+ * Base class for formatters that produce their output with formatInto().
+ */
+class FormatterBase : public Formatter {
+public:
+  // Formatter::format
+  std::string format(const Http::HeaderMap& request_headers,
+                     const Http::HeaderMap& response_headers,
+                     const Http::HeaderMap& response_trailers,
+                     const RequestInfo::RequestInfo& request_info) const override;
+};
+
 /**
  * Composite formatter implementation.
  */
-class FormatterImpl : public Formatter {
+class FormatterImpl : public FormatterBase {
 public:
   FormatterImpl(const std::string& format);
 
@@ -93,11 +109,47 @@ public:
                      const Http::HeaderMap& response_headers,
                      const Http::HeaderMap& response_trailers,
                      const RequestInfo::RequestInfo& request_info) const override;
+  void formatInto(std::string& output, const Http::HeaderMap& request_headers,
+                  const Http::HeaderMap& response_headers,
+                  const Http::HeaderMap& response_trailers,
+                  const RequestInfo::RequestInfo& request_info) const override;
 
 private:
   std::vector<FormatterPtr> formatters_;
 };
 
+/**
+ * Formatter that writes a JSON object per log, with a string value for each configured key. The
+ * format of each value is parsed once, and the keys and surrounding punctuation are kept as
+ * precomputed literals. Values are escaped as they are appended to the output.
+ */
+class JsonFormatterImpl : public FormatterBase {
+public:
+  JsonFormatterImpl(const std::map<std::string, std::string>& format_mapping);
+
+  // Formatter::format
+  void formatInto(std::string& output, const Http::HeaderMap& request_headers,
+                  const Http::HeaderMap& response_headers,
+                  const Http::HeaderMap& response_trailers,
+                  const RequestInfo::RequestInfo& request_info) const override;
+
+  /**
+   * Escape for JSON the part of a string that starts at an offset, in place.
+   * @param output supplies the string to escape.
+   * @param start supplies the offset of the first character to escape.
+   */
+  static void escapeFrom(std::string& output, size_t start);
+
+private:
+  struct Field {
+    // The literal output that precedes the value of the field, e.g. ,"key":" .
+    std::string prefix_;
+    std::vector<FormatterPtr> formatters_;
+  };
+
+  std::vector<Field> fields_;
+};
+
 /**
  * Formatter for string literal. It ignores headers and request info and returns string by which it
  * was initialized.
@@ -109,6 +161,8 @@ public:
   // Formatter::format
   std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
                      const RequestInfo::RequestInfo&) const override;
+  void formatInto(std::string& output, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const Http::HeaderMap&, const RequestInfo::RequestInfo&) const override;
 
 private:
   std::string str_;
@@ -119,7 +173,7 @@ public:
   HeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                   absl::optional<size_t> max_length);
 
-  std::string format(const Http::HeaderMap& headers) const;
+  void formatInto(std::string& output, const Http::HeaderMap& headers) const;
 
 private:
   Http::LowerCaseString main_header_;
@@ -130,56 +184,59 @@ private:
 /**
  * Formatter based on request header.
  */
-class RequestHeaderFormatter : public Formatter, HeaderFormatter {
+class RequestHeaderFormatter : public FormatterBase, HeaderFormatter {
 public:
   RequestHeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                          absl::optional<size_t> max_length);
 
   // Formatter::format
-  std::string format(const Http::HeaderMap& request_headers, const Http::HeaderMap&,
-                     const Http::HeaderMap&, const RequestInfo::RequestInfo&) const override;
+  void formatInto(std::string& output, const Http::HeaderMap& request_headers,
+                  const Http::HeaderMap&, const Http::HeaderMap&,
+                  const RequestInfo::RequestInfo&) const override;
 };
 
 /**
  * Formatter based on the response header.
  */
-class ResponseHeaderFormatter : public Formatter, HeaderFormatter {
+class ResponseHeaderFormatter : public FormatterBase, HeaderFormatter {
 public:
   ResponseHeaderFormatter(const std::string& main_header, const std::string& alternative_header,
                           absl::optional<size_t> max_length);
 
   // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap& response_headers,
-                     const Http::HeaderMap&, const RequestInfo::RequestInfo&) const override;
+  void formatInto(std::string& output, const Http::HeaderMap&,
+                  const Http::HeaderMap& response_headers, const Http::HeaderMap&,
+                  const RequestInfo::RequestInfo&) const override;
 };
 
 /**
  * Formatter based on the response trailer.
  */
-class ResponseTrailerFormatter : public Formatter, HeaderFormatter {
+class ResponseTrailerFormatter : public FormatterBase, HeaderFormatter {
 public:
   ResponseTrailerFormatter(const std::string& main_header, const std::string& alternative_header,
                            absl::optional<size_t> max_length);
 
   // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&,
-                     const Http::HeaderMap& response_trailers,
-                     const RequestInfo::RequestInfo&) const override;
+  void formatInto(std::string& output, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const Http::HeaderMap& response_trailers,
+                  const RequestInfo::RequestInfo&) const override;
 };
 
 /**
  * Formatter based on the RequestInfo field.
  */
-class RequestInfoFormatter : public Formatter {
+class RequestInfoFormatter : public FormatterBase {
 public:
   RequestInfoFormatter(const std::string& field_name);
 
   // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const RequestInfo::RequestInfo& request_info) const override;
+  void formatInto(std::string& output, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const Http::HeaderMap&,
+                  const RequestInfo::RequestInfo& request_info) const override;
 
 private:
-  std::function<std::string(const RequestInfo::RequestInfo&)> field_extractor_;
+  std::function<void(std::string&, const RequestInfo::RequestInfo&)> field_extractor_;
 };
 
 /**
@@ -190,7 +247,7 @@ public:
   MetadataFormatter(const std::string& filter_namespace, const std::vector<std::string>& path,
                     absl::optional<size_t> max_length);
 
-  std::string format(const envoy::api::v2::core::Metadata& metadata) const;
+  void formatInto(std::string& output, const envoy::api::v2::core::Metadata& metadata) const;
 
 private:
   std::string filter_namespace_;
@@ -201,24 +258,25 @@ private:
 /**
  * Formatter based on the DynamicMetadata from RequestInfo.
  */
-class DynamicMetadataFormatter : public Formatter, MetadataFormatter {
+class DynamicMetadataFormatter : public FormatterBase, MetadataFormatter {
 public:
   DynamicMetadataFormatter(const std::string& filter_namespace,
                            const std::vector<std::string>& path, absl::optional<size_t> max_length);
 
   // Formatter::format
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const RequestInfo::RequestInfo& request_info) const override;
+  void formatInto(std::string& output, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const Http::HeaderMap&,
+                  const RequestInfo::RequestInfo& request_info) const override;
 };
 
 /**
  * Formatter
  */
-class StartTimeFormatter : public Formatter {
+class StartTimeFormatter : public FormatterBase {
 public:
   StartTimeFormatter(const std::string& format);
-  std::string format(const Http::HeaderMap&, const Http::HeaderMap&, const Http::HeaderMap&,
-                     const RequestInfo::RequestInfo&) const override;
+  void formatInto(std::string& output, const Http::HeaderMap&, const Http::HeaderMap&,
+                  const Http::HeaderMap&, const RequestInfo::RequestInfo&) const override;
 
 private:
   const Envoy::DateFormatter date_formatter_;
@@ -6,6 +6,8 @@
 #include "envoy/api/api.h"
 #include "envoy/filesystem/filesystem.h"
 
+#include "common/filesystem/filesystem_impl.h"
+
 namespace Envoy {
 namespace Api {
 
@@ -26,6 +28,8 @@ public:
 
 private:
   std::chrono::milliseconds file_flush_interval_msec_;
+  // Writes the data of all the files created by this Api to disk.
+  Filesystem::FileFlushThreadSharedPtr file_flush_thread_;
 };
 
 } // namespace Api
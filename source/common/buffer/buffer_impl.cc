@@ -20,18 +20,56 @@ static_assert(offsetof(RawSlice, mem_) == offsetof(evbuffer_iovec, iov_base),
 static_assert(offsetof(RawSlice, len_) == offsetof(evbuffer_iovec, iov_len),
               "RawSlice != evbuffer_iovec");
 
-void OwnedImpl::add(const void* data, uint64_t size) { evbuffer_add(buffer_.get(), data, size); }
+// The evbuffer implementation remains the default until the native implementation has been
+// proven in production. See OptionsImpl for the command line flag that controls this.
+bool OwnedImpl::use_old_impl_ = true;
 
-void OwnedImpl::addBufferFragment(BufferFragment& fragment) {
-  evbuffer_add_reference(
-      buffer_.get(), fragment.data(), fragment.size(),
-      [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); }, &fragment);
+void OwnedImpl::useOldImpl(bool use_old_impl) { use_old_impl_ = use_old_impl; }
+
+bool OwnedImpl::isSameBufferImpl(const Instance& rhs) const {
+  const OwnedImpl* other = dynamic_cast<const OwnedImpl*>(&rhs);
+  if (other == nullptr) {
+    return false;
+  }
+  return old_impl_ == other->old_impl_;
+}
+
+void OwnedImpl::addImpl(const void* data, uint64_t size) {
+  if (old_impl_) {
+    evbuffer_add(buffer_.get(), data, size);
+    return;
+  }
+
+  const uint8_t* src = static_cast<const uint8_t*>(data);
+  // Fast path: copy as much as possible into the space remaining at the end of the last slice.
+  if (!slices_.empty()) {
+    const uint64_t copy_size = slices_.back()->append(src, size);
+    src += copy_size;
+    size -= copy_size;
+    length_ += copy_size;
+  }
+  if (size != 0) {
+    slices_.emplace_back(OwnedSlice::create(src, size));
+    length_ += size;
+  }
 }
 
-void OwnedImpl::add(const std::string& data) {
-  evbuffer_add(buffer_.get(), data.c_str(), data.size());
+void OwnedImpl::add(const void* data, uint64_t size) { addImpl(data, size); }
+
+void OwnedImpl::addBufferFragment(BufferFragment& fragment) {
+  if (old_impl_) {
+    evbuffer_add_reference(
+        buffer_.get(), fragment.data(), fragment.size(),
+        [](const void*, size_t, void* arg) { static_cast<BufferFragment*>(arg)->done(); },
+        &fragment);
+  } else {
+    length_ += fragment.size();
+    slices_.emplace_back(std::make_unique<UnownedSlice>(fragment));
+  }
 }
 
+void OwnedImpl::add(const std::string& data) { add(data.data(), data.size()); }
+
 void OwnedImpl::add(const Instance& data) {
   uint64_t num_slices = data.getRawSlices(nullptr, 0);
   RawSlice slices[num_slices];
@@ -42,56 +80,248 @@ void OwnedImpl::add(const Instance& data) {
 }
 
 void OwnedImpl::commit(RawSlice* iovecs, uint64_t num_iovecs) {
-  int rc =
-      evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(rc == 0);
+  if (old_impl_) {
+    int rc =
+        evbuffer_commit_space(buffer_.get(), reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    ASSERT(rc == 0);
+    return;
+  }
+
+  if (num_iovecs == 0 || slices_.empty()) {
+    return;
+  }
+
+  // Reservations are always made from the trailing slices of the buffer, in order. Find the last
+  // slice containing data; no slice before it can match a reservation.
+  size_t slice_index = slices_.size() - 1;
+  while (slice_index > 0 && slices_[slice_index]->dataSize() == 0) {
+    slice_index--;
+  }
+
+  // Match the iovecs to the slices in order. An iovec that doesn't match any remaining slice is
+  // ignored, as is done by evbuffer_commit_space() for stale reservations.
+  for (uint64_t i = 0; i < num_iovecs && slice_index < slices_.size(); i++) {
+    if (iovecs[i].len_ == 0) {
+      continue;
+    }
+    while (slice_index < slices_.size()) {
+      if (slices_[slice_index++]->commit(iovecs[i])) {
+        length_ += iovecs[i].len_;
+        break;
+      }
+    }
+  }
 }
 
 void OwnedImpl::copyOut(size_t start, uint64_t size, void* data) const {
   ASSERT(start + size <= length());
 
-  evbuffer_ptr start_ptr;
-  int rc = evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET);
-  ASSERT(rc != -1);
+  if (old_impl_) {
+    evbuffer_ptr start_ptr;
+    int rc = evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET);
+    ASSERT(rc != -1);
 
-  ev_ssize_t copied = evbuffer_copyout_from(buffer_.get(), &start_ptr, data, size);
-  ASSERT(static_cast<uint64_t>(copied) == size);
+    ev_ssize_t copied = evbuffer_copyout_from(buffer_.get(), &start_ptr, data, size);
+    ASSERT(static_cast<uint64_t>(copied) == size);
+    return;
+  }
+
+  uint8_t* dest = static_cast<uint8_t*>(data);
+  for (const SlicePtr& slice : slices_) {
+    if (size == 0) {
+      break;
+    }
+    const uint64_t data_size = slice->dataSize();
+    if (data_size <= start) {
+      start -= data_size;
+      continue;
+    }
+    const uint64_t copy_size = std::min(size, data_size - start);
+    memcpy(dest, slice->data() + start, copy_size);
+    size -= copy_size;
+    dest += copy_size;
+    start = 0;
+  }
+  ASSERT(size == 0);
 }
 
 void OwnedImpl::drain(uint64_t size) {
   ASSERT(size <= length());
-  int rc = evbuffer_drain(buffer_.get(), size);
-  ASSERT(rc == 0);
+  if (old_impl_) {
+    int rc = evbuffer_drain(buffer_.get(), size);
+    ASSERT(rc == 0);
+    return;
+  }
+
+  while (size != 0 && !slices_.empty()) {
+    const uint64_t slice_size = slices_.front()->dataSize();
+    if (slice_size <= size) {
+      slices_.pop_front();
+      length_ -= slice_size;
+      size -= slice_size;
+    } else {
+      slices_.front()->drain(size);
+      length_ -= size;
+      size = 0;
+    }
+  }
 }
 
 uint64_t OwnedImpl::getRawSlices(RawSlice* out, uint64_t out_size) const {
-  return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
-                       out_size);
+  if (old_impl_) {
+    return evbuffer_peek(buffer_.get(), -1, nullptr, reinterpret_cast<evbuffer_iovec*>(out),
+                         out_size);
+  }
+
+  // Unlike evbuffer_peek(), empty slices are never returned.
+  uint64_t num_slices = 0;
+  for (const SlicePtr& slice : slices_) {
+    if (slice->dataSize() == 0) {
+      continue;
+    }
+    if (num_slices < out_size) {
+      out[num_slices].mem_ = slice->data();
+      out[num_slices].len_ = slice->dataSize();
+    }
+    num_slices++;
+  }
+  return num_slices;
 }
 
-uint64_t OwnedImpl::length() const { return evbuffer_get_length(buffer_.get()); }
+uint64_t OwnedImpl::length() const {
+  if (old_impl_) {
+    return evbuffer_get_length(buffer_.get());
+  }
+  return length_;
+}
 
 void* OwnedImpl::linearize(uint32_t size) {
   ASSERT(size <= length());
-  return evbuffer_pullup(buffer_.get(), size);
+  if (old_impl_) {
+    return evbuffer_pullup(buffer_.get(), size);
+  }
+
+  if (slices_.empty()) {
+    return nullptr;
+  }
+
+  // Find how many leading slices are needed to cover size bytes.
+  uint64_t linearized_size = 0;
+  uint64_t num_slices_to_linearize = 0;
+  for (const SlicePtr& slice : slices_) {
+    num_slices_to_linearize++;
+    linearized_size += slice->dataSize();
+    if (linearized_size >= size) {
+      break;
+    }
+  }
+
+  if (num_slices_to_linearize > 1) {
+    // Coalesce the leading slices into one new slice. Whole slices are copied so that no slice is
+    // left partially drained at the front of the buffer.
+    SlicePtr new_slice = OwnedSlice::create(linearized_size);
+    for (uint64_t i = 0; i < num_slices_to_linearize; i++) {
+      new_slice->append(slices_.front()->data(), slices_.front()->dataSize());
+      slices_.pop_front();
+    }
+    slices_.emplace_front(std::move(new_slice));
+  }
+  return slices_.front()->data();
+}
+
+void OwnedImpl::moveByCopy(Instance& rhs, uint64_t length) {
+  uint64_t num_slices = rhs.getRawSlices(nullptr, 0);
+  RawSlice slices[num_slices];
+  rhs.getRawSlices(slices, num_slices);
+  uint64_t remaining = length;
+  for (uint64_t i = 0; i < num_slices && remaining != 0; i++) {
+    const uint64_t copy_size = std::min(static_cast<uint64_t>(slices[i].len_), remaining);
+    addImpl(slices[i].mem_, copy_size);
+    remaining -= copy_size;
+  }
+  ASSERT(remaining == 0);
+  rhs.drain(length);
 }
 
 void OwnedImpl::move(Instance& rhs) {
+  ASSERT(&rhs != this);
+  if (!isSameBufferImpl(rhs)) {
+    moveByCopy(rhs, rhs.length());
+    return;
+  }
+
   // We do the static cast here because in practice we only have one buffer implementation right
   // now and this is safe. Using the evbuffer move routines require having access to both evbuffers.
   // This is a reasonable compromise in a high performance path where we want to maintain an
   // abstraction in case we get rid of evbuffer later.
-  int rc = evbuffer_add_buffer(buffer_.get(), static_cast<LibEventInstance&>(rhs).buffer().get());
-  ASSERT(rc == 0);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  if (old_impl_) {
+    int rc = evbuffer_add_buffer(buffer_.get(), other.buffer().get());
+    ASSERT(rc == 0);
+  } else {
+    while (!other.slices_.empty()) {
+      SlicePtr& slice = other.slices_.front();
+      const uint64_t slice_size = slice->dataSize();
+      if (slice_size < CopyThreshold && !slices_.empty() &&
+          slices_.back()->reservableSize() >= slice_size) {
+        // Small slice that fits at the end of the last slice: copy it rather than adding another
+        // (mostly empty) slice to this buffer.
+        slices_.back()->append(slice->data(), slice_size);
+      } else if (slice_size != 0) {
+        slices_.emplace_back(std::move(slice));
+      }
+      length_ += slice_size;
+      other.length_ -= slice_size;
+      other.slices_.pop_front();
+    }
+  }
+  other.postProcess();
 }
 
 void OwnedImpl::move(Instance& rhs, uint64_t length) {
+  ASSERT(&rhs != this);
+  if (!isSameBufferImpl(rhs)) {
+    moveByCopy(rhs, length);
+    return;
+  }
+
   // See move() above for why we do the static cast.
-  int rc = evbuffer_remove_buffer(static_cast<LibEventInstance&>(rhs).buffer().get(), buffer_.get(),
-                                  length);
-  ASSERT(static_cast<uint64_t>(rc) == length);
-  static_cast<LibEventInstance&>(rhs).postProcess();
+  OwnedImpl& other = static_cast<OwnedImpl&>(rhs);
+  if (old_impl_) {
+    int rc = evbuffer_remove_buffer(other.buffer().get(), buffer_.get(), length);
+    ASSERT(static_cast<uint64_t>(rc) == length);
+  } else {
+    ASSERT(length <= other.length_);
+    while (length != 0 && !other.slices_.empty()) {
+      SlicePtr& slice = other.slices_.front();
+      const uint64_t slice_size = slice->dataSize();
+      if (slice_size <= length &&
+          !(slice_size < CopyThreshold && !slices_.empty() &&
+            slices_.back()->reservableSize() >= slice_size)) {
+        // Transfer the whole slice without copying.
+        if (slice_size != 0) {
+          slices_.emplace_back(std::move(slice));
+        }
+        other.slices_.pop_front();
+        length_ += slice_size;
+        other.length_ -= slice_size;
+        length -= slice_size;
+      } else {
+        // Either only part of the slice is wanted, or the slice is small enough to be copied.
+        // Slices are not reference counted, so the partial case has to copy.
+        const uint64_t copy_size = std::min(slice_size, length);
+        addImpl(slice->data(), copy_size);
+        slice->drain(copy_size);
+        other.length_ -= copy_size;
+        length -= copy_size;
+        if (slice->dataSize() == 0) {
+          other.slices_.pop_front();
+        }
+      }
+    }
+    ASSERT(length == 0);
+  }
+  other.postProcess();
 }
 
 Api::SysCallResult OwnedImpl::read(int fd, uint64_t max_length) {
@@ -135,21 +365,129 @@ Api::SysCallResult OwnedImpl::read(int fd, uint64_t max_length) {
 }
 
 uint64_t OwnedImpl::reserve(uint64_t length, RawSlice* iovecs, uint64_t num_iovecs) {
-  uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
-                                        reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
-  ASSERT(ret >= 1);
-  return ret;
+  if (old_impl_) {
+    uint64_t ret = evbuffer_reserve_space(buffer_.get(), length,
+                                          reinterpret_cast<evbuffer_iovec*>(iovecs), num_iovecs);
+    ASSERT(ret >= 1);
+    return ret;
+  }
+
+  if (num_iovecs == 0 || length == 0) {
+    return 0;
+  }
+
+  // Find the run of slices at the end of the buffer that have reservable space: the last slice
+  // (which may contain data) and any empty slices after the last slice containing data.
+  size_t first_reservable_slice = slices_.size();
+  while (first_reservable_slice > 0) {
+    if (slices_[first_reservable_slice - 1]->reservableSize() == 0) {
+      break;
+    }
+    first_reservable_slice--;
+    if (slices_[first_reservable_slice]->dataSize() != 0) {
+      // Anything in front of a slice containing data can't be reserved.
+      break;
+    }
+  }
+
+  // Reserve as much space as possible from each of those slices.
+  uint64_t num_slices_used = 0;
+  uint64_t bytes_remaining = length;
+  for (size_t slice_index = first_reservable_slice;
+       slice_index < slices_.size() && bytes_remaining != 0 && num_slices_used < num_iovecs;
+       slice_index++) {
+    const uint64_t reservation_size =
+        std::min(slices_[slice_index]->reservableSize(), bytes_remaining);
+    if (num_slices_used + 1 == num_iovecs && reservation_size < bytes_remaining) {
+      // Only one iovec is left and this slice can't complete the reservation. Leave the last
+      // iovec for a new slice that can hold the rest.
+      break;
+    }
+    iovecs[num_slices_used] = slices_[slice_index]->reserve(reservation_size);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+  }
+
+  // If needed, allocate one more slice at the end to provide the remainder of the reservation.
+  if (bytes_remaining != 0) {
+    slices_.emplace_back(OwnedSlice::create(bytes_remaining));
+    iovecs[num_slices_used] = slices_.back()->reserve(bytes_remaining);
+    bytes_remaining -= iovecs[num_slices_used].len_;
+    num_slices_used++;
+  }
+
+  ASSERT(num_slices_used <= num_iovecs);
+  ASSERT(bytes_remaining == 0);
+  return num_slices_used;
 }
 
 ssize_t OwnedImpl::search(const void* data, uint64_t size, size_t start) const {
-  evbuffer_ptr start_ptr;
-  if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
+  if (old_impl_) {
+    evbuffer_ptr start_ptr;
+    if (-1 == evbuffer_ptr_set(buffer_.get(), &start_ptr, start, EVBUFFER_PTR_SET)) {
+      return -1;
+    }
+
+    evbuffer_ptr result_ptr =
+        evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
+    return result_ptr.pos;
+  }
+
+  if (start > length_) {
     return -1;
   }
+  if (size == 0) {
+    return start;
+  }
 
-  evbuffer_ptr result_ptr =
-      evbuffer_search(buffer_.get(), static_cast<const char*>(data), size, &start_ptr);
-  return result_ptr.pos;
+  // This uses the same naive algorithm as evbuffer_search(): memchr() for the first byte of the
+  // needle, then compare the rest, following the match across slice boundaries as needed.
+  const uint8_t* needle = static_cast<const uint8_t*>(data);
+  uint64_t offset = 0;
+  for (size_t slice_index = 0; slice_index < slices_.size(); slice_index++) {
+    const SlicePtr& slice = slices_[slice_index];
+    const uint64_t slice_size = slice->dataSize();
+    if (slice_size <= start) {
+      start -= slice_size;
+      offset += slice_size;
+      continue;
+    }
+    const uint8_t* slice_start = slice->data();
+    const uint8_t* haystack = slice_start + start;
+    const uint8_t* haystack_end = slice_start + slice_size;
+    while (haystack < haystack_end) {
+      const uint8_t* first_byte_match =
+          static_cast<const uint8_t*>(memchr(haystack, needle[0], haystack_end - haystack));
+      if (first_byte_match == nullptr) {
+        break;
+      }
+      uint64_t i = 1;
+      size_t match_index = slice_index;
+      const uint8_t* match_next = first_byte_match + 1;
+      const uint8_t* match_end = haystack_end;
+      while (i < size) {
+        if (match_next == match_end) {
+          if (++match_index == slices_.size()) {
+            break;
+          }
+          match_next = slices_[match_index]->data();
+          match_end = match_next + slices_[match_index]->dataSize();
+          continue;
+        }
+        if (*match_next++ != needle[i]) {
+          break;
+        }
+        i++;
+      }
+      if (i == size) {
+        return offset + (first_byte_match - slice_start);
+      }
+      haystack = first_byte_match + 1;
+    }
+    start = 0;
+    offset += slice_size;
+  }
+  return -1;
 }
 
 Api::SysCallResult OwnedImpl::write(int fd) {
@@ -177,7 +515,8 @@ Api::SysCallResult OwnedImpl::write(int fd) {
   return {static_cast<int>(rc), error};
 }
 
-OwnedImpl::OwnedImpl() : buffer_(evbuffer_new()) {}
+OwnedImpl::OwnedImpl()
+    : old_impl_(use_old_impl_), buffer_(old_impl_ ? evbuffer_new() : nullptr) {}
 
 OwnedImpl::OwnedImpl(const std::string& data) : OwnedImpl() { add(data); }
 
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
 #include <string>
 
 #include "envoy/buffer/buffer.h"
 
+#include "common/common/assert.h"
 #include "common/common/non_copyable.h"
 #include "common/event/libevent.h"
 
@@ -46,6 +51,165 @@ private:
   const std::function<void(const void*, size_t, const BufferFragmentImpl*)> releasor_;
 };
 
+/**
+ * A contiguous region of memory holding buffer data. The region is split into three parts:
+ *
+ *   base_                  base_ + data_        base_ + reservable_            base_ + size_
+ *     | drained (unusable) |  data (readable)   |  reservable (writable)       |
+ *
+ * Data is appended at the reservable end and drained from the front. A Slice is never shared
+ * between buffers; moving a Slice between buffers transfers ownership of the memory, which is how
+ * OwnedImpl::move() avoids copying.
+ */
+class Slice {
+public:
+  virtual ~Slice() {}
+
+  /**
+   * @return a pointer to the start of the readable data in the slice.
+   */
+  const uint8_t* data() const { return base_ + data_; }
+  uint8_t* data() { return base_ + data_; }
+
+  /**
+   * @return the number of bytes of readable data in the slice.
+   */
+  uint64_t dataSize() const { return reservable_ - data_; }
+
+  /**
+   * Remove data from the front of the slice. The drained space is not reused; OwnedImpl releases
+   * slices once all of their data has been drained.
+   * @param size supplies the number of bytes to remove. Must be <= dataSize().
+   */
+  void drain(uint64_t size) {
+    ASSERT(data_ + size <= reservable_);
+    data_ += size;
+  }
+
+  /**
+   * @return the number of bytes that can be appended to the slice without reallocating.
+   */
+  uint64_t reservableSize() const { return size_ - reservable_; }
+
+  /**
+   * Reserve space at the end of the slice. The reservation is not visible as data until it is
+   * committed. A later reserve() or append() invalidates an uncommitted reservation.
+   * @param size supplies the number of bytes wanted.
+   * @return a RawSlice describing the reserved memory, which may be smaller than size (or empty if
+   *         the slice has no reservable space).
+   */
+  RawSlice reserve(uint64_t size) {
+    const uint64_t reservation_size = std::min(size, reservableSize());
+    if (reservation_size == 0) {
+      return {nullptr, 0};
+    }
+    return {base_ + reservable_, static_cast<size_t>(reservation_size)};
+  }
+
+  /**
+   * Commit a reservation previously obtained from reserve(), making the bytes part of the data.
+   * @param reservation supplies the (possibly shortened) reservation.
+   * @return true if the reservation belonged to this slice and was committed, false otherwise.
+   */
+  bool commit(const RawSlice& reservation) {
+    if (reservation.mem_ != base_ + reservable_ || reservation.len_ > reservableSize()) {
+      return false;
+    }
+    reservable_ += reservation.len_;
+    return true;
+  }
+
+  /**
+   * Copy as much of the supplied data as fits into the reservable space at the end of the slice.
+   * @param data supplies the data to copy.
+   * @param size supplies the length of the data.
+   * @return the number of bytes copied.
+   */
+  uint64_t append(const void* data, uint64_t size) {
+    const uint64_t copy_size = std::min(size, reservableSize());
+    if (copy_size != 0) {
+      memcpy(base_ + reservable_, data, copy_size);
+      reservable_ += copy_size;
+    }
+    return copy_size;
+  }
+
+protected:
+  Slice(uint64_t data, uint64_t reservable, uint64_t size)
+      : data_(data), reservable_(reservable), size_(size) {}
+
+  // Start of the slice's memory. Set by subclasses.
+  uint8_t* base_{nullptr};
+  // Offset of the first readable byte.
+  uint64_t data_;
+  // Offset of the first reservable byte (one past the last readable byte).
+  uint64_t reservable_;
+  // Total size of the memory region.
+  uint64_t size_;
+};
+
+typedef std::unique_ptr<Slice> SlicePtr;
+
+/**
+ * A Slice whose memory is allocated together with the Slice object in a single heap allocation.
+ */
+class OwnedSlice : public Slice {
+public:
+  /**
+   * Create an empty OwnedSlice.
+   * @param capacity supplies the minimum number of reservable bytes. The slice is rounded up so
+   *        that the slice object plus its data fill an integral number of pages.
+   */
+  static SlicePtr create(uint64_t capacity) {
+    const uint64_t slice_capacity = sliceSize(capacity);
+    return SlicePtr(new (slice_capacity) OwnedSlice(slice_capacity));
+  }
+
+  /**
+   * Create an OwnedSlice containing a copy of the supplied data.
+   * @param data supplies the data to copy.
+   * @param size supplies the length of the data.
+   */
+  static SlicePtr create(const void* data, uint64_t size) {
+    SlicePtr slice = create(size);
+    slice->append(data, size);
+    return slice;
+  }
+
+  static void* operator new(size_t object_size, size_t data_size) {
+    return ::operator new(object_size + data_size);
+  }
+  static void operator delete(void* address) { ::operator delete(address); }
+
+private:
+  OwnedSlice(uint64_t size) : Slice(0, 0, size) { base_ = storage_; }
+
+  static uint64_t sliceSize(uint64_t data_size) {
+    static constexpr uint64_t PageSize = 4096;
+    const uint64_t num_pages = (sizeof(OwnedSlice) + data_size + PageSize - 1) / PageSize;
+    return num_pages * PageSize - sizeof(OwnedSlice);
+  }
+
+  uint8_t storage_[];
+};
+
+/**
+ * A Slice that references externally owned memory via a BufferFragment. The fragment is released
+ * when the slice is destroyed. Nothing can be appended to an UnownedSlice.
+ */
+class UnownedSlice : public Slice {
+public:
+  UnownedSlice(BufferFragment& fragment)
+      : Slice(0, fragment.size(), fragment.size()), fragment_(fragment) {
+    base_ = static_cast<uint8_t*>(const_cast<void*>(fragment.data()));
+  }
+
+  ~UnownedSlice() override { fragment_.done(); }
+
+private:
+  BufferFragment& fragment_;
+};
+
 class LibEventInstance : public Instance {
 public:
   // Allows access into the underlying buffer for move() optimizations.
@@ -55,10 +219,18 @@ public:
 };
 
 /**
- * Wraps an allocated and owned evbuffer.
+ * Buffer::Instance implementation with two interchangeable backends:
+ *  - The original implementation, which wraps an allocated and owned evbuffer.
+ *  - A native implementation, which holds a deque of Slices. Small writes are copied into the
+ *    reservable space of the last slice, and move() transfers whole slices between buffers
+ *    without copying.
  *
- * Note that due to the internals of move() accessing buffer(), OwnedImpl is not
- * compatible with non-LibEventInstance buffers.
+ * The backend is chosen when the buffer is constructed, based on the process-wide setting
+ * controlled by useOldImpl(). The setting is meant to be configured once at startup, before any
+ * buffers are created.
+ *
+ * Note that due to the internals of move() accessing buffer() and the slices of the other buffer,
+ * OwnedImpl is not compatible with non-OwnedImpl buffers.
  */
 class OwnedImpl : public LibEventInstance {
 public:
@@ -89,8 +261,53 @@ public:
 
   Event::Libevent::BufferPtr& buffer() override { return buffer_; }
 
+  /**
+   * Select the buffer implementation used by OwnedImpl instances constructed after this call.
+   * @param use_old_impl true to use the evbuffer-based implementation, false to use the native
+   *        slice-based implementation.
+   */
+  static void useOldImpl(bool use_old_impl);
+
+  /**
+   * @return true if newly constructed OwnedImpl instances use the evbuffer-based implementation.
+   */
+  static bool newBuffersUseOldImpl() { return use_old_impl_; }
+
+  /**
+   * @return true if this buffer uses the evbuffer-based implementation.
+   */
+  bool usesOldImpl() const { return old_impl_; }
+
 private:
+  // Returns true if the other buffer uses the same implementation as this one, which is required
+  // for the zero-copy move() paths.
+  bool isSameBufferImpl(const Instance& rhs) const;
+
+  // Copies data to the end of the buffer without calling any virtual methods, so that it can be
+  // used to implement the move() paths that must not trigger subclass (watermark) hooks twice.
+  void addImpl(const void* data, uint64_t size);
+
+  // Move-copy fallback used when the two buffers use different implementations.
+  void moveByCopy(Instance& rhs, uint64_t length);
+
+  // Slices smaller than this are copied, rather than transferred, by move() when they fit in the
+  // reservable space at the end of the destination buffer. This keeps the slice count (and so
+  // the number of iovecs passed to writev()) down when many small buffers are moved together.
+  static constexpr uint64_t CopyThreshold = 512;
+
+  // Process-wide selection of the implementation for newly constructed buffers.
+  static bool use_old_impl_;
+
+  // Implementation selected when this buffer was constructed.
+  const bool old_impl_;
+
+  // Used by the old implementation.
   Event::Libevent::BufferPtr buffer_;
+
+  // Used by the native implementation. The slices are in order of their data, and length_ is the
+  // sum of their data sizes.
+  std::deque<SlicePtr> slices_;
+  uint64_t length_{0};
 };
 
 } // namespace Buffer
@@ -70,7 +70,7 @@ bool StringMatcher::match(const ProtobufWkt::Value& value) const {
   case envoy::type::matcher::StringMatcher::kSuffix:
     return absl::EndsWith(s, matcher_.suffix());
   case envoy::type::matcher::StringMatcher::kRegex:
-    return std::regex_match(s, regex_);
+    return regex_->match(s);
   default:
     NOT_REACHED_GCOVR_EXCL_LINE;
   }
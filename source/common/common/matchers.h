@@ -3,11 +3,13 @@
 #include <string>
 
 #include "envoy/api/v2/core/base.pb.h"
+#include "envoy/common/regex.h"
 #include "envoy/type/matcher/metadata.pb.h"
 #include "envoy/type/matcher/number.pb.h"
 #include "envoy/type/matcher/string.pb.h"
 #include "envoy/type/matcher/value.pb.h"
 
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/protobuf/protobuf.h"
 
@@ -74,7 +76,7 @@ class StringMatcher : public ValueMatcher {
 public:
   StringMatcher(const envoy::type::matcher::StringMatcher& matcher) : matcher_(matcher) {
     if (matcher.match_pattern_case() == envoy::type::matcher::StringMatcher::kRegex) {
-      regex_ = RegexUtil::parseRegex(matcher_.regex());
+      regex_ = Regex::Utility::parseRegex(matcher_.regex());
     }
   }
 
@@ -82,7 +84,7 @@ public:
 
 private:
   const envoy::type::matcher::StringMatcher matcher_;
-  std::regex regex_;
+  Regex::CompiledMatcherSharedPtr regex_;
 };
 
 class ListMatcher : public ValueMatcher {
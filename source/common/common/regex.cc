@@ -0,0 +1,126 @@
+#include "common/common/regex.h"
+
+#include <regex>
+#include <unordered_map>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/lock_guard.h"
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/common/utility.h"
+
+#include "re2/re2.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+class Re2CompiledMatcher : public CompiledMatcher {
+public:
+  Re2CompiledMatcher(const std::string& regex, const RE2::Options& options)
+      : regex_(regex, options) {}
+
+  bool ok() const { return regex_.ok(); }
+
+  // Regex::CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return RE2::FullMatch(re2::StringPiece(value.data(), value.size()), regex_);
+  }
+  const std::string& pattern() const override { return regex_.pattern(); }
+
+private:
+  const RE2 regex_;
+};
+
+class StdRegexCompiledMatcher : public CompiledMatcher {
+public:
+  StdRegexCompiledMatcher(const std::string& regex)
+      : regex_(RegexUtil::parseRegex(regex)), pattern_(regex) {}
+
+  // Regex::CompiledMatcher
+  bool match(absl::string_view value) const override {
+    return std::regex_match(value.begin(), value.end(), regex_);
+  }
+  const std::string& pattern() const override { return pattern_; }
+
+private:
+  const std::regex regex_;
+  const std::string pattern_;
+};
+
+/**
+ * Cache of the live compiled matchers, keyed by pattern. Entries are removed when the last
+ * reference to their matcher goes away, which may happen on any thread.
+ */
+class MatcherCache : Logger::Loggable<Logger::Id::misc> {
+public:
+  CompiledMatcherSharedPtr get(const std::string& regex) {
+    Thread::LockGuard lock(lock_);
+    std::weak_ptr<const CompiledMatcher>& entry = matchers_[regex];
+    CompiledMatcherSharedPtr matcher = entry.lock();
+    if (matcher == nullptr) {
+      std::unique_ptr<const CompiledMatcher> compiled;
+      try {
+        compiled = compile(regex);
+      } catch (const EnvoyException&) {
+        matchers_.erase(regex);
+        throw;
+      }
+      matcher = CompiledMatcherSharedPtr(compiled.release(),
+                                         [this](const CompiledMatcher* matcher) {
+                                           release(matcher->pattern());
+                                           delete matcher;
+                                         });
+      entry = matcher;
+    }
+    return matcher;
+  }
+
+private:
+  std::unique_ptr<const CompiledMatcher> compile(const std::string& regex) {
+    RE2::Options options;
+    options.set_encoding(RE2::Options::EncodingLatin1);
+    options.set_log_errors(false);
+    std::unique_ptr<Re2CompiledMatcher> re2_matcher(new Re2CompiledMatcher(regex, options));
+    if (re2_matcher->ok()) {
+      return std::unique_ptr<const CompiledMatcher>(std::move(re2_matcher));
+    }
+
+    // Throws if the pattern isn't valid at all.
+    std::unique_ptr<const CompiledMatcher> std_matcher(new StdRegexCompiledMatcher(regex));
+    ENVOY_LOG(warn,
+              "regex '{}' is not supported by the linear-time regex engine and will be evaluated "
+              "with std::regex",
+              regex);
+    return std_matcher;
+  }
+
+  void release(const std::string& regex) {
+    Thread::LockGuard lock(lock_);
+    // The pattern may have been compiled again between the last reference going away and this
+    // call, in which case the entry refers to the new matcher and must be kept.
+    auto it = matchers_.find(regex);
+    if (it != matchers_.end() && it->second.expired()) {
+      matchers_.erase(it);
+    }
+  }
+
+  Thread::MutexBasicLockable lock_;
+  std::unordered_map<std::string, std::weak_ptr<const CompiledMatcher>> matchers_;
+};
+
+MatcherCache& matcherCache() {
+  // Never destroyed, as matchers may outlive static destruction.
+  static MatcherCache* cache = new MatcherCache();
+  return *cache;
+}
+
+} // namespace
+
+CompiledMatcherSharedPtr Utility::parseRegex(const std::string& regex) {
+  return matcherCache().get(regex);
+}
+
+} // namespace Regex
+} // namespace Envoy
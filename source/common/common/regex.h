@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/common/regex.h"
+
+namespace Envoy {
+namespace Regex {
+
+/**
+ * Utilities for compiling regular expressions.
+ */
+class Utility {
+public:
+  /**
+   * Compiles a regular expression. Patterns are compiled with RE2, which matches in time linear in
+   * the size of the input and never recurses on it. Patterns RE2 doesn't support (e.g.
+   * backreferences and lookahead assertions) are compiled with std::regex so that existing
+   * configurations keep working. Matching is done on bytes, as std::regex does.
+   *
+   * Compiled matchers are cached, so parsing the same pattern again while a matcher for it is still
+   * alive returns that matcher instead of compiling a new one.
+   * @param regex supplies the regular expression to compile.
+   * @return CompiledMatcherSharedPtr the compiled matcher.
+   * @throw EnvoyException if the regex string is invalid.
+   */
+  static CompiledMatcherSharedPtr parseRegex(const std::string& regex);
+};
+
+} // namespace Regex
+} // namespace Envoy
@@ -3,6 +3,7 @@
 #include <dirent.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <fstream>
@@ -19,6 +20,7 @@
 #include "common/common/fmt.h"
 #include "common/common/lock_guard.h"
 #include "common/common/thread.h"
+#include "common/common/utility.h"
 
 #include "absl/strings/match.h"
 
@@ -92,15 +94,85 @@ bool illegalPath(const std::string& path) {
   }
 }
 
+FileFlushThread::~FileFlushThread() {
+  Thread::ThreadPtr thread;
+  {
+    Thread::LockGuard lock(lock_);
+    ASSERT(pending_files_.empty());
+    exit_ = true;
+    thread = std::move(thread_);
+  }
+  wakeup_.notifyOne();
+
+  if (thread != nullptr) {
+    thread->join();
+  }
+}
+
+void FileFlushThread::requestFlush(FileImpl& file) {
+  {
+    Thread::LockGuard lock(lock_);
+    if (std::find(pending_files_.begin(), pending_files_.end(), &file) != pending_files_.end()) {
+      return;
+    }
+    pending_files_.push_back(&file);
+
+    if (thread_ == nullptr) {
+      thread_ = std::make_unique<Thread::Thread>([this]() -> void { threadRoutine(); });
+    }
+  }
+  wakeup_.notifyOne();
+}
+
+void FileFlushThread::removeFile(FileImpl& file) {
+  Thread::LockGuard lock(lock_);
+  pending_files_.erase(std::remove(pending_files_.begin(), pending_files_.end(), &file),
+                       pending_files_.end());
+  while (flushing_file_ == &file) {
+    // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+    flush_done_.wait(lock_);
+  }
+}
+
+void FileFlushThread::threadRoutine() {
+  while (true) {
+    FileImpl* file;
+    {
+      Thread::LockGuard lock(lock_);
+      while (pending_files_.empty() && !exit_) {
+        wakeup_.wait(lock_);
+      }
+
+      if (exit_) {
+        return;
+      }
+
+      file = pending_files_.front();
+      pending_files_.erase(pending_files_.begin());
+      flushing_file_ = file;
+    }
+
+    file->flushStagedData();
+
+    {
+      Thread::LockGuard lock(lock_);
+      flushing_file_ = nullptr;
+    }
+    flush_done_.notifyAll();
+  }
+}
+
 FileImpl::FileImpl(const std::string& path, Event::Dispatcher& dispatcher,
                    Thread::BasicLockable& lock, Stats::Store& stats_store,
-                   std::chrono::milliseconds flush_interval_msec)
+                   std::chrono::milliseconds flush_interval_msec,
+                   FileFlushThreadSharedPtr flush_thread)
     : path_(path), file_lock_(lock), flush_timer_(dispatcher.createTimer([this]() -> void {
         stats_.flushed_by_timer_.inc();
-        flush_event_.notifyOne();
+        requestFlush();
         flush_timer_->enableTimer(flush_interval_msec_);
       })),
       os_sys_calls_(Api::OsSysCallsSingleton::get()), flush_interval_msec_(flush_interval_msec),
+      flush_thread_(flush_thread),
       stats_{FILESYSTEM_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
                               POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {
   open();
@@ -118,20 +190,15 @@ void FileImpl::open() {
 void FileImpl::reopen() { reopen_file_ = true; }
 
 FileImpl::~FileImpl() {
-  {
-    Thread::LockGuard lock(write_lock_);
-    flush_thread_exit_ = true;
-    flush_event_.notifyOne();
-  }
-
-  if (flush_thread_ != nullptr) {
-    flush_thread_->join();
-  }
+  flush_thread_->removeFile(*this);
 
   // Flush any remaining data. If file was not opened for some reason, skip flushing part.
   if (fd_ != -1) {
-    if (flush_buffer_.length() > 0) {
-      doWrite(flush_buffer_);
+    for (StagingBuffer& staging : staging_buffers_) {
+      Thread::LockGuard lock(staging.lock_);
+      if (staging.buffer_.length() > 0) {
+        doWrite(staging.buffer_);
+      }
     }
 
     os_sys_calls_.close(fd_);
@@ -139,9 +206,8 @@ FileImpl::~FileImpl() {
 }
 
 void FileImpl::doWrite(Buffer::Instance& buffer) {
-  uint64_t num_slices = buffer.getRawSlices(nullptr, 0);
-  Buffer::RawSlice slices[num_slices];
-  buffer.getRawSlices(slices, num_slices);
+  const MonotonicTime start_time = ProdMonotonicTimeSource::instance_.currentTime();
+  const uint64_t length = buffer.length();
 
   // We must do the actual writes to disk under lock, so that we don't intermix chunks from
   // different FileImpl pointing to the same underlying file. This can happen either via hot
@@ -153,102 +219,87 @@ void FileImpl::doWrite(Buffer::Instance& buffer) {
   //            process lock or had multiple locks.
   {
     Thread::LockGuard lock(file_lock_);
-    for (Buffer::RawSlice& slice : slices) {
-      ssize_t rc = os_sys_calls_.write(fd_, slice.mem_, slice.len_);
-      ASSERT(rc == static_cast<ssize_t>(slice.len_));
+    // Each write is a writev() of several slices of the buffer, which the buffer drains.
+    while (buffer.length() > 0) {
+      const Api::SysCallResult result = buffer.write(fd_);
+      if (result.rc_ < 0 && result.errno_ == EINTR) {
+        continue;
+      }
+      if (result.rc_ <= 0) {
+        stats_.write_failed_.inc();
+        buffer.drain(buffer.length());
+        break;
+      }
       stats_.write_completed_.inc();
     }
   }
 
-  stats_.write_total_buffered_.sub(buffer.length());
-  buffer.drain(buffer.length());
+  stats_.write_total_buffered_.sub(length);
+  stats_.flush_duration_us_.add(std::chrono::duration_cast<std::chrono::microseconds>(
+                                    ProdMonotonicTimeSource::instance_.currentTime() - start_time)
+                                    .count());
 }
 
-void FileImpl::flushThreadFunc() {
+void FileImpl::flushStagedData() {
+  Thread::LockGuard flush_lock(flush_lock_);
 
-  while (true) {
-    std::unique_lock<Thread::BasicLockable> flush_lock;
-
-    {
-      Thread::LockGuard write_lock(write_lock_);
+  // Clear the request before taking the data, so that writes that come in from now on ask for
+  // another flush.
+  flush_requested_ = false;
+  for (StagingBuffer& staging : staging_buffers_) {
+    Thread::LockGuard lock(staging.lock_);
+    staged_bytes_ -= staging.buffer_.length();
+    about_to_write_buffer_.move(staging.buffer_);
+  }
 
-      // flush_event_ can be woken up either by large enough flush_buffer or by timer.
-      // In case it was timer, flush_buffer_ can be empty.
-      while (flush_buffer_.length() == 0 && !flush_thread_exit_) {
-        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
-        flush_event_.wait(write_lock_);
-      }
+  if (about_to_write_buffer_.length() == 0) {
+    return;
+  }
 
-      if (flush_thread_exit_) {
-        return;
+  // if we failed to open file before (-1 == fd_), then simply ignore
+  if (fd_ != -1) {
+    try {
+      if (reopen_file_) {
+        reopen_file_ = false;
+        os_sys_calls_.close(fd_);
+        open();
       }
 
-      flush_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-      ASSERT(flush_buffer_.length() > 0);
-      about_to_write_buffer_.move(flush_buffer_);
-      ASSERT(flush_buffer_.length() == 0);
-    }
-
-    // if we failed to open file before (-1 == fd_), then simply ignore
-    if (fd_ != -1) {
-      try {
-        if (reopen_file_) {
-          reopen_file_ = false;
-          os_sys_calls_.close(fd_);
-          open();
-        }
-
-        doWrite(about_to_write_buffer_);
-      } catch (const EnvoyException&) {
-        stats_.reopen_failed_.inc();
-      }
+      doWrite(about_to_write_buffer_);
+    } catch (const EnvoyException&) {
+      stats_.reopen_failed_.inc();
     }
   }
 }
 
-void FileImpl::flush() {
-  std::unique_lock<Thread::BasicLockable> flush_buffer_lock;
+void FileImpl::flush() { flushStagedData(); }
 
-  {
-    Thread::LockGuard write_lock(write_lock_);
-
-    // flush_lock_ must be held while checking this or else it is
-    // possible that flushThreadFunc() has already moved data from
-    // flush_buffer_ to about_to_write_buffer_, has unlocked write_lock_,
-    // but has not yet completed doWrite(). This would allow flush() to
-    // return before the pending data has actually been written to disk.
-    flush_buffer_lock = std::unique_lock<Thread::BasicLockable>(flush_lock_);
-
-    if (flush_buffer_.length() == 0) {
-      return;
-    }
-
-    about_to_write_buffer_.move(flush_buffer_);
-    ASSERT(flush_buffer_.length() == 0);
+void FileImpl::requestFlush() {
+  if (!flush_requested_.exchange(true)) {
+    flush_thread_->requestFlush(*this);
   }
-
-  doWrite(about_to_write_buffer_);
 }
 
 void FileImpl::write(absl::string_view data) {
-  Thread::LockGuard lock(write_lock_);
+  if (!flush_timer_started_.exchange(true)) {
+    flush_timer_->enableTimer(flush_interval_msec_);
+  }
 
-  if (flush_thread_ == nullptr) {
-    createFlushStructures();
+  // The thread id is looked up once per thread, and keeps each thread on one staging buffer.
+  static thread_local const uint32_t thread_id = Thread::Thread::currentThreadId();
+  StagingBuffer& staging = staging_buffers_[thread_id % NUM_STAGING_BUFFERS];
+  {
+    Thread::LockGuard lock(staging.lock_);
+    staging.buffer_.add(data.data(), data.size());
+    staged_bytes_ += data.size();
   }
 
   stats_.write_buffered_.inc();
   stats_.write_total_buffered_.add(data.length());
-  flush_buffer_.add(data.data(), data.size());
-  if (flush_buffer_.length() > MIN_FLUSH_SIZE) {
-    flush_event_.notifyOne();
+  if (staged_bytes_ > MIN_FLUSH_SIZE) {
+    requestFlush();
   }
 }
 
-void FileImpl::createFlushStructures() {
-  flush_thread_.reset(new Thread::Thread([this]() -> void { flushThreadFunc(); }));
-  flush_timer_->enableTimer(flush_interval_msec_);
-}
-
 } // namespace Filesystem
 } // namespace Envoy
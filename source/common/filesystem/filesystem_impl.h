@@ -1,10 +1,13 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <cstdlib>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "envoy/api/os_sys_calls.h"
 #include "envoy/event/dispatcher.h"
@@ -22,6 +25,8 @@ namespace Envoy {
   COUNTER(write_completed)                                                                         \
   COUNTER(flushed_by_timer)                                                                        \
   COUNTER(reopen_failed)                                                                           \
+  COUNTER(write_failed)                                                                            \
+  COUNTER(flush_duration_us)                                                                       \
   GAUGE  (write_total_buffered)
 // clang-format on
 
@@ -72,17 +77,58 @@ std::string canonicalPath(const std::string& path);
  */
 bool illegalPath(const std::string& path);
 
+class FileImpl;
+
+/**
+ * A thread that writes the buffered data of files to disk. It is shared by all the files created
+ * by an Api::Impl, so that the number of flush threads stays at one no matter how many access logs
+ * are configured. Files are flushed one at a time, in the order they ask to be flushed.
+ */
+class FileFlushThread {
+public:
+  ~FileFlushThread();
+
+  /**
+   * Queue a file to be flushed by the thread. A file is queued at most once at a time. The thread
+   * is started on the first request.
+   * @param file supplies the file to flush.
+   */
+  void requestFlush(FileImpl& file);
+
+  /**
+   * Remove a file from the queue, waiting for a flush of the file that is in progress to finish.
+   * This must be called before the file is destroyed.
+   * @param file supplies the file to remove.
+   */
+  void removeFile(FileImpl& file);
+
+private:
+  void threadRoutine();
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar wakeup_;
+  Thread::CondVar flush_done_;
+  std::vector<FileImpl*> pending_files_ GUARDED_BY(lock_);
+  FileImpl* flushing_file_ GUARDED_BY(lock_){};
+  bool exit_ GUARDED_BY(lock_){};
+  Thread::ThreadPtr thread_ GUARDED_BY(lock_);
+};
+
+typedef std::shared_ptr<FileFlushThread> FileFlushThreadSharedPtr;
+
 /**
  * This is a file implementation geared for writing out access logs. It turn out that in certain
  * cases even if a standard file is opened with O_NONBLOCK, the kernel can still block when writing.
- * This implementation uses a flush thread per file, with the idea there there aren't that many
- * files. If this turns out to be a good implementation we can potentially have a single flush
- * thread that flushes all files, but we will start with this.
+ * Writes are staged in memory and written to disk by a FileFlushThread, which is shared with the
+ * other files. Writing threads are spread over several staging buffers with a lock each, so
+ * workers logging to the same file rarely wait on each other, and only wait on the flush thread
+ * for as long as it takes to move a staging buffer out.
  */
 class FileImpl : public File {
 public:
   FileImpl(const std::string& path, Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
-           Stats::Store& stats_store, std::chrono::milliseconds flush_interval_msec);
+           Stats::Store& stats_store, std::chrono::milliseconds flush_interval_msec,
+           FileFlushThreadSharedPtr flush_thread);
   ~FileImpl();
 
   // Filesystem::File
@@ -100,55 +146,60 @@ public:
   void flush() override;
 
 private:
+  friend class FileFlushThread;
+
+  struct StagingBuffer {
+    Thread::MutexBasicLockable lock_;
+    Buffer::OwnedImpl buffer_ GUARDED_BY(lock_);
+  };
+
   void doWrite(Buffer::Instance& buffer);
-  void flushThreadFunc();
+  void flushStagedData();
   void open();
-  void createFlushStructures();
+  void requestFlush();
 
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
+  // The number of staging buffers that writing threads are spread over.
+  static const uint32_t NUM_STAGING_BUFFERS = 8;
 
   int fd_;
   std::string path_;
 
   // These locks are always acquired in the following order if multiple locks are held:
-  //    1) write_lock_
-  //    2) flush_lock_
+  //    1) flush_lock_
+  //    2) the lock of a staging buffer
   //    3) file_lock_
-  Thread::BasicLockable& file_lock_;      // This lock is used only by the flush thread when writing
-                                          // to disk. This is used to make sure that file blocks do
-                                          // not get interleaved by multiple processes writing to
-                                          // the same file during hot-restart.
+  Thread::BasicLockable& file_lock_;      // This lock is used only when writing to disk. This is
+                                          // used to make sure that file blocks do not get
+                                          // interleaved by multiple processes writing to the same
+                                          // file during hot-restart.
   Thread::MutexBasicLockable flush_lock_; // This lock is used to prevent simulataneous flushes from
                                           // the flush thread and a syncronous flush. This protects
                                           // concurrent access to the about_to_write_buffer_, fd_,
                                           // and all other data used during flushing and file
                                           // re-opening.
-  Thread::MutexBasicLockable
-      write_lock_; // The lock is used when filling the flush buffer. It allows
-                   // multiple threads to write to the same file at relatively
-                   // high performance. It is always local to the process.
-  Thread::ThreadPtr flush_thread_;
-  Thread::CondVar flush_event_;
-  std::atomic<bool> flush_thread_exit_{};
+  std::array<StagingBuffer, NUM_STAGING_BUFFERS> staging_buffers_; // Filled by writing threads,
+                                                                   // each of which always uses
+                                                                   // the same buffer so that
+                                                                   // its writes stay in order.
+  std::atomic<uint64_t> staged_bytes_{};
+  std::atomic<bool> flush_requested_{};
+  std::atomic<bool> flush_timer_started_{};
   std::atomic<bool> reopen_file_{};
-  Buffer::OwnedImpl flush_buffer_
-      GUARDED_BY(write_lock_); // This buffer is used by multiple threads. It gets filled and
-                               // then flushed either when max size is reached or when a timer
-                               // fires.
   // TODO(jmarantz): this should be GUARDED_BY(flush_lock_) but the analysis cannot poke through
   // the std::make_unique assignment. I do not believe it's possible to annotate this properly now
   // due to limitations in the clang thread annotation analysis.
-  Buffer::OwnedImpl about_to_write_buffer_; // This buffer is used only by the flush thread. Data
-                                            // is moved from flush_buffer_ under lock, and then
-                                            // the lock is released so that flush_buffer_ can
-                                            // continue to fill. This buffer is then used for the
-                                            // final write to disk.
+  Buffer::OwnedImpl about_to_write_buffer_; // Data is moved here from the staging buffers under
+                                            // their locks, and then the locks are released so
+                                            // that the staging buffers can continue to fill. This
+                                            // buffer is then used for the final write to disk.
   Event::TimerPtr flush_timer_;
   Api::OsSysCalls& os_sys_calls_;
   const std::chrono::milliseconds flush_interval_msec_; // Time interval buffer gets flushed no
                                                         // matter if it reached the MIN_FLUSH_SIZE
                                                         // or not.
+  FileFlushThreadSharedPtr flush_thread_;
   FileSystemStats stats_;
 };
 
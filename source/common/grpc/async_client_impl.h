@@ -56,6 +56,9 @@ public:
   void sendMessage(const Protobuf::Message& request, bool end_stream) override;
   void closeStream() override;
   void resetStream() override;
+  bool isAboveWriteBufferHighWatermark() const override {
+    return stream_ != nullptr && stream_->isAboveWriteBufferHighWatermark();
+  }
 
   bool hasResetStream() const { return http_reset_; }
 
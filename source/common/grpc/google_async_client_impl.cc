@@ -188,6 +188,7 @@ void GoogleAsyncStreamImpl::notifyRemoteClose(Status::GrpcStatus grpc_status,
 
 void GoogleAsyncStreamImpl::sendMessage(const Protobuf::Message& request, bool end_stream) {
   write_pending_queue_.emplace(request, end_stream);
+  bytes_in_write_pending_queue_ += write_pending_queue_.back().buf_.value().Length();
   ENVOY_LOG(trace, "Queued message to write ({} bytes)",
             write_pending_queue_.back().buf_.value().Length());
   writeQueued();
@@ -291,6 +292,7 @@ void GoogleAsyncStreamImpl::handleOpCompletion(GoogleAsyncTag::Operation op, boo
   case GoogleAsyncTag::Operation::Write: {
     ASSERT(ok);
     write_pending_ = false;
+    bytes_in_write_pending_queue_ -= write_pending_queue_.front().buf_.value().Length();
     write_pending_queue_.pop();
     writeQueued();
     break;
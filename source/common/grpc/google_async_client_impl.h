@@ -203,6 +203,9 @@ public:
   void sendMessage(const Protobuf::Message& request, bool end_stream) override;
   void closeStream() override;
   void resetStream() override;
+  bool isAboveWriteBufferHighWatermark() const override {
+    return bytes_in_write_pending_queue_ > WRITE_BUFFER_HIGH_WATERMARK_BYTES;
+  }
 
 protected:
   bool call_failed() const { return call_failed_; }
@@ -249,6 +252,10 @@ private:
     const bool end_stream_;
   };
 
+  // The size of the queued writes above which the stream reports that it is backed up. This
+  // matches the default buffer limit of Envoy connections.
+  static constexpr uint64_t WRITE_BUFFER_HIGH_WATERMARK_BYTES = 1024 * 1024;
+
   GoogleAsyncTag init_tag_{*this, GoogleAsyncTag::Operation::Init};
   GoogleAsyncTag read_initial_metadata_tag_{*this, GoogleAsyncTag::Operation::ReadInitialMetadata};
   GoogleAsyncTag read_tag_{*this, GoogleAsyncTag::Operation::Read};
@@ -272,6 +279,8 @@ private:
   grpc::ClientContext ctxt_;
   std::unique_ptr<grpc::GenericClientAsyncReaderWriter> rw_;
   std::queue<PendingMessage> write_pending_queue_;
+  // The serialized size of the messages in write_pending_queue_.
+  uint64_t bytes_in_write_pending_queue_{};
   grpc::ByteBuffer read_buf_;
   grpc::Status status_;
   // Has Operation::Init completed?
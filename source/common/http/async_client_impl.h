@@ -80,6 +80,7 @@ public:
   void sendData(Buffer::Instance& data, bool end_stream) override;
   void sendTrailers(HeaderMap& trailers) override;
   void reset() override;
+  bool isAboveWriteBufferHighWatermark() const override { return high_watermark_calls_ > 0; }
 
 protected:
   bool remoteClosed() { return remote_closed_; }
@@ -90,7 +91,7 @@ private:
   struct NullCorsPolicy : public Router::CorsPolicy {
     // Router::CorsPolicy
     const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-    const std::list<std::regex>& allowOriginRegexes() const override {
+    const std::list<Regex::CompiledMatcherSharedPtr>& allowOriginRegexes() const override {
       return allow_origin_regex_;
     };
     const std::string& allowMethods() const override { return EMPTY_STRING; };
@@ -101,7 +102,7 @@ private:
     bool enabled() const override { return false; };
 
     static const std::list<std::string> allow_origin_;
-    static const std::list<std::regex> allow_origin_regex_;
+    static const std::list<Regex::CompiledMatcherSharedPtr> allow_origin_regex_;
     static const absl::optional<bool> allow_credentials_;
   };
 
@@ -289,8 +290,11 @@ private:
   void encodeHeaders(HeaderMapPtr&& headers, bool end_stream) override;
   void encodeData(Buffer::Instance& data, bool end_stream) override;
   void encodeTrailers(HeaderMapPtr&& trailers) override;
-  void onDecoderFilterAboveWriteBufferHighWatermark() override {}
-  void onDecoderFilterBelowWriteBufferLowWatermark() override {}
+  void onDecoderFilterAboveWriteBufferHighWatermark() override { ++high_watermark_calls_; }
+  void onDecoderFilterBelowWriteBufferLowWatermark() override {
+    ASSERT(high_watermark_calls_ > 0);
+    --high_watermark_calls_;
+  }
   void addDownstreamWatermarkCallbacks(DownstreamWatermarkCallbacks&) override {}
   void removeDownstreamWatermarkCallbacks(DownstreamWatermarkCallbacks&) override {}
   void setDecoderBufferLimit(uint32_t) override {}
@@ -307,6 +311,8 @@ private:
   bool remote_closed_{};
   Buffer::InstancePtr buffered_body_;
   bool is_grpc_request_{};
+  // The number of outstanding high watermark events from the router's upstream request.
+  uint32_t high_watermark_calls_{};
   friend class AsyncClientImpl;
 };
 
@@ -1,7 +1,7 @@
 #include "common/http/header_map_impl.h"
 
+#include <algorithm>
 #include <cstdint>
-#include <list>
 #include <string>
 
 #include "common/common/assert.h"
@@ -199,6 +199,49 @@ template <> bool HeaderMapImpl::HeaderList::isPseudoHeader(const LowerCaseString
   return key.get().c_str()[0] == ':';
 }
 
+HeaderMapImpl::HeaderList::~HeaderList() {
+  for (HeaderEntryImpl* entry : entries_) {
+    entry->~HeaderEntryImpl();
+  }
+}
+
+void HeaderMapImpl::HeaderList::erase(HeaderEntryImpl* entry) {
+  auto i = std::find(entries_.begin(), entries_.end(), entry);
+  ASSERT(i != entries_.end());
+  if (static_cast<size_t>(i - entries_.begin()) < pseudo_headers_end_) {
+    pseudo_headers_end_--;
+  }
+  entries_.erase(i);
+  destroy(entry);
+}
+
+void* HeaderMapImpl::HeaderList::allocateSlot() {
+  if (free_slots_ != nullptr) {
+    void* slot = free_slots_;
+    free_slots_ = *static_cast<void**>(slot);
+    return slot;
+  }
+
+  if (overflow_blocks_.empty()) {
+    if (next_unused_slot_ < InlineEntries) {
+      return &inline_slots_[next_unused_slot_++];
+    }
+    overflow_blocks_.emplace_back(new Block);
+    next_unused_slot_ = 0;
+  } else if (next_unused_slot_ == BlockEntries) {
+    overflow_blocks_.emplace_back(new Block);
+    next_unused_slot_ = 0;
+  }
+  return &overflow_blocks_.back()->slots_[next_unused_slot_++];
+}
+
+void HeaderMapImpl::HeaderList::destroy(HeaderEntryImpl* entry) {
+  entry->~HeaderEntryImpl();
+  void* slot = entry;
+  *static_cast<void**>(slot) = free_slots_;
+  free_slots_ = slot;
+}
+
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key) : key_(key) {}
 
 HeaderMapImpl::HeaderEntryImpl::HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value)
@@ -276,7 +319,18 @@ void HeaderMapImpl::appendToHeader(HeaderString& header, absl::string_view data)
 
 HeaderMapImpl::HeaderMapImpl() { memset(&inline_headers_, 0, sizeof(inline_headers_)); }
 
-HeaderMapImpl::HeaderMapImpl(const HeaderMap& rhs) : HeaderMapImpl() {
+HeaderMapImpl::HeaderMapImpl(const HeaderMap& rhs) : HeaderMapImpl() { copyFrom(rhs); }
+
+HeaderMapImpl& HeaderMapImpl::operator=(const HeaderMapImpl& rhs) {
+  if (this != &rhs) {
+    headers_.remove_if([](const HeaderEntryImpl&) { return true; });
+    memset(&inline_headers_, 0, sizeof(inline_headers_));
+    copyFrom(rhs);
+  }
+  return *this;
+}
+
+void HeaderMapImpl::copyFrom(const HeaderMap& rhs) {
   rhs.iterate(
       [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
         // TODO(mattklein123) PERF: Avoid copying here is not necessary.
@@ -310,7 +364,7 @@ bool HeaderMapImpl::operator==(const HeaderMapImpl& rhs) const {
   }
 
   for (auto i = headers_.begin(), j = rhs.headers_.begin(); i != headers_.end(); ++i, ++j) {
-    if (i->key() != j->key().c_str() || i->value() != j->value().c_str()) {
+    if ((*i)->key() != (*j)->key().c_str() || (*i)->value() != (*j)->value().c_str()) {
       return false;
     }
   }
@@ -326,8 +380,7 @@ void HeaderMapImpl::insertByKey(HeaderString&& key, HeaderString&& value) {
     ASSERT(*ref_lookup_response.entry_ == nullptr); // This function doesn't handle append.
     maybeCreateInline(ref_lookup_response.entry_, *ref_lookup_response.key_, std::move(value));
   } else {
-    std::list<HeaderEntryImpl>::iterator i = headers_.insert(std::move(key), std::move(value));
-    i->entry_ = i;
+    headers_.insert(std::move(key), std::move(value));
   }
 }
 
@@ -416,18 +469,18 @@ void HeaderMapImpl::setReferenceKey(const LowerCaseString& key, const std::strin
 
 uint64_t HeaderMapImpl::byteSize() const {
   uint64_t byte_size = 0;
-  for (const HeaderEntryImpl& header : headers_) {
-    byte_size += header.key().size();
-    byte_size += header.value().size();
+  for (const HeaderEntryImpl* header : headers_) {
+    byte_size += header->key().size();
+    byte_size += header->value().size();
   }
 
   return byte_size;
 }
 
 const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
+  for (const HeaderEntryImpl* header : headers_) {
+    if (header->key() == key.get().c_str()) {
+      return header;
     }
   }
 
@@ -435,9 +488,9 @@ const HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) const {
 }
 
 HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) {
-  for (HeaderEntryImpl& header : headers_) {
-    if (header.key() == key.get().c_str()) {
-      return &header;
+  for (HeaderEntryImpl* header : headers_) {
+    if (header->key() == key.get().c_str()) {
+      return header;
     }
   }
 
@@ -445,8 +498,8 @@ HeaderEntry* HeaderMapImpl::get(const LowerCaseString& key) {
 }
 
 void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
-  for (const HeaderEntryImpl& header : headers_) {
-    if (cb(header, context) == HeaderMap::Iterate::Break) {
+  for (const HeaderEntryImpl* header : headers_) {
+    if (cb(*header, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
@@ -454,7 +507,7 @@ void HeaderMapImpl::iterate(ConstIterateCb cb, void* context) const {
 
 void HeaderMapImpl::iterateReverse(ConstIterateCb cb, void* context) const {
   for (auto it = headers_.rbegin(); it != headers_.rend(); it++) {
-    if (cb(*it, context) == HeaderMap::Iterate::Break) {
+    if (cb(**it, context) == HeaderMap::Iterate::Break) {
       break;
     }
   }
@@ -489,13 +542,8 @@ void HeaderMapImpl::remove(const LowerCaseString& key) {
     StaticLookupResponse ref_lookup_response = cb(*this);
     removeInline(ref_lookup_response.entry_);
   } else {
-    for (auto i = headers_.begin(); i != headers_.end();) {
-      if (i->key() == key.get().c_str()) {
-        i = headers_.erase(i);
-      } else {
-        ++i;
-      }
-    }
+    headers_.remove_if(
+        [&](const HeaderEntryImpl& entry) { return entry.key() == key.get().c_str(); });
   }
 }
 
@@ -524,9 +572,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key);
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.insert(key);
   return **entry;
 }
 
@@ -538,9 +584,7 @@ HeaderMapImpl::HeaderEntryImpl& HeaderMapImpl::maybeCreateInline(HeaderEntryImpl
     return **entry;
   }
 
-  std::list<HeaderEntryImpl>::iterator i = headers_.insert(key, std::move(value));
-  i->entry_ = i;
-  *entry = &(*i);
+  *entry = &headers_.insert(key, std::move(value));
   return **entry;
 }
 
@@ -560,7 +604,7 @@ void HeaderMapImpl::removeInline(HeaderEntryImpl** ptr_to_entry) {
 
   HeaderEntryImpl* entry = *ptr_to_entry;
   *ptr_to_entry = nullptr;
-  headers_.erase(entry->entry_);
+  headers_.erase(entry);
 }
 
 } // namespace Http
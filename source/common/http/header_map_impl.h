@@ -2,15 +2,18 @@
 
 #include <array>
 #include <cstdint>
-#include <list>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 #include "envoy/http/header_map.h"
 
 #include "common/common/non_copyable.h"
 #include "common/http/headers.h"
 
+#include "absl/container/inlined_vector.h"
+
 namespace Envoy {
 namespace Http {
 
@@ -33,7 +36,8 @@ public:
  * headers are added to the map, we do a hash lookup to see if it's one of the O(1) headers.
  * If it is, we store a reference to it that can be accessed later directly. Most high performance
  * paths use O(1) direct access. In general, we try to copy as little as possible and allocate as
- * little as possible in any of the paths.
+ * little as possible in any of the paths. The header entries themselves are stored inside the map
+ * (see HeaderList), so maps with a typical number of headers need no allocations of their own.
  */
 class HeaderMapImpl : public HeaderMap {
 public:
@@ -48,6 +52,9 @@ public:
   HeaderMapImpl();
   HeaderMapImpl(const std::initializer_list<std::pair<LowerCaseString, std::string>>& values);
   HeaderMapImpl(const HeaderMap& rhs);
+  // The O(1) header table points into the map's own storage, so copies are made entry by entry.
+  HeaderMapImpl(const HeaderMapImpl& rhs) : HeaderMapImpl(static_cast<const HeaderMap&>(rhs)) {}
+  HeaderMapImpl& operator=(const HeaderMapImpl& rhs);
 
   /**
    * Add a header via full move. This is the expected high performance paths for codecs populating
@@ -96,7 +103,6 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
   };
 
   struct StaticLookupResponse {
@@ -128,57 +134,93 @@ protected:
   };
 
   /**
-   * List of HeaderEntryImpl that keeps the pseudo headers (key starting with ':') in the front
-   * of the list (as required by nghttp2) and otherwise maintains insertion order.
+   * Storage for the HeaderEntryImpls of a map. Entries are constructed in place in slots. The
+   * first InlineEntries slots are part of the map itself and further slots are allocated in blocks
+   * of BlockEntries as the map grows. Entries never move once constructed, so
+   * pointers to them (inline headers and the results of get()) stay valid until the entry is
+   * removed, as they did with the previous std::list storage.
+   *
+   * Iteration order is kept separately in a contiguous vector of entry pointers, which keeps the
+   * pseudo headers (key starting with ':') in the front (as required by nghttp2) and otherwise
+   * maintains insertion order.
    */
-  class HeaderList {
+  class HeaderList : NonCopyable {
   public:
-    HeaderList() : pseudo_headers_end_(headers_.end()) {}
+    // Each entry is ~300 bytes, so only a few are embedded in the map to keep maps that hold few
+    // headers (e.g. trailers) small.
+    static constexpr size_t InlineEntries = 4;
+    // Large enough to hold the remaining headers of typical requests and responses in one block.
+    static constexpr size_t BlockEntries = 16;
+
+    typedef absl::InlinedVector<HeaderEntryImpl*, BlockEntries> EntryVector;
+
+    HeaderList() {}
+    ~HeaderList();
 
     template <class Key> bool isPseudoHeader(const Key& key) { return key.c_str()[0] == ':'; }
 
-    template <class Key, class... Value>
-    std::list<HeaderEntryImpl>::iterator insert(Key&& key, Value&&... value) {
+    template <class Key, class... Value> HeaderEntryImpl& insert(Key&& key, Value&&... value) {
       const bool is_pseudo_header = isPseudoHeader(key);
-      std::list<HeaderEntryImpl>::iterator i =
-          headers_.emplace(is_pseudo_header ? pseudo_headers_end_ : headers_.end(),
-                           std::forward<Key>(key), std::forward<Value>(value)...);
-      if (!is_pseudo_header && pseudo_headers_end_ == headers_.end()) {
-        pseudo_headers_end_ = i;
-      }
-      return i;
-    }
-
-    std::list<HeaderEntryImpl>::iterator erase(std::list<HeaderEntryImpl>::iterator i) {
-      if (pseudo_headers_end_ == i) {
+      HeaderEntryImpl* entry = new (allocateSlot())
+          HeaderEntryImpl(std::forward<Key>(key), std::forward<Value>(value)...);
+      if (is_pseudo_header) {
+        entries_.insert(entries_.begin() + pseudo_headers_end_, entry);
         pseudo_headers_end_++;
+      } else {
+        entries_.push_back(entry);
       }
-      return headers_.erase(i);
+      return *entry;
     }
 
+    void erase(HeaderEntryImpl* entry);
+
     template <class UnaryPredicate> void remove_if(UnaryPredicate p) {
-      headers_.remove_if([&](const HeaderEntryImpl& entry) {
-        const bool to_remove = p(entry);
-        if (to_remove) {
-          if (pseudo_headers_end_ == entry.entry_) {
-            pseudo_headers_end_++;
+      size_t num_kept = 0;
+      size_t num_pseudo_headers_removed = 0;
+      for (size_t i = 0; i < entries_.size(); i++) {
+        HeaderEntryImpl* entry = entries_[i];
+        if (p(*entry)) {
+          if (i < pseudo_headers_end_) {
+            num_pseudo_headers_removed++;
           }
+          destroy(entry);
+        } else {
+          entries_[num_kept++] = entry;
         }
-        return to_remove;
-      });
+      }
+      pseudo_headers_end_ -= num_pseudo_headers_removed;
+      entries_.resize(num_kept);
     }
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
-    size_t size() const { return headers_.size(); }
+    EntryVector::const_iterator begin() const { return entries_.begin(); }
+    EntryVector::const_iterator end() const { return entries_.end(); }
+    EntryVector::const_reverse_iterator rbegin() const { return entries_.rbegin(); }
+    EntryVector::const_reverse_iterator rend() const { return entries_.rend(); }
+    size_t size() const { return entries_.size(); }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
-    std::list<HeaderEntryImpl>::iterator pseudo_headers_end_;
+    typedef std::aligned_storage<sizeof(HeaderEntryImpl), alignof(HeaderEntryImpl)>::type Slot;
+
+    struct Block {
+      std::array<Slot, BlockEntries> slots_;
+    };
+
+    // Returns uninitialized storage for one HeaderEntryImpl, reusing the slot of a removed entry if
+    // there is one.
+    void* allocateSlot();
+    // Destroys the entry and returns its slot to the free list. Does not update entries_.
+    void destroy(HeaderEntryImpl* entry);
+
+    std::array<Slot, InlineEntries> inline_slots_;
+    std::vector<std::unique_ptr<Block>> overflow_blocks_;
+    // Number of slots of the last block (overflow_blocks_.back(), or inline_slots_ if there are no
+    // overflow blocks) that have been handed out.
+    size_t next_unused_slot_{0};
+    // Singly linked list of free slots, threaded through the free slots themselves.
+    void* free_slots_{nullptr};
+    EntryVector entries_;
+    // Number of pseudo headers, all of which are at the front of entries_.
+    size_t pseudo_headers_end_{0};
   };
 
   void insertByKey(HeaderString&& key, HeaderString&& value);
@@ -188,6 +230,7 @@ protected:
   HeaderEntryImpl* getExistingInline(const char* key);
 
   void removeInline(HeaderEntryImpl** entry);
+  void copyFrom(const HeaderMap& rhs);
 
   AllInlineHeaders inline_headers_;
   HeaderList headers_;
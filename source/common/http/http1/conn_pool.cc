@@ -1,5 +1,6 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <cmath>
 #include <cstdint>
 #include <list>
 
@@ -50,6 +51,24 @@ void ConnPoolImpl::drainConnections() {
   }
 }
 
+void ConnPoolImpl::prefetch() {
+  const float ratio = host_->cluster().perUpstreamPrefetchRatio();
+  if (ratio <= 1.0 || !drained_callbacks_.empty()) {
+    return;
+  }
+
+  // Keep enough connections for the ratio times the current demand plus the next request, so that
+  // even an idle pool has a connection ready. Connecting clients are in the busy list and move to
+  // the ready list once connected, unless a pending request grabs them first.
+  const uint64_t demand = active_requests_ + pending_requests_.size() + 1;
+  const uint64_t target = static_cast<uint64_t>(std::ceil(ratio * demand)) - 1;
+  while (ready_clients_.size() + busy_clients_.size() < target &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+    createNewConnection();
+  }
+}
+
 void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
   drained_callbacks_.push_back(cb);
   checkForDrained();
@@ -88,6 +107,7 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
     ready_clients_.front()->moveBetweenLists(ready_clients_, busy_clients_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_clients_.front()->codec_client_);
     attachRequestToClient(*busy_clients_.front(), response_decoder, callbacks);
+    prefetch();
     return nullptr;
   }
 
@@ -106,6 +126,7 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(StreamDecoder& response_dec
     ENVOY_LOG(debug, "queueing request due to no available connections");
     PendingRequestPtr pending_request(new PendingRequest(*this, response_decoder, callbacks));
     pending_request->moveIntoList(std::move(pending_request), pending_requests_);
+    prefetch();
     return pending_requests_.front().get();
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
@@ -187,7 +208,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   // drain/destruction event, we key off of the existence of the connect timer above to determine
   // whether the client is in the ready list (connected) or the busy list (failed to connect).
   if (event == Network::ConnectionEvent::Connected) {
-    conn_connect_ms_->complete();
+    client.conn_connect_ms_->complete();
     processIdleClient(client, false);
   }
 }
@@ -269,11 +290,13 @@ ConnPoolImpl::StreamWrapper::StreamWrapper(StreamDecoder& response_decoder, Acti
   StreamEncoderWrapper::inner_.getStream().addCallbacks(*this);
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.inc();
   parent_.parent_.host_->stats().rq_active_.inc();
+  parent_.parent_.active_requests_++;
 }
 
 ConnPoolImpl::StreamWrapper::~StreamWrapper() {
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.dec();
   parent_.parent_.host_->stats().rq_active_.dec();
+  parent_.parent_.active_requests_--;
 }
 
 void ConnPoolImpl::StreamWrapper::onEncodeComplete() { encode_complete_ = true; }
@@ -312,7 +335,7 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
       connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })),
       remaining_requests_(parent_.host_->cluster().maxRequestsPerConnection()) {
 
-  parent_.conn_connect_ms_.reset(
+  conn_connect_ms_.reset(
       new Stats::Timespan(parent_.host_->cluster().stats().upstream_cx_connect_ms_));
   Upstream::Host::CreateConnectionData data =
       parent_.host_->createConnection(parent_.dispatcher_, parent_.socket_options_);
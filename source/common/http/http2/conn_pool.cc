@@ -20,12 +20,12 @@ ConnPoolImpl::ConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSha
     : dispatcher_(dispatcher), host_(host), priority_(priority), socket_options_(options) {}
 
 ConnPoolImpl::~ConnPoolImpl() {
-  if (primary_client_) {
-    primary_client_->client_->close();
+  while (!active_clients_.empty()) {
+    active_clients_.front()->client_->close();
   }
 
-  if (draining_client_) {
-    draining_client_->client_->close();
+  while (!draining_clients_.empty()) {
+    draining_clients_.front()->client_->close();
   }
 
   // Make sure all clients are destroyed before we are destroyed.
@@ -33,11 +33,25 @@ ConnPoolImpl::~ConnPoolImpl() {
 }
 
 void ConnPoolImpl::ConnPoolImpl::drainConnections() {
-  if (primary_client_ != nullptr) {
-    movePrimaryClientToDraining();
+  while (!active_clients_.empty()) {
+    moveClientToDraining(*active_clients_.front());
   }
 }
 
+void ConnPoolImpl::prefetch() {
+  // A single connection carries many streams, so there is nothing to gain from opening more than
+  // one ahead of demand; just make sure the first request doesn't wait for the handshake.
+  if (host_->cluster().perUpstreamPrefetchRatio() <= 1.0 || !drained_callbacks_.empty() ||
+      !active_clients_.empty() ||
+      !host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    return;
+  }
+
+  host_->cluster().stats().upstream_cx_prefetch_.inc();
+  ActiveClientPtr client(new ActiveClient(*this));
+  client->moveIntoListBack(std::move(client), active_clients_);
+}
+
 void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
   drained_callbacks_.push_back(cb);
   checkForDrained();
@@ -49,17 +63,19 @@ void ConnPoolImpl::checkForDrained() {
   }
 
   bool drained = true;
-  if (primary_client_) {
-    if (primary_client_->client_->numActiveRequests() == 0) {
-      primary_client_->client_->close();
-      ASSERT(!primary_client_);
+  for (auto it = active_clients_.begin(); it != active_clients_.end();) {
+    // Closing the client removes it from the list, so advance first.
+    ActiveClient& client = **it++;
+    if (client.client_->numActiveRequests() == 0) {
+      client.client_->close();
     } else {
       drained = false;
     }
   }
 
-  ASSERT(!draining_client_ || (draining_client_->client_->numActiveRequests() > 0));
-  if (draining_client_ && draining_client_->client_->numActiveRequests() > 0) {
+  // Draining clients are closed as soon as their last stream completes, so any that remain still
+  // have active streams.
+  if (!draining_clients_.empty()) {
     drained = false;
   }
 
@@ -75,39 +91,61 @@ ConnectionPool::Cancellable* ConnPoolImpl::newStream(Http::StreamDecoder& respon
                                                      ConnectionPool::Callbacks& callbacks) {
   ASSERT(drained_callbacks_.empty());
 
-  // First see if we need to handle max streams rollover.
-  uint64_t max_streams = host_->cluster().maxRequestsPerConnection();
-  if (max_streams == 0) {
-    max_streams = maxTotalStreams();
-  }
-
-  if (primary_client_ && primary_client_->total_streams_ >= max_streams) {
-    movePrimaryClientToDraining();
-  }
-
-  if (!primary_client_) {
-    primary_client_.reset(new ActiveClient(*this));
-  }
-
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
     ENVOY_LOG(debug, "max requests overflow");
     callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
-    ENVOY_CONN_LOG(debug, "creating stream", *primary_client_->client_);
-    primary_client_->total_streams_++;
+    ActiveClient& client = selectClient();
+    ENVOY_CONN_LOG(debug, "creating stream", *client.client_);
+    host_->cluster().stats().upstream_cx_http2_active_streams_.recordValue(
+        client.client_->numActiveRequests());
+    client.total_streams_++;
     host_->stats().rq_total_.inc();
     host_->stats().rq_active_.inc();
     host_->cluster().stats().upstream_rq_total_.inc();
     host_->cluster().stats().upstream_rq_active_.inc();
     host_->cluster().resourceManager(priority_).requests().inc();
-    callbacks.onPoolReady(primary_client_->client_->newStream(response_decoder),
-                          primary_client_->real_host_description_);
+    callbacks.onPoolReady(client.client_->newStream(response_decoder),
+                          client.real_host_description_);
   }
 
   return nullptr;
 }
 
+ConnPoolImpl::ActiveClient& ConnPoolImpl::selectClient() {
+  uint64_t max_streams = host_->cluster().maxRequestsPerConnection();
+  if (max_streams == 0) {
+    max_streams = maxTotalStreams();
+  }
+
+  // Pick the active client with the fewest streams in flight, handling max streams rollover for
+  // any client that has used up its streams along the way.
+  ActiveClient* selected = nullptr;
+  for (auto it = active_clients_.begin(); it != active_clients_.end();) {
+    // Draining the client removes it from the list, so advance first.
+    ActiveClient& client = **it++;
+    if (client.total_streams_ >= max_streams) {
+      moveClientToDraining(client);
+    } else if (selected == nullptr || client.client_->numActiveRequests() <
+                                          selected->client_->numActiveRequests()) {
+      selected = &client;
+    }
+  }
+
+  // Only open another connection if every existing one is busy, so that a lightly loaded pool
+  // keeps multiplexing over as few connections as possible.
+  const uint32_t max_connections = host_->cluster().http2Settings().max_connections_per_host_;
+  if (selected == nullptr || (selected->client_->numActiveRequests() > 0 &&
+                              active_clients_.size() < max_connections)) {
+    ActiveClientPtr client(new ActiveClient(*this));
+    selected = client.get();
+    selected->moveIntoListBack(std::move(client), active_clients_);
+  }
+
+  return *selected;
+}
+
 void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
@@ -121,12 +159,12 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
       }
     }
 
-    if (&client == primary_client_.get()) {
-      ENVOY_CONN_LOG(debug, "destroying primary client", *client.client_);
-      dispatcher_.deferredDelete(std::move(primary_client_));
-    } else {
+    if (client.draining_) {
       ENVOY_CONN_LOG(debug, "destroying draining client", *client.client_);
-      dispatcher_.deferredDelete(std::move(draining_client_));
+      dispatcher_.deferredDelete(client.removeFromList(draining_clients_));
+    } else {
+      ENVOY_CONN_LOG(debug, "destroying active client", *client.client_);
+      dispatcher_.deferredDelete(client.removeFromList(active_clients_));
     }
 
     if (client.connect_timer_) {
@@ -140,7 +178,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 
   if (event == Network::ConnectionEvent::Connected) {
-    conn_connect_ms_->complete();
+    client.conn_connect_ms_->complete();
   }
 
   if (client.connect_timer_) {
@@ -149,25 +187,16 @@ void ConnPoolImpl::onConnectionEvent(ActiveClient& client, Network::ConnectionEv
   }
 }
 
-void ConnPoolImpl::movePrimaryClientToDraining() {
-  ENVOY_CONN_LOG(debug, "moving primary to draining", *primary_client_->client_);
-  if (draining_client_) {
-    // This should pretty much never happen, but is possible if we start draining and then get
-    // a goaway for example. In this case just kill the current draining connection. It's not
-    // worth keeping a list.
-    draining_client_->client_->close();
-  }
-
-  ASSERT(!draining_client_);
-  if (primary_client_->client_->numActiveRequests() == 0) {
-    // If we are making a new connection and the primary does not have any active requests just
-    // close it now.
-    primary_client_->client_->close();
+void ConnPoolImpl::moveClientToDraining(ActiveClient& client) {
+  ENVOY_CONN_LOG(debug, "moving client to draining", *client.client_);
+  ASSERT(!client.draining_);
+  if (client.client_->numActiveRequests() == 0) {
+    // If the client does not have any active requests just close it now.
+    client.client_->close();
   } else {
-    draining_client_ = std::move(primary_client_);
+    client.draining_ = true;
+    client.moveBetweenLists(active_clients_, draining_clients_);
   }
-
-  ASSERT(!primary_client_);
 }
 
 void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
@@ -179,8 +208,8 @@ void ConnPoolImpl::onConnectTimeout(ActiveClient& client) {
 void ConnPoolImpl::onGoAway(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "remote goaway", *client.client_);
   host_->cluster().stats().upstream_cx_close_notify_.inc();
-  if (&client == primary_client_.get()) {
-    movePrimaryClientToDraining();
+  if (!client.draining_) {
+    moveClientToDraining(client);
   }
 }
 
@@ -190,7 +219,7 @@ void ConnPoolImpl::onStreamDestroy(ActiveClient& client) {
   host_->stats().rq_active_.dec();
   host_->cluster().stats().upstream_rq_active_.dec();
   host_->cluster().resourceManager(priority_).requests().dec();
-  if (&client == draining_client_.get() && client.client_->numActiveRequests() == 0) {
+  if (client.draining_ && client.client_->numActiveRequests() == 0) {
     // Close out the draining client if we no long have active requests.
     client.client_->close();
   }
@@ -219,7 +248,7 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
     : parent_(parent),
       connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })) {
 
-  parent_.conn_connect_ms_.reset(
+  conn_connect_ms_.reset(
       new Stats::Timespan(parent_.host_->cluster().stats().upstream_cx_connect_ms_));
   Upstream::Host::CreateConnectionData data =
       parent_.host_->createConnection(parent_.dispatcher_, parent_.socket_options_);
@@ -247,6 +276,7 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
 ConnPoolImpl::ActiveClient::~ActiveClient() {
   parent_.host_->stats().cx_active_.dec();
   parent_.host_->cluster().stats().upstream_cx_active_.dec();
+  parent_.host_->cluster().stats().upstream_cx_http2_streams_.recordValue(total_streams_);
   conn_length_->complete();
 }
 
@@ -10,6 +10,7 @@
 #include "envoy/stats/timespan.h"
 #include "envoy/upstream/upstream.h"
 
+#include "common/common/linked_object.h"
 #include "common/http/codec_client.h"
 
 namespace Envoy {
@@ -17,9 +18,12 @@ namespace Http {
 namespace Http2 {
 
 /**
- * Implementation of a "connection pool" for HTTP/2. This mainly handles stats as well as
- * shifting to a new connection if we reach max streams on the primary. This is a base class
- * used for both the prod implementation as well as the testing one.
+ * Implementation of a "connection pool" for HTTP/2. Streams are multiplexed over up to
+ * Http2Settings::max_connections_per_host_ active connections: each new stream goes to the active
+ * connection with the fewest active streams, and a new connection is only opened when every
+ * active connection already has streams in flight. A connection that reaches max streams or
+ * receives a GOAWAY is moved to draining and closed once its last stream completes. This is a base
+ * class used for both the prod implementation as well as the testing one.
  */
 class ConnPoolImpl : Logger::Loggable<Logger::Id::pool>, public ConnectionPool::Instance {
 public:
@@ -32,11 +36,13 @@ public:
   Http::Protocol protocol() const override { return Http::Protocol::Http2; }
   void addDrainedCallback(DrainedCb cb) override;
   void drainConnections() override;
+  void prefetch() override;
   ConnectionPool::Cancellable* newStream(Http::StreamDecoder& response_decoder,
                                          ConnectionPool::Callbacks& callbacks) override;
 
 protected:
-  struct ActiveClient : public Network::ConnectionCallbacks,
+  struct ActiveClient : LinkedObject<ActiveClient>,
+                        public Network::ConnectionCallbacks,
                         public CodecClientCallbacks,
                         public Event::DeferredDeletable,
                         public Http::ConnectionCallbacks {
@@ -66,8 +72,10 @@ protected:
     Upstream::HostDescriptionConstSharedPtr real_host_description_;
     uint64_t total_streams_{};
     Event::TimerPtr connect_timer_;
+    Stats::TimespanPtr conn_connect_ms_;
     Stats::TimespanPtr conn_length_;
     bool closed_with_active_rq_{};
+    bool draining_{};
   };
 
   typedef std::unique_ptr<ActiveClient> ActiveClientPtr;
@@ -75,18 +83,18 @@ protected:
   void checkForDrained();
   virtual CodecClientPtr createCodecClient(Upstream::Host::CreateConnectionData& data) PURE;
   virtual uint32_t maxTotalStreams() PURE;
-  void movePrimaryClientToDraining();
+  void moveClientToDraining(ActiveClient& client);
+  ActiveClient& selectClient();
   void onConnectionEvent(ActiveClient& client, Network::ConnectionEvent event);
   void onConnectTimeout(ActiveClient& client);
   void onGoAway(ActiveClient& client);
   void onStreamDestroy(ActiveClient& client);
   void onStreamReset(ActiveClient& client, Http::StreamResetReason reason);
 
-  Stats::TimespanPtr conn_connect_ms_;
   Event::Dispatcher& dispatcher_;
   Upstream::HostConstSharedPtr host_;
-  ActiveClientPtr primary_client_;
-  ActiveClientPtr draining_client_;
+  std::list<ActiveClientPtr> active_clients_;
+  std::list<ActiveClientPtr> draining_clients_;
   std::list<DrainedCb> drained_callbacks_;
   Upstream::ResourcePriority priority_;
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
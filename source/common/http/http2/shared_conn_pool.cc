@@ -0,0 +1,418 @@
+#include "common/http/http2/shared_conn_pool.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+OwnerConnPoolImpl::OwnerConnPoolImpl(Event::Dispatcher& dispatcher,
+                                     ConnectionPool::InstancePtr&& pool,
+                                     std::function<void()> unregister_cb)
+    : pool_(std::move(pool)), shared_(std::make_shared<SharedConnPool>(dispatcher, *pool_)),
+      unregister_cb_(unregister_cb) {}
+
+OwnerConnPoolImpl::~OwnerConnPoolImpl() { unregister(); }
+
+void OwnerConnPoolImpl::addDrainedCallback(DrainedCb cb) {
+  // The owner of a pool that is being drained must not create new streams on it, so streams that
+  // are still being forwarded from other workers fail from here on.
+  unregister();
+  pool_->addDrainedCallback(cb);
+}
+
+void OwnerConnPoolImpl::unregister() {
+  if (unregister_cb_) {
+    shared_->pool_ = nullptr;
+    shared_->unregistered_ = true;
+    unregister_cb_();
+    unregister_cb_ = nullptr;
+  }
+}
+
+ForwardingConnPoolImpl::ForwardingConnPoolImpl(Event::Dispatcher& dispatcher,
+                                               Upstream::HostConstSharedPtr host,
+                                               Http::Protocol protocol,
+                                               const SharedConnPoolSharedPtr& shared,
+                                               std::function<ConnectionPool::InstancePtr()>
+                                                   local_pool_factory)
+    : dispatcher_(dispatcher), host_(host), protocol_(protocol), shared_(shared),
+      local_pool_factory_(local_pool_factory) {}
+
+ForwardingConnPoolImpl::~ForwardingConnPoolImpl() {
+  // Make sure the owner and the local pool let go of any streams that are still in flight.
+  while (!streams_.empty()) {
+    streams_.front()->cancel();
+  }
+
+  // Make sure all streams are destroyed before we are destroyed.
+  dispatcher_.clearDeferredDeleteList();
+}
+
+void ForwardingConnPoolImpl::addDrainedCallback(DrainedCb cb) {
+  drained_callbacks_.push_back(cb);
+  checkForDrained();
+}
+
+void ForwardingConnPoolImpl::drainConnections() {
+  if (local_pool_ != nullptr) {
+    local_pool_->drainConnections();
+  }
+}
+
+void ForwardingConnPoolImpl::prefetch() {
+  if (local_pool_ != nullptr) {
+    local_pool_->prefetch();
+  }
+}
+
+ConnectionPool::Instance& ForwardingConnPoolImpl::localPool() {
+  if (local_pool_ == nullptr) {
+    ENVOY_LOG(debug, "shared pool is draining, creating a local pool");
+    local_pool_ = local_pool_factory_();
+  }
+  return *local_pool_;
+}
+
+void ForwardingConnPoolImpl::checkForDrained() {
+  if (drained_callbacks_.empty()) {
+    return;
+  }
+
+  // The local pool is only watched from here, once it holds every stream moved to it, since it
+  // would otherwise report being drained before a moved stream is created on it.
+  if (local_pool_ != nullptr && !local_pool_watched_) {
+    local_pool_watched_ = true;
+    // The local pool may report that it has drained right away, which checks for this pool too.
+    local_pool_->addDrainedCallback([this]() -> void {
+      local_pool_drained_ = true;
+      checkForDrained();
+    });
+    return;
+  }
+
+  if (streams_.empty() && (local_pool_ == nullptr || local_pool_drained_)) {
+    ENVOY_LOG(debug, "invoking drained callbacks");
+    for (const DrainedCb& cb : drained_callbacks_) {
+      cb();
+    }
+  }
+}
+
+ConnectionPool::Cancellable*
+ForwardingConnPoolImpl::newStream(Http::StreamDecoder& response_decoder,
+                                  ConnectionPool::Callbacks& callbacks) {
+  ASSERT(drained_callbacks_.empty());
+  if (local_pool_ != nullptr || shared_->unregistered_) {
+    // The owner's pool is draining, and this pool will be replaced once the host's pools drain on
+    // this worker too. Until then, streams use a pool of this worker's own rather than failing.
+    return localPool().newStream(response_decoder, callbacks);
+  }
+
+  ENVOY_LOG(debug, "forwarding stream to shared pool");
+  host_->cluster().stats().upstream_rq_forwarded_.inc();
+
+  WorkerStreamPtr stream(new WorkerStream(*this, response_decoder, callbacks));
+  stream->moveIntoList(std::move(stream), streams_);
+  streams_.front()->postToOwner([](OwnerStream& owner) -> void { owner.newStream(); });
+  return streams_.front().get();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::postToWorker(std::function<void(WorkerStream&)> cb) {
+  OwnerStreamSharedPtr self = shared_from_this();
+  worker_dispatcher_.post([self, cb]() -> void {
+    if (self->worker_stream_ != nullptr) {
+      cb(*self->worker_stream_);
+    }
+  });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::newStream() {
+  if (shared_->pool_ == nullptr) {
+    // The owner's pool started draining after the stream was posted to it.
+    postToWorker([](WorkerStream& stream) -> void { stream.moveToLocalPool(); });
+    return;
+  }
+
+  // The callbacks may fire and release the stream before newStream() returns, so only keep the
+  // handle if the stream is still pending afterwards.
+  self_ = shared_from_this();
+  ConnectionPool::Cancellable* handle = shared_->pool_->newStream(*this, *this);
+  if (self_ != nullptr && upstream_encoder_ == nullptr) {
+    upstream_handle_ = handle;
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::encodeHeaders(const HeaderMap& headers,
+                                                        bool end_stream) {
+  if (upstream_encoder_ != nullptr) {
+    upstream_encoder_->encodeHeaders(headers, end_stream);
+    if (end_stream) {
+      onLocalComplete();
+    }
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (upstream_encoder_ != nullptr) {
+    upstream_encoder_->encodeData(data, end_stream);
+    if (end_stream) {
+      onLocalComplete();
+    }
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::encodeTrailers(const HeaderMap& trailers) {
+  if (upstream_encoder_ != nullptr) {
+    upstream_encoder_->encodeTrailers(trailers);
+    onLocalComplete();
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::readDisable(bool disable) {
+  if (upstream_encoder_ != nullptr) {
+    upstream_encoder_->getStream().readDisable(disable);
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::resetStream(Http::StreamResetReason reason) {
+  if (upstream_handle_ != nullptr) {
+    upstream_handle_->cancel();
+  } else if (upstream_encoder_ != nullptr) {
+    upstream_encoder_->getStream().removeCallbacks(*this);
+    upstream_encoder_->getStream().resetStream(reason);
+  }
+  release();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onLocalComplete() {
+  local_complete_ = true;
+  // The stream might have been reset while encoding.
+  if (remote_complete_ && upstream_encoder_ != nullptr) {
+    upstream_encoder_->getStream().removeCallbacks(*this);
+    release();
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onRemoteComplete() {
+  remote_complete_ = true;
+  if (local_complete_ && upstream_encoder_ != nullptr) {
+    upstream_encoder_->getStream().removeCallbacks(*this);
+    release();
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::release() {
+  upstream_handle_ = nullptr;
+  upstream_encoder_ = nullptr;
+  // Callers hold their own reference, so this doesn't destroy the stream from under them.
+  self_.reset();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::decode100ContinueHeaders(HeaderMapPtr&& headers) {
+  std::shared_ptr<HeaderMapPtr> moved = std::make_shared<HeaderMapPtr>(std::move(headers));
+  postToWorker([moved](WorkerStream& stream) -> void {
+    stream.response_decoder_.decode100ContinueHeaders(std::move(*moved));
+  });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::decodeHeaders(HeaderMapPtr&& headers,
+                                                        bool end_stream) {
+  OwnerStreamSharedPtr self = shared_from_this();
+  std::shared_ptr<HeaderMapPtr> moved = std::make_shared<HeaderMapPtr>(std::move(headers));
+  postToWorker([moved, end_stream](WorkerStream& stream) -> void {
+    stream.response_decoder_.decodeHeaders(std::move(*moved), end_stream);
+    if (end_stream) {
+      stream.onRemoteComplete();
+    }
+  });
+  if (end_stream) {
+    onRemoteComplete();
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  OwnerStreamSharedPtr self = shared_from_this();
+  std::shared_ptr<Buffer::OwnedImpl> moved = std::make_shared<Buffer::OwnedImpl>();
+  moved->move(data);
+  postToWorker([moved, end_stream](WorkerStream& stream) -> void {
+    stream.response_decoder_.decodeData(*moved, end_stream);
+    if (end_stream) {
+      stream.onRemoteComplete();
+    }
+  });
+  if (end_stream) {
+    onRemoteComplete();
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::decodeTrailers(HeaderMapPtr&& trailers) {
+  OwnerStreamSharedPtr self = shared_from_this();
+  std::shared_ptr<HeaderMapPtr> moved = std::make_shared<HeaderMapPtr>(std::move(trailers));
+  postToWorker([moved](WorkerStream& stream) -> void {
+    stream.response_decoder_.decodeTrailers(std::move(*moved));
+    stream.onRemoteComplete();
+  });
+  onRemoteComplete();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onResetStream(Http::StreamResetReason reason) {
+  OwnerStreamSharedPtr self = shared_from_this();
+  postToWorker([reason](WorkerStream& stream) -> void { stream.onResetStream(reason); });
+  release();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onAboveWriteBufferHighWatermark() {
+  postToWorker([](WorkerStream& stream) -> void { stream.runHighWatermarkCallbacks(); });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onBelowWriteBufferLowWatermark() {
+  postToWorker([](WorkerStream& stream) -> void { stream.runLowWatermarkCallbacks(); });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onPoolFailure(
+    ConnectionPool::PoolFailureReason reason, Upstream::HostDescriptionConstSharedPtr host) {
+  OwnerStreamSharedPtr self = shared_from_this();
+  postToWorker(
+      [reason, host](WorkerStream& stream) -> void { stream.onPoolFailure(reason, host); });
+  release();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onPoolReady(
+    Http::StreamEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host) {
+  upstream_handle_ = nullptr;
+  upstream_encoder_ = &encoder;
+  encoder.getStream().addCallbacks(*this);
+  buffer_limit_ = encoder.getStream().bufferLimit();
+  postToWorker([host](WorkerStream& stream) -> void { stream.onPoolReady(host); });
+}
+
+ForwardingConnPoolImpl::WorkerStream::WorkerStream(ForwardingConnPoolImpl& parent,
+                                                   Http::StreamDecoder& response_decoder,
+                                                   ConnectionPool::Callbacks& callbacks)
+    : parent_(parent), response_decoder_(response_decoder), callbacks_(callbacks),
+      owner_(std::make_shared<OwnerStream>(parent.dispatcher_, parent.shared_)) {
+  owner_->worker_stream_ = this;
+}
+
+void ForwardingConnPoolImpl::WorkerStream::postToOwner(std::function<void(OwnerStream&)> cb) {
+  OwnerStreamSharedPtr owner = owner_;
+  parent_.shared_->dispatcher_.post([owner, cb]() -> void { cb(*owner); });
+}
+
+void ForwardingConnPoolImpl::WorkerStream::moveToLocalPool() {
+  // The local pool gets a stream to wait for even if it had already drained.
+  parent_.local_pool_drained_ = false;
+  // The local pool may call back before newStream() returns, so only keep the handle if the stream
+  // is still pending afterwards.
+  ConnectionPool::Cancellable* handle = parent_.localPool().newStream(response_decoder_, *this);
+  if (!done_) {
+    local_handle_ = handle;
+  }
+}
+
+void ForwardingConnPoolImpl::WorkerStream::onPoolFailure(
+    ConnectionPool::PoolFailureReason reason, Upstream::HostDescriptionConstSharedPtr host) {
+  local_handle_ = nullptr;
+  done();
+  callbacks_.onPoolFailure(reason, host);
+}
+
+void ForwardingConnPoolImpl::WorkerStream::onPoolReady(
+    Http::StreamEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host) {
+  // The stream was moved to the local pool, whose encoder the caller uses from now on.
+  local_handle_ = nullptr;
+  done();
+  callbacks_.onPoolReady(encoder, host);
+}
+
+void ForwardingConnPoolImpl::WorkerStream::cancel() {
+  if (local_handle_ != nullptr) {
+    local_handle_->cancel();
+    local_handle_ = nullptr;
+    done();
+    return;
+  }
+  resetStream(Http::StreamResetReason::LocalReset);
+}
+
+void ForwardingConnPoolImpl::WorkerStream::onPoolReady(
+    Upstream::HostDescriptionConstSharedPtr host) {
+  callbacks_.onPoolReady(*this, host);
+}
+
+void ForwardingConnPoolImpl::WorkerStream::onResetStream(Http::StreamResetReason reason) {
+  done();
+  runResetCallbacks(reason);
+}
+
+void ForwardingConnPoolImpl::WorkerStream::onRemoteComplete() {
+  remote_complete_ = true;
+  if (local_end_stream_) {
+    done();
+  }
+}
+
+void ForwardingConnPoolImpl::WorkerStream::done() {
+  if (done_) {
+    return;
+  }
+
+  // The caller may still reference the stream until the end of the current dispatch, e.g. to
+  // remove its stream callbacks, so the stream is deferred deleted. No more events are delivered.
+  done_ = true;
+  owner_->worker_stream_ = nullptr;
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.streams_));
+  parent_.checkForDrained();
+}
+
+void ForwardingConnPoolImpl::WorkerStream::encodeHeaders(const HeaderMap& headers,
+                                                         bool end_stream) {
+  local_end_stream_ = end_stream;
+  std::shared_ptr<HeaderMapImpl> copy = std::make_shared<HeaderMapImpl>(headers);
+  postToOwner(
+      [copy, end_stream](OwnerStream& owner) -> void { owner.encodeHeaders(*copy, end_stream); });
+  if (end_stream && remote_complete_) {
+    done();
+  }
+}
+
+void ForwardingConnPoolImpl::WorkerStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  local_end_stream_ = end_stream;
+  std::shared_ptr<Buffer::OwnedImpl> moved = std::make_shared<Buffer::OwnedImpl>();
+  moved->move(data);
+  postToOwner(
+      [moved, end_stream](OwnerStream& owner) -> void { owner.encodeData(*moved, end_stream); });
+  if (end_stream && remote_complete_) {
+    done();
+  }
+}
+
+void ForwardingConnPoolImpl::WorkerStream::encodeTrailers(const HeaderMap& trailers) {
+  local_end_stream_ = true;
+  std::shared_ptr<HeaderMapImpl> copy = std::make_shared<HeaderMapImpl>(trailers);
+  postToOwner([copy](OwnerStream& owner) -> void { owner.encodeTrailers(*copy); });
+  if (remote_complete_) {
+    done();
+  }
+}
+
+void ForwardingConnPoolImpl::WorkerStream::resetStream(Http::StreamResetReason reason) {
+  // Like codec streams, a local reset runs the reset callbacks, but nothing is posted back from
+  // the owner for it.
+  postToOwner([reason](OwnerStream& owner) -> void { owner.resetStream(reason); });
+  done();
+  runResetCallbacks(reason);
+}
+
+void ForwardingConnPoolImpl::WorkerStream::readDisable(bool disable) {
+  postToOwner([disable](OwnerStream& owner) -> void { owner.readDisable(disable); });
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
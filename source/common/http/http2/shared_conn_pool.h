@@ -0,0 +1,234 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/codec.h"
+#include "envoy/http/conn_pool.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/common/assert.h"
+#include "common/common/linked_object.h"
+#include "common/common/logger.h"
+#include "common/http/codec_helper.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * A connection pool that is shared by all workers. The pool lives on the worker that created it,
+ * the owner, and is only ever touched on the owner's thread. Other workers hand their streams to
+ * the owner by posting to its dispatcher. @see OwnerConnPoolImpl and ForwardingConnPoolImpl.
+ */
+struct SharedConnPool {
+  SharedConnPool(Event::Dispatcher& dispatcher, ConnectionPool::Instance& pool)
+      : dispatcher_(dispatcher), pool_(&pool) {}
+
+  Event::Dispatcher& dispatcher_;
+  // Only accessed on the owner's thread. Cleared once the owner's pool starts draining.
+  ConnectionPool::Instance* pool_;
+  // Set once the owner's pool starts draining, and read by the other workers.
+  std::atomic<bool> unregistered_{};
+};
+
+typedef std::shared_ptr<SharedConnPool> SharedConnPoolSharedPtr;
+
+/**
+ * The pool of the worker that owns a shared pool. The owner uses the pool directly, while other
+ * workers forward their streams to it. Once the pool starts draining, the unregister callback fires
+ * so that a new shared pool gets set up, and the other workers stop forwarding to it. Streams that
+ * are already on their way are sent back to their workers' local pools.
+ */
+class OwnerConnPoolImpl : public ConnectionPool::Instance {
+public:
+  OwnerConnPoolImpl(Event::Dispatcher& dispatcher, ConnectionPool::InstancePtr&& pool,
+                    std::function<void()> unregister_cb);
+  ~OwnerConnPoolImpl();
+
+  const SharedConnPoolSharedPtr& shared() const { return shared_; }
+
+  // Http::ConnectionPool::Instance
+  Http::Protocol protocol() const override { return pool_->protocol(); }
+  void addDrainedCallback(DrainedCb cb) override;
+  void drainConnections() override { pool_->drainConnections(); }
+  void prefetch() override { pool_->prefetch(); }
+  ConnectionPool::Cancellable* newStream(Http::StreamDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override {
+    return pool_->newStream(response_decoder, callbacks);
+  }
+
+private:
+  void unregister();
+
+  ConnectionPool::InstancePtr pool_;
+  SharedConnPoolSharedPtr shared_;
+  std::function<void()> unregister_cb_;
+};
+
+/**
+ * The pool of a worker that doesn't own a shared pool. Each stream is created on the owner's pool
+ * by posting to the owner's dispatcher, and all further stream events are posted back and forth
+ * between the two workers. Headers are copied and data is moved across.
+ *
+ * Once the owner's pool starts draining, new streams go to a pool of the worker's own, which is
+ * made by the given factory, until this pool is drained and replaced in turn. Streams that reach
+ * the owner after it stopped taking them are moved to the local pool too.
+ */
+class ForwardingConnPoolImpl : Logger::Loggable<Logger::Id::pool>,
+                               public ConnectionPool::Instance {
+public:
+  ForwardingConnPoolImpl(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
+                         Http::Protocol protocol, const SharedConnPoolSharedPtr& shared,
+                         std::function<ConnectionPool::InstancePtr()> local_pool_factory);
+  ~ForwardingConnPoolImpl();
+
+  // Http::ConnectionPool::Instance
+  Http::Protocol protocol() const override { return protocol_; }
+  void addDrainedCallback(DrainedCb cb) override;
+  // The owner drains its connections on host health failures itself, and prefetches for its own
+  // traffic, so these only apply to the local pool on the forwarding side.
+  void drainConnections() override;
+  void prefetch() override;
+  ConnectionPool::Cancellable* newStream(Http::StreamDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override;
+
+private:
+  struct WorkerStream;
+
+  /**
+   * The owner's side of a forwarded stream, which is the decoder and the pool callbacks of the
+   * stream on the owner's pool. It keeps itself alive for as long as the owner's pool references
+   * it. Except where noted, all members are accessed on the owner's thread.
+   */
+  struct OwnerStream : public Http::StreamDecoder,
+                       public Http::StreamCallbacks,
+                       public ConnectionPool::Callbacks,
+                       public std::enable_shared_from_this<OwnerStream> {
+    OwnerStream(Event::Dispatcher& worker_dispatcher, const SharedConnPoolSharedPtr& shared)
+        : worker_dispatcher_(worker_dispatcher), shared_(shared) {}
+
+    void postToWorker(std::function<void(WorkerStream&)> cb);
+    void newStream();
+    void encodeHeaders(const HeaderMap& headers, bool end_stream);
+    void encodeData(Buffer::Instance& data, bool end_stream);
+    void encodeTrailers(const HeaderMap& trailers);
+    void readDisable(bool disable);
+    void resetStream(Http::StreamResetReason reason);
+    void onLocalComplete();
+    void onRemoteComplete();
+    void release();
+
+    // Http::StreamDecoder
+    void decode100ContinueHeaders(HeaderMapPtr&& headers) override;
+    void decodeHeaders(HeaderMapPtr&& headers, bool end_stream) override;
+    void decodeData(Buffer::Instance& data, bool end_stream) override;
+    void decodeTrailers(HeaderMapPtr&& trailers) override;
+
+    // Http::StreamCallbacks
+    void onResetStream(Http::StreamResetReason reason) override;
+    void onAboveWriteBufferHighWatermark() override;
+    void onBelowWriteBufferLowWatermark() override;
+
+    // Http::ConnectionPool::Callbacks
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       Upstream::HostDescriptionConstSharedPtr host) override;
+    void onPoolReady(Http::StreamEncoder& encoder,
+                     Upstream::HostDescriptionConstSharedPtr host) override;
+
+    Event::Dispatcher& worker_dispatcher_;
+    SharedConnPoolSharedPtr shared_;
+    // Only accessed on the worker's thread. Cleared once the worker is done with the stream.
+    WorkerStream* worker_stream_{};
+    // Set on the owner's thread before the worker is told that the stream is ready.
+    uint32_t buffer_limit_{};
+    std::shared_ptr<OwnerStream> self_;
+    ConnectionPool::Cancellable* upstream_handle_{};
+    Http::StreamEncoder* upstream_encoder_{};
+    bool local_complete_{};
+    bool remote_complete_{};
+  };
+
+  typedef std::shared_ptr<OwnerStream> OwnerStreamSharedPtr;
+
+  /**
+   * The worker's side of a forwarded stream, which is the request encoder handed to the caller.
+   */
+  struct WorkerStream : LinkedObject<WorkerStream>,
+                        public Event::DeferredDeletable,
+                        public Http::StreamEncoder,
+                        public Http::Stream,
+                        public Http::StreamCallbackHelper,
+                        public ConnectionPool::Callbacks,
+                        public ConnectionPool::Cancellable {
+    WorkerStream(ForwardingConnPoolImpl& parent, Http::StreamDecoder& response_decoder,
+                 ConnectionPool::Callbacks& callbacks);
+
+    void postToOwner(std::function<void(OwnerStream&)> cb);
+    void moveToLocalPool();
+    void onPoolReady(Upstream::HostDescriptionConstSharedPtr host);
+    void onResetStream(Http::StreamResetReason reason);
+    void onRemoteComplete();
+    void done();
+
+    // Http::StreamEncoder
+    void encode100ContinueHeaders(const HeaderMap&) override { NOT_REACHED_GCOVR_EXCL_LINE; }
+    void encodeHeaders(const HeaderMap& headers, bool end_stream) override;
+    void encodeData(Buffer::Instance& data, bool end_stream) override;
+    void encodeTrailers(const HeaderMap& trailers) override;
+    Http::Stream& getStream() override { return *this; }
+
+    // Http::Stream
+    void addCallbacks(Http::StreamCallbacks& callbacks) override { addCallbacks_(callbacks); }
+    void removeCallbacks(Http::StreamCallbacks& callbacks) override {
+      removeCallbacks_(callbacks);
+    }
+    void resetStream(Http::StreamResetReason reason) override;
+    void readDisable(bool disable) override;
+    uint32_t bufferLimit() override { return owner_->buffer_limit_; }
+
+    // Http::ConnectionPool::Callbacks, which are also used for failures on the owner's pool.
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       Upstream::HostDescriptionConstSharedPtr host) override;
+    void onPoolReady(Http::StreamEncoder& encoder,
+                     Upstream::HostDescriptionConstSharedPtr host) override;
+
+    // Http::ConnectionPool::Cancellable
+    void cancel() override;
+
+    ForwardingConnPoolImpl& parent_;
+    Http::StreamDecoder& response_decoder_;
+    ConnectionPool::Callbacks& callbacks_;
+    OwnerStreamSharedPtr owner_;
+    // Set while the stream is pending on the local pool after the owner turned it away. Once the
+    // local pool calls back, the caller gets the local pool's encoder and this stream is done.
+    ConnectionPool::Cancellable* local_handle_{};
+    bool remote_complete_{};
+    bool done_{};
+  };
+
+  typedef std::unique_ptr<WorkerStream> WorkerStreamPtr;
+
+  ConnectionPool::Instance& localPool();
+  void checkForDrained();
+
+  Event::Dispatcher& dispatcher_;
+  Upstream::HostConstSharedPtr host_;
+  const Http::Protocol protocol_;
+  SharedConnPoolSharedPtr shared_;
+  std::function<ConnectionPool::InstancePtr()> local_pool_factory_;
+  ConnectionPool::InstancePtr local_pool_;
+  bool local_pool_watched_{};
+  bool local_pool_drained_{};
+  std::list<WorkerStreamPtr> streams_;
+  std::list<DrainedCb> drained_callbacks_;
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
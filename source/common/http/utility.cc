@@ -227,6 +227,8 @@ Utility::parseHttp2Settings(const envoy::api::v2::core::Http2ProtocolOptions& co
   ret.initial_connection_window_size_ =
       PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, initial_connection_window_size,
                                       Http::Http2Settings::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE);
+  ret.max_connections_per_host_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+      config, max_connections_per_host, Http::Http2Settings::DEFAULT_MAX_CONNECTIONS_PER_HOST);
   return ret;
 }
 
@@ -0,0 +1,39 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Network {
+
+void ExactConnectionBalancerImpl::registerHandler(BalancedConnectionHandler& handler) {
+  Thread::LockGuard guard(lock_);
+  handlers_.push_back(&handler);
+}
+
+void ExactConnectionBalancerImpl::unregisterHandler(BalancedConnectionHandler& handler) {
+  Thread::LockGuard guard(lock_);
+  auto it = std::find(handlers_.begin(), handlers_.end(), &handler);
+  ASSERT(it != handlers_.end());
+  handlers_.erase(it);
+}
+
+BalancedConnectionHandler&
+ExactConnectionBalancerImpl::pickTargetHandler(BalancedConnectionHandler& current_handler) {
+  Thread::LockGuard guard(lock_);
+  // Prefer the current handler on a tie so that sockets only move when it pays off.
+  BalancedConnectionHandler* min_handler = &current_handler;
+  for (BalancedConnectionHandler* handler : handlers_) {
+    if (handler->numConnections() < min_handler->numConnections()) {
+      min_handler = handler;
+    }
+  }
+
+  // The count is taken under the lock so that concurrent accepts see each other's picks.
+  min_handler->incNumConnections();
+  return *min_handler;
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+
+#include "envoy/network/connection_balancer.h"
+
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * A balancer that keeps every socket on the handler that accepted it.
+ */
+class NopConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Network::ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler&) override {}
+  void unregisterHandler(BalancedConnectionHandler&) override {}
+  BalancedConnectionHandler&
+  pickTargetHandler(BalancedConnectionHandler& current_handler) override {
+    current_handler.incNumConnections();
+    return current_handler;
+  }
+};
+
+/**
+ * A balancer that hands each socket to the handler with the fewest connections. All handlers of
+ * the listener are scanned under a lock on every accept, so this trades accept throughput for an
+ * even spread of long lived connections.
+ */
+class ExactConnectionBalancerImpl : public ConnectionBalancer {
+public:
+  // Network::ConnectionBalancer
+  void registerHandler(BalancedConnectionHandler& handler) override;
+  void unregisterHandler(BalancedConnectionHandler& handler) override;
+  BalancedConnectionHandler& pickTargetHandler(BalancedConnectionHandler& current_handler) override;
+
+private:
+  Thread::MutexBasicLockable lock_;
+  std::vector<BalancedConnectionHandler*> handlers_ GUARDED_BY(lock_);
+};
+
+} // namespace Network
+} // namespace Envoy
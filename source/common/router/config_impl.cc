@@ -5,7 +5,6 @@
 #include <cstdint>
 #include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <vector>
 
@@ -18,6 +17,7 @@
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
 #include "common/common/hash.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/config/metadata.h"
 #include "common/config/rds_json.h"
@@ -55,7 +55,7 @@ CorsPolicyImpl::CorsPolicyImpl(const envoy::api::v2::route::CorsPolicy& config)
     allow_origin_.push_back(origin);
   }
   for (const auto& regex : config.allow_origin_regex()) {
-    allow_origin_regex_.push_back(RegexUtil::parseRegex(regex));
+    allow_origin_regex_.push_back(Regex::Utility::parseRegex(regex));
   }
   allow_methods_ = config.allow_methods();
   allow_headers_ = config.allow_headers();
@@ -676,8 +676,7 @@ RegexRouteEntryImpl::RegexRouteEntryImpl(const VirtualHostImpl& vhost,
                                          const envoy::api::v2::route::Route& route,
                                          Server::Configuration::FactoryContext& factory_context)
     : RouteEntryImplBase(vhost, route, factory_context),
-      regex_(RegexUtil::parseRegex(route.match().regex().c_str())),
-      regex_str_(route.match().regex()) {}
+      regex_(Regex::Utility::parseRegex(route.match().regex())) {}
 
 void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
                                             bool insert_envoy_original_path) const {
@@ -685,7 +684,7 @@ void RegexRouteEntryImpl::rewritePathHeader(Http::HeaderMap& headers,
   const char* query_string_start = Http::Utility::findQueryStringStart(path);
   // TODO(yuval-k): This ASSERT can happen if the path was changed by a filter without clearing the
   // route cache. We should consider if ASSERT-ing is the desired behavior in this case.
-  ASSERT(std::regex_match(path.c_str(), query_string_start, regex_));
+  ASSERT(regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str())));
   std::string matched_path(path.c_str(), query_string_start);
 
   finalizePathHeader(headers, matched_path, insert_envoy_original_path);
@@ -696,7 +695,7 @@ RouteConstSharedPtr RegexRouteEntryImpl::matches(const Http::HeaderMap& headers,
   if (RouteEntryImplBase::matchRoute(headers, random_value)) {
     const Http::HeaderString& path = headers.Path()->value();
     const char* query_string_start = Http::Utility::findQueryStringStart(path);
-    if (std::regex_match(path.c_str(), query_string_start, regex_)) {
+    if (regex_->match(absl::string_view(path.c_str(), query_string_start - path.c_str()))) {
       return clusterEntry(headers, random_value);
     }
   }
@@ -734,13 +733,17 @@ VirtualHostImpl::VirtualHostImpl(const envoy::api::v2::route::VirtualHost& virtu
         route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kPath;
     const bool has_regex =
         route.match().path_specifier_case() == envoy::api::v2::route::RouteMatch::kRegex;
+    const uint32_t position = routes_.size();
     if (has_prefix) {
       routes_.emplace_back(new PrefixRouteEntryImpl(*this, route, factory_context));
+      route_index_.addPrefix(route.match().prefix(), routes_.back()->caseSensitive(), position);
     } else if (has_path) {
       routes_.emplace_back(new PathRouteEntryImpl(*this, route, factory_context));
+      route_index_.addPath(route.match().path(), routes_.back()->caseSensitive(), position);
     } else {
       ASSERT(has_regex);
       routes_.emplace_back(new RegexRouteEntryImpl(*this, route, factory_context));
+      route_index_.addAlways(position);
     }
 
     if (validate_clusters) {
@@ -770,7 +773,7 @@ VirtualHostImpl::VirtualClusterEntry::VirtualClusterEntry(
   }
 
   const std::string pattern = virtual_cluster.pattern();
-  pattern_ = RegexUtil::parseRegex(pattern);
+  pattern_ = Regex::Utility::parseRegex(pattern);
   name_ = virtual_cluster.name();
 }
 
@@ -780,26 +783,6 @@ const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::str
   return per_filter_configs_.get(name);
 }
 
-const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(const std::string& host) const {
-  // We do a longest wildcard suffix match against the host that's passed in.
-  // (e.g. foo-bar.baz.com should match *-bar.baz.com before matching *.baz.com)
-  // This is done by scanning the length => wildcards map looking for every
-  // wildcard whose size is < length.
-  for (const auto& iter : wildcard_virtual_host_suffixes_) {
-    const uint32_t wildcard_length = iter.first;
-    const auto& wildcard_map = iter.second;
-    // >= because *.foo.com shouldn't match .foo.com.
-    if (wildcard_length >= host.size()) {
-      continue;
-    }
-    const auto& match = wildcard_map.find(host.substr(host.size() - wildcard_length));
-    if (match != wildcard_map.end()) {
-      return match->second.get();
-    }
-  }
-  return nullptr;
-}
-
 RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_config,
                            const ConfigImpl& global_route_config,
                            Server::Configuration::FactoryContext& factory_context,
@@ -807,6 +790,8 @@ RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_confi
   for (const auto& virtual_host_config : route_config.virtual_hosts()) {
     VirtualHostSharedPtr virtual_host(new VirtualHostImpl(virtual_host_config, global_route_config,
                                                           factory_context, validate_clusters));
+    const uint32_t position = virtual_hosts_.size();
+    virtual_hosts_.push_back(virtual_host);
     for (const std::string& domain_name : virtual_host_config.domains()) {
       const std::string domain = Http::LowerCaseString(domain_name).get();
       if ("*" == domain) {
@@ -815,14 +800,10 @@ RouteMatcher::RouteMatcher(const envoy::api::v2::RouteConfiguration& route_confi
         }
         default_virtual_host_ = virtual_host;
       } else if (domain.size() > 0 && '*' == domain[0]) {
-        wildcard_virtual_host_suffixes_[domain.size() - 1].emplace(domain.substr(1), virtual_host);
-      } else {
-        if (virtual_hosts_.find(domain) != virtual_hosts_.end()) {
-          throw EnvoyException(fmt::format(
-              "Only unique values for domains are permitted. Duplicate entry of domain {}",
-              domain));
-        }
-        virtual_hosts_.emplace(domain, virtual_host);
+        virtual_host_index_.addWildcard(absl::string_view(domain).substr(1), position);
+      } else if (!virtual_host_index_.addExact(domain, position)) {
+        throw EnvoyException(fmt::format(
+            "Only unique values for domains are permitted. Duplicate entry of domain {}", domain));
       }
     }
   }
@@ -838,9 +819,13 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
     return SSL_REDIRECT_ROUTE;
   }
 
-  // Check for a route that matches the request.
-  for (const RouteEntryImplBaseConstSharedPtr& route : routes_) {
-    RouteConstSharedPtr route_entry = route->matches(headers, random_value);
+  // Check for a route that matches the request. Only the routes whose path matcher may match are
+  // evaluated, in configuration order, so the first matching route still wins.
+  RouteIndex::Candidates candidates;
+  const Http::HeaderString& path = headers.Path()->value();
+  route_index_.candidates(absl::string_view(path.c_str(), path.size()), candidates);
+  for (const uint32_t position : candidates) {
+    RouteConstSharedPtr route_entry = routes_[position]->matches(headers, random_value);
     if (nullptr != route_entry) {
       return route_entry;
     }
@@ -851,22 +836,17 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const Http::HeaderMap&
 
 const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::HeaderMap& headers) const {
   // Fast path the case where we only have a default virtual host.
-  if (virtual_hosts_.empty() && default_virtual_host_) {
+  if (!virtual_host_index_.hasExact() && default_virtual_host_) {
     return default_virtual_host_.get();
   }
 
   // TODO (@rshriram) Match Origin header in WebSocket
   // request with VHost, using wildcard match
-  const std::string host = Http::LowerCaseString(headers.Host()->value().c_str()).get();
-  const auto& iter = virtual_hosts_.find(host);
-  if (iter != virtual_hosts_.end()) {
-    return iter->second.get();
-  }
-  if (!wildcard_virtual_host_suffixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(host);
-    if (vhost != nullptr) {
-      return vhost;
-    }
+  const Http::HeaderString& host = headers.Host()->value();
+  const absl::optional<uint32_t> position =
+      virtual_host_index_.find(absl::string_view(host.c_str(), host.size()));
+  if (position) {
+    return virtual_hosts_[position.value()].get();
   }
   return default_virtual_host_.get();
 }
@@ -892,7 +872,7 @@ VirtualHostImpl::virtualClusterFromEntries(const Http::HeaderMap& headers) const
     bool method_matches =
         !entry.method_ || headers.Method()->value().c_str() == entry.method_.value();
 
-    if (method_matches && std::regex_match(headers.Path()->value().c_str(), entry.pattern_)) {
+    if (method_matches && entry.pattern_->match(headers.Path()->value().getStringView())) {
       return &entry;
     }
   }
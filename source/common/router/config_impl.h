@@ -3,15 +3,14 @@
 #include <chrono>
 #include <cstdint>
 #include <list>
-#include <map>
 #include <memory>
-#include <regex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "envoy/api/v2/rds.pb.h"
 #include "envoy/api/v2/route/route.pb.h"
+#include "envoy/common/regex.h"
 #include "envoy/router/router.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/server/filter_config.h"
@@ -22,7 +21,9 @@
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
 #include "common/router/metadatamatchcriteria_impl.h"
+#include "common/router/route_index.h"
 #include "common/router/router_ratelimit.h"
+#include "common/router/virtual_host_index.h"
 #include "common/tcp_proxy/tcp_proxy.h"
 
 #include "absl/types/optional.h"
@@ -98,7 +99,9 @@ public:
 
   // Router::CorsPolicy
   const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-  const std::list<std::regex>& allowOriginRegexes() const override { return allow_origin_regex_; }
+  const std::list<Regex::CompiledMatcherSharedPtr>& allowOriginRegexes() const override {
+    return allow_origin_regex_;
+  }
   const std::string& allowMethods() const override { return allow_methods_; };
   const std::string& allowHeaders() const override { return allow_headers_; };
   const std::string& exposeHeaders() const override { return expose_headers_; };
@@ -108,7 +111,7 @@ public:
 
 private:
   std::list<std::string> allow_origin_;
-  std::list<std::regex> allow_origin_regex_;
+  std::list<Regex::CompiledMatcherSharedPtr> allow_origin_regex_;
   std::string allow_methods_;
   std::string allow_headers_;
   std::string expose_headers_;
@@ -150,7 +153,7 @@ private:
     // Router::VirtualCluster
     const std::string& name() const override { return name_; }
 
-    std::regex pattern_;
+    Regex::CompiledMatcherSharedPtr pattern_;
     absl::optional<std::string> method_;
     std::string name_;
   };
@@ -167,6 +170,8 @@ private:
 
   const std::string name_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // Narrows down the routes that need to be evaluated for a request path. See RouteIndex.
+  RouteIndex route_index_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
@@ -284,6 +289,7 @@ public:
     return !host_redirect_.empty() || !path_redirect_.empty() || !prefix_rewrite_redirect_.empty();
   }
 
+  bool caseSensitive() const { return case_sensitive_; }
   bool matchRoute(const Http::HeaderMap& headers, uint64_t random_value) const;
   void validateClusters(Upstream::ClusterManager& cm) const;
 
@@ -601,7 +607,7 @@ public:
                       Server::Configuration::FactoryContext& factory_context);
 
   // Router::PathMatchCriterion
-  const std::string& matcher() const override { return regex_str_; }
+  const std::string& matcher() const override { return regex_->pattern(); }
   PathMatchType matchType() const override { return PathMatchType::Regex; }
 
   // Router::Matchable
@@ -611,8 +617,7 @@ public:
   void rewritePathHeader(Http::HeaderMap& headers, bool insert_envoy_original_path) const override;
 
 private:
-  const std::regex regex_;
-  const std::string regex_str_;
+  const Regex::CompiledMatcherSharedPtr regex_;
 };
 
 /**
@@ -629,20 +634,10 @@ public:
 
 private:
   const VirtualHostImpl* findVirtualHost(const Http::HeaderMap& headers) const;
-  const VirtualHostImpl* findWildcardVirtualHost(const std::string& host) const;
-
-  std::unordered_map<std::string, VirtualHostSharedPtr> virtual_hosts_;
-  // std::greater as a minor optimization to iterate from more to less specific
-  //
-  // A note on using an unordered_map versus a vector of (string, VirtualHostSharedPtr) pairs:
-  //
-  // Based on local benchmarks, each vector entry costs around 20ns for recall and (string)
-  // comparison with a fixed cost of about 25ns. For unordered_map, the empty map costs about 65ns
-  // and climbs to about 110ns once there are any entries.
-  //
-  // The break-even is 4 entries.
-  std::map<int64_t, std::unordered_map<std::string, VirtualHostSharedPtr>, std::greater<int64_t>>
-      wildcard_virtual_host_suffixes_;
+
+  // All virtual hosts in configuration order, indexed by their exact and wildcard domains.
+  std::vector<VirtualHostSharedPtr> virtual_hosts_;
+  VirtualHostIndex virtual_host_index_;
   VirtualHostSharedPtr default_virtual_host_;
 };
 
@@ -0,0 +1,107 @@
+#include "common/router/route_index.h"
+
+#include <algorithm>
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+void RouteIndex::addPrefix(const std::string& prefix, bool case_sensitive, uint32_t position) {
+  if (case_sensitive) {
+    prefixes_.add(prefix, position);
+  } else {
+    case_insensitive_prefixes_.add(absl::AsciiStrToLower(prefix), position);
+  }
+}
+
+void RouteIndex::addPath(const std::string& path, bool case_sensitive, uint32_t position) {
+  if (case_sensitive) {
+    paths_[path].push_back(position);
+  } else {
+    case_insensitive_paths_[absl::AsciiStrToLower(path)].push_back(position);
+  }
+}
+
+void RouteIndex::addAlways(uint32_t position) { always_.push_back(position); }
+
+void RouteIndex::candidates(absl::string_view path, Candidates& candidates) const {
+  const size_t initial_size = candidates.size();
+
+  prefixes_.find<true>(path, candidates);
+  case_insensitive_prefixes_.find<false>(path, candidates);
+
+  if (!paths_.empty() || !case_insensitive_paths_.empty()) {
+    // Exact path matching ignores the query string.
+    const absl::string_view path_only = path.substr(0, path.find('?'));
+    if (!paths_.empty()) {
+      const auto it = paths_.find(path_only);
+      if (it != paths_.end()) {
+        candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+      }
+    }
+    if (!case_insensitive_paths_.empty()) {
+      // Reused across requests so that lower casing the path doesn't allocate once it has grown.
+      static thread_local std::string lower_path;
+      lower_path.assign(path_only.data(), path_only.size());
+      absl::AsciiStrToLower(&lower_path);
+      const auto it = case_insensitive_paths_.find(lower_path);
+      if (it != case_insensitive_paths_.end()) {
+        candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+      }
+    }
+  }
+
+  candidates.insert(candidates.end(), always_.begin(), always_.end());
+
+  // Every route is stored in exactly one of the structures above, so sorting is all that's needed
+  // to restore the configured order.
+  std::sort(candidates.begin() + initial_size, candidates.end());
+}
+
+void RouteIndex::Trie::add(absl::string_view prefix, uint32_t position) {
+  uint32_t current = 0;
+  for (const char c : prefix) {
+    auto& children = nodes_[current].children_;
+    auto it = std::lower_bound(
+        children.begin(), children.end(), c,
+        [](const std::pair<char, uint32_t>& child, char value) { return child.first < value; });
+    if (it != children.end() && it->first == c) {
+      current = it->second;
+    } else {
+      const uint32_t next = nodes_.size();
+      children.emplace(it, c, next);
+      // May reallocate nodes_, so children must not be used past this point.
+      nodes_.emplace_back();
+      current = next;
+    }
+  }
+  nodes_[current].positions_.push_back(position);
+}
+
+template <bool CaseSensitive>
+void RouteIndex::Trie::find(absl::string_view path, Candidates& candidates) const {
+  if (empty()) {
+    return;
+  }
+
+  const Node* node = &nodes_[0];
+  for (size_t i = 0;; i++) {
+    candidates.insert(candidates.end(), node->positions_.begin(), node->positions_.end());
+    if (i == path.size() || node->children_.empty()) {
+      return;
+    }
+
+    const char c = CaseSensitive ? path[i] : absl::ascii_tolower(path[i]);
+    const auto it = std::lower_bound(
+        node->children_.begin(), node->children_.end(), c,
+        [](const std::pair<char, uint32_t>& child, char value) { return child.first < value; });
+    if (it == node->children_.end() || it->first != c) {
+      return;
+    }
+    node = &nodes_[it->second];
+  }
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Index over the path matchers of an ordered list of routes. Given a request path it returns the
+ * positions of the routes whose path matcher can possibly match, in ascending order, so that the
+ * caller only needs to evaluate those routes (including their header, query parameter and runtime
+ * criteria) to find the first match. Routes are identified by their position in the route list.
+ *
+ * Exact paths are looked up in a map, prefixes are found by walking a trie with the request
+ * path, and regex routes are always returned as candidates since their match can't be predicted
+ * without evaluating them.
+ */
+class RouteIndex {
+public:
+  typedef absl::InlinedVector<uint32_t, 16> Candidates;
+
+  /**
+   * Add a route matching on a path prefix. The prefix is compared against the full path,
+   * including the query string.
+   * @param prefix supplies the prefix.
+   * @param case_sensitive supplies whether the prefix is compared case sensitively.
+   * @param position supplies the position of the route in the route list.
+   */
+  void addPrefix(const std::string& prefix, bool case_sensitive, uint32_t position);
+
+  /**
+   * Add a route matching on an exact path. The path is compared against the path with the query
+   * string removed.
+   * @param path supplies the path.
+   * @param case_sensitive supplies whether the path is compared case sensitively.
+   * @param position supplies the position of the route in the route list.
+   */
+  void addPath(const std::string& path, bool case_sensitive, uint32_t position);
+
+  /**
+   * Add a route that must be evaluated for every request, e.g. a regex route.
+   * @param position supplies the position of the route in the route list.
+   */
+  void addAlways(uint32_t position);
+
+  /**
+   * Find the routes that may match a request path.
+   * @param path supplies the request path, including the query string.
+   * @param candidates supplies the vector the positions of the candidate routes are appended to,
+   *        in ascending order.
+   */
+  void candidates(absl::string_view path, Candidates& candidates) const;
+
+private:
+  // Prefix trie. Nodes are stored in a flat vector and refer to each other by index; the root is
+  // nodes_[0]. The children of a node are kept sorted by character.
+  class Trie {
+  public:
+    Trie() : nodes_(1) {}
+
+    void add(absl::string_view prefix, uint32_t position);
+    template <bool CaseSensitive> void find(absl::string_view path, Candidates& candidates) const;
+    bool empty() const { return nodes_.size() == 1 && nodes_[0].positions_.empty(); }
+
+  private:
+    struct Node {
+      std::vector<std::pair<char, uint32_t>> children_;
+      std::vector<uint32_t> positions_;
+    };
+
+    std::vector<Node> nodes_;
+  };
+
+  // Ordered with a transparent comparator so that it can be searched with a string_view of the
+  // request path without copying it.
+  typedef std::map<std::string, std::vector<uint32_t>, std::less<>> PathMap;
+
+  Trie prefixes_;
+  Trie case_insensitive_prefixes_;
+  PathMap paths_;
+  PathMap case_insensitive_paths_;
+  std::vector<uint32_t> always_;
+};
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,84 @@
+#include "common/router/virtual_host_index.h"
+
+#include <algorithm>
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+namespace {
+
+bool charLess(const std::pair<char, uint32_t>& child, char value) { return child.first < value; }
+
+} // namespace
+
+constexpr uint32_t VirtualHostIndex::NONE;
+
+bool VirtualHostIndex::addExact(absl::string_view domain, uint32_t position) {
+  Node& node = insert(domain);
+  if (node.exact_ != NONE) {
+    return false;
+  }
+  node.exact_ = position;
+  has_exact_ = true;
+  return true;
+}
+
+void VirtualHostIndex::addWildcard(absl::string_view suffix, uint32_t position) {
+  Node& node = insert(suffix);
+  if (node.wildcard_ == NONE) {
+    node.wildcard_ = position;
+  }
+}
+
+VirtualHostIndex::Node& VirtualHostIndex::insert(absl::string_view domain) {
+  uint32_t current = 0;
+  for (auto it = domain.rbegin(); it != domain.rend(); ++it) {
+    const char c = *it;
+    auto& children = nodes_[current].children_;
+    auto child = std::lower_bound(children.begin(), children.end(), c, charLess);
+    if (child != children.end() && child->first == c) {
+      current = child->second;
+    } else {
+      const uint32_t next = nodes_.size();
+      children.emplace(child, c, next);
+      // May reallocate nodes_, so children must not be used past this point.
+      nodes_.emplace_back();
+      current = next;
+    }
+  }
+  return nodes_[current];
+}
+
+absl::optional<uint32_t> VirtualHostIndex::find(absl::string_view host) const {
+  uint32_t wildcard = NONE;
+  const Node* node = &nodes_[0];
+  for (size_t i = 0; i < host.size(); i++) {
+    // The host has at least one more character than the suffix represented by this node, which the
+    // '*' can match. Deeper nodes are longer suffixes, so the last one seen wins.
+    if (node->wildcard_ != NONE) {
+      wildcard = node->wildcard_;
+    }
+
+    const char c = absl::ascii_tolower(host[host.size() - 1 - i]);
+    const auto child =
+        std::lower_bound(node->children_.begin(), node->children_.end(), c, charLess);
+    if (child == node->children_.end() || child->first != c) {
+      node = nullptr;
+      break;
+    }
+    node = &nodes_[child->second];
+  }
+
+  if (node != nullptr && node->exact_ != NONE) {
+    return node->exact_;
+  }
+  if (wildcard != NONE) {
+    return wildcard;
+  }
+  return absl::nullopt;
+}
+
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Index over the domains of the virtual hosts in a route configuration. Given a request host it
+ * returns the position of the virtual host with an exact domain match, or failing that the one
+ * with the longest matching wildcard suffix (e.g. foo-bar.baz.com matches *-bar.baz.com before
+ * *.baz.com). Virtual hosts are identified by their position in the virtual host list.
+ *
+ * Domains are stored in a trie keyed on their characters in reverse order, so exact and wildcard
+ * domains are found with a single walk from the end of the host and no allocations. Domains must
+ * be added in lower case; the host is lower cased while walking.
+ */
+class VirtualHostIndex {
+public:
+  VirtualHostIndex() : nodes_(1) {}
+
+  /**
+   * Add an exact domain.
+   * @param domain supplies the lower case domain.
+   * @param position supplies the position of the virtual host.
+   * @return false if the domain has already been added, true otherwise.
+   */
+  bool addExact(absl::string_view domain, uint32_t position);
+
+  /**
+   * Add a wildcard domain. If the suffix has already been added the first virtual host wins.
+   * @param suffix supplies the lower case domain without the leading '*'. It only matches hosts
+   *        that are at least one character longer than the suffix.
+   * @param position supplies the position of the virtual host.
+   */
+  void addWildcard(absl::string_view suffix, uint32_t position);
+
+  /**
+   * Find the virtual host for a request host.
+   * @param host supplies the request host, in any case.
+   * @return the position of the matching virtual host, if any.
+   */
+  absl::optional<uint32_t> find(absl::string_view host) const;
+
+  /**
+   * @return whether any exact domains have been added.
+   */
+  bool hasExact() const { return has_exact_; }
+
+private:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  // Nodes are stored in a flat vector and refer to each other by index; the root is nodes_[0] and
+  // represents the empty suffix. The children of a node are kept sorted by character.
+  struct Node {
+    std::vector<std::pair<char, uint32_t>> children_;
+    uint32_t exact_{NONE};
+    uint32_t wildcard_{NONE};
+  };
+
+  Node& insert(absl::string_view domain);
+
+  std::vector<Node> nodes_;
+  bool has_exact_{};
+};
+
+} // namespace Router
+} // namespace Envoy
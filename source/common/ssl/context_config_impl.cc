@@ -91,6 +91,7 @@ ContextConfigImpl::ContextConfigImpl(const envoy::api::v2::auth::CommonTlsContex
           config.tls_certificates().empty()
               ? ""
               : Config::DataSource::getPath(config.tls_certificates()[0].private_key())),
+      private_key_thread_pool_size_(privateKeyThreadPoolSizeFromProto(config)),
       verify_subject_alt_name_list_(config.validation_context().verify_subject_alt_name().begin(),
                                     config.validation_context().verify_subject_alt_name().end()),
       verify_certificate_hash_list_(config.validation_context().verify_certificate_hash().begin(),
@@ -118,6 +119,22 @@ ContextConfigImpl::ContextConfigImpl(const envoy::api::v2::auth::CommonTlsContex
   }
 }
 
+uint32_t ContextConfigImpl::privateKeyThreadPoolSizeFromProto(
+    const envoy::api::v2::auth::CommonTlsContext& config) {
+  if (config.tls_certificates().empty() ||
+      !config.tls_certificates()[0].has_private_key_provider()) {
+    return 0;
+  }
+
+  const auto& provider = config.tls_certificates()[0].private_key_provider();
+  switch (provider.provider_type_case()) {
+  case envoy::api::v2::auth::PrivateKeyProvider::kThreadPool:
+    return PROTOBUF_GET_WRAPPED_OR_DEFAULT(provider.thread_pool(), threads, 1);
+  default:
+    NOT_REACHED_GCOVR_EXCL_LINE;
+  }
+}
+
 unsigned ContextConfigImpl::tlsVersionFromProto(
     const envoy::api::v2::auth::TlsParameters_TlsProtocol& version, unsigned default_version) {
   switch (version) {
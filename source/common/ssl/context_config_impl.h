@@ -41,6 +41,7 @@ public:
   const std::string& privateKeyPath() const override {
     return (private_key_path_.empty() && !private_key_.empty()) ? INLINE_STRING : private_key_path_;
   }
+  uint32_t privateKeyThreadPoolSize() const override { return private_key_thread_pool_size_; }
   const std::vector<std::string>& verifySubjectAltNameList() const override {
     return verify_subject_alt_name_list_;
   };
@@ -59,6 +60,8 @@ protected:
                     Secret::SecretManager& secret_manager);
 
 private:
+  static uint32_t
+  privateKeyThreadPoolSizeFromProto(const envoy::api::v2::auth::CommonTlsContext& config);
   static unsigned
   tlsVersionFromProto(const envoy::api::v2::auth::TlsParameters_TlsProtocol& version,
                       unsigned default_version);
@@ -78,6 +81,7 @@ private:
   const std::string cert_chain_path_;
   const std::string private_key_;
   const std::string private_key_path_;
+  const uint32_t private_key_thread_pool_size_;
   const std::vector<std::string> verify_subject_alt_name_list_;
   const std::vector<std::string> verify_certificate_hash_list_;
   const std::vector<std::string> verify_certificate_spki_list_;
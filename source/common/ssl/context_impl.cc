@@ -31,7 +31,8 @@ int ContextImpl::sslContextIndex() {
   }());
 }
 
-ContextImpl::ContextImpl(Stats::Scope& scope, const ContextConfig& config)
+ContextImpl::ContextImpl(Stats::Scope& scope, const ContextConfig& config,
+                         PrivateKeyThreadPoolSharedPtr private_key_thread_pool)
     : ctx_(SSL_CTX_new(TLS_method())), scope_(scope), stats_(generateStats(scope)) {
   RELEASE_ASSERT(ctx_, "");
 
@@ -215,6 +216,15 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const ContextConfig& config)
       throw EnvoyException(
           fmt::format("Failed to load private key from {}", config.privateKeyPath()));
     }
+
+    // The key stays set on the SSL_CTX so that BoringSSL checks it against the certificate, but
+    // the private key method takes precedence for the operations of handshakes.
+    if (config.privateKeyThreadPoolSize() > 0) {
+      private_key_method_provider_ = std::make_shared<ThreadPoolPrivateKeyMethodProvider>(
+          std::move(pkey), std::move(private_key_thread_pool));
+      SSL_CTX_set_private_key_method(ctx_.get(),
+                                     private_key_method_provider_->getBoringSslPrivateKeyMethod());
+    }
   }
 
   // use the server's cipher list preferences
@@ -471,8 +481,10 @@ std::string ContextImpl::getCertChainInformation() const {
                      getDaysUntilExpiration(cert_chain_.get()));
 }
 
-ClientContextImpl::ClientContextImpl(Stats::Scope& scope, const ClientContextConfig& config)
-    : ContextImpl(scope, config), server_name_indication_(config.serverNameIndication()),
+ClientContextImpl::ClientContextImpl(Stats::Scope& scope, const ClientContextConfig& config,
+                                     PrivateKeyThreadPoolSharedPtr private_key_thread_pool)
+    : ContextImpl(scope, config, std::move(private_key_thread_pool)),
+      server_name_indication_(config.serverNameIndication()),
       allow_renegotiation_(config.allowRenegotiation()) {
   if (!parsed_alpn_protocols_.empty()) {
     int rc = SSL_CTX_set_alpn_protos(ctx_.get(), &parsed_alpn_protocols_[0],
@@ -498,8 +510,11 @@ bssl::UniquePtr<SSL> ClientContextImpl::newSsl() const {
 
 ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const ServerContextConfig& config,
                                      const std::vector<std::string>& server_names,
-                                     Runtime::Loader& runtime)
-    : ContextImpl(scope, config), runtime_(runtime),
+                                     Runtime::Loader& runtime,
+                                     PrivateKeyThreadPoolSharedPtr private_key_thread_pool,
+                                     SessionCache* session_cache)
+    : ContextImpl(scope, config, std::move(private_key_thread_pool)), runtime_(runtime),
+      session_cache_(session_cache),
       session_ticket_keys_(config.sessionTicketKeys()) {
   if (config.certChain().empty()) {
     throw EnvoyException("Server TlsCertificates must have a certificate specified");
@@ -560,17 +575,33 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const ServerContextCon
                                this);
   }
 
-  if (!session_ticket_keys_.empty()) {
+  // Without configured keys, the session cache supplies keys that are shared with the other
+  // contexts of the process and, with hot restart, with the next process.
+  if (!session_ticket_keys_.empty() || session_cache_ != nullptr) {
     SSL_CTX_set_tlsext_ticket_key_cb(
         ctx_.get(),
         [](SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx,
            int encrypt) -> int {
-          ContextImpl* context_impl = static_cast<ContextImpl*>(
-              SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), sslContextIndex()));
-          ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(context_impl);
-          RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
-          return server_context_impl->sessionTicketProcess(ssl, key_name, iv, ctx, hmac_ctx,
-                                                           encrypt);
+          return fromSslCtx(SSL_get_SSL_CTX(ssl))
+              ->sessionTicketProcess(ssl, key_name, iv, ctx, hmac_ctx, encrypt);
+        });
+  }
+
+  if (session_cache_ != nullptr) {
+    // BoringSSL's internal cache is still consulted first, so the session cache is only used for
+    // sessions created by other contexts or by the previous process. No remove callback is set,
+    // since BoringSSL removes every session of a context when freeing it, which would empty the
+    // cache whenever a listener is updated or the parent process shuts down.
+    SSL_CTX_sess_set_new_cb(ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+      fromSslCtx(SSL_get_SSL_CTX(ssl))->newSession(session);
+      // The session is copied, so no reference is kept.
+      return 0;
+    });
+    SSL_CTX_sess_set_get_cb(
+        ctx_.get(), [](SSL* ssl, const uint8_t* id, int id_len, int* out_copy) -> SSL_SESSION* {
+          // The returned session is owned by the caller.
+          *out_copy = 0;
+          return fromSslCtx(SSL_get_SSL_CTX(ssl))->getSession(id, id_len).release();
         });
   }
 
@@ -663,19 +694,51 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope, const ServerContextCon
   RELEASE_ASSERT(rc == 1, "");
 }
 
+ServerContextImpl* ServerContextImpl::fromSslCtx(SSL_CTX* ctx) {
+  ContextImpl* context_impl =
+      static_cast<ContextImpl*>(SSL_CTX_get_ex_data(ctx, sslContextIndex()));
+  ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(context_impl);
+  RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
+  return server_context_impl;
+}
+
 int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv,
                                             EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx, int encrypt) {
+  if (!session_ticket_keys_.empty()) {
+    return sessionTicketProcess(session_ticket_keys_, key_name, iv, ctx, hmac_ctx, encrypt);
+  }
+
+  // The callback is only set without configured keys when there is a session cache. Generations
+  // start at 1, so the first call always fetches the keys.
+  const uint64_t generation = session_cache_->ticketKeysGeneration();
+  {
+    absl::ReaderMutexLock lock(&cached_ticket_keys_lock_);
+    if (cached_ticket_keys_generation_ == generation) {
+      return sessionTicketProcess(cached_ticket_keys_, key_name, iv, ctx, hmac_ctx, encrypt);
+    }
+  }
+
+  absl::MutexLock lock(&cached_ticket_keys_lock_);
+  if (cached_ticket_keys_generation_ != generation) {
+    cached_ticket_keys_generation_ = session_cache_->ticketKeys(cached_ticket_keys_);
+  }
+  return sessionTicketProcess(cached_ticket_keys_, key_name, iv, ctx, hmac_ctx, encrypt);
+}
+
+int ServerContextImpl::sessionTicketProcess(
+    const std::vector<ServerContextConfig::SessionTicketKey>& keys, uint8_t* key_name, uint8_t* iv,
+    EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx, int encrypt) {
   const EVP_MD* hmac = EVP_sha256();
   const EVP_CIPHER* cipher = EVP_aes_256_cbc();
 
   if (encrypt == 1) {
     // Encrypt
-    RELEASE_ASSERT(session_ticket_keys_.size() >= 1, "");
+    RELEASE_ASSERT(keys.size() >= 1, "");
     // TODO(ggreenway): validate in SDS that session_ticket_keys_ cannot be empty,
     // or if we allow it to be emptied, reconfigure the context so this callback
     // isn't set.
 
-    const ServerContextConfig::SessionTicketKey& key = session_ticket_keys_.front();
+    const ServerContextConfig::SessionTicketKey& key = keys.front();
 
     static_assert(std::tuple_size<decltype(key.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
                   "Expected key.name length");
@@ -699,7 +762,7 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
   } else {
     // Decrypt
     bool is_enc_key = true; // first element is the encryption key
-    for (const ServerContextConfig::SessionTicketKey& key : session_ticket_keys_) {
+    for (const ServerContextConfig::SessionTicketKey& key : keys) {
       static_assert(std::tuple_size<decltype(key.name_)>::value == SSL_TICKET_KEY_NAME_LEN,
                     "Expected key.name length");
       if (std::equal(key.name_.begin(), key.name_.end(), key_name)) {
@@ -723,5 +786,36 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
   }
 }
 
+void ServerContextImpl::newSession(SSL_SESSION* session) {
+  uint8_t* data;
+  size_t data_len;
+  if (!SSL_SESSION_to_bytes(session, &data, &data_len)) {
+    return;
+  }
+  bssl::UniquePtr<uint8_t> data_ptr(data);
+
+  unsigned id_len;
+  const uint8_t* id = SSL_SESSION_get_id(session, &id_len);
+  session_cache_->insertSession(absl::string_view(reinterpret_cast<const char*>(id), id_len),
+                                absl::string_view(reinterpret_cast<const char*>(data), data_len));
+}
+
+bssl::UniquePtr<SSL_SESSION> ServerContextImpl::getSession(const uint8_t* id, int id_len) {
+  const absl::string_view session_id(reinterpret_cast<const char*>(id), id_len);
+  std::string data;
+  if (!session_cache_->lookupSession(session_id, data)) {
+    return nullptr;
+  }
+
+  bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_from_bytes(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size(), ctx_.get()));
+  if (session == nullptr) {
+    // The session may have been stored by a process built against a different BoringSSL.
+    ERR_clear_error();
+    session_cache_->removeSession(session_id);
+  }
+  return session;
+}
+
 } // namespace Ssl
 } // namespace Envoy
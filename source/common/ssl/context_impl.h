@@ -6,12 +6,17 @@
 #include "envoy/runtime/runtime.h"
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
+#include "envoy/ssl/private_key_method.h"
+#include "envoy/ssl/session_cache.h"
 #include "envoy/stats/scope.h"
 #include "envoy/stats/stats_macros.h"
 
+#include "common/common/thread_annotations.h"
 #include "common/ssl/context_impl.h"
 #include "common/ssl/context_manager_impl.h"
+#include "common/ssl/thread_pool_private_key_method_provider.h"
 
+#include "absl/synchronization/mutex.h"
 #include "openssl/ssl.h"
 
 namespace Envoy {
@@ -30,7 +35,9 @@ namespace Ssl {
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
-  COUNTER(fail_verify_cert_hash)
+  COUNTER(fail_verify_cert_hash)                                                                   \
+  HISTOGRAM(handshake_duration_ms)                                                                 \
+  HISTOGRAM(private_key_operation_duration_ms)
 // clang-format on
 
 /**
@@ -69,13 +76,26 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return the provider that performs the private key operations of handshakes, or nullptr if
+   *         they are performed on the thread of the connection.
+   */
+  const PrivateKeyMethodProviderSharedPtr& privateKeyMethodProvider() const {
+    return private_key_method_provider_;
+  }
+
   // Ssl::Context
   size_t daysUntilFirstCertExpires() const override;
   std::string getCaCertInformation() const override;
   std::string getCertChainInformation() const override;
 
 protected:
-  ContextImpl(Stats::Scope& scope, const ContextConfig& config);
+  /**
+   * @param private_key_thread_pool supplies the pool that performs the private key operations of
+   *        handshakes if the config has a thread pool size, or nullptr otherwise.
+   */
+  ContextImpl(Stats::Scope& scope, const ContextConfig& config,
+              PrivateKeyThreadPoolSharedPtr private_key_thread_pool);
 
   /**
    * The global SSL-library index used for storing a pointer to the context
@@ -134,13 +154,15 @@ protected:
   bssl::UniquePtr<X509> cert_chain_;
   std::string ca_file_path_;
   std::string cert_chain_file_path_;
+  PrivateKeyMethodProviderSharedPtr private_key_method_provider_;
 };
 
 typedef std::shared_ptr<ContextImpl> ContextImplSharedPtr;
 
 class ClientContextImpl : public ContextImpl, public ClientContext {
 public:
-  ClientContextImpl(Stats::Scope& scope, const ClientContextConfig& config);
+  ClientContextImpl(Stats::Scope& scope, const ClientContextConfig& config,
+                    PrivateKeyThreadPoolSharedPtr private_key_thread_pool);
 
   bssl::UniquePtr<SSL> newSsl() const override;
 
@@ -151,18 +173,39 @@ private:
 
 class ServerContextImpl : public ContextImpl, public ServerContext {
 public:
+  /**
+   * @param session_cache supplies the cache that provides session ticket keys when none are
+   *        configured and stores sessions for resumption by session ID, or nullptr to leave both
+   *        to BoringSSL's per context state.
+   */
   ServerContextImpl(Stats::Scope& scope, const ServerContextConfig& config,
-                    const std::vector<std::string>& server_names, Runtime::Loader& runtime);
+                    const std::vector<std::string>& server_names, Runtime::Loader& runtime,
+                    PrivateKeyThreadPoolSharedPtr private_key_thread_pool,
+                    SessionCache* session_cache = nullptr);
 
 private:
+  static ServerContextImpl* fromSslCtx(SSL_CTX* ctx);
+
   int alpnSelectCallback(const unsigned char** out, unsigned char* outlen, const unsigned char* in,
                          unsigned int inlen);
   int sessionTicketProcess(SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx,
                            HMAC_CTX* hmac_ctx, int encrypt);
+  static int sessionTicketProcess(const std::vector<ServerContextConfig::SessionTicketKey>& keys,
+                                  uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx,
+                                  HMAC_CTX* hmac_ctx, int encrypt);
+  void newSession(SSL_SESSION* session);
+  bssl::UniquePtr<SSL_SESSION> getSession(const uint8_t* id, int id_len);
 
   Runtime::Loader& runtime_;
+  SessionCache* session_cache_;
   std::vector<uint8_t> parsed_alt_alpn_protocols_;
   const std::vector<ServerContextConfig::SessionTicketKey> session_ticket_keys_;
+  // The session cache's ticket keys, which are only fetched again when their generation changes,
+  // so that handshakes don't take the cache's process shared lock.
+  absl::Mutex cached_ticket_keys_lock_;
+  std::vector<ServerContextConfig::SessionTicketKey>
+      cached_ticket_keys_ GUARDED_BY(cached_ticket_keys_lock_);
+  uint64_t cached_ticket_keys_generation_ GUARDED_BY(cached_ticket_keys_lock_){};
 };
 
 } // namespace Ssl
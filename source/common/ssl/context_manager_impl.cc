@@ -22,7 +22,8 @@ void ContextManagerImpl::removeEmptyContexts() {
 
 ClientContextSharedPtr
 ContextManagerImpl::createSslClientContext(Stats::Scope& scope, const ClientContextConfig& config) {
-  ClientContextSharedPtr context = std::make_shared<ClientContextImpl>(scope, config);
+  ClientContextSharedPtr context = std::make_shared<ClientContextImpl>(
+      scope, config, privateKeyThreadPool(config.privateKeyThreadPoolSize()));
   removeEmptyContexts();
   contexts_.emplace_back(context);
   return context;
@@ -31,13 +32,28 @@ ContextManagerImpl::createSslClientContext(Stats::Scope& scope, const ClientCont
 ServerContextSharedPtr
 ContextManagerImpl::createSslServerContext(Stats::Scope& scope, const ServerContextConfig& config,
                                            const std::vector<std::string>& server_names) {
-  ServerContextSharedPtr context =
-      std::make_shared<ServerContextImpl>(scope, config, server_names, runtime_);
+  ServerContextSharedPtr context = std::make_shared<ServerContextImpl>(
+      scope, config, server_names, runtime_,
+      privateKeyThreadPool(config.privateKeyThreadPoolSize()), session_cache_);
   removeEmptyContexts();
   contexts_.emplace_back(context);
   return context;
 }
 
+PrivateKeyThreadPoolSharedPtr ContextManagerImpl::privateKeyThreadPool(uint32_t num_threads) {
+  if (num_threads == 0) {
+    return nullptr;
+  }
+
+  std::weak_ptr<PrivateKeyThreadPool>& entry = private_key_thread_pools_[num_threads];
+  PrivateKeyThreadPoolSharedPtr thread_pool = entry.lock();
+  if (thread_pool == nullptr) {
+    thread_pool = std::make_shared<PrivateKeyThreadPool>(num_threads);
+    entry = thread_pool;
+  }
+  return thread_pool;
+}
+
 size_t ContextManagerImpl::daysUntilFirstCertExpires() const {
   size_t ret = std::numeric_limits<int>::max();
   for (const auto& ctx_weak_ptr : contexts_) {
@@ -1,12 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <list>
+#include <unordered_map>
 
 #include "envoy/runtime/runtime.h"
 #include "envoy/ssl/context_manager.h"
+#include "envoy/ssl/session_cache.h"
 #include "envoy/stats/scope.h"
 
+#include "common/ssl/thread_pool_private_key_method_provider.h"
+
 namespace Envoy {
 namespace Ssl {
 
@@ -19,7 +24,12 @@ namespace Ssl {
  */
 class ContextManagerImpl final : public ContextManager {
 public:
-  ContextManagerImpl(Runtime::Loader& runtime) : runtime_(runtime) {}
+  /**
+   * @param session_cache supplies the session resumption state shared by all server contexts, or
+   *        nullptr to leave it to each context.
+   */
+  ContextManagerImpl(Runtime::Loader& runtime, SessionCache* session_cache = nullptr)
+      : runtime_(runtime), session_cache_(session_cache) {}
   ~ContextManagerImpl();
 
   // Ssl::ContextManager
@@ -33,8 +43,15 @@ public:
 
 private:
   void removeEmptyContexts();
+  // Returns the pool shared by the contexts with a private key thread pool of num_threads, or
+  // nullptr if num_threads is 0.
+  PrivateKeyThreadPoolSharedPtr privateKeyThreadPool(uint32_t num_threads);
+
   Runtime::Loader& runtime_;
+  SessionCache* session_cache_;
   std::list<std::weak_ptr<Context>> contexts_;
+  // Keyed by the number of threads. A pool is destroyed with the last context using it.
+  std::unordered_map<uint32_t, std::weak_ptr<PrivateKeyThreadPool>> private_key_thread_pools_;
 };
 
 } // namespace Ssl
@@ -0,0 +1,117 @@
+#include "common/ssl/session_cache_impl.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+#include "common/common/lock_guard.h"
+
+#include "openssl/rand.h"
+
+namespace Envoy {
+namespace Ssl {
+
+const uint32_t SessionCacheImpl::MAX_TICKET_KEYS;
+const uint32_t SessionCacheImpl::MAX_SESSIONS;
+const uint32_t SessionCacheImpl::MAX_SESSION_ID_SIZE;
+const uint32_t SessionCacheImpl::MAX_SESSION_SIZE;
+const std::chrono::seconds SessionCacheImpl::TICKET_KEY_ROTATION_INTERVAL(3600);
+
+uint64_t SessionCacheImpl::ticketKeys(std::vector<ServerContextConfig::SessionTicketKey>& keys) {
+  const int64_t current_time = now();
+
+  keys.clear();
+  Thread::LockGuard lock(lock_);
+  if (current_time >= state_.next_ticket_key_rotation_) {
+    rotateTicketKeys(current_time);
+  }
+
+  // Walk back from the current key so that keys are ordered from newest to oldest.
+  for (uint32_t i = 0; i < state_.num_ticket_keys_; i++) {
+    const uint32_t index = (state_.current_ticket_key_ + MAX_TICKET_KEYS - i) % MAX_TICKET_KEYS;
+    keys.push_back(state_.ticket_keys_[index].key_);
+  }
+  return state_.ticket_keys_generation_;
+}
+
+uint64_t SessionCacheImpl::ticketKeysGeneration() {
+  const int64_t current_time = now();
+  if (current_time >= state_.next_ticket_key_rotation_) {
+    // Another thread or process may have rotated the keys since the check.
+    Thread::LockGuard lock(lock_);
+    if (current_time >= state_.next_ticket_key_rotation_) {
+      rotateTicketKeys(current_time);
+    }
+  }
+  return state_.ticket_keys_generation_;
+}
+
+int64_t SessionCacheImpl::now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             time_source_.currentTime().time_since_epoch())
+      .count();
+}
+
+void SessionCacheImpl::rotateTicketKeys(int64_t now) {
+  const uint32_t next =
+      state_.num_ticket_keys_ == 0 ? 0 : (state_.current_ticket_key_ + 1) % MAX_TICKET_KEYS;
+  TicketKey& entry = state_.ticket_keys_[next];
+  int rc = RAND_bytes(entry.key_.name_.data(), entry.key_.name_.size());
+  RELEASE_ASSERT(rc == 1, "");
+  rc = RAND_bytes(entry.key_.hmac_key_.data(), entry.key_.hmac_key_.size());
+  RELEASE_ASSERT(rc == 1, "");
+  rc = RAND_bytes(entry.key_.aes_key_.data(), entry.key_.aes_key_.size());
+  RELEASE_ASSERT(rc == 1, "");
+  entry.created_ = now;
+
+  state_.current_ticket_key_ = next;
+  state_.num_ticket_keys_ = std::min(state_.num_ticket_keys_ + 1, MAX_TICKET_KEYS);
+  state_.next_ticket_key_rotation_ = now + TICKET_KEY_ROTATION_INTERVAL.count();
+  ++state_.ticket_keys_generation_;
+}
+
+bool SessionCacheImpl::insertSession(absl::string_view id, absl::string_view session) {
+  if (id.empty() || id.size() > MAX_SESSION_ID_SIZE || session.size() > MAX_SESSION_SIZE) {
+    return false;
+  }
+
+  Thread::LockGuard lock(lock_);
+  Session& entry = sessionEntry(id);
+  entry.id_size_ = id.size();
+  std::copy(id.begin(), id.end(), entry.id_);
+  entry.session_size_ = session.size();
+  std::copy(session.begin(), session.end(), entry.session_);
+  return true;
+}
+
+bool SessionCacheImpl::lookupSession(absl::string_view id, std::string& session) {
+  Thread::LockGuard lock(lock_);
+  const Session& entry = sessionEntry(id);
+  if (!sessionIdMatches(entry, id)) {
+    return false;
+  }
+
+  session.assign(reinterpret_cast<const char*>(entry.session_), entry.session_size_);
+  return true;
+}
+
+void SessionCacheImpl::removeSession(absl::string_view id) {
+  Thread::LockGuard lock(lock_);
+  Session& entry = sessionEntry(id);
+  if (sessionIdMatches(entry, id)) {
+    entry.id_size_ = 0;
+  }
+}
+
+SessionCacheImpl::Session& SessionCacheImpl::sessionEntry(absl::string_view id) {
+  return state_.sessions_[HashUtil::xxHash64(id) % MAX_SESSIONS];
+}
+
+bool SessionCacheImpl::sessionIdMatches(const Session& entry, absl::string_view id) {
+  return entry.id_size_ != 0 && entry.id_size_ == id.size() &&
+         memcmp(entry.id_, id.data(), id.size()) == 0;
+}
+
+} // namespace Ssl
+} // namespace Envoy
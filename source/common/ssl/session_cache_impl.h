@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/ssl/session_cache.h"
+#include "envoy/thread/thread.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Implementation of SessionCache over a fixed size block of memory, which is laid directly into
+ * shared memory when the cache is shared across hot restarts. All access to the block is under
+ * the supplied lock, which must be process shared in that case.
+ *
+ * Ticket keys are generated on first use and rotated every TICKET_KEY_ROTATION_INTERVAL. The
+ * previous keys are kept for decrypting tickets until the session lifetime has passed. The
+ * generation of the keys and the time of their next rotation can be read without the lock, so
+ * checking whether cached keys are current doesn't contend with other processes. Sessions
+ * are stored in a direct mapped table indexed by a hash of the session ID, so a new session
+ * evicts any session that hashes to the same entry.
+ */
+class SessionCacheImpl : public SessionCache {
+public:
+  static const uint32_t MAX_TICKET_KEYS = 3;
+  static const uint32_t MAX_SESSIONS = 4096;
+  static const uint32_t MAX_SESSION_ID_SIZE = 32;  // SSL_MAX_SSL_SESSION_ID_LENGTH
+  static const uint32_t MAX_SESSION_SIZE = 512;
+  static const std::chrono::seconds TICKET_KEY_ROTATION_INTERVAL;
+
+  struct TicketKey {
+    ServerContextConfig::SessionTicketKey key_;
+    // Seconds since the epoch at which the key was generated.
+    int64_t created_;
+  };
+
+  struct Session {
+    uint8_t id_size_; // 0 if the entry is empty.
+    uint8_t id_[MAX_SESSION_ID_SIZE];
+    uint16_t session_size_;
+    uint8_t session_[MAX_SESSION_SIZE];
+  };
+
+  /**
+   * The cache contents. All zeroes is an empty cache, so a freshly created shared memory segment
+   * or a value initialized State can be used as is.
+   */
+  struct State {
+    uint32_t num_ticket_keys_;
+    uint32_t current_ticket_key_;
+    // Read without the lock, and only written under it when the keys are rotated.
+    std::atomic<uint64_t> ticket_keys_generation_;
+    // Seconds since the epoch at which the keys are next rotated. Also read without the lock.
+    std::atomic<int64_t> next_ticket_key_rotation_;
+    TicketKey ticket_keys_[MAX_TICKET_KEYS];
+    Session sessions_[MAX_SESSIONS];
+  };
+
+  SessionCacheImpl(State& state, Thread::BasicLockable& lock, SystemTimeSource& time_source)
+      : state_(state), lock_(lock), time_source_(time_source) {}
+
+  // Ssl::SessionCache
+  uint64_t ticketKeys(std::vector<ServerContextConfig::SessionTicketKey>& keys) override;
+  uint64_t ticketKeysGeneration() override;
+  bool insertSession(absl::string_view id, absl::string_view session) override;
+  bool lookupSession(absl::string_view id, std::string& session) override;
+  void removeSession(absl::string_view id) override;
+
+private:
+  int64_t now();
+  void rotateTicketKeys(int64_t now);
+  Session& sessionEntry(absl::string_view id);
+  static bool sessionIdMatches(const Session& entry, absl::string_view id);
+
+  State& state_;
+  Thread::BasicLockable& lock_;
+  SystemTimeSource& time_source_;
+};
+
+} // namespace Ssl
+} // namespace Envoy
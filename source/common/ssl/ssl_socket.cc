@@ -27,12 +27,19 @@ SslSocket::SslSocket(ContextSharedPtr ctx, InitialState state)
   }
 }
 
+SslSocket::~SslSocket() { unregisterPrivateKeyMethod(); }
+
 void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& callbacks) {
   ASSERT(!callbacks_);
   callbacks_ = &callbacks;
 
   BIO* bio = BIO_new_socket(callbacks_->fd(), 0);
   SSL_set_bio(ssl_.get(), bio, bio);
+
+  const PrivateKeyMethodProviderSharedPtr& provider = ctx_->privateKeyMethodProvider();
+  if (provider != nullptr) {
+    provider->registerPrivateKeyMethod(ssl_.get(), *this, callbacks_->connection().dispatcher());
+  }
 }
 
 Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
@@ -97,10 +104,15 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
 
 PostIoAction SslSocket::doHandshake() {
   ASSERT(!handshake_complete_);
+  if (handshake_timer_ == nullptr) {
+    handshake_timer_ = std::make_unique<Stats::Timespan>(ctx_->stats().handshake_duration_ms_);
+  }
+
   int rc = SSL_do_handshake(ssl_.get());
   if (rc == 1) {
     ENVOY_CONN_LOG(debug, "handshake complete", callbacks_->connection());
     handshake_complete_ = true;
+    handshake_timer_->complete();
     ctx_->logHandshake(ssl_.get());
     callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 
@@ -115,6 +127,13 @@ PostIoAction SslSocket::doHandshake() {
     case SSL_ERROR_WANT_READ:
     case SSL_ERROR_WANT_WRITE:
       return PostIoAction::KeepOpen;
+    case SSL_ERROR_WANT_PRIVATE_KEY_OPERATION:
+      // The handshake is resumed by onPrivateKeyMethodComplete().
+      if (private_key_timer_ == nullptr) {
+        private_key_timer_ =
+            std::make_unique<Stats::Timespan>(ctx_->stats().private_key_operation_duration_ms_);
+      }
+      return PostIoAction::KeepOpen;
     default:
       drainErrorQueue();
       return PostIoAction::Close;
@@ -122,6 +141,22 @@ PostIoAction SslSocket::doHandshake() {
   }
 }
 
+void SslSocket::onPrivateKeyMethodComplete() {
+  ASSERT(private_key_timer_ != nullptr);
+  private_key_timer_->complete();
+  private_key_timer_.reset();
+
+  // Resume the handshake from the read path, which also picks up any data that arrived while the
+  // operation was pending.
+  callbacks_->setReadBufferReady();
+}
+
+void SslSocket::unregisterPrivateKeyMethod() {
+  if (ctx_->privateKeyMethodProvider() != nullptr) {
+    ctx_->privateKeyMethodProvider()->unregisterPrivateKeyMethod(ssl_.get());
+  }
+}
+
 void SslSocket::drainErrorQueue() {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -327,6 +362,9 @@ std::vector<std::string> SslSocket::getDnsSansFromCertificate(X509* cert) {
 }
 
 void SslSocket::closeSocket(Network::ConnectionEvent) {
+  // The connection may outlive the close until it is deferred deleted, but must not be resumed.
+  unregisterPrivateKeyMethod();
+
   // Attempt to send a shutdown before closing the socket. It's possible this won't go out if
   // there is no room on the socket. We can extend the state machine to handle this at some point
   // if needed.
@@ -5,7 +5,9 @@
 
 #include "envoy/network/connection.h"
 #include "envoy/network/transport_socket.h"
+#include "envoy/ssl/private_key_method.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/timespan.h"
 
 #include "common/common/logger.h"
 #include "common/ssl/context_impl.h"
@@ -19,9 +21,11 @@ enum class InitialState { Client, Server };
 
 class SslSocket : public Network::TransportSocket,
                   public Connection,
+                  public PrivateKeyConnectionCallbacks,
                   protected Logger::Loggable<Logger::Id::connection> {
 public:
   SslSocket(ContextSharedPtr ctx, InitialState state);
+  ~SslSocket();
 
   // Ssl::Connection
   bool peerCertificatePresented() const override;
@@ -46,12 +50,16 @@ public:
   Ssl::Connection* ssl() override { return this; }
   const Ssl::Connection* ssl() const override { return this; }
 
+  // Ssl::PrivateKeyConnectionCallbacks
+  void onPrivateKeyMethodComplete() override;
+
   SSL* rawSslForTest() { return ssl_.get(); }
 
 private:
   Network::PostIoAction doHandshake();
   void drainErrorQueue();
   void shutdownSsl();
+  void unregisterPrivateKeyMethod();
 
   // TODO: Move helper functions to the `Ssl::Utility` namespace.
   std::string getUriSanFromCertificate(X509* cert) const;
@@ -64,6 +72,8 @@ private:
   bool handshake_complete_{};
   bool shutdown_sent_{};
   uint64_t bytes_to_retry_{};
+  Stats::TimespanPtr handshake_timer_;
+  Stats::TimespanPtr private_key_timer_;
   mutable std::string cached_sha_256_peer_certificate_digest_;
   mutable std::string cached_url_encoded_pem_encoded_peer_certificate_;
 };
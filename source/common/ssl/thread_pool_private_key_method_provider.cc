@@ -0,0 +1,251 @@
+#include "common/ssl/thread_pool_private_key_method_provider.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+
+#include "openssl/err.h"
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Ssl {
+
+PrivateKeyThreadPool::PrivateKeyThreadPool(uint32_t num_threads) {
+  ASSERT(num_threads > 0);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back(std::make_unique<Thread::Thread>([this]() -> void { threadRoutine(); }));
+  }
+}
+
+PrivateKeyThreadPool::~PrivateKeyThreadPool() {
+  {
+    Thread::LockGuard lock(lock_);
+    exit_ = true;
+  }
+  wakeup_.notifyAll();
+
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+void PrivateKeyThreadPool::post(std::function<void()> operation) {
+  {
+    Thread::LockGuard lock(lock_);
+    queue_.push_back(std::move(operation));
+  }
+  wakeup_.notifyOne();
+}
+
+void PrivateKeyThreadPool::threadRoutine() {
+  while (true) {
+    std::function<void()> operation;
+    {
+      Thread::LockGuard lock(lock_);
+      while (queue_.empty() && !exit_) {
+        wakeup_.wait(lock_);
+      }
+
+      if (exit_) {
+        return;
+      }
+
+      operation = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    operation();
+  }
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    bssl::UniquePtr<EVP_PKEY> pkey, PrivateKeyThreadPoolSharedPtr thread_pool)
+    : pkey_(pkey.release(), EVP_PKEY_free), thread_pool_(std::move(thread_pool)) {
+  ASSERT(thread_pool_ != nullptr);
+  method_.sign = sign;
+  method_.decrypt = decrypt;
+  method_.complete = complete;
+}
+
+int ThreadPoolPrivateKeyMethodProvider::sslConnectionStateIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    RELEASE_ASSERT(index >= 0, "");
+    return index;
+  }());
+}
+
+ThreadPoolPrivateKeyMethodProvider::ConnectionState*
+ThreadPoolPrivateKeyMethodProvider::connectionState(SSL* ssl) {
+  return static_cast<ConnectionState*>(SSL_get_ex_data(ssl, sslConnectionStateIndex()));
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, PrivateKeyConnectionCallbacks& callbacks, Event::Dispatcher& dispatcher) {
+  ASSERT(connectionState(ssl) == nullptr);
+  int rc = SSL_set_ex_data(ssl, sslConnectionStateIndex(),
+                           new ConnectionState(*this, callbacks, dispatcher));
+  RELEASE_ASSERT(rc == 1, "");
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  std::unique_ptr<ConnectionState> state(connectionState(ssl));
+  if (state == nullptr) {
+    return;
+  }
+  SSL_set_ex_data(ssl, sslConnectionStateIndex(), nullptr);
+
+  if (state->pending_ != nullptr) {
+    // The pool thread may still be working on the operation, but won't post its completion.
+    Thread::LockGuard lock(state->pending_->lock_);
+    state->pending_->cancelled_ = true;
+  }
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::sign(SSL* ssl, uint8_t*, size_t*,
+                                                                  size_t,
+                                                                  uint16_t signature_algorithm,
+                                                                  const uint8_t* in,
+                                                                  size_t in_len) {
+  return startOperation(ssl, false, signature_algorithm, in, in_len);
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::decrypt(SSL* ssl, uint8_t*, size_t*,
+                                                                     size_t, const uint8_t* in,
+                                                                     size_t in_len) {
+  return startOperation(ssl, true, 0, in, in_len);
+}
+
+ssl_private_key_result_t
+ThreadPoolPrivateKeyMethodProvider::startOperation(SSL* ssl, bool decrypt,
+                                                   uint16_t signature_algorithm, const uint8_t* in,
+                                                   size_t in_len) {
+  ConnectionState* state = connectionState(ssl);
+  if (state == nullptr || state->pending_ != nullptr) {
+    return ssl_private_key_failure;
+  }
+
+  OperationSharedPtr operation =
+      std::make_shared<Operation>(state->parent_.pkey_, state->callbacks_, state->dispatcher_);
+  operation->decrypt_ = decrypt;
+  operation->signature_algorithm_ = signature_algorithm;
+  operation->input_.assign(in, in + in_len);
+  state->pending_ = operation;
+  state->parent_.thread_pool_->post([operation]() -> void { runOperation(operation); });
+  return ssl_private_key_retry;
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::complete(SSL* ssl, uint8_t* out,
+                                                                      size_t* out_len,
+                                                                      size_t max_out) {
+  ConnectionState* state = connectionState(ssl);
+  if (state == nullptr || state->pending_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+
+  OperationSharedPtr operation = state->pending_;
+  Thread::LockGuard lock(operation->lock_);
+  if (!operation->done_) {
+    return ssl_private_key_retry;
+  }
+
+  state->pending_.reset();
+  if (operation->failed_ || operation->output_.size() > max_out) {
+    return ssl_private_key_failure;
+  }
+  std::copy(operation->output_.begin(), operation->output_.end(), out);
+  *out_len = operation->output_.size();
+  return ssl_private_key_success;
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::performOperation(const Operation& operation,
+                                                          std::vector<uint8_t>& output) {
+  // These mirror what BoringSSL does with a private key that is set on the SSL_CTX.
+  EVP_PKEY* pkey = operation.pkey_.get();
+  if (operation.decrypt_) {
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey);
+    if (rsa == nullptr) {
+      return false;
+    }
+    output.resize(RSA_size(rsa));
+    size_t output_len;
+    if (!RSA_decrypt(rsa, &output_len, output.data(), output.size(), operation.input_.data(),
+                     operation.input_.size(), RSA_NO_PADDING)) {
+      return false;
+    }
+    output.resize(output_len);
+    return true;
+  }
+
+  if (SSL_get_signature_algorithm_key_type(operation.signature_algorithm_) !=
+      EVP_PKEY_id(pkey)) {
+    return false;
+  }
+
+  bssl::ScopedEVP_MD_CTX ctx;
+  EVP_PKEY_CTX* pctx;
+  if (!EVP_DigestSignInit(ctx.get(), &pctx,
+                          SSL_get_signature_algorithm_digest(operation.signature_algorithm_),
+                          nullptr, pkey)) {
+    return false;
+  }
+  if (SSL_is_signature_algorithm_rsa_pss(operation.signature_algorithm_) &&
+      (!EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PSS_PADDING) ||
+       !EVP_PKEY_CTX_set_rsa_pss_saltlen(pctx, -1 /* salt length is digest length */))) {
+    return false;
+  }
+
+  size_t output_len;
+  if (!EVP_DigestSign(ctx.get(), nullptr, &output_len, operation.input_.data(),
+                      operation.input_.size())) {
+    return false;
+  }
+  output.resize(output_len);
+  if (!EVP_DigestSign(ctx.get(), output.data(), &output_len, operation.input_.data(),
+                      operation.input_.size())) {
+    return false;
+  }
+  output.resize(output_len);
+  return true;
+}
+
+void ThreadPoolPrivateKeyMethodProvider::runOperation(const OperationSharedPtr& operation) {
+  {
+    // Don't spend time on the operations of connections that have been closed.
+    Thread::LockGuard lock(operation->lock_);
+    if (operation->cancelled_) {
+      return;
+    }
+  }
+
+  std::vector<uint8_t> output;
+  const bool ok = performOperation(*operation, output);
+  // The error queue is per thread, so failures must not leave errors behind for the next
+  // operation performed on this thread.
+  ERR_clear_error();
+
+  Thread::LockGuard lock(operation->lock_);
+  if (operation->cancelled_) {
+    return;
+  }
+  operation->done_ = true;
+  operation->failed_ = !ok;
+  operation->output_ = std::move(output);
+  // The connection is only unregistered on its dispatcher's thread, so checking for
+  // cancellation again there is enough to not call back into a closed connection.
+  operation->dispatcher_.post([operation]() -> void {
+    {
+      Thread::LockGuard lock(operation->lock_);
+      if (operation->cancelled_) {
+        return;
+      }
+    }
+    operation->callbacks_.onPrivateKeyMethodComplete();
+  });
+}
+
+} // namespace Ssl
+} // namespace Envoy
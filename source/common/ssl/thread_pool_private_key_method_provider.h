@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/ssl/private_key_method.h"
+
+#include "common/common/thread.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * A pool of threads that runs the private key operations of any number of
+ * ThreadPoolPrivateKeyMethodProviders. Operations that are still queued when the pool is destroyed
+ * are dropped.
+ */
+class PrivateKeyThreadPool {
+public:
+  explicit PrivateKeyThreadPool(uint32_t num_threads);
+  ~PrivateKeyThreadPool();
+
+  /**
+   * Queue an operation to be run on one of the threads of the pool.
+   * @param operation supplies the operation to run.
+   */
+  void post(std::function<void()> operation);
+
+private:
+  void threadRoutine();
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar wakeup_;
+  std::list<std::function<void()>> queue_ GUARDED_BY(lock_);
+  bool exit_ GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+typedef std::shared_ptr<PrivateKeyThreadPool> PrivateKeyThreadPoolSharedPtr;
+
+/**
+ * PrivateKeyMethodProvider that performs the private key operations of handshakes with a local key
+ * on a thread pool, so that a burst of handshakes doesn't stall the other connections of a worker
+ * while it signs. The pool may be shared with other providers. A completed operation resumes the
+ * handshake on the connection's dispatcher.
+ */
+class ThreadPoolPrivateKeyMethodProvider : public PrivateKeyMethodProvider {
+public:
+  ThreadPoolPrivateKeyMethodProvider(bssl::UniquePtr<EVP_PKEY> pkey,
+                                     PrivateKeyThreadPoolSharedPtr thread_pool);
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, PrivateKeyConnectionCallbacks& callbacks,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  SSL_PRIVATE_KEY_METHOD* getBoringSslPrivateKeyMethod() override { return &method_; }
+
+private:
+  /**
+   * A private key operation, shared by the connection that started it and the pool thread that
+   * performs it. It holds a reference to the key, as the pool may outlive the provider.
+   */
+  struct Operation {
+    Operation(std::shared_ptr<EVP_PKEY> pkey, PrivateKeyConnectionCallbacks& callbacks,
+              Event::Dispatcher& dispatcher)
+        : pkey_(std::move(pkey)), callbacks_(callbacks), dispatcher_(dispatcher) {}
+
+    const std::shared_ptr<EVP_PKEY> pkey_;
+    PrivateKeyConnectionCallbacks& callbacks_;
+    Event::Dispatcher& dispatcher_;
+    // Whether to decrypt rather than sign with signature_algorithm_.
+    bool decrypt_{};
+    uint16_t signature_algorithm_{};
+    std::vector<uint8_t> input_;
+    Thread::MutexBasicLockable lock_;
+    bool cancelled_ GUARDED_BY(lock_){};
+    bool done_ GUARDED_BY(lock_){};
+    bool failed_ GUARDED_BY(lock_){};
+    std::vector<uint8_t> output_ GUARDED_BY(lock_);
+  };
+
+  typedef std::shared_ptr<Operation> OperationSharedPtr;
+
+  /**
+   * The state of a registered connection, kept in the ex data of its SSL.
+   */
+  struct ConnectionState {
+    ConnectionState(ThreadPoolPrivateKeyMethodProvider& parent,
+                    PrivateKeyConnectionCallbacks& callbacks, Event::Dispatcher& dispatcher)
+        : parent_(parent), callbacks_(callbacks), dispatcher_(dispatcher) {}
+
+    ThreadPoolPrivateKeyMethodProvider& parent_;
+    PrivateKeyConnectionCallbacks& callbacks_;
+    Event::Dispatcher& dispatcher_;
+    OperationSharedPtr pending_;
+  };
+
+  static int sslConnectionStateIndex();
+  static ConnectionState* connectionState(SSL* ssl);
+  static ssl_private_key_result_t sign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                       uint16_t signature_algorithm, const uint8_t* in,
+                                       size_t in_len);
+  static ssl_private_key_result_t decrypt(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                          const uint8_t* in, size_t in_len);
+  static ssl_private_key_result_t complete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                           size_t max_out);
+
+  static ssl_private_key_result_t startOperation(SSL* ssl, bool decrypt,
+                                                 uint16_t signature_algorithm, const uint8_t* in,
+                                                 size_t in_len);
+  static bool performOperation(const Operation& operation, std::vector<uint8_t>& output);
+  static void runOperation(const OperationSharedPtr& operation);
+
+  const std::shared_ptr<EVP_PKEY> pkey_;
+  const PrivateKeyThreadPoolSharedPtr thread_pool_;
+  SSL_PRIVATE_KEY_METHOD method_{};
+};
+
+} // namespace Ssl
+} // namespace Envoy
@@ -6,8 +6,6 @@
 namespace Envoy {
 namespace Stats {
 
-HeapStatData::HeapStatData(absl::string_view key) : name_(key.data(), key.size()) {}
-
 HeapStatDataAllocator::HeapStatDataAllocator() {}
 
 HeapStatDataAllocator::~HeapStatDataAllocator() { ASSERT(stats_.empty()); }
@@ -15,16 +13,30 @@ HeapStatDataAllocator::~HeapStatDataAllocator() { ASSERT(stats_.empty()); }
 HeapStatData* HeapStatDataAllocator::alloc(absl::string_view name) {
   // Any expected truncation of name is done at the callsite. No truncation is
   // required to use this allocator.
-  auto data = std::make_unique<HeapStatData>(name);
+  //
+  // Most names are of stats that already exist in another scope, so look the name up before
+  // interning it, which would take the symbol table's lock exclusively and allocate.
+  std::string encoded;
+  if (symbolTable().encodeExisting(name, encoded)) {
+    Thread::LockGuard lock(mutex_);
+    auto it = stats_.find(encoded);
+    if (it != stats_.end()) {
+      ++it->second->ref_count_;
+      return it->second;
+    }
+  }
+
+  auto data = std::make_unique<HeapStatData>(symbolTable().encode(name));
   Thread::ReleasableLockGuard lock(mutex_);
-  auto ret = stats_.insert(data.get());
-  HeapStatData* existing_data = *ret.first;
+  auto ret = stats_.emplace(data->name_.bytes(), data.get());
+  HeapStatData* existing_data = ret.first->second;
   lock.release();
 
   if (ret.second) {
     return data.release();
   }
   ++existing_data->ref_count_;
+  symbolTable().free(data->name_);
   return existing_data;
 }
 
@@ -36,10 +48,11 @@ void HeapStatDataAllocator::free(HeapStatData& data) {
 
   {
     Thread::LockGuard lock(mutex_);
-    size_t key_removed = stats_.erase(&data);
+    size_t key_removed = stats_.erase(data.name_.bytes());
     ASSERT(key_removed == 1);
   }
 
+  symbolTable().free(data.name_);
   delete &data;
 }
 
@@ -2,33 +2,30 @@
 
 #include <cstdint>
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
 
 #include "common/common/hash.h"
 #include "common/common/thread.h"
 #include "common/common/thread_annotations.h"
 #include "common/stats/stat_data_allocator_impl.h"
+#include "common/stats/symbol_table_impl.h"
 
 namespace Envoy {
 namespace Stats {
 
 /**
  * This structure is an alternate backing store for both CounterImpl and GaugeImpl. It is designed
- * so that it can be allocated efficiently from the heap on demand.
+ * so that it can be allocated efficiently from the heap on demand. The name is encoded in the
+ * allocator's symbol table.
  */
 struct HeapStatData {
-  explicit HeapStatData(absl::string_view key);
-
-  /**
-   * @returns absl::string_view the name as a string_view.
-   */
-  absl::string_view key() const { return name_; }
+  explicit HeapStatData(StatName&& name) : name_(std::move(name)) {}
 
   std::atomic<uint64_t> value_{0};
   std::atomic<uint64_t> pending_increment_{0};
   std::atomic<uint16_t> flags_{0};
   std::atomic<uint16_t> ref_count_{1};
-  std::string name_;
+  StatName name_;
 };
 
 /**
@@ -47,24 +44,27 @@ public:
   // StatDataAllocator
   bool requiresBoundedStatNameSize() const override { return false; }
 
+  /**
+   * @param data supplies data returned by alloc().
+   * @return std::string the name of the stat.
+   */
+  std::string name(const HeapStatData& data) { return symbolTable().decode(data.name_); }
+
+  /**
+   * @return SymbolTable& the table in which the names of the stat data are encoded.
+   */
+  SymbolTable& symbolTable() { return symbol_table_; }
+
 private:
-  struct HeapStatHash_ {
-    size_t operator()(const HeapStatData* a) const { return HashUtil::xxHash64(a->key()); }
-  };
-  struct HeapStatCompare_ {
-    bool operator()(const HeapStatData* a, const HeapStatData* b) const {
-      return (a->key() == b->key());
-    }
+  struct StringViewHash {
+    size_t operator()(absl::string_view key) const { return HashUtil::xxHash64(key); }
   };
 
-  // TODO(jmarantz): See https://github.com/envoyproxy/envoy/pull/3927 and
-  //  https://github.com/envoyproxy/envoy/issues/3585, which can help reorganize
-  // the heap stats using a ref-counted symbol table to compress the stat strings.
-  typedef std::unordered_set<HeapStatData*, HeapStatHash_, HeapStatCompare_> StatSet;
+  // HeapStatData pointers keyed by the bytes of their encoded names, which they own.
+  typedef std::unordered_map<absl::string_view, HeapStatData*, StringViewHash> StatMap;
 
-  // An unordered set of HeapStatData pointers which keys off the key()
-  // field in each object. This necessitates a custom comparator and hasher.
-  StatSet stats_ GUARDED_BY(mutex_);
+  SymbolTable symbol_table_;
+  StatMap stats_ GUARDED_BY(mutex_);
   // A mutex is needed here to protect the stats_ object from both alloc() and free() operations.
   // Although alloc() operations are called under existing locking, free() operations are made from
   // the destructors of the individual stat objects, which are not protected by locks.
@@ -11,9 +11,11 @@ namespace Envoy {
 namespace Stats {
 
 HistogramStatisticsImpl::HistogramStatisticsImpl(const histogram_t* histogram_ptr)
-    : computed_quantiles_(supportedQuantiles().size(), 0.0) {
+    : computed_quantiles_(supportedQuantiles().size(), 0.0),
+      computed_buckets_(supportedBuckets().size(), 0) {
   hist_approx_quantile(histogram_ptr, supportedQuantiles().data(), supportedQuantiles().size(),
                        computed_quantiles_.data());
+  computeBuckets(histogram_ptr);
 }
 
 const std::vector<double>& HistogramStatisticsImpl::supportedQuantiles() const {
@@ -22,6 +24,14 @@ const std::vector<double>& HistogramStatisticsImpl::supportedQuantiles() const {
   return supported_quantiles;
 }
 
+const std::vector<double>& HistogramStatisticsImpl::supportedBuckets() const {
+  // Histograms mostly hold durations in milliseconds, so the buckets span 0.5ms to one hour.
+  static const std::vector<double> supported_buckets = {
+      0.5,  1,    5,     10,    25,     50,     100,    250,     500,    1000,
+      2500, 5000, 10000, 30000, 60000, 300000, 600000, 1800000, 3600000};
+  return supported_buckets;
+}
+
 std::string HistogramStatisticsImpl::summary() const {
   std::vector<std::string> summary;
   const std::vector<double>& supported_quantiles_ref = supportedQuantiles();
@@ -41,6 +51,37 @@ void HistogramStatisticsImpl::refresh(const histogram_t* new_histogram_ptr) {
   ASSERT(supportedQuantiles().size() == computed_quantiles_.size());
   hist_approx_quantile(new_histogram_ptr, supportedQuantiles().data(), supportedQuantiles().size(),
                        computed_quantiles_.data());
+  computeBuckets(new_histogram_ptr);
+}
+
+/**
+ * Computes the cumulative bucket counts from the histogram bins. A bin is counted in every bucket
+ * whose upper bound is at least the bin's lower edge, so a value recorded exactly on a bound is
+ * counted in that bucket, and a bucket may also count values up to one bin width (at most 10% of
+ * the bound) above it.
+ */
+void HistogramStatisticsImpl::computeBuckets(const histogram_t* histogram_ptr) {
+  const std::vector<double>& supported_buckets = supportedBuckets();
+  std::fill(computed_buckets_.begin(), computed_buckets_.end(), 0);
+  sample_count_ = hist_sample_count(histogram_ptr);
+  sample_sum_ = hist_approx_sum(histogram_ptr);
+
+  const int bin_count = hist_bucket_count(histogram_ptr);
+  for (int i = 0; i < bin_count; ++i) {
+    hist_bucket_t bin;
+    uint64_t count;
+    if (!hist_bucket_idx_bucket(histogram_ptr, i, &bin, &count)) {
+      continue;
+    }
+    const double lower_edge = hist_bucket_to_double(bin);
+    // The bucket bounds are ascending, so all buckets after the first one counting this bin count
+    // it too.
+    const auto first = std::lower_bound(supported_buckets.begin(), supported_buckets.end(),
+                                        lower_edge);
+    for (auto it = first; it != supported_buckets.end(); ++it) {
+      computed_buckets_[it - supported_buckets.begin()] += count;
+    }
+  }
 }
 
 } // namespace Stats
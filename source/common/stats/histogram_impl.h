@@ -20,7 +20,9 @@ namespace Stats {
  */
 class HistogramStatisticsImpl : public HistogramStatistics, NonCopyable {
 public:
-  HistogramStatisticsImpl() : computed_quantiles_(supportedQuantiles().size(), 0.0) {}
+  HistogramStatisticsImpl()
+      : computed_quantiles_(supportedQuantiles().size(), 0.0),
+        computed_buckets_(supportedBuckets().size(), 0) {}
   /**
    * HistogramStatisticsImpl object is constructed using the passed in histogram.
    * @param histogram_ptr pointer to the histogram for which stats will be calculated. This pointer
@@ -34,9 +36,18 @@ public:
   std::string summary() const override;
   const std::vector<double>& supportedQuantiles() const override;
   const std::vector<double>& computedQuantiles() const override { return computed_quantiles_; }
+  const std::vector<double>& supportedBuckets() const override;
+  const std::vector<uint64_t>& computedBuckets() const override { return computed_buckets_; }
+  uint64_t sampleCount() const override { return sample_count_; }
+  double sampleSum() const override { return sample_sum_; }
 
 private:
+  void computeBuckets(const histogram_t* histogram_ptr);
+
   std::vector<double> computed_quantiles_;
+  std::vector<uint64_t> computed_buckets_;
+  uint64_t sample_count_{};
+  double sample_sum_{};
 };
 
 /**
@@ -73,6 +73,10 @@ public:
   std::vector<ParentHistogramSharedPtr> histograms() const override {
     return std::vector<ParentHistogramSharedPtr>{};
   }
+  void latchChanged(std::vector<CounterSharedPtr>& counters,
+                    std::vector<GaugeSharedPtr>& gauges) override {
+    alloc_.latchChanged(counters, gauges);
+  }
 
 private:
   HeapStatDataAllocator alloc_;
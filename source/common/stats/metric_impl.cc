@@ -0,0 +1,45 @@
+#include "common/stats/metric_impl.h"
+
+namespace Envoy {
+namespace Stats {
+
+MetricImpl::MetricImpl(absl::string_view name, std::string&& tag_extracted_name,
+                       std::vector<Tag>&& tags)
+    : name_(symbolTable().encode(name)),
+      tag_extracted_name_(symbolTable().encode(tag_extracted_name)) {
+  std::vector<absl::string_view> tokens;
+  tokens.reserve(2 * tags.size());
+  for (const Tag& tag : tags) {
+    tokens.push_back(tag.name_);
+    tokens.push_back(tag.value_);
+  }
+  tags_ = symbolTable().encodeTokens(tokens);
+}
+
+MetricImpl::~MetricImpl() {
+  symbolTable().free(name_);
+  symbolTable().free(tag_extracted_name_);
+  symbolTable().free(tags_);
+}
+
+std::string MetricImpl::tagExtractedName() const {
+  return symbolTable().decode(tag_extracted_name_);
+}
+
+std::vector<Tag> MetricImpl::tags() const {
+  std::vector<std::string> tokens = symbolTable().decodeTokens(tags_);
+  std::vector<Tag> tags;
+  tags.reserve(tokens.size() / 2);
+  for (size_t i = 0; i + 1 < tokens.size(); i += 2) {
+    tags.push_back({std::move(tokens[i]), std::move(tokens[i + 1])});
+  }
+  return tags;
+}
+
+SymbolTable& MetricImpl::symbolTable() {
+  static SymbolTable* symbol_table = new SymbolTable();
+  return *symbol_table;
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -4,6 +4,11 @@
 #include <vector>
 
 #include "envoy/stats/stats.h"
+#include "envoy/stats/tag.h"
+
+#include "common/stats/symbol_table_impl.h"
+
+#include "absl/strings/string_view.h"
 
 namespace Envoy {
 namespace Stats {
@@ -11,15 +16,24 @@ namespace Stats {
 /**
  * Implementation of the Metric interface. Virtual inheritance is used because the interfaces that
  * will inherit from Metric will have other base classes that will also inherit from Metric.
+ *
+ * The name, the tag extracted name and the tags are kept encoded in symbolTable(), and strings are
+ * only built when they are read.
  */
 class MetricImpl : public virtual Metric {
 public:
-  MetricImpl(const std::string& name, std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : name_(name), tag_extracted_name_(std::move(tag_extracted_name)), tags_(std::move(tags)) {}
+  MetricImpl(absl::string_view name, std::string&& tag_extracted_name, std::vector<Tag>&& tags);
+  ~MetricImpl();
+
+  std::string name() const override { return symbolTable().decode(name_); }
+  std::string tagExtractedName() const override;
+  std::vector<Tag> tags() const override;
 
-  const std::string& name() const override { return name_; }
-  const std::string& tagExtractedName() const override { return tag_extracted_name_; }
-  const std::vector<Tag>& tags() const override { return tags_; }
+  /**
+   * @return SymbolTable& the table in which all metrics encode their names and tags. Metrics may be
+   *         held past the store or allocator that made them, so the table is never destroyed.
+   */
+  static SymbolTable& symbolTable();
 
 protected:
   /**
@@ -30,9 +44,10 @@ protected:
   };
 
 private:
-  const std::string name_;
-  const std::string tag_extracted_name_;
-  const std::vector<Tag> tags_;
+  StatName name_;
+  StatName tag_extracted_name_;
+  // Tag names and values, interleaved.
+  StatName tags_;
 };
 
 } // namespace Stats
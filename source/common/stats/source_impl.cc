@@ -24,10 +24,36 @@ std::vector<ParentHistogramSharedPtr>& SourceImpl::cachedHistograms() {
   return *histograms_;
 }
 
+std::vector<CounterSharedPtr>& SourceImpl::cachedChangedCounters() {
+  if (!changed_counters_) {
+    latchChanged();
+  }
+  return *changed_counters_;
+}
+std::vector<GaugeSharedPtr>& SourceImpl::cachedChangedGauges() {
+  if (!changed_gauges_) {
+    latchChanged();
+  }
+  return *changed_gauges_;
+}
+
+void SourceImpl::latchChanged() {
+  changed_counters_.emplace();
+  changed_gauges_.emplace();
+  store_.latchChanged(*changed_counters_, *changed_gauges_);
+}
+
 void SourceImpl::clearCache() {
   counters_.reset();
   gauges_.reset();
   histograms_.reset();
+  // Latch the changes of this interval even if nobody asked for them, so that the next interval
+  // starts afresh.
+  if (!changed_counters_) {
+    latchChanged();
+  }
+  changed_counters_.reset();
+  changed_gauges_.reset();
 }
 
 } // namespace Stats
@@ -17,13 +17,20 @@ public:
   std::vector<CounterSharedPtr>& cachedCounters() override;
   std::vector<GaugeSharedPtr>& cachedGauges() override;
   std::vector<ParentHistogramSharedPtr>& cachedHistograms() override;
+  std::vector<CounterSharedPtr>& cachedChangedCounters() override;
+  std::vector<GaugeSharedPtr>& cachedChangedGauges() override;
   void clearCache() override;
 
 private:
+  void latchChanged();
+
   Store& store_;
   absl::optional<std::vector<CounterSharedPtr>> counters_;
   absl::optional<std::vector<GaugeSharedPtr>> gauges_;
   absl::optional<std::vector<ParentHistogramSharedPtr>> histograms_;
+  // Counters and gauges are latched together, so both are set or neither is.
+  absl::optional<std::vector<CounterSharedPtr>> changed_counters_;
+  absl::optional<std::vector<GaugeSharedPtr>> changed_gauges_;
 };
 
 } // namespace Stats
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -7,6 +9,9 @@
 #include "envoy/stats/stats.h"
 
 #include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/common/thread_annotations.h"
 #include "common/stats/metric_impl.h"
 
 #include "absl/strings/string_view.h"
@@ -14,6 +19,9 @@
 namespace Envoy {
 namespace Stats {
 
+template <class StatData> class CounterImpl;
+template <class StatData> class GaugeImpl;
+
 // Partially implements a StatDataAllocator, leaving alloc & free for subclasses.
 // We templatize on StatData rather than defining a virtual base StatData class
 // for performance reasons; stat increment is on the hot path.
@@ -34,6 +42,20 @@ public:
                                std::vector<Tag>&& tags) override;
   GaugeSharedPtr makeGauge(absl::string_view name, std::string&& tag_extracted_name,
                            std::vector<Tag>&& tags) override;
+  void latchChanged(std::vector<CounterSharedPtr>& counters,
+                    std::vector<GaugeSharedPtr>& gauges) override;
+
+  /**
+   * Called by a stat when it is first written after a latchChanged().
+   */
+  void addChanged(std::weak_ptr<CounterImpl<StatData>>&& counter) {
+    Thread::LockGuard lock(changed_lock_);
+    changed_counters_.emplace_back(std::move(counter));
+  }
+  void addChanged(std::weak_ptr<GaugeImpl<StatData>>&& gauge) {
+    Thread::LockGuard lock(changed_lock_);
+    changed_gauges_.emplace_back(std::move(gauge));
+  }
 
   /**
    * @param name the full name of the stat.
@@ -50,6 +72,33 @@ public:
    * @param data the data returned by alloc().
    */
   virtual void free(StatData& data) PURE;
+
+private:
+  // The stats written since the last latchChanged(). The stats aren't kept alive for this, so that
+  // the stats of a deleted scope are freed as before.
+  Thread::MutexBasicLockable changed_lock_;
+  std::vector<std::weak_ptr<CounterImpl<StatData>>> changed_counters_ GUARDED_BY(changed_lock_);
+  std::vector<std::weak_ptr<GaugeImpl<StatData>>> changed_gauges_ GUARDED_BY(changed_lock_);
+};
+
+/**
+ * Tracks whether a stat has been written since the last StatDataAllocator::latchChanged(), so that
+ * each stat adds itself to the allocator's list of changed stats once per interval. The flag is
+ * kept per stat object rather than in StatData, which may be shared with another process.
+ */
+class ChangeTracker {
+public:
+  /**
+   * @return bool true if this is the first write since the last clearChanged().
+   */
+  bool markChanged() {
+    // The load keeps the common case of an already changed stat free of a second atomic write.
+    return !changed_.load() && !changed_.exchange(true);
+  }
+  void clearChanged() { changed_ = false; }
+
+private:
+  std::atomic<bool> changed_{};
 };
 
 /**
@@ -59,11 +108,15 @@ public:
  *    std::atomic<int16_t> flags_;
  *    std::atomic<int16_t> ref_count_;
  */
-template <class StatData> class CounterImpl : public Counter, public MetricImpl {
+template <class StatData>
+class CounterImpl : public Counter,
+                    public MetricImpl,
+                    public ChangeTracker,
+                    public std::enable_shared_from_this<CounterImpl<StatData>> {
 public:
-  CounterImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc,
+  CounterImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc, absl::string_view name,
               std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : MetricImpl(data.name_, std::move(tag_extracted_name), std::move(tags)), data_(data),
+      : MetricImpl(name, std::move(tag_extracted_name), std::move(tags)), data_(data),
         alloc_(alloc) {}
   ~CounterImpl() { alloc_.free(data_); }
 
@@ -72,6 +125,9 @@ public:
     data_.value_ += amount;
     data_.pending_increment_ += amount;
     data_.flags_ |= Flags::Used;
+    if (markChanged()) {
+      alloc_.addChanged(std::weak_ptr<CounterImpl<StatData>>(this->shared_from_this()));
+    }
   }
 
   void inc() override { add(1); }
@@ -88,11 +144,15 @@ private:
 /**
  * Gauge implementation that wraps a StatData.
  */
-template <class StatData> class GaugeImpl : public Gauge, public MetricImpl {
+template <class StatData>
+class GaugeImpl : public Gauge,
+                  public MetricImpl,
+                  public ChangeTracker,
+                  public std::enable_shared_from_this<GaugeImpl<StatData>> {
 public:
-  GaugeImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc,
+  GaugeImpl(StatData& data, StatDataAllocatorImpl<StatData>& alloc, absl::string_view name,
             std::string&& tag_extracted_name, std::vector<Tag>&& tags)
-      : MetricImpl(data.name_, std::move(tag_extracted_name), std::move(tags)), data_(data),
+      : MetricImpl(name, std::move(tag_extracted_name), std::move(tags)), data_(data),
         alloc_(alloc) {}
   ~GaugeImpl() { alloc_.free(data_); }
 
@@ -100,26 +160,64 @@ public:
   virtual void add(uint64_t amount) override {
     data_.value_ += amount;
     data_.flags_ |= Flags::Used;
+    onChange();
   }
   virtual void dec() override { sub(1); }
   virtual void inc() override { add(1); }
   virtual void set(uint64_t value) override {
     data_.value_ = value;
     data_.flags_ |= Flags::Used;
+    onChange();
   }
   virtual void sub(uint64_t amount) override {
     ASSERT(data_.value_ >= amount);
     ASSERT(used());
     data_.value_ -= amount;
+    onChange();
   }
   virtual uint64_t value() const override { return data_.value_; }
   bool used() const override { return data_.flags_ & Flags::Used; }
 
 private:
+  void onChange() {
+    if (markChanged()) {
+      alloc_.addChanged(std::weak_ptr<GaugeImpl<StatData>>(this->shared_from_this()));
+    }
+  }
+
   StatData& data_;
   StatDataAllocatorImpl<StatData>& alloc_;
 };
 
+template <class StatData>
+void StatDataAllocatorImpl<StatData>::latchChanged(std::vector<CounterSharedPtr>& counters,
+                                                   std::vector<GaugeSharedPtr>& gauges) {
+  std::vector<std::weak_ptr<CounterImpl<StatData>>> changed_counters;
+  std::vector<std::weak_ptr<GaugeImpl<StatData>>> changed_gauges;
+  {
+    Thread::LockGuard lock(changed_lock_);
+    changed_counters.swap(changed_counters_);
+    changed_gauges.swap(changed_gauges_);
+  }
+
+  // The flag of each stat is cleared before its value is read by the caller, so a write that
+  // races with this is either seen by the caller or adds the stat to the next interval.
+  for (const auto& weak_counter : changed_counters) {
+    std::shared_ptr<CounterImpl<StatData>> counter = weak_counter.lock();
+    if (counter != nullptr) {
+      counter->clearChanged();
+      counters.emplace_back(std::move(counter));
+    }
+  }
+  for (const auto& weak_gauge : changed_gauges) {
+    std::shared_ptr<GaugeImpl<StatData>> gauge = weak_gauge.lock();
+    if (gauge != nullptr) {
+      gauge->clearChanged();
+      gauges.emplace_back(std::move(gauge));
+    }
+  }
+}
+
 template <class StatData>
 CounterSharedPtr StatDataAllocatorImpl<StatData>::makeCounter(absl::string_view name,
                                                               std::string&& tag_extracted_name,
@@ -128,8 +226,8 @@ CounterSharedPtr StatDataAllocatorImpl<StatData>::makeCounter(absl::string_view
   if (data == nullptr) {
     return nullptr;
   }
-  return std::make_shared<CounterImpl<StatData>>(*data, *this, std::move(tag_extracted_name),
-                                                 std::move(tags));
+  return std::make_shared<CounterImpl<StatData>>(*data, *this, name,
+                                                 std::move(tag_extracted_name), std::move(tags));
 }
 
 template <class StatData>
@@ -140,7 +238,7 @@ GaugeSharedPtr StatDataAllocatorImpl<StatData>::makeGauge(absl::string_view name
   if (data == nullptr) {
     return nullptr;
   }
-  return std::make_shared<GaugeImpl<StatData>>(*data, *this, std::move(tag_extracted_name),
+  return std::make_shared<GaugeImpl<StatData>>(*data, *this, name, std::move(tag_extracted_name),
                                                std::move(tags));
 }
 
@@ -0,0 +1,168 @@
+#include "common/stats/symbol_table_impl.h"
+
+#include "common/common/assert.h"
+
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Stats {
+
+namespace {
+
+// Symbols and lengths are stored as variable length integers: 7 bits per byte, least significant
+// group first, with the high bit set on every byte but the last.
+void appendVarint(uint64_t value, std::vector<uint8_t>& out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t readVarint(const uint8_t*& data) {
+  uint64_t value = 0;
+  for (uint32_t shift = 0;; shift += 7) {
+    const uint8_t byte = *data++;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+}
+
+} // namespace
+
+absl::string_view StatName::bytes() const {
+  if (storage_ == nullptr) {
+    return absl::string_view();
+  }
+  const uint8_t* data = storage_.get();
+  const uint64_t size = readVarint(data);
+  return absl::string_view(reinterpret_cast<const char*>(data), size);
+}
+
+SymbolTable::~SymbolTable() {
+  // Every name must have been freed before the table is destroyed.
+  ASSERT(encode_map_.empty());
+}
+
+StatName SymbolTable::encode(absl::string_view name) {
+  std::vector<absl::string_view> tokens = absl::StrSplit(name, '.');
+  return encodeTokens(tokens);
+}
+
+StatName SymbolTable::encodeTokens(const std::vector<absl::string_view>& tokens) {
+  std::vector<Symbol> symbols;
+  symbols.reserve(tokens.size());
+  {
+    absl::MutexLock lock(&lock_);
+    for (const absl::string_view token : tokens) {
+      symbols.push_back(toSymbol(token));
+    }
+  }
+  return encodeSymbols(symbols);
+}
+
+bool SymbolTable::encodeExisting(absl::string_view name, std::string& bytes) const {
+  std::vector<uint8_t> encoded;
+  {
+    absl::ReaderMutexLock lock(&lock_);
+    for (const absl::string_view token : absl::StrSplit(name, '.')) {
+      auto encode_it = encode_map_.find(token);
+      if (encode_it == encode_map_.end()) {
+        return false;
+      }
+      appendVarint(encode_it->second.symbol_, encoded);
+    }
+  }
+  bytes.assign(encoded.begin(), encoded.end());
+  return true;
+}
+
+std::string SymbolTable::decode(const StatName& stat_name) const {
+  return absl::StrJoin(decodeTokens(stat_name), ".");
+}
+
+std::vector<std::string> SymbolTable::decodeTokens(const StatName& stat_name) const {
+  const std::vector<Symbol> symbols = decodeSymbols(stat_name);
+  std::vector<std::string> tokens;
+  tokens.reserve(symbols.size());
+  absl::ReaderMutexLock lock(&lock_);
+  for (const Symbol symbol : symbols) {
+    ASSERT(symbol < decode_map_.size() && decode_map_[symbol] != nullptr);
+    tokens.push_back(*decode_map_[symbol]);
+  }
+  return tokens;
+}
+
+void SymbolTable::free(StatName& stat_name) {
+  const std::vector<Symbol> symbols = decodeSymbols(stat_name);
+  stat_name.storage_.reset();
+
+  absl::MutexLock lock(&lock_);
+  for (const Symbol symbol : symbols) {
+    ASSERT(symbol < decode_map_.size() && decode_map_[symbol] != nullptr);
+    auto encode_it = encode_map_.find(*decode_map_[symbol]);
+    ASSERT(encode_it != encode_map_.end());
+    if (--encode_it->second.ref_count_ == 0) {
+      encode_map_.erase(encode_it);
+      decode_map_[symbol].reset();
+      free_symbols_.push_back(symbol);
+    }
+  }
+}
+
+uint64_t SymbolTable::numSymbols() const {
+  absl::ReaderMutexLock lock(&lock_);
+  return encode_map_.size();
+}
+
+SymbolTable::Symbol SymbolTable::toSymbol(absl::string_view token) {
+  auto encode_it = encode_map_.find(token);
+  if (encode_it != encode_map_.end()) {
+    ++encode_it->second.ref_count_;
+    return encode_it->second.symbol_;
+  }
+
+  // Reuse the most recently freed symbol if there is one, to keep symbols small.
+  Symbol symbol;
+  if (free_symbols_.empty()) {
+    symbol = decode_map_.size();
+    decode_map_.emplace_back();
+  } else {
+    symbol = free_symbols_.back();
+    free_symbols_.pop_back();
+  }
+  decode_map_[symbol] = std::make_unique<const std::string>(token);
+  encode_map_.emplace(*decode_map_[symbol], SharedSymbol{symbol, 1});
+  return symbol;
+}
+
+StatName SymbolTable::encodeSymbols(const std::vector<Symbol>& symbols) {
+  std::vector<uint8_t> encoded;
+  for (const Symbol symbol : symbols) {
+    appendVarint(symbol, encoded);
+  }
+  std::vector<uint8_t> size;
+  appendVarint(encoded.size(), size);
+
+  std::unique_ptr<uint8_t[]> storage(new uint8_t[size.size() + encoded.size()]);
+  std::copy(size.begin(), size.end(), storage.get());
+  std::copy(encoded.begin(), encoded.end(), storage.get() + size.size());
+  return StatName(std::move(storage));
+}
+
+std::vector<SymbolTable::Symbol> SymbolTable::decodeSymbols(const StatName& stat_name) const {
+  std::vector<Symbol> symbols;
+  const absl::string_view bytes = stat_name.bytes();
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes.data());
+  const uint8_t* end = data + bytes.size();
+  while (data < end) {
+    symbols.push_back(readVarint(data));
+  }
+  return symbols;
+}
+
+} // namespace Stats
+} // namespace Envoy
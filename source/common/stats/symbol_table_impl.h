@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common/hash.h"
+#include "common/common/thread_annotations.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Stats {
+
+/**
+ * A sequence of tokens encoded as symbols by a SymbolTable. Each symbol is stored as a variable
+ * length integer, so as long as the table holds fewer than 128 distinct tokens each one takes a
+ * single byte. Two StatNames from the same table are equal if and only if their tokens are.
+ *
+ * A StatName holds a reference on each of its symbols, which it doesn't release itself since it
+ * doesn't know its table: the owner must pass it to SymbolTable::free() before destroying it.
+ */
+class StatName {
+public:
+  StatName() {}
+
+  /**
+   * @return the encoded symbols, suitable for hashing and comparison.
+   */
+  absl::string_view bytes() const;
+
+  /**
+   * @return whether this holds an encoding, i.e. it hasn't been default constructed or freed.
+   */
+  bool empty() const { return storage_ == nullptr; }
+
+  uint64_t hash() const { return HashUtil::xxHash64(bytes()); }
+  bool operator==(const StatName& rhs) const { return bytes() == rhs.bytes(); }
+
+private:
+  friend class SymbolTable;
+
+  explicit StatName(std::unique_ptr<uint8_t[]>&& storage) : storage_(std::move(storage)) {}
+
+  // The length of the encoded symbols as a variable length integer, followed by the symbols.
+  std::unique_ptr<uint8_t[]> storage_;
+};
+
+/**
+ * Interns the tokens of stat names, e.g. "cluster", "foo" and "upstream_rq_200" for
+ * "cluster.foo.upstream_rq_200", and hands out names encoded as sequences of small integer symbols.
+ * With thousands of clusters each having dozens of stats, the same handful of tokens makes up most
+ * stat names, so storing each token once cuts the memory used by names severalfold.
+ *
+ * Symbols are reference counted, and a token is removed from the table once the last name using
+ * it is freed. Symbols are recycled so they stay small. The table is thread safe. Encoding and
+ * freeing take its lock exclusively, so names should be encoded when a stat is created. Decoding
+ * only takes it shared, so sinks on several threads can read names out concurrently.
+ */
+class SymbolTable {
+public:
+  typedef uint32_t Symbol;
+
+  SymbolTable() {}
+  ~SymbolTable();
+
+  /**
+   * Encode a dot-separated name. Empty tokens are preserved, so decode() returns exactly the
+   * original name.
+   * @param name supplies the name to encode.
+   * @return StatName the encoded name, which must be released with free().
+   */
+  StatName encode(absl::string_view name);
+
+  /**
+   * Encode a sequence of tokens. Tokens are not split on dots, so e.g. each tag name and value
+   * becomes a single symbol.
+   * @param tokens supplies the tokens to encode.
+   * @return StatName the encoded tokens, which must be released with free().
+   */
+  StatName encodeTokens(const std::vector<absl::string_view>& tokens);
+
+  /**
+   * Compute the bytes encode() would return for a name, without interning its tokens or taking
+   * references on them. This lets callers look up names they have already encoded without
+   * writing to the table.
+   * @param name supplies the dot-separated name.
+   * @param bytes is set to the encoded symbols if the function returns true.
+   * @return bool false if a token of the name isn't in the table, in which case no name
+   *         encoded by this table is equal to it.
+   */
+  bool encodeExisting(absl::string_view name, std::string& bytes) const;
+
+  /**
+   * @param stat_name supplies a name returned by encode().
+   * @return std::string the name with its tokens joined by dots.
+   */
+  std::string decode(const StatName& stat_name) const;
+
+  /**
+   * @param stat_name supplies a name returned by encodeTokens().
+   * @return std::vector<std::string> the tokens.
+   */
+  std::vector<std::string> decodeTokens(const StatName& stat_name) const;
+
+  /**
+   * Release the references held by a name, removing any tokens no longer used by other names. The
+   * name is left empty. Freeing an empty name is a no-op.
+   * @param stat_name supplies a name returned by this table.
+   */
+  void free(StatName& stat_name);
+
+  /**
+   * @return uint64_t the number of distinct tokens in the table.
+   */
+  uint64_t numSymbols() const;
+
+private:
+  struct SharedSymbol {
+    Symbol symbol_;
+    uint32_t ref_count_;
+  };
+
+  struct StringViewHash {
+    size_t operator()(absl::string_view key) const { return HashUtil::xxHash64(key); }
+  };
+
+  Symbol toSymbol(absl::string_view token) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  StatName encodeSymbols(const std::vector<Symbol>& symbols);
+  std::vector<Symbol> decodeSymbols(const StatName& stat_name) const;
+
+  mutable absl::Mutex lock_;
+  // Keys refer to the strings owned by decode_map_.
+  std::unordered_map<absl::string_view, SharedSymbol, StringViewHash> encode_map_ GUARDED_BY(lock_);
+  // Indexed by symbol. Entries for symbols that are free to be reused are null.
+  std::vector<std::unique_ptr<const std::string>> decode_map_ GUARDED_BY(lock_);
+  std::vector<Symbol> free_symbols_ GUARDED_BY(lock_);
+};
+
+} // namespace Stats
+} // namespace Envoy
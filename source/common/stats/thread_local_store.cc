@@ -39,6 +39,7 @@ std::vector<CounterSharedPtr> ThreadLocalStoreImpl::counters() const {
   std::unordered_set<std::string> names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
+    Thread::LockGuard scope_lock(scope->central_cache_lock_);
     for (auto& counter : scope->central_cache_.counters_) {
       if (names.insert(counter.first).second) {
         ret.push_back(counter.second);
@@ -62,6 +63,7 @@ std::vector<GaugeSharedPtr> ThreadLocalStoreImpl::gauges() const {
   std::unordered_set<std::string> names;
   Thread::LockGuard lock(lock_);
   for (ScopeImpl* scope : scopes_) {
+    Thread::LockGuard scope_lock(scope->central_cache_lock_);
     for (auto& gauge : scope->central_cache_.gauges_) {
       if (names.insert(gauge.first).second) {
         ret.push_back(gauge.second);
@@ -81,6 +83,7 @@ std::vector<ParentHistogramSharedPtr> ThreadLocalStoreImpl::histograms() const {
   // in histograms with duplicate names, but until shared storage is implemented it's ultimately
   // less confusing for users who have such configs.
   for (ScopeImpl* scope : scopes_) {
+    Thread::LockGuard scope_lock(scope->central_cache_lock_);
     for (const auto& name_histogram_pair : scope->central_cache_.histograms_) {
       const ParentHistogramSharedPtr& parent_hist = name_histogram_pair.second;
       ret.push_back(parent_hist);
@@ -90,6 +93,28 @@ std::vector<ParentHistogramSharedPtr> ThreadLocalStoreImpl::histograms() const {
   return ret;
 }
 
+void ThreadLocalStoreImpl::latchChanged(std::vector<CounterSharedPtr>& counters,
+                                        std::vector<GaugeSharedPtr>& gauges) {
+  std::vector<CounterSharedPtr> changed_counters;
+  std::vector<GaugeSharedPtr> changed_gauges;
+  alloc_.latchChanged(changed_counters, changed_gauges);
+  heap_allocator_.latchChanged(changed_counters, changed_gauges);
+
+  // Handle de-dup due to overlapping scopes, which make a stat object per scope.
+  std::unordered_set<std::string> names;
+  for (CounterSharedPtr& counter : changed_counters) {
+    if (names.insert(counter->name()).second) {
+      counters.emplace_back(std::move(counter));
+    }
+  }
+  names.clear();
+  for (GaugeSharedPtr& gauge : changed_gauges) {
+    if (names.insert(gauge->name()).second) {
+      gauges.emplace_back(std::move(gauge));
+    }
+  }
+}
+
 void ThreadLocalStoreImpl::initializeThreading(Event::Dispatcher& main_thread_dispatcher,
                                                ThreadLocal::Instance& tls) {
   main_thread_dispatcher_ = &main_thread_dispatcher;
@@ -198,10 +223,17 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
     return **tls_ref;
   }
 
-  // We must now look in the central store so we must be locked. We grab a reference to the
-  // central store location. It might contain nothing. In this case, we allocate a new stat.
-  Thread::LockGuard lock(parent_.lock_);
-  std::shared_ptr<StatType>& central_ref = central_cache_map[name];
+  // We must now look in the central store so we must be locked. It might not contain the stat. In
+  // this case, we allocate a new stat.
+  std::shared_ptr<StatType> central_ref;
+  {
+    Thread::LockGuard lock(central_cache_lock_);
+    auto iter = central_cache_map.find(name);
+    if (iter != central_cache_map.end()) {
+      central_ref = iter->second;
+    }
+  }
+
   if (!central_ref) {
     std::vector<Tag> tags;
 
@@ -217,7 +249,11 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
                        std::move(tags));
       ASSERT(stat != nullptr);
     }
-    central_ref = stat;
+
+    // Another thread may have created the same stat while we weren't holding the lock, in which
+    // case we use theirs and drop ours.
+    Thread::LockGuard lock(central_cache_lock_);
+    central_ref = central_cache_map.emplace(name, std::move(stat)).first->second;
   }
 
   // If we have a TLS location to store or allocation into, do it.
@@ -225,7 +261,8 @@ StatType& ThreadLocalStoreImpl::ScopeImpl::safeMakeStat(
     *tls_ref = central_ref;
   }
 
-  // Finally we return the reference.
+  // Finally we return the reference. The central cache keeps the stat alive for the lifetime of
+  // the scope.
   return *central_ref;
 }
 
@@ -301,13 +338,23 @@ Histogram& ThreadLocalStoreImpl::ScopeImpl::histogram(const std::string& name) {
     return **tls_ref;
   }
 
-  Thread::LockGuard lock(parent_.lock_);
-  ParentHistogramImplSharedPtr& central_ref = central_cache_.histograms_[final_name];
+  ParentHistogramImplSharedPtr central_ref;
+  {
+    Thread::LockGuard lock(central_cache_lock_);
+    auto iter = central_cache_.histograms_.find(final_name);
+    if (iter != central_cache_.histograms_.end()) {
+      central_ref = iter->second;
+    }
+  }
+
   if (!central_ref) {
     std::vector<Tag> tags;
     std::string tag_extracted_name = parent_.getTagsForName(final_name, tags);
-    central_ref.reset(new ParentHistogramImpl(final_name, parent_, *this,
-                                              std::move(tag_extracted_name), std::move(tags)));
+    ParentHistogramImplSharedPtr stat(new ParentHistogramImpl(
+        final_name, parent_, *this, std::move(tag_extracted_name), std::move(tags)));
+
+    Thread::LockGuard lock(central_cache_lock_);
+    central_ref = central_cache_.histograms_.emplace(final_name, std::move(stat)).first->second;
   }
 
   if (tls_ref) {
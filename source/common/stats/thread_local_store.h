@@ -133,6 +133,11 @@ public:
  * - Scopes can be deleted from any thread, and they are in practice as scopes are likely to be
  *   shared across all worker threads.
  * - Per thread caches are checked, and if empty, they are populated from the central cache.
+ * - Each scope's central cache has its own lock, which is only held to look up and insert entries.
+ *   Stats are created (tag extraction and allocation) outside of the lock, so creating stats in
+ *   different scopes, or different stats in the same scope, doesn't serialize across threads. If
+ *   two threads race to create the same stat, the first one inserted wins and the other is
+ *   discarded; the allocators de-dup by name so both refer to the same backing data.
  * - Scopes are entirely owned by the caller. The store only keeps weak pointers.
  * - When a scope is destroyed, a cache flush operation is run on all threads to flush any cached
  *   data owned by the destroyed scope.
@@ -141,6 +146,9 @@ public:
  *   reference the old scope which may be about to be cache flushed.
  * - Since it's possible to have overlapping scopes, we de-dup stats when counters() or gauges() is
  *   called since these are very uncommon operations.
+ * - Counters and gauges add themselves to their allocator's list of changed stats when they are
+ *   first written after a latchChanged(), so latchChanged() only walks the stats that changed. It
+ *   de-dups the changed stats by name like counters() and gauges().
  * - Though this implementation is designed to work with a fixed shared memory space, it will fall
  *   back to heap allocated stats if needed. NOTE: In this case, overlapping scopes will not share
  *   the same backing store. This is to keep things simple, it could be done in the future if
@@ -186,6 +194,8 @@ public:
   std::vector<CounterSharedPtr> counters() const override;
   std::vector<GaugeSharedPtr> gauges() const override;
   std::vector<ParentHistogramSharedPtr> histograms() const override;
+  void latchChanged(std::vector<CounterSharedPtr>& counters,
+                    std::vector<GaugeSharedPtr>& gauges) override;
 
   // Stats::StoreRoot
   void addSink(Sink& sink) override { timer_sinks_.push_back(sink); }
@@ -242,7 +252,8 @@ private:
     /**
      * Makes a stat either by looking it up in the central cache,
      * generating it from the the parent allocator, or as a last
-     * result, creating it with the heap allocator.
+     * result, creating it with the heap allocator. Must be called without
+     * central_cache_lock_ held.
      *
      * @param name the full name of the stat (not tag extracted).
      * @param central_cache_map a map from name to the desired object in the central cache.
@@ -261,7 +272,8 @@ private:
     const uint64_t scope_id_;
     ThreadLocalStoreImpl& parent_;
     const std::string prefix_;
-    CentralCacheEntry central_cache_;
+    mutable Thread::MutexBasicLockable central_cache_lock_;
+    CentralCacheEntry central_cache_ GUARDED_BY(central_cache_lock_);
   };
 
   struct TlsCache : public ThreadLocal::ThreadLocalObject {
@@ -285,6 +297,8 @@ private:
   StatDataAllocator& alloc_;
   Event::Dispatcher* main_thread_dispatcher_{};
   ThreadLocal::SlotPtr tls_;
+  // Protects the set of scopes. Lock ordering: lock_ may be held while acquiring a scope's
+  // central_cache_lock_, but not the other way around.
   mutable Thread::MutexBasicLockable lock_;
   std::unordered_set<ScopeImpl*> scopes_ GUARDED_BY(lock_);
   ScopePtr default_scope_;
@@ -1,5 +1,7 @@
 #include "common/tcp/conn_pool.h"
 
+#include <cmath>
+
 #include "envoy/event/dispatcher.h"
 #include "envoy/event/timer.h"
 #include "envoy/upstream/upstream.h"
@@ -38,6 +40,23 @@ void ConnPoolImpl::drainConnections() {
   }
 }
 
+void ConnPoolImpl::prefetch() {
+  const float ratio = host_->cluster().perUpstreamPrefetchRatio();
+  if (ratio <= 1.0 || !drained_callbacks_.empty()) {
+    return;
+  }
+
+  // Keep enough connections for the ratio times the current demand plus the next request, so that
+  // even an idle pool has a connection ready.
+  const uint64_t demand = active_requests_ + pending_requests_.size() + 1;
+  const uint64_t target = static_cast<uint64_t>(std::ceil(ratio * demand)) - 1;
+  while (ready_conns_.size() + busy_conns_.size() < target &&
+         host_->cluster().resourceManager(priority_).connections().canCreate()) {
+    host_->cluster().stats().upstream_cx_prefetch_.inc();
+    createNewConnection();
+  }
+}
+
 void ConnPoolImpl::addDrainedCallback(DrainedCb cb) {
   drained_callbacks_.push_back(cb);
   checkForDrained();
@@ -72,6 +91,7 @@ ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbac
     ready_conns_.front()->moveBetweenLists(ready_conns_, busy_conns_);
     ENVOY_CONN_LOG(debug, "using existing connection", *busy_conns_.front()->conn_);
     assignConnection(*busy_conns_.front(), callbacks);
+    prefetch();
     return nullptr;
   }
 
@@ -90,6 +110,7 @@ ConnectionPool::Cancellable* ConnPoolImpl::newConnection(ConnectionPool::Callbac
     ENVOY_LOG(debug, "queueing request due to no available connections");
     PendingRequestPtr pending_request(new PendingRequest(*this, callbacks));
     pending_request->moveIntoList(std::move(pending_request), pending_requests_);
+    prefetch();
     return pending_requests_.front().get();
   } else {
     ENVOY_LOG(debug, "max pending requests overflow");
@@ -183,7 +204,7 @@ void ConnPoolImpl::onConnectionEvent(ActiveConn& conn, Network::ConnectionEvent
   // drain/destruction event, we key off of the existence of the connect timer above to determine
   // whether the connection is in the ready list (connected) or the busy list (failed to connect).
   if (event == Network::ConnectionEvent::Connected) {
-    conn_connect_ms_->complete();
+    conn.conn_connect_ms_->complete();
     processIdleConnection(conn, false);
   }
 }
@@ -256,11 +277,13 @@ ConnPoolImpl::ConnectionWrapper::ConnectionWrapper(ActiveConn& parent) : parent_
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.inc();
   parent_.parent_.host_->stats().rq_total_.inc();
   parent_.parent_.host_->stats().rq_active_.inc();
+  parent_.parent_.active_requests_++;
 }
 
 ConnPoolImpl::ConnectionWrapper::~ConnectionWrapper() {
   parent_.parent_.host_->cluster().stats().upstream_rq_active_.dec();
   parent_.parent_.host_->stats().rq_active_.dec();
+  parent_.parent_.active_requests_--;
 }
 
 Network::ClientConnection& ConnPoolImpl::ConnectionWrapper::connection() { return *parent_.conn_; }
@@ -295,7 +318,7 @@ ConnPoolImpl::ActiveConn::ActiveConn(ConnPoolImpl& parent)
       connect_timer_(parent_.dispatcher_.createTimer([this]() -> void { onConnectTimeout(); })),
       remaining_requests_(parent_.host_->cluster().maxRequestsPerConnection()), timed_out_(false) {
 
-  parent_.conn_connect_ms_.reset(
+  conn_connect_ms_.reset(
       new Stats::Timespan(parent_.host_->cluster().stats().upstream_cx_connect_ms_));
 
   Upstream::Host::CreateConnectionData data =
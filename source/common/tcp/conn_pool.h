@@ -29,6 +29,7 @@ public:
   // ConnectionPool::Instance
   void addDrainedCallback(DrainedCb cb) override;
   void drainConnections() override;
+  void prefetch() override;
   ConnectionPool::Cancellable* newConnection(ConnectionPool::Callbacks& callbacks) override;
 
 protected:
@@ -81,6 +82,7 @@ protected:
     ConnectionWrapperPtr wrapper_;
     Network::ClientConnectionPtr conn_;
     Event::TimerPtr connect_timer_;
+    Stats::TimespanPtr conn_connect_ms_;
     Stats::TimespanPtr conn_length_;
     uint64_t remaining_requests_;
     bool timed_out_;
@@ -117,10 +119,11 @@ protected:
   const Network::ConnectionSocket::OptionsSharedPtr socket_options_;
 
   std::list<ActiveConnPtr> ready_conns_;
+  // Connections that are assigned, as well as connections that are still connecting.
   std::list<ActiveConnPtr> busy_conns_;
   std::list<PendingRequestPtr> pending_requests_;
   std::list<DrainedCb> drained_callbacks_;
-  Stats::TimespanPtr conn_connect_ms_;
+  uint64_t active_requests_{};
   Event::TimerPtr upstream_ready_timer_;
   bool upstream_ready_enabled_{false};
 };
@@ -925,6 +925,41 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::drainTcpConnPools(
   }
 }
 
+Http::ConnectionPool::InstancePtr
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::allocateSharedConnPool(
+    const HostConstSharedPtr& host, ResourcePriority priority, Http::Protocol protocol,
+    const std::vector<uint8_t>& hash_key,
+    const Network::ConnectionSocket::OptionsSharedPtr& options) {
+  Thread::LockGuard lock(parent_.shared_conn_pools_lock_);
+  const SharedConnPoolKey key{host, hash_key};
+  ClusterManagerImpl& cm = parent_;
+  auto it = parent_.shared_conn_pools_.find(key);
+  if (it != parent_.shared_conn_pools_.end()) {
+    // Once the owner's pool drains, streams use a pool of this worker's own until the host's
+    // pools drain on this worker as well.
+    Event::Dispatcher& dispatcher = thread_local_dispatcher_;
+    return std::make_unique<Http::Http2::ForwardingConnPoolImpl>(
+        thread_local_dispatcher_, host, protocol, it->second,
+        [&cm, &dispatcher, host, priority, protocol,
+         options]() -> Http::ConnectionPool::InstancePtr {
+          return cm.factory_.allocateConnPool(dispatcher, host, priority, protocol, options);
+        });
+  }
+
+  // This worker becomes the owner. The pool unregisters itself once it starts draining or is
+  // destroyed, after which the next worker that needs a pool for the host becomes the owner.
+  ENVOY_LOG(debug, "creating shared connection pool for {}", host->address()->asString());
+  auto pool = std::make_unique<Http::Http2::OwnerConnPoolImpl>(
+      thread_local_dispatcher_,
+      cm.factory_.allocateConnPool(thread_local_dispatcher_, host, priority, protocol, options),
+      [&cm, key]() -> void {
+        Thread::LockGuard lock(cm.shared_conn_pools_lock_);
+        cm.shared_conn_pools_.erase(key);
+      });
+  parent_.shared_conn_pools_.emplace(key, pool->shared());
+  return pool;
+}
+
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::removeTcpConn(
     const HostConstSharedPtr& host, Network::ClientConnection& connection) {
   auto host_tcp_conn_map_it = host_tcp_conn_map_.find(host);
@@ -961,6 +996,14 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
     ENVOY_LOG(debug, "re-creating local LB for TLS cluster {}", name);
     cluster_entry->lb_ = cluster_entry->lb_factory_->create();
   }
+
+  if (cluster_entry->cluster_info_->perUpstreamPrefetchRatio() > 1.0) {
+    for (const HostSharedPtr& host : hosts_added) {
+      if (host->healthy()) {
+        cluster_entry->prefetchHost(host);
+      }
+    }
+  }
 }
 
 void ClusterManagerImpl::ThreadLocalClusterManagerImpl::onHostHealthFailure(
@@ -1119,16 +1162,34 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     }
   }
 
+  if (!have_options) {
+    http_pool_kinds_.emplace(protocol, priority);
+  }
+
   ConnPoolsContainer& container = parent_.host_http_conn_pool_map_[host];
   if (!container.pools_[hash_key]) {
-    container.pools_[hash_key] = parent_.parent_.factory_.allocateConnPool(
-        parent_.thread_local_dispatcher_, host, priority, protocol,
-        have_options ? context->downstreamConnection()->socketOptions() : nullptr);
+    container.pools_[hash_key] =
+        allocateConnPool(host, priority, protocol, hash_key,
+                         have_options ? context->downstreamConnection()->socketOptions() : nullptr);
   }
 
   return container.pools_[hash_key].get();
 }
 
+Http::ConnectionPool::InstancePtr
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::allocateConnPool(
+    const HostConstSharedPtr& host, ResourcePriority priority, Http::Protocol protocol,
+    const std::vector<uint8_t>& hash_key,
+    const Network::ConnectionSocket::OptionsSharedPtr& options) {
+  if (protocol == Http::Protocol::Http2 &&
+      (cluster_info_->features() & ClusterInfo::Features::SHARE_HTTP2_CONNECTION_POOLS)) {
+    return parent_.allocateSharedConnPool(host, priority, protocol, hash_key, options);
+  }
+
+  return parent_.parent_.factory_.allocateConnPool(parent_.thread_local_dispatcher_, host,
+                                                   priority, protocol, options);
+}
+
 Tcp::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPool(
     ResourcePriority priority, LoadBalancerContext* context) {
@@ -1157,6 +1218,10 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPool(
     }
   }
 
+  if (!have_options) {
+    tcp_pool_kinds_.insert(priority);
+  }
+
   TcpConnPoolsContainer& container = parent_.host_tcp_conn_pool_map_[host];
   if (!container.pools_[hash_key]) {
     container.pools_[hash_key] = parent_.parent_.factory_.allocateTcpConnPool(
@@ -1167,6 +1232,35 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::tcpConnPool(
   return container.pools_[hash_key].get();
 }
 
+void ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::prefetchHost(
+    const HostConstSharedPtr& host) {
+  // The pools are keyed the same way as in connPool() and tcpConnPool() for requests that carry no
+  // socket options, so that those requests pick up the prefetched connections.
+  if (!http_pool_kinds_.empty()) {
+    ConnPoolsContainer& container = parent_.host_http_conn_pool_map_[host];
+    for (const auto& kind : http_pool_kinds_) {
+      const std::vector<uint8_t> hash_key = {uint8_t(kind.first), uint8_t(kind.second)};
+      Http::ConnectionPool::InstancePtr& pool = container.pools_[hash_key];
+      if (!pool) {
+        pool = allocateConnPool(host, kind.second, kind.first, hash_key, nullptr);
+      }
+      pool->prefetch();
+    }
+  }
+
+  if (!tcp_pool_kinds_.empty()) {
+    TcpConnPoolsContainer& container = parent_.host_tcp_conn_pool_map_[host];
+    for (const ResourcePriority priority : tcp_pool_kinds_) {
+      Tcp::ConnectionPool::InstancePtr& pool = container.pools_[{uint8_t(priority)}];
+      if (!pool) {
+        pool = parent_.parent_.factory_.allocateTcpConnPool(parent_.thread_local_dispatcher_, host,
+                                                            priority, nullptr);
+      }
+      pool->prefetch();
+    }
+  }
+}
+
 ClusterManagerPtr ProdClusterManagerFactory::clusterManagerFromProto(
     const envoy::config::bootstrap::v2::Bootstrap& bootstrap, Stats::Store& stats,
     ThreadLocal::Instance& tls, Runtime::Loader& runtime, Runtime::RandomGenerator& random,
@@ -6,11 +6,14 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "envoy/config/bootstrap/v2/bootstrap.pb.h"
 #include "envoy/http/codes.h"
+#include "envoy/http/conn_pool.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/secret/secret_manager.h"
@@ -19,8 +22,10 @@
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
+#include "common/common/thread.h"
 #include "common/config/grpc_mux_impl.h"
 #include "common/http/async_client_impl.h"
+#include "common/http/http2/shared_conn_pool.h"
 #include "common/upstream/load_stats_reporter.h"
 #include "common/upstream/upstream_impl.h"
 
@@ -275,9 +280,21 @@ private:
       Http::ConnectionPool::Instance* connPool(ResourcePriority priority, Http::Protocol protocol,
                                                LoadBalancerContext* context);
 
+      Http::ConnectionPool::InstancePtr
+      allocateConnPool(const HostConstSharedPtr& host, ResourcePriority priority,
+                       Http::Protocol protocol, const std::vector<uint8_t>& hash_key,
+                       const Network::ConnectionSocket::OptionsSharedPtr& options);
+
       Tcp::ConnectionPool::Instance* tcpConnPool(ResourcePriority priority,
                                                  LoadBalancerContext* context);
 
+      /**
+       * Create the pools this cluster has used so far on a newly added host and prefetch
+       * connections on them, so that the first requests sent to the host don't pay for the
+       * connection handshake.
+       */
+      void prefetchHost(const HostConstSharedPtr& host);
+
       // Upstream::ThreadLocalCluster
       const PrioritySet& prioritySet() override { return priority_set_; }
       ClusterInfoConstSharedPtr info() override { return cluster_info_; }
@@ -293,6 +310,10 @@ private:
       LoadBalancerPtr lb_;
       ClusterInfoConstSharedPtr cluster_info_;
       Http::AsyncClientImpl http_async_client_;
+      // The kinds of pools that have been created without downstream socket options, which are
+      // the ones prefetchHost() warms up.
+      std::set<std::pair<Http::Protocol, ResourcePriority>> http_pool_kinds_;
+      std::set<ResourcePriority> tcp_pool_kinds_;
     };
 
     typedef std::unique_ptr<ClusterEntry> ClusterEntryPtr;
@@ -303,6 +324,16 @@ private:
     void drainConnPools(const HostVector& hosts);
     void drainConnPools(HostSharedPtr old_host, ConnPoolsContainer& container);
     void drainTcpConnPools(HostSharedPtr old_host, TcpConnPoolsContainer& container);
+    /**
+     * Look up the pool shared by all workers for the host and hash key, or create it with this
+     * worker as the owner if there is none yet.
+     * @return the owner's pool on the owning worker, and a pool that forwards streams to the
+     *         owner on any other worker.
+     */
+    Http::ConnectionPool::InstancePtr
+    allocateSharedConnPool(const HostConstSharedPtr& host, ResourcePriority priority,
+                           Http::Protocol protocol, const std::vector<uint8_t>& hash_key,
+                           const Network::ConnectionSocket::OptionsSharedPtr& options);
     void removeTcpConn(const HostConstSharedPtr& host, Network::ClientConnection& connection);
     static void updateClusterMembership(const std::string& name, uint32_t priority,
                                         HostVectorConstSharedPtr hosts,
@@ -418,6 +449,12 @@ private:
   ClusterManagerFactory& factory_;
   Runtime::Loader& runtime_;
   Stats::Store& stats_;
+  // HTTP/2 pools shared across workers, keyed by host and pool hash key. Declared before tls_ so
+  // that it outlives the thread local pools, which unregister themselves on destruction.
+  typedef std::pair<HostConstSharedPtr, std::vector<uint8_t>> SharedConnPoolKey;
+  Thread::MutexBasicLockable shared_conn_pools_lock_;
+  std::map<SharedConnPoolKey, Http::Http2::SharedConnPoolSharedPtr>
+      shared_conn_pools_ GUARDED_BY(shared_conn_pools_lock_);
   ThreadLocal::SlotPtr tls_;
   Runtime::RandomGenerator& random_;
   AccessLog::AccessLogManager& log_manager_;
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <memory>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/compiler_requirements.h"
 #include "common/common/perf_annotation.h"
 #include "common/event/libevent.h"
@@ -41,6 +42,7 @@ Runtime::LoaderPtr ProdComponentFactory::createRuntime(Server::Instance& server,
 MainCommonBase::MainCommonBase(OptionsImpl& options) : options_(options) {
   ares_library_init(ARES_LIB_INIT_ALL);
   Event::Libevent::Global::initialize();
+  Buffer::OwnedImpl::useOldImpl(options_.libeventBufferEnabled());
   RELEASE_ASSERT(Envoy::Server::validateProtoDescriptors(), "");
 
   switch (options_.mode()) {
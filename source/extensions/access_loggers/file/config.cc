@@ -1,10 +1,14 @@
 #include "extensions/access_loggers/file/config.h"
 
+#include <map>
+#include <string>
+
 #include "envoy/config/accesslog/v2/file.pb.validate.h"
 #include "envoy/registry/registry.h"
 #include "envoy/server/filter_config.h"
 
 #include "common/access_log/access_log_formatter.h"
+#include "common/common/fmt.h"
 #include "common/protobuf/protobuf.h"
 
 #include "extensions/access_loggers/file/file_access_log_impl.h"
@@ -22,7 +26,20 @@ FileAccessLogFactory::createAccessLogInstance(const Protobuf::Message& config,
   const auto& fal_config =
       MessageUtil::downcastAndValidate<const envoy::config::accesslog::v2::FileAccessLog&>(config);
   AccessLog::FormatterPtr formatter;
-  if (fal_config.format().empty()) {
+  if (fal_config.access_log_format_case() ==
+      envoy::config::accesslog::v2::FileAccessLog::kJsonFormat) {
+    std::map<std::string, std::string> format_mapping;
+    for (const auto& field : fal_config.json_format().fields()) {
+      if (field.second.kind_case() != ProtobufWkt::Value::kStringValue) {
+        throw EnvoyException(
+            fmt::format("Only string values are supported in the JSON access log format, given "
+                        "a different value for key: {}",
+                        field.first));
+      }
+      format_mapping.emplace(field.first, field.second.string_value());
+    }
+    formatter.reset(new AccessLog::JsonFormatterImpl(format_mapping));
+  } else if (fal_config.format().empty()) {
     formatter = AccessLog::AccessLogFormatUtils::defaultAccessLogFormatter();
   } else {
     formatter.reset(new AccessLog::FormatterImpl(fal_config.format()));
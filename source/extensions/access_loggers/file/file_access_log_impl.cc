@@ -35,8 +35,13 @@ void FileAccessLog::log(const Http::HeaderMap* request_headers,
     }
   }
 
-  log_file_->write(
-      formatter_->format(*request_headers, *response_headers, *response_trailers, request_info));
+  // The log line buffer is reused across logs on each thread, so that formatting a log does not
+  // allocate once the buffer has grown to the size of a typical log line.
+  static thread_local std::string log_line;
+  log_line.clear();
+  formatter_->formatInto(log_line, *request_headers, *response_headers, *response_trailers,
+                         request_info);
+  log_file_->write(log_line);
 }
 
 } // namespace File
@@ -3,6 +3,7 @@
 #include "common/common/assert.h"
 #include "common/http/header_map_impl.h"
 #include "common/network/utility.h"
+#include "common/protobuf/utility.h"
 #include "common/request_info/utility.h"
 
 namespace Envoy {
@@ -12,54 +13,115 @@ namespace HttpGrpc {
 
 GrpcAccessLogStreamerImpl::GrpcAccessLogStreamerImpl(Grpc::AsyncClientFactoryPtr&& factory,
                                                      ThreadLocal::SlotAllocator& tls,
-                                                     const LocalInfo::LocalInfo& local_info)
+                                                     const LocalInfo::LocalInfo& local_info,
+                                                     Stats::Scope& scope)
     : tls_slot_(tls.allocateSlot()) {
-  SharedStateSharedPtr shared_state = std::make_shared<SharedState>(std::move(factory), local_info);
-  tls_slot_->set([shared_state](Event::Dispatcher&) {
-    return ThreadLocal::ThreadLocalObjectSharedPtr{new ThreadLocalStreamer(shared_state)};
+  SharedStateSharedPtr shared_state =
+      std::make_shared<SharedState>(std::move(factory), local_info, scope);
+  tls_slot_->set([shared_state](Event::Dispatcher& dispatcher) {
+    return ThreadLocal::ThreadLocalObjectSharedPtr{
+        new ThreadLocalStreamer(shared_state, dispatcher)};
   });
 }
 
+GrpcAccessLogStreamerImpl::ThreadLocalStream::ThreadLocalStream(
+    ThreadLocalStreamer& parent,
+    const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config)
+    : parent_(parent), log_name_(config.log_name()),
+      buffer_flush_interval_(PROTOBUF_GET_MS_OR_DEFAULT(config, buffer_flush_interval, 1000)),
+      buffer_size_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, buffer_size_bytes, 16384)),
+      buffer_size_logs_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, buffer_size_logs, 0)),
+      max_pending_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_pending_bytes, 1024 * 1024)),
+      flush_timer_(parent.dispatcher_.createTimer([this]() -> void { flush(); })) {}
+
 void GrpcAccessLogStreamerImpl::ThreadLocalStream::onRemoteClose(Grpc::Status::GrpcStatus,
                                                                  const std::string&) {
-  auto it = parent_.stream_map_.find(log_name_);
-  ASSERT(it != parent_.stream_map_.end());
-  if (it->second.stream_ != nullptr) {
-    // Only erase if we have a stream. Otherwise we had an inline failure and we will clear the
-    // stream data in send().
-    parent_.stream_map_.erase(it);
-  }
+  // The stream is gone, and a new one is started with the next batch. This is also called inline
+  // when the stream fails to start, in which case flush() drops the batch.
+  stream_ = nullptr;
 }
 
-GrpcAccessLogStreamerImpl::ThreadLocalStreamer::ThreadLocalStreamer(
-    const SharedStateSharedPtr& shared_state)
-    : client_(shared_state->factory_->create()), shared_state_(shared_state) {}
+void GrpcAccessLogStreamerImpl::ThreadLocalStream::log(
+    envoy::service::accesslog::v2::StreamAccessLogsMessage& message) {
+  auto* entries = message.mutable_http_logs()->mutable_log_entry();
+  if (batch_bytes_ >= max_pending_bytes_) {
+    // The batch could not be sent for a while because the stream is backed up.
+    parent_.shared_state_->stats_.logs_dropped_.add(entries->size());
+    return;
+  }
 
-void GrpcAccessLogStreamerImpl::ThreadLocalStreamer::send(
-    envoy::service::accesslog::v2::StreamAccessLogsMessage& message, const std::string& log_name) {
-  auto stream_it = stream_map_.find(log_name);
-  if (stream_it == stream_map_.end()) {
-    stream_it = stream_map_.emplace(log_name, ThreadLocalStream(*this, log_name)).first;
+  if (batch_logs_ == 0) {
+    flush_timer_->enableTimer(buffer_flush_interval_);
   }
+  // Swapping moves the entries into the batch without copying their fields.
+  auto* batch_entries = batch_.mutable_http_logs()->mutable_log_entry();
+  for (auto& entry : *entries) {
+    batch_bytes_ += entry.ByteSize();
+    batch_entries->Add()->Swap(&entry);
+  }
+  batch_logs_ += entries->size();
 
-  auto& stream_entry = stream_it->second;
-  if (stream_entry.stream_ == nullptr) {
-    stream_entry.stream_ =
-        client_->start(*Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
-                           "envoy.service.accesslog.v2.AccessLogService.StreamAccessLogs"),
-                       stream_entry);
+  if (batch_bytes_ >= buffer_size_bytes_ ||
+      (buffer_size_logs_ > 0 && batch_logs_ >= buffer_size_logs_)) {
+    flush();
+  }
+}
 
-    auto* identifier = message.mutable_identifier();
-    *identifier->mutable_node() = shared_state_->local_info_.node();
-    identifier->set_log_name(log_name);
+void GrpcAccessLogStreamerImpl::ThreadLocalStream::flush() {
+  if (batch_logs_ == 0) {
+    return;
   }
 
-  if (stream_entry.stream_ != nullptr) {
-    stream_entry.stream_->sendMessage(message, false);
-  } else {
-    // Clear out the stream data due to stream creation failure.
-    stream_map_.erase(stream_it);
+  if (stream_ == nullptr) {
+    stream_ = parent_.client_->start(
+        *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
+            "envoy.service.accesslog.v2.AccessLogService.StreamAccessLogs"),
+        *this);
+    if (stream_ == nullptr) {
+      // The stream failed inline, so there is nowhere to send the batch.
+      parent_.shared_state_->stats_.logs_dropped_.add(batch_logs_);
+      clearBatch();
+      return;
+    }
+
+    // The first message on a stream identifies the log.
+    auto* identifier = batch_.mutable_identifier();
+    *identifier->mutable_node() = parent_.shared_state_->local_info_.node();
+    identifier->set_log_name(log_name_);
+  } else if (stream_->isAboveWriteBufferHighWatermark()) {
+    // Keep buffering while the access log service catches up, and try again later.
+    flush_timer_->enableTimer(buffer_flush_interval_);
+    return;
   }
+
+  stream_->sendMessage(batch_, false);
+  parent_.shared_state_->stats_.logs_written_.add(batch_logs_);
+  clearBatch();
+}
+
+void GrpcAccessLogStreamerImpl::ThreadLocalStream::clearBatch() {
+  batch_.Clear();
+  batch_bytes_ = 0;
+  batch_logs_ = 0;
+  flush_timer_->disableTimer();
+}
+
+GrpcAccessLogStreamerImpl::ThreadLocalStreamer::ThreadLocalStreamer(
+    const SharedStateSharedPtr& shared_state, Event::Dispatcher& dispatcher)
+    : client_(shared_state->factory_->create()), dispatcher_(dispatcher),
+      shared_state_(shared_state) {}
+
+void GrpcAccessLogStreamerImpl::ThreadLocalStreamer::send(
+    envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+    const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config) {
+  auto stream_it = stream_map_.find(config.log_name());
+  if (stream_it == stream_map_.end()) {
+    stream_it =
+        stream_map_.emplace(config.log_name(), std::make_unique<ThreadLocalStream>(*this, config))
+            .first;
+  }
+
+  stream_it->second->log(message);
 }
 
 HttpGrpcAccessLog::HttpGrpcAccessLog(
@@ -333,8 +395,7 @@ void HttpGrpcAccessLog::log(const Http::HeaderMap* request_headers,
     }
   }
 
-  // TODO(mattklein123): Consider batching multiple logs and flushing.
-  grpc_access_log_streamer_->send(message, config_.common_config().log_name());
+  grpc_access_log_streamer_->send(message, config_.common_config());
 }
 
 } // namespace HttpGrpc
@@ -1,16 +1,22 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "envoy/access_log/access_log.h"
 #include "envoy/config/accesslog/v2/als.pb.h"
 #include "envoy/config/filter/accesslog/v2/accesslog.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
 #include "envoy/grpc/async_client.h"
 #include "envoy/grpc/async_client_manager.h"
 #include "envoy/local_info/local_info.h"
 #include "envoy/service/accesslog/v2/als.pb.h"
 #include "envoy/singleton/instance.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/thread_local/thread_local.h"
 
 namespace Envoy {
@@ -18,7 +24,18 @@ namespace Extensions {
 namespace AccessLoggers {
 namespace HttpGrpc {
 
-// TODO(mattklein123): Stats
+// clang-format off
+#define ALL_GRPC_ACCESS_LOG_STATS(COUNTER)                                                         \
+  COUNTER(logs_written)                                                                            \
+  COUNTER(logs_dropped)
+// clang-format on
+
+/**
+ * Wrapper struct for gRPC access log stats. @see stats_macros.h
+ */
+struct GrpcAccessLogStats {
+  ALL_GRPC_ACCESS_LOG_STATS(GENERATE_COUNTER_STRUCT)
+};
 
 /**
  * Interface for an access log streamer. The streamer deals with threading and sends access logs
@@ -29,12 +46,13 @@ public:
   virtual ~GrpcAccessLogStreamer() {}
 
   /**
-   * Send an access log.
-   * @param message supplies the access log to send.
-   * @param log_name supplies the name of the log stream to send on.
+   * Send an access log. The log entries are buffered and sent in batches on each thread.
+   * @param message supplies the access log, whose log entries are moved out of it.
+   * @param config supplies the configuration of the log stream to send on. Logs with the same log
+   *        name share a stream, which is batched as configured by the first of them to be sent.
    */
   virtual void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-                    const std::string& log_name) PURE;
+                    const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config) PURE;
 };
 
 typedef std::shared_ptr<GrpcAccessLogStreamer> GrpcAccessLogStreamerSharedPtr;
@@ -46,12 +64,12 @@ typedef std::shared_ptr<GrpcAccessLogStreamer> GrpcAccessLogStreamerSharedPtr;
 class GrpcAccessLogStreamerImpl : public Singleton::Instance, public GrpcAccessLogStreamer {
 public:
   GrpcAccessLogStreamerImpl(Grpc::AsyncClientFactoryPtr&& factory, ThreadLocal::SlotAllocator& tls,
-                            const LocalInfo::LocalInfo& local_info);
+                            const LocalInfo::LocalInfo& local_info, Stats::Scope& scope);
 
   // GrpcAccessLogStreamer
   void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-            const std::string& log_name) override {
-    tls_slot_->getTyped<ThreadLocalStreamer>().send(message, log_name);
+            const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config) override {
+    tls_slot_->getTyped<ThreadLocalStreamer>().send(message, config);
   }
 
 private:
@@ -60,11 +78,15 @@ private:
    * slot to be destroyed while the streamers hold onto the shared state.
    */
   struct SharedState {
-    SharedState(Grpc::AsyncClientFactoryPtr&& factory, const LocalInfo::LocalInfo& local_info)
-        : factory_(std::move(factory)), local_info_(local_info) {}
+    SharedState(Grpc::AsyncClientFactoryPtr&& factory, const LocalInfo::LocalInfo& local_info,
+                Stats::Scope& scope)
+        : factory_(std::move(factory)), local_info_(local_info),
+          stats_({ALL_GRPC_ACCESS_LOG_STATS(
+              POOL_COUNTER_PREFIX(scope, "access_logs.grpc_access_log."))}) {}
 
     Grpc::AsyncClientFactoryPtr factory_;
     const LocalInfo::LocalInfo& local_info_;
+    GrpcAccessLogStats stats_;
   };
 
   typedef std::shared_ptr<SharedState> SharedStateSharedPtr;
@@ -72,12 +94,13 @@ private:
   struct ThreadLocalStreamer;
 
   /**
-   * Per-thread stream state.
+   * Per-thread stream state. This buffers the logs of the stream into batches, and outlives the
+   * gRPC stream so that logs are kept while a stream is restarted.
    */
   struct ThreadLocalStream : public Grpc::TypedAsyncStreamCallbacks<
                                  envoy::service::accesslog::v2::StreamAccessLogsResponse> {
-    ThreadLocalStream(ThreadLocalStreamer& parent, const std::string& log_name)
-        : parent_(parent), log_name_(log_name) {}
+    ThreadLocalStream(ThreadLocalStreamer& parent,
+                      const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config);
 
     // Grpc::TypedAsyncStreamCallbacks
     void onCreateInitialMetadata(Http::HeaderMap&) override {}
@@ -87,21 +110,46 @@ private:
     void onReceiveTrailingMetadata(Http::HeaderMapPtr&&) override {}
     void onRemoteClose(Grpc::Status::GrpcStatus status, const std::string& message) override;
 
+    /**
+     * Add the log entries of a message to the batch, and send the batch if it is full.
+     */
+    void log(envoy::service::accesslog::v2::StreamAccessLogsMessage& message);
+
+    /**
+     * Send the batch, starting a stream if there is none. The batch is kept if the stream is
+     * backed up.
+     */
+    void flush();
+
+    void clearBatch();
+
     ThreadLocalStreamer& parent_;
     const std::string log_name_;
+    const std::chrono::milliseconds buffer_flush_interval_;
+    const uint64_t buffer_size_bytes_;
+    const uint32_t buffer_size_logs_;
+    const uint64_t max_pending_bytes_;
+    Event::TimerPtr flush_timer_;
+    envoy::service::accesslog::v2::StreamAccessLogsMessage batch_;
+    // The serialized size of the log entries in the batch, not counting the batch's framing.
+    uint64_t batch_bytes_{};
+    uint32_t batch_logs_{};
     Grpc::AsyncStream* stream_{};
   };
 
+  typedef std::unique_ptr<ThreadLocalStream> ThreadLocalStreamPtr;
+
   /**
    * Per-thread multi-stream state.
    */
   struct ThreadLocalStreamer : public ThreadLocal::ThreadLocalObject {
-    ThreadLocalStreamer(const SharedStateSharedPtr& shared_state);
+    ThreadLocalStreamer(const SharedStateSharedPtr& shared_state, Event::Dispatcher& dispatcher);
     void send(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-              const std::string& log_name);
+              const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config);
 
     Grpc::AsyncClientPtr client_;
-    std::unordered_map<std::string, ThreadLocalStream> stream_map_;
+    Event::Dispatcher& dispatcher_;
+    std::unordered_map<std::string, ThreadLocalStreamPtr> stream_map_;
     SharedStateSharedPtr shared_state_;
   };
 
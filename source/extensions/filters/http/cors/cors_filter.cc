@@ -123,7 +123,7 @@ bool CorsFilter::isOriginAllowedRegex(const Http::HeaderString& origin) {
     return false;
   }
   for (const auto& regex : *allowOriginRegexes()) {
-    if (std::regex_match(origin.c_str(), regex)) {
+    if (regex->match(absl::string_view(origin.c_str(), origin.size()))) {
       return true;
     }
   }
@@ -139,7 +139,7 @@ const std::list<std::string>* CorsFilter::allowOrigins() {
   return nullptr;
 }
 
-const std::list<std::regex>* CorsFilter::allowOriginRegexes() {
+const std::list<Regex::CompiledMatcherSharedPtr>* CorsFilter::allowOriginRegexes() {
   for (const auto policy : policies_) {
     if (policy && !policy->allowOriginRegexes().empty()) {
       return &policy->allowOriginRegexes();
@@ -45,7 +45,7 @@ private:
   friend class CorsFilterTest;
 
   const std::list<std::string>* allowOrigins();
-  const std::list<std::regex>* allowOriginRegexes();
+  const std::list<Regex::CompiledMatcherSharedPtr>* allowOriginRegexes();
   const std::string& allowMethods();
   const std::string& allowHeaders();
   const std::string& exposeHeaders();
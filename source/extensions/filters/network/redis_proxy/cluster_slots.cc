@@ -0,0 +1,149 @@
+#include "extensions/filters/network/redis_proxy/cluster_slots.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/macros.h"
+#include "common/common/utility.h"
+#include "common/network/utility.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+namespace {
+
+typedef std::array<uint16_t, 256> Crc16Table;
+
+// CRC16-CCITT (XMODEM), as used by Redis Cluster: polynomial 0x1021, initial value 0.
+const Crc16Table& crc16Table() {
+  CONSTRUCT_ON_FIRST_USE(Crc16Table, []() -> Crc16Table {
+    Crc16Table table;
+    for (uint32_t i = 0; i < table.size(); i++) {
+      uint16_t crc = i << 8;
+      for (uint32_t bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+      }
+      table[i] = crc;
+    }
+    return table;
+  }());
+}
+
+uint16_t crc16(const char* data, size_t length) {
+  const Crc16Table& table = crc16Table();
+  uint16_t crc = 0;
+  for (size_t i = 0; i < length; i++) {
+    crc = (crc << 8) ^ table[((crc >> 8) ^ static_cast<uint8_t>(data[i])) & 0xff];
+  }
+  return crc;
+}
+
+} // namespace
+
+uint16_t ClusterSlots::keySlot(const std::string& key) {
+  const size_t start = key.find('{');
+  if (start != std::string::npos) {
+    const size_t end = key.find('}', start + 1);
+    if (end != std::string::npos && end != start + 1) {
+      return crc16(key.data() + start + 1, end - start - 1) % NUM_SLOTS;
+    }
+  }
+
+  return crc16(key.data(), key.size()) % NUM_SLOTS;
+}
+
+bool ClusterSlots::parseClusterSlots(const RespValue& value, std::vector<ClusterSlot>& slots) {
+  // Each slot range looks like: [start, end, [master ip, master port, ...], replicas...]
+  if (value.type() != RespType::Array) {
+    return false;
+  }
+
+  slots.clear();
+  for (const RespValue& range : value.asArray()) {
+    if (range.type() != RespType::Array || range.asArray().size() < 3) {
+      return false;
+    }
+
+    const RespValue& start = range.asArray()[0];
+    const RespValue& end = range.asArray()[1];
+    const RespValue& master = range.asArray()[2];
+    if (start.type() != RespType::Integer || end.type() != RespType::Integer ||
+        start.asInteger() < 0 || start.asInteger() > end.asInteger() ||
+        end.asInteger() >= NUM_SLOTS || master.type() != RespType::Array ||
+        master.asArray().size() < 2 || master.asArray()[0].type() != RespType::BulkString ||
+        master.asArray()[1].type() != RespType::Integer || master.asArray()[1].asInteger() < 0) {
+      return false;
+    }
+
+    Network::Address::InstanceConstSharedPtr address =
+        parseAddress(master.asArray()[0].asString(), master.asArray()[1].asInteger());
+    if (address == nullptr) {
+      return false;
+    }
+    slots.push_back({static_cast<uint16_t>(start.asInteger()),
+                     static_cast<uint16_t>(end.asInteger()), address});
+  }
+
+  return true;
+}
+
+bool ClusterSlots::parseRedirection(const RespValue& value, ClusterRedirection& redirection) {
+  // Redirections look like: MOVED 3999 127.0.0.1:6381
+  if (value.type() != RespType::Error) {
+    return false;
+  }
+
+  std::vector<absl::string_view> tokens = StringUtil::splitToken(value.asString(), " ");
+  if (tokens.size() != 3) {
+    return false;
+  }
+  if (tokens[0] == "ASK") {
+    redirection.ask_ = true;
+  } else if (tokens[0] == "MOVED") {
+    redirection.ask_ = false;
+  } else {
+    return false;
+  }
+
+  uint64_t slot;
+  if (!StringUtil::atoul(std::string(tokens[1]).c_str(), slot) || slot >= NUM_SLOTS) {
+    return false;
+  }
+  redirection.slot_ = slot;
+
+  // IPv6 addresses aren't bracketed, so the port follows the last colon.
+  const size_t colon = tokens[2].rfind(':');
+  uint64_t port;
+  if (colon == absl::string_view::npos ||
+      !StringUtil::atoul(std::string(tokens[2].substr(colon + 1)).c_str(), port)) {
+    return false;
+  }
+  redirection.address_ = parseAddress(std::string(tokens[2].substr(0, colon)), port);
+  return redirection.address_ != nullptr;
+}
+
+Network::Address::InstanceConstSharedPtr ClusterSlots::parseAddress(const std::string& ip,
+                                                                    uint64_t port) {
+  if (port > UINT16_MAX) {
+    return nullptr;
+  }
+
+  try {
+    return Network::Utility::parseInternetAddress(ip, port);
+  } catch (const EnvoyException&) {
+    return nullptr;
+  }
+}
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "envoy/network/address.h"
+
+#include "extensions/filters/network/redis_proxy/codec.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+/**
+ * A range of hash slots served by a master, as returned by CLUSTER SLOTS.
+ */
+struct ClusterSlot {
+  uint16_t start_;
+  uint16_t end_;
+  Network::Address::InstanceConstSharedPtr master_;
+};
+
+/**
+ * A MOVED or ASK redirection of a command, as returned by a Redis Cluster node that doesn't serve
+ * the slot of the command's key.
+ */
+struct ClusterRedirection {
+  // Whether the redirection only applies to this command (ASK), rather than to the slot (MOVED).
+  bool ask_;
+  uint16_t slot_;
+  Network::Address::InstanceConstSharedPtr address_;
+};
+
+/**
+ * Utilities for routing commands by Redis Cluster hash slot. See
+ * https://redis.io/topics/cluster-spec.
+ */
+class ClusterSlots {
+public:
+  static const uint16_t NUM_SLOTS = 16384;
+
+  /**
+   * @param key supplies the key of a command.
+   * @return uint16_t the hash slot of the key. Only the hash tag of the key is hashed if it has
+   *         one, i.e. a non-empty substring between the first '{' and the following '}'.
+   */
+  static uint16_t keySlot(const std::string& key);
+
+  /**
+   * Parse a reply to CLUSTER SLOTS.
+   * @param value supplies the reply.
+   * @param slots supplies the slot ranges to fill in.
+   * @return bool whether the reply was a valid slot map.
+   */
+  static bool parseClusterSlots(const RespValue& value, std::vector<ClusterSlot>& slots);
+
+  /**
+   * Parse a MOVED or ASK redirection.
+   * @param value supplies a reply to a command.
+   * @param redirection supplies the redirection to fill in.
+   * @return bool whether the reply was a valid redirection.
+   */
+  static bool parseRedirection(const RespValue& value, ClusterRedirection& redirection);
+
+private:
+  static Network::Address::InstanceConstSharedPtr parseAddress(const std::string& ip,
+                                                               uint64_t port);
+};
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
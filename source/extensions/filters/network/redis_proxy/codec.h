@@ -24,8 +24,11 @@ enum class RespType { Null, SimpleString, BulkString, Integer, Error, Array };
 class RespValue {
 public:
   RespValue() : type_(RespType::Null) {}
+  RespValue(const RespValue& other);
   ~RespValue() { cleanup(); }
 
+  RespValue& operator=(const RespValue& other);
+
   /**
    * Convert a RESP value to a string for debugging purposes.
    */
@@ -49,6 +52,21 @@ public:
   RespType type() const { return type_; }
   void type(RespType type);
 
+  /**
+   * @return the bytes that the value was decoded from, if the decoder retained them, so that the
+   *         value can be forwarded without being encoded again. The bytes are dropped as soon as
+   *         the value is changed through type() or one of the non-const as* methods.
+   */
+  const std::shared_ptr<const Buffer::Instance>& raw() const { return raw_; }
+  void raw(std::shared_ptr<const Buffer::Instance>&& raw) { raw_ = std::move(raw); }
+
+  /**
+   * Set the bytes that a bulk string value was decoded from, when its contents weren't copied out
+   * of them. The contents are only copied out the first time the string is read through asString(),
+   * so that a large value that is only forwarded is held once.
+   */
+  void rawBulkString(std::shared_ptr<const Buffer::Instance>&& raw);
+
 private:
   union {
     std::vector<RespValue> array_;
@@ -57,8 +75,12 @@ private:
   };
 
   void cleanup();
+  void decodeRawBulkString();
 
   RespType type_;
+  std::shared_ptr<const Buffer::Instance> raw_;
+  // Whether the contents of a bulk string still have to be copied out of raw_.
+  bool raw_bulk_string_{};
 };
 
 typedef std::unique_ptr<RespValue> RespValuePtr;
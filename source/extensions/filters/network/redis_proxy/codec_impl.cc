@@ -1,6 +1,8 @@
 #include "extensions/filters/network/redis_proxy/codec_impl.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -13,6 +15,40 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace RedisProxy {
 
+RespValue::RespValue(const RespValue& other) : type_(RespType::Null) { *this = other; }
+
+RespValue& RespValue::operator=(const RespValue& other) {
+  if (&other == this) {
+    return *this;
+  }
+
+  type(other.type());
+  switch (type_) {
+  case RespType::Array: {
+    array_ = other.array_;
+    break;
+  }
+  case RespType::SimpleString:
+  case RespType::BulkString:
+  case RespType::Error: {
+    string_ = other.string_;
+    break;
+  }
+  case RespType::Integer: {
+    integer_ = other.integer_;
+    break;
+  }
+  case RespType::Null: {
+    break;
+  }
+  }
+
+  // The bytes are never changed once decoded, so they can be shared.
+  raw_ = other.raw_;
+  raw_bulk_string_ = other.raw_bulk_string_;
+  return *this;
+}
+
 std::string RespValue::toString() const {
   switch (type_) {
   case RespType::Array: {
@@ -40,6 +76,7 @@ std::string RespValue::toString() const {
 
 std::vector<RespValue>& RespValue::asArray() {
   ASSERT(type_ == RespType::Array);
+  raw_.reset();
   return array_;
 }
 
@@ -51,17 +88,43 @@ const std::vector<RespValue>& RespValue::asArray() const {
 std::string& RespValue::asString() {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  if (raw_bulk_string_) {
+    decodeRawBulkString();
+  }
+  raw_.reset();
   return string_;
 }
 
 const std::string& RespValue::asString() const {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  if (raw_bulk_string_) {
+    // Copying the contents out doesn't change the value, only how it is held.
+    const_cast<RespValue*>(this)->decodeRawBulkString();
+  }
   return string_;
 }
 
+void RespValue::rawBulkString(std::shared_ptr<const Buffer::Instance>&& raw) {
+  ASSERT(type_ == RespType::BulkString && string_.empty());
+  raw_ = std::move(raw);
+  raw_bulk_string_ = true;
+}
+
+void RespValue::decodeRawBulkString() {
+  // The bytes are "$<length>\r\n<contents>\r\n", and were already validated by the decoder.
+  const ssize_t header_end = raw_->search("\r\n", 2, 0);
+  ASSERT(header_end > 0);
+  const uint64_t start = header_end + 2;
+  ASSERT(raw_->length() >= start + 2);
+  string_.resize(raw_->length() - start - 2);
+  raw_->copyOut(start, string_.size(), &string_[0]);
+  raw_bulk_string_ = false;
+}
+
 int64_t& RespValue::asInteger() {
   ASSERT(type_ == RespType::Integer);
+  raw_.reset();
   return integer_;
 }
 
@@ -92,6 +155,8 @@ void RespValue::cleanup() {
 
 void RespValue::type(RespType type) {
   cleanup();
+  raw_.reset();
+  raw_bulk_string_ = false;
 
   // Need to use placement new because of the union.
   type_ = type;
@@ -117,16 +182,67 @@ void DecoderImpl::decode(Buffer::Instance& data) {
   uint64_t num_slices = data.getRawSlices(nullptr, 0);
   Buffer::RawSlice slices[num_slices];
   data.getRawSlices(slices, num_slices);
-  for (const Buffer::RawSlice& slice : slices) {
-    parseSlice(slice);
+  bytes_after_slice_ = data.length();
+  try {
+    for (const Buffer::RawSlice& slice : slices) {
+      bytes_after_slice_ -= slice.len_;
+      parseSlice(slice);
+    }
+  } catch (ProtocolError&) {
+    // The values that were complete before the error are still passed on.
+    passthroughCompletedValues(data);
+    throw;
   }
 
+  passthroughCompletedValues(data);
   data.drain(data.length());
 }
 
+void DecoderImpl::passthroughCompletedValues(Buffer::Instance& data) {
+  if (passthrough_threshold_ == 0) {
+    return;
+  }
+
+  // The slices are moved rather than copied, except for the ones that are shared by several
+  // values. The callbacks are only called once the decoded buffer isn't referenced anymore.
+  pending_raw_.move(data);
+  std::vector<CompletedValue> completed_values;
+  completed_values.swap(completed_values_);
+  for (CompletedValue& completed : completed_values) {
+    if (completed.length_ >= passthrough_threshold_) {
+      std::shared_ptr<Buffer::OwnedImpl> raw = std::make_shared<Buffer::OwnedImpl>();
+      raw->move(pending_raw_, completed.length_);
+      if (completed.bulk_string_skipped_) {
+        completed.value_->rawBulkString(std::move(raw));
+      } else {
+        completed.value_->raw(std::move(raw));
+      }
+    } else {
+      pending_raw_.drain(completed.length_);
+    }
+  }
+
+  for (CompletedValue& completed : completed_values) {
+    callbacks_.onRespValue(std::move(completed.value_));
+  }
+}
+
+void DecoderImpl::onValueComplete() {
+  if (passthrough_threshold_ == 0) {
+    callbacks_.onRespValue(std::move(pending_value_root_));
+  } else {
+    completed_values_.push_back(
+        {std::move(pending_value_root_), pending_value_length_, skip_bulk_string_body_});
+  }
+  pending_value_length_ = 0;
+  skip_bulk_string_body_ = false;
+}
+
 void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
   const char* buffer = reinterpret_cast<const char*>(slice.mem_);
   uint64_t remaining = slice.len_;
+  // The bytes of the slice up to this point that haven't been counted in pending_value_length_.
+  const char* value_start = buffer;
 
   while (remaining || state_ == State::ValueComplete) {
     ENVOY_LOG(trace, "parse slice: {} remaining", remaining);
@@ -243,7 +359,17 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
       } else {
         ASSERT(current_value.value_->type() == RespType::BulkString);
         if (!pending_integer_.negative_) {
-          // TODO(mattklein123): reserve and define max length since we don't stream currently.
+          if (skip_large_bulk_strings_ && current_value.value_ == pending_value_root_.get() &&
+              pending_value_length_ + (buffer - value_start) + pending_integer_.integer_ + 2 >=
+                  passthrough_threshold_) {
+            // The contents will only be held in the bytes that are retained for the value.
+            skip_bulk_string_body_ = true;
+          } else {
+            // Reserve what can be appended from the buffer being decoded, so that a large string
+            // isn't copied again as it grows, without trusting the length for more than that.
+            current_value.value_->asString().reserve(
+                std::min(pending_integer_.integer_, remaining + bytes_after_slice_));
+          }
           state_ = State::BulkStringBody;
         } else {
           // Null bulk string. Switch type to null and move to value complete.
@@ -259,14 +385,18 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
       ASSERT(!pending_integer_.negative_);
       uint64_t length_to_copy =
           std::min(static_cast<uint64_t>(pending_integer_.integer_), remaining);
-      pending_value_stack_.front().value_->asString().append(buffer, length_to_copy);
+      if (!skip_bulk_string_body_) {
+        pending_value_stack_.front().value_->asString().append(buffer, length_to_copy);
+      }
       pending_integer_.integer_ -= length_to_copy;
       remaining -= length_to_copy;
       buffer += length_to_copy;
 
       if (pending_integer_.integer_ == 0) {
-        ENVOY_LOG(trace, "parse slice: BulkStringBody complete: {}",
-                  pending_value_stack_.front().value_->asString());
+        if (!skip_bulk_string_body_) {
+          ENVOY_LOG(trace, "parse slice: BulkStringBody complete: {}",
+                    pending_value_stack_.front().value_->asString());
+        }
         state_ = State::CR;
       }
 
@@ -315,7 +445,9 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
       ASSERT(!pending_value_stack_.empty());
       pending_value_stack_.pop_front();
       if (pending_value_stack_.empty()) {
-        callbacks_.onRespValue(std::move(pending_value_root_));
+        pending_value_length_ += buffer - value_start;
+        value_start = buffer;
+        onValueComplete();
         state_ = State::ValueRootStart;
       } else {
         PendingValue& current_value = pending_value_stack_.front();
@@ -332,9 +464,16 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
     }
     }
   }
+
+  pending_value_length_ += buffer - value_start;
 }
 
 void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
+  if (value.raw()) {
+    encodeRaw(value.raw(), out);
+    return;
+  }
+
   switch (value.type()) {
   case RespType::Array: {
     encodeArray(value.asArray(), out);
@@ -362,6 +501,22 @@ void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
   }
 }
 
+void EncoderImpl::encodeRaw(const std::shared_ptr<const Buffer::Instance>& raw,
+                            Buffer::Instance& out) {
+  // The slices of the raw bytes are referenced rather than copied. Each fragment keeps the bytes
+  // alive until it has been drained from wherever the output is moved to.
+  uint64_t num_slices = raw->getRawSlices(nullptr, 0);
+  Buffer::RawSlice slices[num_slices];
+  raw->getRawSlices(slices, num_slices);
+  for (const Buffer::RawSlice& slice : slices) {
+    out.addBufferFragment(*new Buffer::BufferFragmentImpl(
+        slice.mem_, slice.len_,
+        [raw](const void*, size_t, const Buffer::BufferFragmentImpl* fragment) -> void {
+          delete fragment;
+        }));
+  }
+}
+
 void EncoderImpl::encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out) {
   char buffer[32];
   char* current = buffer;
@@ -2,9 +2,11 @@
 
 #include <cstdint>
 #include <forward_list>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/logger.h"
 
 #include "extensions/filters/network/redis_proxy/codec.h"
@@ -18,10 +20,22 @@ namespace RedisProxy {
  * Decoder implementation of https://redis.io/topics/protocol
  *
  * This implementation buffers when needed and will always consume all bytes passed for decoding.
+ *
+ * With a non-zero passthrough threshold, the bytes of each top level value that is at least that
+ * large are moved out of the decoded buffer and attached to the value (see RespValue::raw()), so
+ * that it can be forwarded as is. In that mode the values decoded from a buffer are only passed to
+ * the callbacks once the whole buffer has been parsed.
+ *
+ * Such a value is then held both decoded and as bytes. With skip_large_bulk_strings, the contents
+ * of a top level bulk string that is at least that large aren't copied out while decoding, and
+ * are only held in the bytes until they are read (see RespValue::rawBulkString()).
  */
 class DecoderImpl : public Decoder, Logger::Loggable<Logger::Id::redis> {
 public:
-  DecoderImpl(DecoderCallbacks& callbacks) : callbacks_(callbacks) {}
+  DecoderImpl(DecoderCallbacks& callbacks, uint64_t passthrough_threshold = 0,
+              bool skip_large_bulk_strings = false)
+      : callbacks_(callbacks), passthrough_threshold_(passthrough_threshold),
+        skip_large_bulk_strings_(passthrough_threshold != 0 && skip_large_bulk_strings) {}
 
   // RedisProxy::Decoder
   void decode(Buffer::Instance& data) override;
@@ -55,13 +69,35 @@ private:
     uint64_t current_array_element_;
   };
 
+  struct CompletedValue {
+    RespValuePtr value_;
+    // The number of bytes that the value was decoded from.
+    uint64_t length_;
+    // Whether the value is a bulk string whose contents weren't copied out of the bytes.
+    bool bulk_string_skipped_;
+  };
+
   void parseSlice(const Buffer::RawSlice& slice);
+  void onValueComplete();
+  void passthroughCompletedValues(Buffer::Instance& data);
 
   DecoderCallbacks& callbacks_;
+  const uint64_t passthrough_threshold_;
+  const bool skip_large_bulk_strings_;
   State state_{State::ValueRootStart};
   PendingInteger pending_integer_;
   RespValuePtr pending_value_root_;
   std::forward_list<PendingValue> pending_value_stack_;
+  // The number of bytes of pending_value_root_ parsed so far.
+  uint64_t pending_value_length_{};
+  // Whether the contents of pending_value_root_, a large bulk string, aren't being copied.
+  bool skip_bulk_string_body_{};
+  // The number of bytes that follow the slice being parsed in the buffer being decoded.
+  uint64_t bytes_after_slice_{};
+  // In passthrough mode, the values decoded from the buffer being decoded, and the bytes that
+  // haven't been attached to a value or drained yet.
+  std::vector<CompletedValue> completed_values_;
+  Buffer::OwnedImpl pending_raw_;
 };
 
 /**
@@ -69,10 +105,30 @@ private:
  */
 class DecoderFactoryImpl : public DecoderFactory {
 public:
+  /**
+   * @param passthrough_threshold supplies the size from which decoded values retain the bytes they
+   *        were decoded from, or 0 to never retain them.
+   * @param skip_large_bulk_strings supplies whether top level bulk strings that retain their bytes
+   *        are only held as bytes until they are read. The proxy uses it for upstream responses,
+   *        which are mostly forwarded as is.
+   */
+  DecoderFactoryImpl(uint64_t passthrough_threshold = 0, bool skip_large_bulk_strings = false)
+      : passthrough_threshold_(passthrough_threshold),
+        skip_large_bulk_strings_(skip_large_bulk_strings) {}
+
   // RedisProxy::DecoderFactory
   DecoderPtr create(DecoderCallbacks& callbacks) override {
-    return DecoderPtr{new DecoderImpl(callbacks)};
+    return DecoderPtr{
+        new DecoderImpl(callbacks, passthrough_threshold_, skip_large_bulk_strings_)};
   }
+
+  // The passthrough threshold used by the proxy. Smaller values are cheaper to encode again than
+  // to keep the bytes of, as their bytes usually share slices with other values.
+  static const uint64_t DEFAULT_PASSTHROUGH_THRESHOLD = 16 * 1024;
+
+private:
+  const uint64_t passthrough_threshold_;
+  const bool skip_large_bulk_strings_;
 };
 
 /**
@@ -84,6 +140,7 @@ public:
   void encode(const RespValue& value, Buffer::Instance& out) override;
 
 private:
+  void encodeRaw(const std::shared_ptr<const Buffer::Instance>& raw, Buffer::Instance& out);
   void encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out);
   void encodeBulkString(const std::string& string, Buffer::Instance& out);
   void encodeError(const std::string& string, Buffer::Instance& out);
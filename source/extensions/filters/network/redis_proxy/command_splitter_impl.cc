@@ -1,8 +1,10 @@
 #include "extensions/filters/network/redis_proxy/command_splitter_impl.h"
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "envoy/stats/scope.h"
@@ -105,52 +107,84 @@ void FragmentedRequest::onChildFailure(uint32_t index) {
   onChildResponse(Utility::makeError("upstream failure"), index);
 }
 
+void FragmentedRequest::makeFragmentedRequests(ConnPool::Instance& conn_pool,
+                                               const RespValue& incoming_request,
+                                               uint32_t args_per_key) {
+  const std::vector<RespValue>& args = incoming_request.asArray();
+
+  // Group the keys by host and hash slot, in the order in which the groups are first seen. Keys
+  // without a host are grouped too, and their fragment fails as a whole.
+  std::vector<Upstream::HostConstSharedPtr> hosts;
+  std::vector<std::vector<uint32_t>> key_indexes;
+  std::map<std::pair<Upstream::HostConstSharedPtr, uint16_t>, uint32_t> fragment_indexes;
+  for (uint32_t key_index = 0; 1 + key_index * args_per_key < args.size(); key_index++) {
+    const std::string& key = args[1 + key_index * args_per_key].asString();
+    Upstream::HostConstSharedPtr host = conn_pool.chooseHost(key);
+    auto fragment =
+        fragment_indexes.emplace(std::make_pair(host, conn_pool.keySlot(key)), hosts.size());
+    if (fragment.second) {
+      hosts.push_back(host);
+      key_indexes.emplace_back();
+    }
+    key_indexes[fragment.first->second].push_back(key_index);
+  }
+
+  num_pending_responses_ = hosts.size();
+  pending_requests_.reserve(hosts.size());
+  for (uint32_t i = 0; i < hosts.size(); i++) {
+    pending_requests_.emplace_back(*this, i);
+    pending_requests_.back().key_indexes_.swap(key_indexes[i]);
+  }
+
+  for (PendingRequest& pending_request : pending_requests_) {
+    const Upstream::HostConstSharedPtr& host = hosts[pending_request.index_];
+    if (host) {
+      // All the arguments have been checked to be bulk strings.
+      std::vector<RespValue> values(1 + pending_request.key_indexes_.size() * args_per_key);
+      for (RespValue& value : values) {
+        value.type(RespType::BulkString);
+      }
+      values[0].asString() = args[0].asString();
+      uint32_t value_index = 1;
+      for (uint32_t key_index : pending_request.key_indexes_) {
+        for (uint32_t i = 0; i < args_per_key; i++) {
+          values[value_index++].asString() = args[1 + key_index * args_per_key + i].asString();
+        }
+      }
+      RespValue fragment;
+      fragment.type(RespType::Array);
+      fragment.asArray().swap(values);
+
+      ENVOY_LOG(debug, "redis: parallel {}: '{}'", args[0].asString(), fragment.toString());
+      pending_request.handle_ = conn_pool.makeRequestToHost(host, fragment, pending_request);
+    }
+    if (!pending_request.handle_) {
+      pending_request.onResponse(Utility::makeError("no upstream host"));
+    }
+  }
+}
+
 SplitRequestPtr MGETRequest::create(ConnPool::Instance& conn_pool,
                                     const RespValue& incoming_request, SplitCallbacks& callbacks) {
   std::unique_ptr<MGETRequest> request_ptr{new MGETRequest(callbacks)};
 
-  request_ptr->num_pending_responses_ = incoming_request.asArray().size() - 1;
-  request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
-
   request_ptr->pending_response_.reset(new RespValue());
   request_ptr->pending_response_->type(RespType::Array);
-  std::vector<RespValue> responses(request_ptr->num_pending_responses_);
+  std::vector<RespValue> responses(incoming_request.asArray().size() - 1);
   request_ptr->pending_response_->asArray().swap(responses);
 
-  std::vector<RespValue> values(2);
-  values[0].type(RespType::BulkString);
-  values[0].asString() = "get";
-  values[1].type(RespType::BulkString);
-  RespValue single_mget;
-  single_mget.type(RespType::Array);
-  single_mget.asArray().swap(values);
-
-  for (uint64_t i = 1; i < incoming_request.asArray().size(); i++) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, i - 1);
-    PendingRequest& pending_request = request_ptr->pending_requests_.back();
-
-    single_mget.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    ENVOY_LOG(debug, "redis: parallel get: '{}'", single_mget.toString());
-    pending_request.handle_ = conn_pool.makeRequest(incoming_request.asArray()[i].asString(),
-                                                    single_mget, pending_request);
-    if (!pending_request.handle_) {
-      pending_request.onResponse(Utility::makeError("no upstream host"));
-    }
-  }
-
+  request_ptr->makeFragmentedRequests(conn_pool, incoming_request, 1);
   return request_ptr->num_pending_responses_ > 0 ? std::move(request_ptr) : nullptr;
 }
 
-void MGETRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
-  pending_requests_[index].handle_ = nullptr;
-
-  pending_response_->asArray()[index].type(value->type());
-  switch (value->type()) {
+void MGETRequest::setResult(RespValue& result, RespValue& value) {
+  result.type(value.type());
+  switch (value.type()) {
   case RespType::Array:
   case RespType::Integer:
   case RespType::SimpleString: {
-    pending_response_->asArray()[index].type(RespType::Error);
-    pending_response_->asArray()[index].asString() = "upstream protocol error";
+    result.type(RespType::Error);
+    result.asString() = "upstream protocol error";
     error_count_++;
     break;
   }
@@ -159,12 +193,35 @@ void MGETRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
     FALLTHRU;
   }
   case RespType::BulkString: {
-    pending_response_->asArray()[index].asString().swap(value->asString());
+    result.asString().swap(value.asString());
     break;
   }
   case RespType::Null:
     break;
   }
+}
+
+void MGETRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
+  PendingRequest& pending_request = pending_requests_[index];
+  pending_request.handle_ = nullptr;
+
+  // The results of an MGET are in the order of its keys. A failure of the whole fragment becomes
+  // the result of each of its keys.
+  std::vector<RespValue>& results = pending_response_->asArray();
+  const std::vector<uint32_t>& key_indexes = pending_request.key_indexes_;
+  if (value->type() == RespType::Array && value->asArray().size() == key_indexes.size()) {
+    for (uint32_t i = 0; i < key_indexes.size(); i++) {
+      setResult(results[key_indexes[i]], value->asArray()[i]);
+    }
+  } else {
+    const std::string error =
+        value->type() == RespType::Error ? value->asString() : "upstream protocol error";
+    for (uint32_t key_index : key_indexes) {
+      results[key_index].type(RespType::Error);
+      results[key_index].asString() = error;
+      error_count_++;
+    }
+  }
 
   ASSERT(num_pending_responses_ > 0);
   if (--num_pending_responses_ == 0) {
@@ -182,54 +239,20 @@ SplitRequestPtr MSETRequest::create(ConnPool::Instance& conn_pool,
 
   std::unique_ptr<MSETRequest> request_ptr{new MSETRequest(callbacks)};
 
-  request_ptr->num_pending_responses_ = (incoming_request.asArray().size() - 1) / 2;
-  request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
-
   request_ptr->pending_response_.reset(new RespValue());
   request_ptr->pending_response_->type(RespType::SimpleString);
 
-  std::vector<RespValue> values(3);
-  values[0].type(RespType::BulkString);
-  values[0].asString() = "set";
-  values[1].type(RespType::BulkString);
-  values[2].type(RespType::BulkString);
-  RespValue single_mset;
-  single_mset.type(RespType::Array);
-  single_mset.asArray().swap(values);
-
-  uint64_t fragment_index = 0;
-  for (uint64_t i = 1; i < incoming_request.asArray().size(); i += 2) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, fragment_index++);
-    PendingRequest& pending_request = request_ptr->pending_requests_.back();
-
-    single_mset.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    single_mset.asArray()[2].asString() = incoming_request.asArray()[i + 1].asString();
-
-    ENVOY_LOG(debug, "redis: parallel set: '{}'", single_mset.toString());
-    pending_request.handle_ = conn_pool.makeRequest(incoming_request.asArray()[i].asString(),
-                                                    single_mset, pending_request);
-    if (!pending_request.handle_) {
-      pending_request.onResponse(Utility::makeError("no upstream host"));
-    }
-  }
-
+  request_ptr->makeFragmentedRequests(conn_pool, incoming_request, 2);
   return request_ptr->num_pending_responses_ > 0 ? std::move(request_ptr) : nullptr;
 }
 
 void MSETRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
-  pending_requests_[index].handle_ = nullptr;
+  PendingRequest& pending_request = pending_requests_[index];
+  pending_request.handle_ = nullptr;
 
-  switch (value->type()) {
-  case RespType::SimpleString: {
-    if (value->asString() == "OK") {
-      break;
-    }
-    FALLTHRU;
-  }
-  default: {
-    error_count_++;
-    break;
-  }
+  // Errors are counted per key, as if each key had been set separately.
+  if (value->type() != RespType::SimpleString || value->asString() != "OK") {
+    error_count_ += pending_request.key_indexes_.size();
   }
 
   ASSERT(num_pending_responses_ > 0);
@@ -249,49 +272,22 @@ SplitRequestPtr SplitKeysSumResultRequest::create(ConnPool::Instance& conn_pool,
                                                   SplitCallbacks& callbacks) {
   std::unique_ptr<SplitKeysSumResultRequest> request_ptr{new SplitKeysSumResultRequest(callbacks)};
 
-  request_ptr->num_pending_responses_ = incoming_request.asArray().size() - 1;
-  request_ptr->pending_requests_.reserve(request_ptr->num_pending_responses_);
-
   request_ptr->pending_response_.reset(new RespValue());
   request_ptr->pending_response_->type(RespType::Integer);
 
-  std::vector<RespValue> values(2);
-  values[0].type(RespType::BulkString);
-  values[0].asString() = incoming_request.asArray()[0].asString();
-  values[1].type(RespType::BulkString);
-  RespValue single_fragment;
-  single_fragment.type(RespType::Array);
-  single_fragment.asArray().swap(values);
-
-  for (uint64_t i = 1; i < incoming_request.asArray().size(); i++) {
-    request_ptr->pending_requests_.emplace_back(*request_ptr, i - 1);
-    PendingRequest& pending_request = request_ptr->pending_requests_.back();
-
-    single_fragment.asArray()[1].asString() = incoming_request.asArray()[i].asString();
-    ENVOY_LOG(debug, "redis: parallel {}: '{}'", incoming_request.asArray()[0].asString(),
-              single_fragment.toString());
-    pending_request.handle_ = conn_pool.makeRequest(incoming_request.asArray()[i].asString(),
-                                                    single_fragment, pending_request);
-    if (!pending_request.handle_) {
-      pending_request.onResponse(Utility::makeError("no upstream host"));
-    }
-  }
-
+  request_ptr->makeFragmentedRequests(conn_pool, incoming_request, 1);
   return request_ptr->num_pending_responses_ > 0 ? std::move(request_ptr) : nullptr;
 }
 
 void SplitKeysSumResultRequest::onChildResponse(RespValuePtr&& value, uint32_t index) {
-  pending_requests_[index].handle_ = nullptr;
+  PendingRequest& pending_request = pending_requests_[index];
+  pending_request.handle_ = nullptr;
 
-  switch (value->type()) {
-  case RespType::Integer: {
+  // Errors are counted per key, as if each key had been sent separately.
+  if (value->type() == RespType::Integer) {
     total_ += value->asInteger();
-    break;
-  }
-  default: {
-    error_count_++;
-    break;
-  }
+  } else {
+    error_count_ += pending_request.key_indexes_.size();
   }
 
   ASSERT(num_pending_responses_ > 0);
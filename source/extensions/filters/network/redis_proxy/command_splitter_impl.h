@@ -89,11 +89,11 @@ private:
 };
 
 /**
- * FragmentedRequest is a base class for requests that contains multiple keys. An individual request
- * is sent to the appropriate server for each key. The responses from all servers are combined and
- * returned to the client.
+ * FragmentedRequest is a base class for requests that contains multiple keys. The keys are grouped
+ * by the server that they hash to, and each server is sent a single command with all of its keys.
+ * The responses from all servers are combined and returned to the client.
  */
-class FragmentedRequest : public SplitRequestBase {
+class FragmentedRequest : public SplitRequestBase, protected Logger::Loggable<Logger::Id::redis> {
 public:
   ~FragmentedRequest();
 
@@ -114,9 +114,21 @@ protected:
 
     FragmentedRequest& parent_;
     const uint32_t index_;
+    // The positions, among the keys of the incoming request, of the keys sent in this fragment.
+    std::vector<uint32_t> key_indexes_;
     ConnPool::PoolRequest* handle_{};
   };
 
+  /**
+   * Sends the fragments of an incoming request, one per server.
+   * @param conn_pool supplies the connection pool to choose servers and send fragments with.
+   * @param incoming_request supplies the request. Each fragment is a command with the same name.
+   * @param args_per_key supplies the number of arguments of the request that go with each key,
+   *        including the key itself.
+   */
+  void makeFragmentedRequests(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
+                              uint32_t args_per_key);
+
   virtual void onChildResponse(RespValuePtr&& value, uint32_t index) PURE;
   void onChildFailure(uint32_t index);
 
@@ -128,10 +140,10 @@ protected:
 };
 
 /**
- * MGETRequest takes each key from the command and sends a GET for each to the appropriate Redis
- * server. The response contains the result from each command.
+ * MGETRequest sends an MGET with the keys of the command that hash to each Redis server. The
+ * response contains the result for each key, in the order of the keys in the command.
  */
-class MGETRequest : public FragmentedRequest, Logger::Loggable<Logger::Id::redis> {
+class MGETRequest : public FragmentedRequest {
 public:
   static SplitRequestPtr create(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
                                 SplitCallbacks& callbacks);
@@ -139,17 +151,19 @@ public:
 private:
   MGETRequest(SplitCallbacks& callbacks) : FragmentedRequest(callbacks) {}
 
+  void setResult(RespValue& result, RespValue& value);
+
   // RedisProxy::CommandSplitter::FragmentedRequest
   void onChildResponse(RespValuePtr&& value, uint32_t index) override;
 };
 
 /**
- * SplitKeysSumResultRequest takes each key from the command and sends the same incoming command
- * with each key to the appropriate Redis server. The response from each Redis (which must be an
- * integer) is summed and returned to the user. If there is any error or failure in processing the
- * fragmented commands, an error will be returned.
+ * SplitKeysSumResultRequest sends the incoming command with the keys that hash to each Redis
+ * server. The response from each Redis (which must be an integer) is summed and returned to the
+ * user. If there is any error or failure in processing the fragmented commands, an error will be
+ * returned.
  */
-class SplitKeysSumResultRequest : public FragmentedRequest, Logger::Loggable<Logger::Id::redis> {
+class SplitKeysSumResultRequest : public FragmentedRequest {
 public:
   static SplitRequestPtr create(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
                                 SplitCallbacks& callbacks);
@@ -164,11 +178,10 @@ private:
 };
 
 /**
- * MSETRequest takes each key and value pair from the command and sends a SET for each to the
- * appropriate Redis server. The response is an OK if all commands succeeded or an ERR if any
- * failed.
+ * MSETRequest sends an MSET with the key and value pairs of the command that hash to each Redis
+ * server. The response is an OK if all commands succeeded or an ERR if any failed.
  */
-class MSETRequest : public FragmentedRequest, Logger::Loggable<Logger::Id::redis> {
+class MSETRequest : public FragmentedRequest {
 public:
   static SplitRequestPtr create(ConnPool::Instance& conn_pool, const RespValue& incoming_request,
                                 SplitCallbacks& callbacks);
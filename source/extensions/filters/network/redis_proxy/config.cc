@@ -35,7 +35,7 @@ Network::FilterFactoryCb RedisProxyFilterConfigFactory::createFilterFactoryFromP
   std::shared_ptr<CommandSplitter::Instance> splitter(new CommandSplitter::InstanceImpl(
       std::move(conn_pool), context.scope(), filter_config->stat_prefix_));
   return [splitter, filter_config](Network::FilterManager& filter_manager) -> void {
-    DecoderFactoryImpl factory;
+    DecoderFactoryImpl factory(DecoderFactoryImpl::DEFAULT_PASSTHROUGH_THRESHOLD);
     filter_manager.addReadFilter(std::make_shared<ProxyFilter>(
         factory, EncoderPtr{new EncoderImpl()}, *splitter, filter_config));
   };
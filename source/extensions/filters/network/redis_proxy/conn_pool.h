@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -94,6 +95,19 @@ public:
    * passive healthcheck operations.
    */
   virtual bool disableOutlierEvents() const PURE;
+
+  /**
+   * @return uint32_t the size in bytes that the encoded requests buffered for a client connection
+   *         can reach before they are written to it. 0 disables buffering, i.e. each request is
+   *         written as soon as it is made.
+   */
+  virtual uint32_t maxBufferSizeBeforeFlush() const PURE;
+
+  /**
+   * @return std::chrono::milliseconds how long buffered requests wait for more requests before
+   *         they are written. 0 writes them on the next iteration of the dispatcher.
+   */
+  virtual std::chrono::milliseconds bufferFlushTimeoutInMs() const PURE;
 };
 
 /**
@@ -132,6 +146,33 @@ public:
    */
   virtual PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                                    PoolCallbacks& callbacks) PURE;
+
+  /**
+   * Chooses the upstream host for a key, so that requests for several keys can be grouped by the
+   * host that serves them.
+   * @param hash_key supplies the key to use for consistent hashing.
+   * @return Upstream::HostConstSharedPtr the chosen host or nullptr if there is none.
+   */
+  virtual Upstream::HostConstSharedPtr chooseHost(const std::string& hash_key) PURE;
+
+  /**
+   * Gets the Redis Cluster hash slot of a key. Keys of different slots can't be sent in a single
+   * multi-key command, even to the same host.
+   * @param hash_key supplies the key.
+   * @return uint16_t the hash slot of the key if the pool routes by hash slot, 0 otherwise.
+   */
+  virtual uint16_t keySlot(const std::string& hash_key) PURE;
+
+  /**
+   * Makes a redis request to a host previously returned by chooseHost().
+   * @param host supplies the host to send the request to.
+   * @param request supplies the request to make.
+   * @param callbacks supplies the request completion callbacks.
+   * @return PoolRequest* a handle to the active request or nullptr if the request could not be made
+   *         for some reason.
+   */
+  virtual PoolRequest* makeRequestToHost(const Upstream::HostConstSharedPtr& host,
+                                         const RespValue& request, PoolCallbacks& callbacks) PURE;
 };
 
 typedef std::unique_ptr<Instance> InstancePtr;
@@ -1,11 +1,13 @@
 #include "extensions/filters/network/redis_proxy/conn_pool_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "common/common/assert.h"
+#include "common/upstream/upstream_impl.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -15,7 +17,9 @@ namespace ConnPool {
 
 ConfigImpl::ConfigImpl(
     const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings& config)
-    : op_timeout_(PROTOBUF_GET_MS_REQUIRED(config, op_timeout)) {}
+    : op_timeout_(PROTOBUF_GET_MS_REQUIRED(config, op_timeout)),
+      max_buffer_size_before_flush_(config.max_buffer_size_before_flush()),
+      buffer_flush_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, buffer_flush_timeout, 0)) {}
 
 ClientPtr ClientImpl::create(Upstream::HostConstSharedPtr host, Event::Dispatcher& dispatcher,
                              EncoderPtr&& encoder, DecoderFactory& decoder_factory,
@@ -35,6 +39,11 @@ ClientImpl::ClientImpl(Upstream::HostConstSharedPtr host, Event::Dispatcher& dis
                        EncoderPtr&& encoder, DecoderFactory& decoder_factory, const Config& config)
     : host_(host), encoder_(std::move(encoder)), decoder_(decoder_factory.create(*this)),
       config_(config),
+      stats_{ALL_REDIS_CLIENT_STATS(POOL_COUNTER_PREFIX(host->cluster().statsScope(), "redis."),
+                                    POOL_HISTOGRAM_PREFIX(host->cluster().statsScope(), "redis."))},
+      flush_timer_(config.maxBufferSizeBeforeFlush() > 0
+                       ? dispatcher.createTimer([this]() -> void { flushBufferAndResetTimer(); })
+                       : nullptr),
       connect_or_op_timer_(dispatcher.createTimer([this]() -> void { onConnectOrOpTimeout(); })) {
   host->cluster().stats().upstream_cx_total_.inc();
   host->stats().cx_total_.inc();
@@ -56,8 +65,24 @@ PoolRequest* ClientImpl::makeRequest(const RespValue& request, PoolCallbacks& ca
   ASSERT(connection_->state() == Network::Connection::State::Open);
 
   pending_requests_.emplace_back(*this, callbacks);
-  encoder_->encode(request, encoder_buffer_);
-  connection_->write(encoder_buffer_, false);
+  if (flush_timer_ == nullptr) {
+    // Buffering is disabled, so every request is written right away.
+    encoder_->encode(request, encoder_buffer_);
+    connection_->write(encoder_buffer_, false);
+  } else {
+    const bool empty_buffer = requests_in_buffer_ == 0;
+    encoder_->encode(request, encoder_buffer_);
+    requests_in_buffer_++;
+
+    // Requests are written right away if the buffer is full. Otherwise the first request in the
+    // buffer arms the flush timer, so that the requests pipelined until it fires share a single
+    // write.
+    if (encoder_buffer_.length() >= config_.maxBufferSizeBeforeFlush()) {
+      flushBufferAndResetTimer();
+    } else if (empty_buffer) {
+      flush_timer_->enableTimer(config_.bufferFlushTimeoutInMs());
+    }
+  }
 
   // Only boost the op timeout if:
   // - We are not already connected. Otherwise, we are governed by the connect timeout and the timer
@@ -72,6 +97,20 @@ PoolRequest* ClientImpl::makeRequest(const RespValue& request, PoolCallbacks& ca
   return &pending_requests_.back();
 }
 
+void ClientImpl::flushBufferAndResetTimer() {
+  if (flush_timer_ != nullptr) {
+    flush_timer_->disableTimer();
+  }
+  if (requests_in_buffer_ == 0) {
+    return;
+  }
+
+  stats_.upstream_flush_total_.inc();
+  stats_.upstream_flush_batch_size_.recordValue(requests_in_buffer_);
+  requests_in_buffer_ = 0;
+  connection_->write(encoder_buffer_, false);
+}
+
 void ClientImpl::onConnectOrOpTimeout() {
   putOutlierEvent(Upstream::Outlier::Result::TIMEOUT);
   if (connected_) {
@@ -126,6 +165,10 @@ void ClientImpl::onEvent(Network::ConnectionEvent event) {
       pending_requests_.pop_front();
     }
 
+    // Buffered requests have just been failed, so there is nothing left to flush.
+    if (flush_timer_ != nullptr) {
+      flush_timer_->disableTimer();
+    }
     connect_or_op_timer_->disableTimer();
   } else if (event == Network::ConnectionEvent::Connected) {
     connected_ = true;
@@ -192,7 +235,22 @@ InstanceImpl::InstanceImpl(
     const std::string& cluster_name, Upstream::ClusterManager& cm, ClientFactory& client_factory,
     ThreadLocal::SlotAllocator& tls,
     const envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings& config)
-    : cm_(cm), client_factory_(client_factory), tls_(tls.allocateSlot()), config_(config) {
+    : cm_(cm), client_factory_(client_factory), tls_(tls.allocateSlot()), config_(config),
+      redis_cluster_(config.enable_redis_cluster()) {
+  std::vector<RespValue> cluster_slots(2);
+  cluster_slots[0].type(RespType::BulkString);
+  cluster_slots[0].asString() = "cluster";
+  cluster_slots[1].type(RespType::BulkString);
+  cluster_slots[1].asString() = "slots";
+  cluster_slots_request_.type(RespType::Array);
+  cluster_slots_request_.asArray().swap(cluster_slots);
+
+  std::vector<RespValue> asking(1);
+  asking[0].type(RespType::BulkString);
+  asking[0].asString() = "asking";
+  asking_request_.type(RespType::Array);
+  asking_request_.asArray().swap(asking);
+
   tls_->set([this, cluster_name](
                 Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<ThreadLocalPool>(*this, dispatcher, cluster_name);
@@ -204,6 +262,19 @@ PoolRequest* InstanceImpl::makeRequest(const std::string& hash_key, const RespVa
   return tls_->getTyped<ThreadLocalPool>().makeRequest(hash_key, value, callbacks);
 }
 
+Upstream::HostConstSharedPtr InstanceImpl::chooseHost(const std::string& hash_key) {
+  return tls_->getTyped<ThreadLocalPool>().chooseHost(hash_key);
+}
+
+uint16_t InstanceImpl::keySlot(const std::string& hash_key) {
+  return redis_cluster_ ? ClusterSlots::keySlot(hash_key) : 0;
+}
+
+PoolRequest* InstanceImpl::makeRequestToHost(const Upstream::HostConstSharedPtr& host,
+                                             const RespValue& request, PoolCallbacks& callbacks) {
+  return tls_->getTyped<ThreadLocalPool>().makeRequestToHost(host, request, callbacks);
+}
+
 InstanceImpl::ThreadLocalPool::ThreadLocalPool(InstanceImpl& parent, Event::Dispatcher& dispatcher,
                                                const std::string& cluster_name)
     : parent_(parent), dispatcher_(dispatcher), cluster_(parent_.cm_.get(cluster_name)) {
@@ -213,10 +284,18 @@ InstanceImpl::ThreadLocalPool::ThreadLocalPool(InstanceImpl& parent, Event::Disp
   //                     safely clean things up and fail requests.
   ASSERT(!cluster_->info()->addedViaApi());
   local_host_set_member_update_cb_handle_ = cluster_->prioritySet().addMemberUpdateCb(
-      [this](uint32_t, const std::vector<Upstream::HostSharedPtr>&,
+      [this](uint32_t, const std::vector<Upstream::HostSharedPtr>& hosts_added,
              const std::vector<Upstream::HostSharedPtr>& hosts_removed) -> void {
         onHostsRemoved(hosts_removed);
+        if (parent_.redis_cluster_ && (!hosts_added.empty() || !hosts_removed.empty())) {
+          // The topology of the Redis Cluster may have changed along with the cluster's hosts.
+          refreshSlots();
+        }
       });
+
+  if (parent_.redis_cluster_) {
+    refreshSlots();
+  }
 }
 
 InstanceImpl::ThreadLocalPool::~ThreadLocalPool() {
@@ -241,12 +320,61 @@ void InstanceImpl::ThreadLocalPool::onHostsRemoved(
 PoolRequest* InstanceImpl::ThreadLocalPool::makeRequest(const std::string& hash_key,
                                                         const RespValue& request,
                                                         PoolCallbacks& callbacks) {
-  LbContextImpl lb_context(hash_key);
-  Upstream::HostConstSharedPtr host = cluster_->loadBalancer().chooseHost(&lb_context);
+  Upstream::HostConstSharedPtr host = chooseHost(hash_key);
   if (!host) {
     return nullptr;
   }
 
+  return makeRequestToHost(host, request, callbacks);
+}
+
+Upstream::HostConstSharedPtr
+InstanceImpl::ThreadLocalPool::chooseHost(const std::string& hash_key) {
+  if (parent_.redis_cluster_ && !slots_.empty()) {
+    Upstream::HostConstSharedPtr host = slots_[ClusterSlots::keySlot(hash_key)];
+    if (host) {
+      return host;
+    }
+  }
+
+  // In Redis Cluster mode, a host that doesn't serve the slot redirects the request to the one
+  // that does, which also refreshes the slot map.
+  LbContextImpl lb_context(hash_key);
+  return cluster_->loadBalancer().chooseHost(&lb_context);
+}
+
+PoolRequest*
+InstanceImpl::ThreadLocalPool::makeRequestToHost(const Upstream::HostConstSharedPtr& host,
+                                                 const RespValue& request,
+                                                 PoolCallbacks& callbacks) {
+  if (!parent_.redis_cluster_) {
+    return makeClientRequest(host, request, callbacks);
+  }
+
+  // The request is encoded once so that redirections send the same bytes again rather than a copy
+  // of the request. Values that the decoder retained the bytes of aren't encoded at all.
+  std::shared_ptr<const Buffer::Instance> raw = request.raw();
+  if (!raw) {
+    std::shared_ptr<Buffer::OwnedImpl> encoded = std::make_shared<Buffer::OwnedImpl>();
+    encoder_.encode(request, *encoded);
+    raw = std::move(encoded);
+  }
+  RedirectingRequestPtr redirecting_request(
+      new RedirectingRequest(*this, std::move(raw), callbacks));
+  redirecting_request->handle_ =
+      makeClientRequest(host, redirecting_request->request_, *redirecting_request);
+  if (!redirecting_request->handle_) {
+    return nullptr;
+  }
+
+  redirecting_request->moveIntoList(std::move(redirecting_request), redirecting_requests_);
+  return redirecting_requests_.front().get();
+}
+
+PoolRequest*
+InstanceImpl::ThreadLocalPool::makeClientRequest(const Upstream::HostConstSharedPtr& host,
+                                                 const RespValue& request,
+                                                 PoolCallbacks& callbacks) {
   ThreadLocalActiveClientPtr& client = client_map_[host];
   if (!client) {
     client.reset(new ThreadLocalActiveClient(*this));
@@ -258,6 +386,149 @@ PoolRequest* InstanceImpl::ThreadLocalPool::makeRequest(const std::string& hash_
   return client->redis_client_->makeRequest(request, callbacks);
 }
 
+void InstanceImpl::ThreadLocalPool::refreshSlots() {
+  if (cluster_slots_handle_ != nullptr) {
+    return;
+  }
+
+  // Any host of the cluster can serve the slot map of the whole Redis Cluster.
+  Upstream::HostConstSharedPtr host = cluster_->loadBalancer().chooseHost(nullptr);
+  if (!host) {
+    return;
+  }
+
+  cluster_slots_handle_ =
+      makeClientRequest(host, parent_.cluster_slots_request_, cluster_slots_callbacks_);
+}
+
+void InstanceImpl::ThreadLocalPool::onClusterSlots(const RespValue& value) {
+  std::vector<ClusterSlot> slots;
+  if (!ClusterSlots::parseClusterSlots(value, slots)) {
+    return;
+  }
+
+  // Hosts which are already known keep their connections across refreshes.
+  std::unordered_map<std::string, Upstream::HostConstSharedPtr> slot_hosts;
+  std::vector<Upstream::HostConstSharedPtr> slot_map(ClusterSlots::NUM_SLOTS);
+  for (const ClusterSlot& slot : slots) {
+    Upstream::HostConstSharedPtr& host = slot_hosts[slot.master_->asString()];
+    if (!host) {
+      host = findOrCreateHost(slot.master_);
+    }
+    std::fill(slot_map.begin() + slot.start_, slot_map.begin() + slot.end_ + 1, host);
+  }
+
+  // Close the connections to the hosts which aren't part of the cluster and no longer serve any
+  // slot. The connections to the cluster's hosts are closed when they are removed.
+  for (const auto& slot_host : slot_hosts_) {
+    auto it = slot_hosts.find(slot_host.first);
+    if ((it == slot_hosts.end() || it->second != slot_host.second) &&
+        clusterHost(slot_host.first) != slot_host.second) {
+      auto client = client_map_.find(slot_host.second);
+      if (client != client_map_.end()) {
+        client->second->redis_client_->close();
+      }
+    }
+  }
+
+  slot_hosts_.swap(slot_hosts);
+  slots_.swap(slot_map);
+}
+
+Upstream::HostConstSharedPtr InstanceImpl::ThreadLocalPool::slotHost(
+    const Network::Address::InstanceConstSharedPtr& address) {
+  const std::string address_string = address->asString();
+  auto it = slot_hosts_.find(address_string);
+  if (it != slot_hosts_.end()) {
+    return it->second;
+  }
+
+  Upstream::HostConstSharedPtr host = findOrCreateHost(address);
+  slot_hosts_.emplace(address_string, host);
+  return host;
+}
+
+Upstream::HostConstSharedPtr InstanceImpl::ThreadLocalPool::findOrCreateHost(
+    const Network::Address::InstanceConstSharedPtr& address) {
+  // Use the host of the cluster with the same address if there is one, so that its health and
+  // outlier detection status apply. Otherwise the node isn't known to the cluster, e.g. because
+  // the cluster only lists a few seed nodes of the Redis Cluster.
+  const std::string address_string = address->asString();
+  Upstream::HostConstSharedPtr host = clusterHost(address_string);
+  if (host) {
+    return host;
+  }
+
+  auto it = slot_hosts_.find(address_string);
+  if (it != slot_hosts_.end()) {
+    return it->second;
+  }
+
+  return std::make_shared<Upstream::HostImpl>(
+      cluster_->info(), "", address, envoy::api::v2::core::Metadata::default_instance(), 1,
+      envoy::api::v2::core::Locality::default_instance(),
+      envoy::api::v2::endpoint::Endpoint::HealthCheckConfig::default_instance());
+}
+
+Upstream::HostConstSharedPtr
+InstanceImpl::ThreadLocalPool::clusterHost(const std::string& address) {
+  for (const auto& host_set : cluster_->prioritySet().hostSetsPerPriority()) {
+    for (const Upstream::HostSharedPtr& host : host_set->hosts()) {
+      if (host->address()->asString() == address) {
+        return host;
+      }
+    }
+  }
+  return nullptr;
+}
+
+void InstanceImpl::ClusterSlotsCallbacks::onResponse(RespValuePtr&& value) {
+  parent_.cluster_slots_handle_ = nullptr;
+  parent_.onClusterSlots(*value);
+}
+
+void InstanceImpl::ClusterSlotsCallbacks::onFailure() { parent_.cluster_slots_handle_ = nullptr; }
+
+void InstanceImpl::RedirectingRequest::cancel() {
+  handle_->cancel();
+  handle_ = nullptr;
+  removeFromList(parent_.redirecting_requests_);
+}
+
+void InstanceImpl::RedirectingRequest::onResponse(RespValuePtr&& value) {
+  handle_ = nullptr;
+  ClusterRedirection redirection;
+  if (num_redirections_ < MAX_REDIRECTIONS &&
+      ClusterSlots::parseRedirection(*value, redirection)) {
+    num_redirections_++;
+    Upstream::HostConstSharedPtr host = parent_.slotHost(redirection.address_);
+    if (redirection.ask_) {
+      // The slot is being migrated, and only this request is redirected.
+      parent_.makeClientRequest(host, parent_.parent_.asking_request_, parent_.asking_callbacks_);
+    } else {
+      // The slot has moved, which usually means that others have too.
+      if (!parent_.slots_.empty()) {
+        parent_.slots_[redirection.slot_] = host;
+      }
+      parent_.refreshSlots();
+    }
+
+    handle_ = parent_.makeClientRequest(host, request_, *this);
+    if (handle_) {
+      return;
+    }
+  }
+
+  callbacks_.onResponse(std::move(value));
+  removeFromList(parent_.redirecting_requests_);
+}
+
+void InstanceImpl::RedirectingRequest::onFailure() {
+  handle_ = nullptr;
+  callbacks_.onFailure();
+  removeFromList(parent_.redirecting_requests_);
+}
+
 void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
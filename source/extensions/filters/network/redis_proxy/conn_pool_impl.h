@@ -9,13 +9,16 @@
 #include <vector>
 
 #include "envoy/config/filter/network/redis_proxy/v2/redis_proxy.pb.h"
+#include "envoy/stats/stats_macros.h"
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/common/linked_object.h"
 #include "common/network/filter_impl.h"
 #include "common/protobuf/utility.h"
 
+#include "extensions/filters/network/redis_proxy/cluster_slots.h"
 #include "extensions/filters/network/redis_proxy/codec_impl.h"
 #include "extensions/filters/network/redis_proxy/conn_pool.h"
 
@@ -28,6 +31,22 @@ namespace ConnPool {
 // TODO(mattklein123): Circuit breaking
 // TODO(rshriram): Fault injection
 
+/**
+ * All redis client stats. @see stats_macros.h
+ */
+// clang-format off
+#define ALL_REDIS_CLIENT_STATS(COUNTER, HISTOGRAM)                                                 \
+  COUNTER(upstream_flush_total)                                                                    \
+  HISTOGRAM(upstream_flush_batch_size)
+// clang-format on
+
+/**
+ * Struct definition for all redis client stats. @see stats_macros.h
+ */
+struct RedisClientStats {
+  ALL_REDIS_CLIENT_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
+};
+
 class ConfigImpl : public Config {
 public:
   ConfigImpl(
@@ -35,9 +54,15 @@ public:
 
   bool disableOutlierEvents() const override { return false; }
   std::chrono::milliseconds opTimeout() const override { return op_timeout_; }
+  uint32_t maxBufferSizeBeforeFlush() const override { return max_buffer_size_before_flush_; }
+  std::chrono::milliseconds bufferFlushTimeoutInMs() const override {
+    return buffer_flush_timeout_;
+  }
 
 private:
   const std::chrono::milliseconds op_timeout_;
+  const uint32_t max_buffer_size_before_flush_;
+  const std::chrono::milliseconds buffer_flush_timeout_;
 };
 
 class ClientImpl : public Client, public DecoderCallbacks, public Network::ConnectionCallbacks {
@@ -84,6 +109,7 @@ private:
              DecoderFactory& decoder_factory, const Config& config);
   void onConnectOrOpTimeout();
   void onData(Buffer::Instance& data);
+  void flushBufferAndResetTimer();
   void putOutlierEvent(Upstream::Outlier::Result result);
 
   // RedisProxy::DecoderCallbacks
@@ -98,9 +124,14 @@ private:
   Network::ClientConnectionPtr connection_;
   EncoderPtr encoder_;
   Buffer::OwnedImpl encoder_buffer_;
+  // The number of requests encoded into encoder_buffer_ that haven't been written yet.
+  uint32_t requests_in_buffer_{};
   DecoderPtr decoder_;
   const Config& config_;
+  RedisClientStats stats_;
   std::list<PendingRequest> pending_requests_;
+  // Only created if requests are buffered. Must be created before connect_or_op_timer_.
+  Event::TimerPtr flush_timer_;
   Event::TimerPtr connect_or_op_timer_;
   bool connected_{};
 };
@@ -114,7 +145,8 @@ public:
   static ClientFactoryImpl instance_;
 
 private:
-  DecoderFactoryImpl decoder_factory_;
+  // Responses are mostly forwarded as is, so large bulk strings are only held as bytes.
+  DecoderFactoryImpl decoder_factory_{DecoderFactoryImpl::DEFAULT_PASSTHROUGH_THRESHOLD, true};
 };
 
 class InstanceImpl : public Instance {
@@ -127,6 +159,13 @@ public:
   // RedisProxy::ConnPool::Instance
   PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                            PoolCallbacks& callbacks) override;
+  Upstream::HostConstSharedPtr chooseHost(const std::string& hash_key) override;
+  uint16_t keySlot(const std::string& hash_key) override;
+  PoolRequest* makeRequestToHost(const Upstream::HostConstSharedPtr& host, const RespValue& request,
+                                 PoolCallbacks& callbacks) override;
+
+  // The maximum number of MOVED or ASK redirections followed for a request.
+  static const uint32_t MAX_REDIRECTIONS = 3;
 
 private:
   struct ThreadLocalPool;
@@ -146,19 +185,92 @@ private:
 
   typedef std::unique_ptr<ThreadLocalActiveClient> ThreadLocalActiveClientPtr;
 
+  /**
+   * A request made in Redis Cluster mode, which is sent again if it is redirected. Keeps a copy of
+   * the request for that purpose.
+   */
+  struct RedirectingRequest : public PoolRequest,
+                              public PoolCallbacks,
+                              public LinkedObject<RedirectingRequest> {
+    RedirectingRequest(ThreadLocalPool& parent, std::shared_ptr<const Buffer::Instance>&& request,
+                       PoolCallbacks& callbacks)
+        : parent_(parent), callbacks_(callbacks) {
+      request_.raw(std::move(request));
+    }
+
+    // RedisProxy::ConnPool::PoolRequest
+    void cancel() override;
+
+    // RedisProxy::ConnPool::PoolCallbacks
+    void onResponse(RespValuePtr&& value) override;
+    void onFailure() override;
+
+    ThreadLocalPool& parent_;
+    // Only the bytes of the request are kept, and every attempt shares them.
+    RespValue request_;
+    PoolCallbacks& callbacks_;
+    PoolRequest* handle_{};
+    uint32_t num_redirections_{};
+  };
+
+  typedef std::unique_ptr<RedirectingRequest> RedirectingRequestPtr;
+
+  /**
+   * Receives the replies to CLUSTER SLOTS.
+   */
+  struct ClusterSlotsCallbacks : public PoolCallbacks {
+    ClusterSlotsCallbacks(ThreadLocalPool& parent) : parent_(parent) {}
+
+    // RedisProxy::ConnPool::PoolCallbacks
+    void onResponse(RespValuePtr&& value) override;
+    void onFailure() override;
+
+    ThreadLocalPool& parent_;
+  };
+
+  /**
+   * Ignores the replies to ASKING, which precedes a command that is redirected with ASK.
+   */
+  struct AskingCallbacks : public PoolCallbacks {
+    // RedisProxy::ConnPool::PoolCallbacks
+    void onResponse(RespValuePtr&&) override {}
+    void onFailure() override {}
+  };
+
   struct ThreadLocalPool : public ThreadLocal::ThreadLocalObject {
     ThreadLocalPool(InstanceImpl& parent, Event::Dispatcher& dispatcher,
                     const std::string& cluster_name);
     ~ThreadLocalPool();
     PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
                              PoolCallbacks& callbacks);
+    Upstream::HostConstSharedPtr chooseHost(const std::string& hash_key);
+    PoolRequest* makeRequestToHost(const Upstream::HostConstSharedPtr& host,
+                                   const RespValue& request, PoolCallbacks& callbacks);
+    PoolRequest* makeClientRequest(const Upstream::HostConstSharedPtr& host,
+                                   const RespValue& request, PoolCallbacks& callbacks);
     void onHostsRemoved(const std::vector<Upstream::HostSharedPtr>& hosts_removed);
+    void refreshSlots();
+    void onClusterSlots(const RespValue& value);
+    Upstream::HostConstSharedPtr slotHost(const Network::Address::InstanceConstSharedPtr& address);
+    Upstream::HostConstSharedPtr
+    findOrCreateHost(const Network::Address::InstanceConstSharedPtr& address);
+    Upstream::HostConstSharedPtr clusterHost(const std::string& address);
 
     InstanceImpl& parent_;
     Event::Dispatcher& dispatcher_;
     Upstream::ThreadLocalCluster* cluster_;
     std::unordered_map<Upstream::HostConstSharedPtr, ThreadLocalActiveClientPtr> client_map_;
     Envoy::Common::CallbackHandle* local_host_set_member_update_cb_handle_;
+
+    // Redis Cluster mode state. The host of each slot, which is empty until the slot map has been
+    // discovered, and the hosts of the slot map by address.
+    std::vector<Upstream::HostConstSharedPtr> slots_;
+    std::unordered_map<std::string, Upstream::HostConstSharedPtr> slot_hosts_;
+    EncoderImpl encoder_;
+    ClusterSlotsCallbacks cluster_slots_callbacks_{*this};
+    PoolRequest* cluster_slots_handle_{};
+    AskingCallbacks asking_callbacks_;
+    std::list<RedirectingRequestPtr> redirecting_requests_;
   };
 
   struct LbContextImpl : public Upstream::LoadBalancerContext {
@@ -177,6 +289,9 @@ private:
   ClientFactory& client_factory_;
   ThreadLocal::SlotPtr tls_;
   ConfigImpl config_;
+  const bool redis_cluster_;
+  RespValue cluster_slots_request_;
+  RespValue asking_request_;
 };
 
 } // namespace ConnPool
@@ -53,6 +53,7 @@ public:
   ThriftFilters::FilterChainFactory& filterFactory() override { return *this; }
   DecoderPtr createDecoder(DecoderCallbacks& callbacks) override;
   Router::Config& routerConfig() override { return *this; }
+  bool payloadPassthrough() const override { return payload_passthrough_; }
 
 private:
   TransportPtr createTransport();
@@ -64,6 +65,7 @@ private:
   envoy::config::filter::network::thrift_proxy::v2alpha1::ThriftProxy_TransportType transport_;
   envoy::config::filter::network::thrift_proxy::v2alpha1::ThriftProxy_ProtocolType proto_;
   std::unique_ptr<Router::RouteMatcher> route_matcher_;
+  const bool payload_passthrough_;
 
   std::list<ThriftFilters::FilterFactoryCb> filter_factories_;
 };
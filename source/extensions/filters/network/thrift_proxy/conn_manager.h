@@ -33,6 +33,11 @@ public:
   virtual ThriftFilterStats& stats() PURE;
   virtual DecoderPtr createDecoder(DecoderCallbacks& callbacks) PURE;
   virtual Router::Config& routerConfig() PURE;
+
+  /**
+   * @return bool whether the bodies of framed requests are forwarded without being decoded.
+   */
+  virtual bool payloadPassthrough() const PURE;
 };
 
 /**
@@ -88,6 +93,8 @@ private:
       return ThriftFilters::FilterStatus::Continue;
     }
     ThriftFilters::FilterStatus transportEnd() override;
+    // Replies are fully decoded to find out whether they're successful.
+    bool passthroughEnabled() const override { return false; }
 
     // DecoderCallbacks
     ThriftFilters::DecoderFilter& newDecoderFilter() override { return *this; }
@@ -137,6 +144,12 @@ private:
       return decoder_filter_->messageBegin(metadata);
     }
     ThriftFilters::FilterStatus messageEnd() override { return decoder_filter_->messageEnd(); }
+    bool passthroughEnabled() const override {
+      return parent_.config_.payloadPassthrough() && decoder_filter_->passthroughEnabled();
+    }
+    ThriftFilters::FilterStatus passthroughData(Buffer::Instance& data) override {
+      return decoder_filter_->passthroughData(data);
+    }
     ThriftFilters::FilterStatus structBegin(absl::string_view name) override {
       return decoder_filter_->structBegin(name);
     }
@@ -15,8 +15,10 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace ThriftProxy {
 
-// MessageBegin -> StructBegin
+// MessageBegin -> StructBegin, or
+// MessageBegin -> PassthroughData (framed message and filter accepts passthrough)
 DecoderStateMachine::DecoderStatus DecoderStateMachine::messageBegin(Buffer::Instance& buffer) {
+  const uint64_t total = buffer.length();
   if (!proto_.readMessageBegin(buffer, *metadata_)) {
     return DecoderStatus(ProtocolState::WaitForData);
   }
@@ -24,6 +26,17 @@ DecoderStateMachine::DecoderStatus DecoderStateMachine::messageBegin(Buffer::Ins
   stack_.clear();
   stack_.emplace_back(Frame(ProtocolState::MessageEnd));
 
+  if (metadata_->hasFrameSize() && filter_.passthroughEnabled()) {
+    const uint64_t header_bytes = total - buffer.length();
+    if (header_bytes > metadata_->frameSize()) {
+      throw EnvoyException(fmt::format("thrift message header ({} bytes) exceeds frame size {}",
+                                       header_bytes, metadata_->frameSize()));
+    }
+    body_bytes_ = metadata_->frameSize() - header_bytes;
+
+    return DecoderStatus(ProtocolState::PassthroughData, filter_.messageBegin(metadata_));
+  }
+
   return DecoderStatus(ProtocolState::StructBegin, filter_.messageBegin(metadata_));
 }
 
@@ -36,6 +49,21 @@ DecoderStateMachine::DecoderStatus DecoderStateMachine::messageEnd(Buffer::Insta
   return DecoderStatus(ProtocolState::Done, filter_.messageEnd());
 }
 
+// PassthroughData -> MessageEnd
+DecoderStateMachine::DecoderStatus DecoderStateMachine::passthroughData(Buffer::Instance& buffer) {
+  if (buffer.length() < body_bytes_) {
+    return DecoderStatus(ProtocolState::WaitForData);
+  }
+
+  // Moves whole slices rather than copying them, so large bodies aren't copied on their way
+  // upstream.
+  Buffer::OwnedImpl body;
+  body.move(buffer, body_bytes_);
+
+  // The body is the whole rest of the message, so pop the frame pushed in messageBegin.
+  return DecoderStatus(popReturnState(), filter_.passthroughData(body));
+}
+
 // StructBegin -> FieldBegin
 DecoderStateMachine::DecoderStatus DecoderStateMachine::structBegin(Buffer::Instance& buffer) {
   std::string name;
@@ -289,6 +317,8 @@ DecoderStateMachine::DecoderStatus DecoderStateMachine::handleState(Buffer::Inst
   switch (state_) {
   case ProtocolState::MessageBegin:
     return messageBegin(buffer);
+  case ProtocolState::PassthroughData:
+    return passthroughData(buffer);
   case ProtocolState::StructBegin:
     return structBegin(buffer);
   case ProtocolState::StructEnd:
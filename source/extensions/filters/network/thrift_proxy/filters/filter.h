@@ -152,6 +152,22 @@ public:
    */
   virtual FilterStatus messageEnd() PURE;
 
+  /**
+   * @return bool whether the filter accepts the undecoded body of a message via passthroughData,
+   *         instead of callbacks for each of its structs, fields and values.
+   */
+  virtual bool passthroughEnabled() const PURE;
+
+  /**
+   * Indicates that the body of a Thrift protocol message, i.e. everything that follows the message
+   * header, is available undecoded. Only called if passthroughEnabled returns true and the length
+   * of the message is known from its transport. Called between messageBegin and messageEnd,
+   * instead of the struct, field and value callbacks.
+   * @param data the message body, which the filter may drain
+   * @return FilterStatus to indicate if filter chain iteration should continue
+   */
+  virtual FilterStatus passthroughData(Buffer::Instance& data) PURE;
+
   /**
    * Indicates that the start of a Thrift protocol struct was detected.
    * @param name the name of the struct, if available
@@ -41,6 +41,13 @@ public:
     return ThriftFilters::FilterStatus::Continue;
   }
 
+  // The body of a message can only be passed through if it's written with the protocol it was
+  // read with, so converters only enable passthrough when they are known to use the same protocol.
+  ThriftFilters::FilterStatus passthroughData(Buffer::Instance& data) override {
+    buffer_->move(data);
+    return ThriftFilters::FilterStatus::Continue;
+  }
+
   ThriftFilters::FilterStatus structBegin(absl::string_view name) override {
     proto_->writeStructBegin(*buffer_, std::string(name));
     return ThriftFilters::FilterStatus::Continue;
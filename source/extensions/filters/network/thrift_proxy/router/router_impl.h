@@ -86,6 +86,9 @@ public:
   ThriftFilters::FilterStatus transportEnd() override;
   ThriftFilters::FilterStatus messageBegin(MessageMetadataSharedPtr metadata) override;
   ThriftFilters::FilterStatus messageEnd() override;
+  // Requests are sent upstream with their downstream protocol, so their bodies can be passed
+  // through.
+  bool passthroughEnabled() const override { return true; }
 
   // Upstream::LoadBalancerContext
   absl::optional<uint64_t> computeHashKey() override { return {}; }
@@ -1,5 +1,8 @@
 #include "extensions/stat_sinks/common/statsd/statsd.h"
 
+#include <sys/socket.h>
+#include <sys/uio.h>
+
 #include <chrono>
 #include <cstdint>
 #include <string>
@@ -38,32 +41,102 @@ void Writer::write(const std::string& message) {
   ::send(fd_, message.c_str(), message.size(), MSG_DONTWAIT);
 }
 
+void Writer::writeBatch(const std::vector<std::string>& messages) {
+#ifdef __linux__
+  std::vector<struct iovec> iovecs(messages.size());
+  std::vector<struct mmsghdr> headers(messages.size());
+  for (size_t i = 0; i < messages.size(); i++) {
+    iovecs[i].iov_base = const_cast<char*>(messages[i].data());
+    iovecs[i].iov_len = messages[i].size();
+    headers[i].msg_hdr.msg_iov = &iovecs[i];
+    headers[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  size_t sent = 0;
+  while (sent < messages.size()) {
+    const int rc = ::sendmmsg(fd_, &headers[sent], messages.size() - sent, MSG_DONTWAIT);
+    // sendmmsg() only fails if the first datagram can't be sent. Drop that one and go on with the
+    // rest, as a failed write() would.
+    sent += rc > 0 ? rc : 1;
+  }
+#else
+  for (const std::string& message : messages) {
+    write(message);
+  }
+#endif
+}
+
 UdpStatsdSink::UdpStatsdSink(ThreadLocal::SlotAllocator& tls,
                              Network::Address::InstanceConstSharedPtr address, const bool use_tag,
-                             const std::string& prefix)
+                             const std::string& prefix, uint64_t max_bytes_per_datagram,
+                             bool skip_unchanged_metrics)
     : tls_(tls.allocateSlot()), server_address_(std::move(address)), use_tag_(use_tag),
-      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix) {
+      prefix_(prefix.empty() ? Statsd::getDefaultPrefix() : prefix),
+      max_bytes_per_datagram_(max_bytes_per_datagram),
+      skip_unchanged_metrics_(skip_unchanged_metrics) {
   tls_->set([this](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr {
     return std::make_shared<Writer>(this->server_address_);
   });
 }
 
+void UdpStatsdSink::DatagramBatcher::add(const std::string& metric) {
+  if (!current_datagram_.empty() &&
+      current_datagram_.size() + 1 + metric.size() > max_bytes_per_datagram_) {
+    completeDatagram();
+  }
+
+  if (!current_datagram_.empty()) {
+    current_datagram_.push_back('\n');
+  }
+  current_datagram_.append(metric);
+}
+
+void UdpStatsdSink::DatagramBatcher::flush() {
+  if (!current_datagram_.empty()) {
+    completeDatagram();
+  }
+  if (!datagrams_.empty()) {
+    writer_.writeBatch(datagrams_);
+    datagrams_.clear();
+  }
+}
+
+void UdpStatsdSink::DatagramBatcher::completeDatagram() {
+  datagrams_.emplace_back(std::move(current_datagram_));
+  current_datagram_.clear();
+  if (datagrams_.size() == MAX_DATAGRAMS_PER_BATCH) {
+    writer_.writeBatch(datagrams_);
+    datagrams_.clear();
+  }
+}
+
 void UdpStatsdSink::flush(Stats::Source& source) {
-  Writer& writer = tls_->getTyped<Writer>();
-  for (const Stats::CounterSharedPtr& counter : source.cachedCounters()) {
+  // When skipping unchanged metrics, only the stats written since the last flush are walked.
+  const std::vector<Stats::CounterSharedPtr>& counters =
+      skip_unchanged_metrics_ ? source.cachedChangedCounters() : source.cachedCounters();
+  const std::vector<Stats::GaugeSharedPtr>& gauges =
+      skip_unchanged_metrics_ ? source.cachedChangedGauges() : source.cachedGauges();
+
+  DatagramBatcher batcher(tls_->getTyped<Writer>(), max_bytes_per_datagram_);
+  for (const Stats::CounterSharedPtr& counter : counters) {
     if (counter->used()) {
       uint64_t delta = counter->latch();
-      writer.write(fmt::format("{}.{}:{}|c{}", prefix_, getName(*counter), delta,
-                               buildTagStr(counter->tags())));
+      if (delta == 0 && skip_unchanged_metrics_) {
+        continue;
+      }
+      batcher.add(fmt::format("{}.{}:{}|c{}", prefix_, getName(*counter), delta,
+                              buildTagStr(counter->tags())));
     }
   }
 
-  for (const Stats::GaugeSharedPtr& gauge : source.cachedGauges()) {
+  for (const Stats::GaugeSharedPtr& gauge : gauges) {
     if (gauge->used()) {
-      writer.write(fmt::format("{}.{}:{}|g{}", prefix_, getName(*gauge), gauge->value(),
-                               buildTagStr(gauge->tags())));
+      batcher.add(fmt::format("{}.{}:{}|g{}", prefix_, getName(*gauge), gauge->value(),
+                              buildTagStr(gauge->tags())));
     }
   }
+
+  batcher.flush();
 }
 
 void UdpStatsdSink::onHistogramComplete(const Stats::Histogram& histogram, uint64_t value) {
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "envoy/local_info/local_info.h"
 #include "envoy/network/connection.h"
 #include "envoy/stats/histogram.h"
@@ -33,6 +36,14 @@ public:
   virtual ~Writer();
 
   virtual void write(const std::string& message);
+
+  /**
+   * Send each message in a datagram of its own, with as few system calls as the platform allows.
+   * Like write(), this is best effort: datagrams that can't be sent are dropped.
+   * @param messages supplies the messages to send.
+   */
+  virtual void writeBatch(const std::vector<std::string>& messages);
+
   // Called in unit test to validate address.
   int getFdForTests() const { return fd_; };
 
@@ -45,13 +56,22 @@ private:
  */
 class UdpStatsdSink : public Stats::Sink {
 public:
+  // The default datagram size, which leaves room for IPv6 and UDP headers in an Ethernet MTU.
+  static constexpr uint64_t DEFAULT_MAX_BYTES_PER_DATAGRAM = 1432;
+
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, Network::Address::InstanceConstSharedPtr address,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix());
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                uint64_t max_bytes_per_datagram = DEFAULT_MAX_BYTES_PER_DATAGRAM,
+                bool skip_unchanged_metrics = false);
   // For testing.
   UdpStatsdSink(ThreadLocal::SlotAllocator& tls, const std::shared_ptr<Writer>& writer,
-                const bool use_tag, const std::string& prefix = getDefaultPrefix())
+                const bool use_tag, const std::string& prefix = getDefaultPrefix(),
+                uint64_t max_bytes_per_datagram = DEFAULT_MAX_BYTES_PER_DATAGRAM,
+                bool skip_unchanged_metrics = false)
       : tls_(tls.allocateSlot()), use_tag_(use_tag),
-        prefix_(prefix.empty() ? getDefaultPrefix() : prefix) {
+        prefix_(prefix.empty() ? getDefaultPrefix() : prefix),
+        max_bytes_per_datagram_(max_bytes_per_datagram),
+        skip_unchanged_metrics_(skip_unchanged_metrics) {
     tls_->set(
         [writer](Event::Dispatcher&) -> ThreadLocal::ThreadLocalObjectSharedPtr { return writer; });
   }
@@ -63,9 +83,37 @@ public:
   // Called in unit test to validate writer construction and address.
   int getFdForTests() { return tls_->getTyped<Writer>().getFdForTests(); }
   bool getUseTagForTest() { return use_tag_; }
+  uint64_t getMaxBytesPerDatagramForTest() { return max_bytes_per_datagram_; }
+  bool getSkipUnchangedMetricsForTest() { return skip_unchanged_metrics_; }
   const std::string& getPrefix() { return prefix_; }
 
 private:
+  /**
+   * Packs newline separated metrics into datagrams of up to max_bytes_per_datagram bytes, and
+   * hands them to the writer in batches of MAX_DATAGRAMS_PER_BATCH.
+   */
+  class DatagramBatcher {
+  public:
+    DatagramBatcher(Writer& writer, uint64_t max_bytes_per_datagram)
+        : writer_(writer), max_bytes_per_datagram_(max_bytes_per_datagram) {}
+
+    void add(const std::string& metric);
+    // Send all buffered metrics.
+    void flush();
+
+  private:
+    void completeDatagram();
+
+    Writer& writer_;
+    const uint64_t max_bytes_per_datagram_;
+    std::vector<std::string> datagrams_;
+    std::string current_datagram_;
+  };
+
+  // Matches the batch size commonly used with sendmmsg(), which bounds the iovec arrays built
+  // for each call.
+  static constexpr uint32_t MAX_DATAGRAMS_PER_BATCH = 64;
+
   const std::string getName(const Stats::Metric& metric);
   const std::string buildTagStr(const std::vector<Stats::Tag>& tags);
 
@@ -74,6 +122,8 @@ private:
   const bool use_tag_;
   // Prefix for all flushed stats.
   const std::string prefix_;
+  const uint64_t max_bytes_per_datagram_;
+  const bool skip_unchanged_metrics_;
 };
 
 /**
@@ -21,8 +21,12 @@ Stats::SinkPtr DogStatsdSinkFactory::createStatsSink(const Protobuf::Message& co
   Network::Address::InstanceConstSharedPtr address =
       Network::Address::resolveProtoAddress(sink_config.address());
   ENVOY_LOG(debug, "dog_statsd UDP ip address: {}", address->asString());
-  return std::make_unique<Common::Statsd::UdpStatsdSink>(server.threadLocal(), std::move(address),
-                                                         true);
+  return std::make_unique<Common::Statsd::UdpStatsdSink>(
+      server.threadLocal(), std::move(address), true, Common::Statsd::getDefaultPrefix(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          sink_config, max_bytes_per_datagram,
+          Common::Statsd::UdpStatsdSink::DEFAULT_MAX_BYTES_PER_DATAGRAM),
+      sink_config.skip_unchanged_metrics());
 }
 
 ProtobufTypes::MessagePtr DogStatsdSinkFactory::createEmptyConfigProto() {
@@ -29,7 +29,8 @@ Stats::SinkPtr MetricsServiceSinkFactory::createStatsSink(const Protobuf::Messag
               grpc_service, server.stats(), false),
           server.threadLocal(), server.localInfo());
 
-  return std::make_unique<MetricsServiceSink>(grpc_metrics_streamer);
+  return std::make_unique<MetricsServiceSink>(grpc_metrics_streamer,
+                                              sink_config.skip_unchanged_metrics());
 }
 
 ProtobufTypes::MessagePtr MetricsServiceSinkFactory::createEmptyConfigProto() {
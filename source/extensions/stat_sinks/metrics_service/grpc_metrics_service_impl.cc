@@ -61,8 +61,10 @@ void GrpcMetricsStreamerImpl::ThreadLocalStreamer::send(
   }
 }
 
-MetricsServiceSink::MetricsServiceSink(const GrpcMetricsStreamerSharedPtr& grpc_metrics_streamer)
-    : grpc_metrics_streamer_(grpc_metrics_streamer) {}
+MetricsServiceSink::MetricsServiceSink(const GrpcMetricsStreamerSharedPtr& grpc_metrics_streamer,
+                                       bool skip_unchanged_metrics)
+    : grpc_metrics_streamer_(grpc_metrics_streamer),
+      skip_unchanged_metrics_(skip_unchanged_metrics) {}
 
 void MetricsServiceSink::flushCounter(const Stats::Counter& counter) {
   io::prometheus::client::MetricFamily* metrics_family = message_.add_envoy_metrics();
@@ -100,8 +102,10 @@ void MetricsServiceSink::flushHistogram(const Stats::ParentHistogram& histogram)
 
 void MetricsServiceSink::flush(Stats::Source& source) {
   message_.clear_envoy_metrics();
-  const std::vector<Stats::CounterSharedPtr>& counters = source.cachedCounters();
-  const std::vector<Stats::GaugeSharedPtr>& gauges = source.cachedGauges();
+  const std::vector<Stats::CounterSharedPtr>& counters =
+      skip_unchanged_metrics_ ? source.cachedChangedCounters() : source.cachedCounters();
+  const std::vector<Stats::GaugeSharedPtr>& gauges =
+      skip_unchanged_metrics_ ? source.cachedChangedGauges() : source.cachedGauges();
   const std::vector<Stats::ParentHistogramSharedPtr>& histograms = source.cachedHistograms();
   // TODO(mrice32): there's probably some more sophisticated preallocation we can do here where we
   // actually preallocate the submessages and then pass ownership to the proto (rather than just
@@ -111,7 +111,8 @@ private:
 class MetricsServiceSink : public Stats::Sink {
 public:
   // MetricsService::Sink
-  MetricsServiceSink(const GrpcMetricsStreamerSharedPtr& grpc_metrics_streamer);
+  MetricsServiceSink(const GrpcMetricsStreamerSharedPtr& grpc_metrics_streamer,
+                     bool skip_unchanged_metrics = false);
   void flush(Stats::Source& source) override;
   void onHistogramComplete(const Stats::Histogram&, uint64_t) override {}
 
@@ -121,6 +122,7 @@ public:
 
 private:
   GrpcMetricsStreamerSharedPtr grpc_metrics_streamer_;
+  const bool skip_unchanged_metrics_;
   envoy::service::metrics::v2::StreamMetricsMessage message_;
 };
 
@@ -6,6 +6,7 @@
 #include "envoy/stats/scope.h"
 #include "envoy/stats/timespan.h"
 
+#include "common/common/fmt.h"
 #include "common/network/connection_impl.h"
 #include "common/network/utility.h"
 
@@ -14,8 +15,11 @@
 namespace Envoy {
 namespace Server {
 
-ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher)
-    : logger_(logger), dispatcher_(dispatcher) {}
+ConnectionHandlerImpl::ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                                             absl::optional<uint32_t> worker_index)
+    : logger_(logger), dispatcher_(dispatcher), worker_index_(worker_index),
+      per_handler_stat_prefix_(worker_index ? fmt::format("worker_{}.", worker_index.value())
+                                            : "main_thread.") {}
 
 void ConnectionHandlerImpl::addListener(Network::ListenerConfig& config) {
   ActiveListenerPtr l(new ActiveListener(*this, config));
@@ -57,20 +61,30 @@ void ConnectionHandlerImpl::ActiveListener::removeConnection(ActiveConnection& c
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
                                                       Network::ListenerConfig& config)
-    : ActiveListener(
-          parent,
-          parent.dispatcher_.createListener(config.socket(), *this, config.bindToPort(),
-                                            config.handOffRestoredDestinationConnections()),
-          config) {}
+    : ActiveListener(parent,
+                     parent.dispatcher_.createListener(
+                         parent.worker_index_ ? config.workerSocket(parent.worker_index_.value())
+                                              : config.socket(),
+                         *this, config.bindToPort(),
+                         config.handOffRestoredDestinationConnections()),
+                     config) {}
 
 ConnectionHandlerImpl::ActiveListener::ActiveListener(ConnectionHandlerImpl& parent,
                                                       Network::ListenerPtr&& listener,
                                                       Network::ListenerConfig& config)
     : parent_(parent), listener_(std::move(listener)),
-      stats_(generateStats(config.listenerScope())), listener_tag_(config.listenerTag()),
-      config_(config) {}
+      stats_(generateStats(config.listenerScope())),
+      per_handler_stats_(
+          generatePerHandlerStats(config.listenerScope(), parent.per_handler_stat_prefix_)),
+      listener_tag_(config.listenerTag()), config_(config) {
+  config_.connectionBalancer().registerHandler(*this);
+}
 
 ConnectionHandlerImpl::ActiveListener::~ActiveListener() {
+  // A listener is stopped on all workers before it is removed, so no other worker picks this
+  // handler once it is unregistered.
+  config_.connectionBalancer().unregisterHandler(*this);
+
   // Purge sockets that have not progressed to connections. This should only happen when
   // a listener filter stops iteration and never resumes.
   while (!sockets_.empty()) {
@@ -120,6 +134,16 @@ ConnectionHandlerImpl::findActiveListenerByAddress(const Network::Address::Insta
   return (listener_it != listeners_.end()) ? listener_it->second.get() : nullptr;
 }
 
+ConnectionHandlerImpl::ActiveListener*
+ConnectionHandlerImpl::findActiveListenerByTag(uint64_t listener_tag) {
+  for (auto& listener : listeners_) {
+    if (listener.second->listener_tag_ == listener_tag) {
+      return listener.second.get();
+    }
+  }
+  return nullptr;
+}
+
 void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
   if (success) {
     if (iter_ == accept_filters_.end()) {
@@ -148,8 +172,10 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
     if (new_listener != nullptr) {
       // Hands off connections redirected by iptables to the listener associated with the
       // original destination address. Pass 'hand_off_restored_destionations' as false to
-      // prevent further redirection.
-      new_listener->onAccept(std::move(socket_), false);
+      // prevent further redirection. The socket was already balanced by the listener that
+      // accepted it, so it stays on this worker.
+      new_listener->incNumConnections();
+      new_listener->onAcceptWorker(std::move(socket_), false, true);
     } else {
       // Set default transport protocol if none of the listener filters did it.
       if (socket_->detectedTransportProtocol().empty()) {
@@ -170,6 +196,21 @@ void ConnectionHandlerImpl::ActiveSocket::continueFilterChain(bool success) {
 
 void ConnectionHandlerImpl::ActiveListener::onAccept(
     Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections) {
+  onAcceptWorker(std::move(socket), hand_off_restored_destination_connections, false);
+}
+
+void ConnectionHandlerImpl::ActiveListener::onAcceptWorker(
+    Network::ConnectionSocketPtr&& socket, bool hand_off_restored_destination_connections,
+    bool rebalanced) {
+  if (!rebalanced) {
+    Network::BalancedConnectionHandler& target_handler =
+        config_.connectionBalancer().pickTargetHandler(*this);
+    if (&target_handler != this) {
+      target_handler.post(std::move(socket));
+      return;
+    }
+  }
+
   Network::Address::InstanceConstSharedPtr local_address = socket->localAddress();
   auto active_socket = std::make_unique<ActiveSocket>(*this, std::move(socket),
                                                       hand_off_restored_destination_connections);
@@ -185,6 +226,23 @@ void ConnectionHandlerImpl::ActiveListener::onAccept(
   }
 }
 
+void ConnectionHandlerImpl::ActiveListener::post(Network::ConnectionSocketPtr&& socket) {
+  // Posted callbacks must be copyable, so the socket is moved into a shared_ptr. If the listener is
+  // removed from this handler before the callback runs, the socket is closed when the callback is
+  // destroyed.
+  std::shared_ptr<Network::ConnectionSocketPtr> posted_socket =
+      std::make_shared<Network::ConnectionSocketPtr>(std::move(socket));
+  ConnectionHandlerImpl& parent = parent_;
+  const uint64_t listener_tag = listener_tag_;
+  parent_.dispatcher_.post([&parent, listener_tag, posted_socket]() -> void {
+    ActiveListener* listener = parent.findActiveListenerByTag(listener_tag);
+    if (listener != nullptr) {
+      listener->onAcceptWorker(std::move(*posted_socket),
+                               listener->config_.handOffRestoredDestinationConnections(), true);
+    }
+  });
+}
+
 void ConnectionHandlerImpl::ActiveListener::newConnection(Network::ConnectionSocketPtr&& socket) {
   // Find matching filter chain.
   const auto filter_chain = config_.filterChainManager().findFilterChain(*socket);
@@ -233,13 +291,18 @@ ConnectionHandlerImpl::ActiveConnection::ActiveConnection(ActiveListener& listen
   // to make this configurable.
   connection_->noDelay(true);
   connection_->addConnectionCallbacks(*this);
+  listener_.incNumConnections();
   listener_.stats_.downstream_cx_total_.inc();
   listener_.stats_.downstream_cx_active_.inc();
+  listener_.per_handler_stats_.downstream_cx_total_.inc();
+  listener_.per_handler_stats_.downstream_cx_active_.inc();
 }
 
 ConnectionHandlerImpl::ActiveConnection::~ActiveConnection() {
+  listener_.decNumConnections();
   listener_.stats_.downstream_cx_active_.dec();
   listener_.stats_.downstream_cx_destroy_.inc();
+  listener_.per_handler_stats_.downstream_cx_active_.dec();
   conn_length_->complete();
 }
 
@@ -247,5 +310,11 @@ ListenerStats ConnectionHandlerImpl::generateStats(Stats::Scope& scope) {
   return {ALL_LISTENER_STATS(POOL_COUNTER(scope), POOL_GAUGE(scope), POOL_HISTOGRAM(scope))};
 }
 
+PerHandlerListenerStats ConnectionHandlerImpl::generatePerHandlerStats(Stats::Scope& scope,
+                                                                       const std::string& prefix) {
+  return {ALL_PER_HANDLER_LISTENER_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                         POOL_GAUGE_PREFIX(scope, prefix))};
+}
+
 } // namespace Server
 } // namespace Envoy
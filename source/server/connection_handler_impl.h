@@ -8,6 +8,7 @@
 #include "envoy/common/time.h"
 #include "envoy/event/deferred_deletable.h"
 #include "envoy/network/connection.h"
+#include "envoy/network/connection_balancer.h"
 #include "envoy/network/connection_handler.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
@@ -16,9 +17,11 @@
 #include "envoy/stats/scope.h"
 #include "envoy/stats/timespan.h"
 
+#include "common/common/assert.h"
 #include "common/common/linked_object.h"
 #include "common/common/non_copyable.h"
 
+#include "absl/types/optional.h"
 #include "spdlog/spdlog.h"
 
 namespace Envoy {
@@ -40,13 +43,35 @@ struct ListenerStats {
   ALL_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
+// clang-format off
+#define ALL_PER_HANDLER_LISTENER_STATS(COUNTER, GAUGE)                                             \
+  COUNTER(downstream_cx_total)                                                                     \
+  GAUGE  (downstream_cx_active)
+// clang-format on
+
+/**
+ * Wrapper struct for the listener stats of a single connection handler, which show how the
+ * listener's connections are spread across workers. @see stats_macros.h
+ */
+struct PerHandlerListenerStats {
+  ALL_PER_HANDLER_LISTENER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
 /**
  * Server side connection handler. This is used both by workers as well as the
  * main thread for non-threaded listeners.
  */
 class ConnectionHandlerImpl : public Network::ConnectionHandler, NonCopyable {
 public:
-  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher);
+  /**
+   * @param logger supplies the logger to log connection events to.
+   * @param dispatcher supplies the dispatcher that listeners and connections run on.
+   * @param worker_index supplies the index of the worker that owns the handler, or nullopt for the
+   *        main thread. Workers accept on their own socket of listeners that have a socket per
+   *        worker, and the listener stats of the handler are scoped by the worker.
+   */
+  ConnectionHandlerImpl(spdlog::logger& logger, Event::Dispatcher& dispatcher,
+                        absl::optional<uint32_t> worker_index);
 
   // Network::ConnectionHandler
   uint64_t numConnections() override { return num_connections_; }
@@ -60,6 +85,7 @@ public:
 private:
   struct ActiveListener;
   ActiveListener* findActiveListenerByAddress(const Network::Address::Instance& address);
+  ActiveListener* findActiveListenerByTag(uint64_t listener_tag);
 
   struct ActiveConnection;
   typedef std::unique_ptr<ActiveConnection> ActiveConnectionPtr;
@@ -69,7 +95,8 @@ private:
   /**
    * Wrapper for an active listener owned by this handler.
    */
-  struct ActiveListener : public Network::ListenerCallbacks {
+  struct ActiveListener : public Network::ListenerCallbacks,
+                          public Network::BalancedConnectionHandler {
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerConfig& config);
 
     ActiveListener(ConnectionHandlerImpl& parent, Network::ListenerPtr&& listener,
@@ -82,6 +109,30 @@ private:
                   bool hand_off_restored_destination_connections) override;
     void onNewConnection(Network::ConnectionPtr&& new_connection) override;
 
+    // Network::BalancedConnectionHandler
+    uint64_t numConnections() const override { return num_listener_connections_; }
+    void incNumConnections() override { num_listener_connections_++; }
+    void post(Network::ConnectionSocketPtr&& socket) override;
+
+    /**
+     * Release a count taken with incNumConnections().
+     */
+    void decNumConnections() {
+      ASSERT(num_listener_connections_ > 0);
+      num_listener_connections_--;
+    }
+
+    /**
+     * Run the listener filters on a socket that is processed by this handler.
+     * @param socket supplies the socket that is moved into the listener.
+     * @param hand_off_restored_destination_connections supplies whether the socket may be handed
+     *        off to the listener of its original destination address.
+     * @param rebalanced supplies whether the socket was already assigned to this handler and
+     *        counted. Otherwise the listener's connection balancer picks the handler first.
+     */
+    void onAcceptWorker(Network::ConnectionSocketPtr&& socket,
+                        bool hand_off_restored_destination_connections, bool rebalanced);
+
     /**
      * Remove and destroy an active connection.
      * @param connection supplies the connection to remove.
@@ -96,10 +147,14 @@ private:
     ConnectionHandlerImpl& parent_;
     Network::ListenerPtr listener_;
     ListenerStats stats_;
+    PerHandlerListenerStats per_handler_stats_;
     std::list<ActiveSocketPtr> sockets_;
     std::list<ActiveConnectionPtr> connections_;
     const uint64_t listener_tag_;
     Network::ListenerConfig& config_;
+    // Sockets and connections of the listener on this handler. This is read by the connection
+    // balancer on other workers.
+    std::atomic<uint64_t> num_listener_connections_{};
   };
 
   typedef std::unique_ptr<ActiveListener> ActiveListenerPtr;
@@ -141,7 +196,10 @@ private:
         : listener_(listener), socket_(std::move(socket)),
           hand_off_restored_destination_connections_(hand_off_restored_destination_connections),
           iter_(accept_filters_.end()) {}
-    ~ActiveSocket() { accept_filters_.clear(); }
+    ~ActiveSocket() {
+      accept_filters_.clear();
+      listener_.decNumConnections();
+    }
 
     // Network::ListenerFilterManager
     void addAcceptFilter(Network::ListenerFilterPtr&& filter) override {
@@ -161,9 +219,13 @@ private:
   };
 
   static ListenerStats generateStats(Stats::Scope& scope);
+  static PerHandlerListenerStats generatePerHandlerStats(Stats::Scope& scope,
+                                                         const std::string& prefix);
 
   spdlog::logger& logger_;
   Event::Dispatcher& dispatcher_;
+  const absl::optional<uint32_t> worker_index_;
+  const std::string per_handler_stat_prefix_;
   std::list<std::pair<Network::Address::InstanceConstSharedPtr, ActiveListenerPtr>> listeners_;
   std::atomic<uint64_t> num_connections_{};
 };
@@ -4,7 +4,9 @@
 #include <sys/prctl.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 
@@ -28,7 +30,7 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t SharedMemory::VERSION = 10;
+const uint64_t SharedMemory::VERSION = 13;
 
 static BlockMemoryHashSetOptions blockMemHashOptions(uint64_t max_stats) {
   BlockMemoryHashSetOptions hash_set_options;
@@ -80,6 +82,7 @@ SharedMemory& SharedMemory::initialize(uint64_t stats_set_size, Options& options
     shmem->initializeMutex(shmem->access_log_lock_);
     shmem->initializeMutex(shmem->stat_lock_);
     shmem->initializeMutex(shmem->init_lock_);
+    shmem->initializeMutex(shmem->ssl_session_cache_lock_);
   } else {
     RELEASE_ASSERT(shmem->size_ == total_size, "");
     RELEASE_ASSERT(shmem->version_ == VERSION, "");
@@ -123,7 +126,10 @@ HotRestartImpl::HotRestartImpl(Options& options)
       shmem_(SharedMemory::initialize(
           RawStatDataSet::numBytes(stats_set_options_, options_.statsOptions()), options_)),
       log_lock_(shmem_.log_lock_), access_log_lock_(shmem_.access_log_lock_),
-      stat_lock_(shmem_.stat_lock_), init_lock_(shmem_.init_lock_) {
+      stat_lock_(shmem_.stat_lock_), init_lock_(shmem_.init_lock_),
+      ssl_session_cache_lock_(shmem_.ssl_session_cache_lock_),
+      ssl_session_cache_(shmem_.ssl_session_cache_state_, ssl_session_cache_lock_,
+                         ProdSystemTimeSource::instance_) {
   {
     // We must hold the stat lock when attaching to an existing memory segment
     // because it might be actively written to while we sanityCheck it.
@@ -225,7 +231,8 @@ void HotRestartImpl::drainParentListeners() {
   shmem_.flags_ &= ~SharedMemory::Flags::INITIALIZING;
 }
 
-int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
+int HotRestartImpl::duplicateParentListenSocket(const std::string& address,
+                                                uint32_t worker_index, bool reuse_port) {
   if (options_.restartEpoch() == 0 || parent_terminated_) {
     return -1;
   }
@@ -233,9 +240,19 @@ int HotRestartImpl::duplicateParentListenSocket(const std::string& address) {
   RpcGetListenSocketRequest rpc;
   ASSERT(address.length() < sizeof(rpc.address_));
   StringUtil::strlcpy(rpc.address_, address.c_str(), sizeof(rpc.address_));
+  rpc.worker_index_ = worker_index;
   sendMessage(parent_address_, rpc);
   RpcGetListenSocketReply* reply =
       receiveTypedRpc<RpcGetListenSocketReply, RpcMessageType::GetListenSocketReply>();
+  if (reply->fd_ != -1 && reply->reuse_port_ != reuse_port) {
+    // A socket per worker can't stand in for a shared socket or the other way around, and binding
+    // a new socket would conflict with the parent's.
+    ::close(reply->fd_);
+    throw EnvoyException(fmt::format(
+        "cannot take over listen socket {} from the parent process: reuse_port is {} in the "
+        "parent and {} in the new configuration",
+        address, reply->reuse_port_, reuse_port));
+  }
   return reply->fd_;
 }
 
@@ -361,10 +378,15 @@ void HotRestartImpl::onGetListenSocket(RpcGetListenSocketRequest& rpc) {
 
   Network::Address::InstanceConstSharedPtr addr =
       Network::Utility::resolveUrl(std::string(rpc.address_));
-  for (const auto& listener : server_->listenerManager().listeners()) {
-    if (*listener.get().socket().localAddress() == *addr) {
-      reply.fd_ = listener.get().socket().fd();
-      break;
+  // A listener has at most one socket per worker, so there is nothing to hand over for a worker
+  // index beyond our own workers.
+  if (rpc.worker_index_ < std::max(1U, server_->options().concurrency())) {
+    for (const auto& listener : server_->listenerManager().listeners()) {
+      if (*listener.get().socket().localAddress() == *addr) {
+        reply.fd_ = listener.get().workerSocket(rpc.worker_index_).fd();
+        reply.reuse_port_ = listener.get().reusePort();
+        break;
+      }
     }
   }
 
@@ -14,6 +14,7 @@
 
 #include "common/common/assert.h"
 #include "common/common/block_memory_hash_set.h"
+#include "common/ssl/session_cache_impl.h"
 #include "common/stats/raw_stat_data.h"
 
 namespace Envoy {
@@ -65,6 +66,8 @@ private:
   pthread_mutex_t access_log_lock_;
   pthread_mutex_t stat_lock_;
   pthread_mutex_t init_lock_;
+  pthread_mutex_t ssl_session_cache_lock_;
+  Ssl::SessionCacheImpl::State ssl_session_cache_state_;
   alignas(BlockMemoryHashSet<Stats::RawStatData>) uint8_t stats_set_data_[];
 
   friend class HotRestartImpl;
@@ -122,7 +125,8 @@ public:
 
   // Server::HotRestart
   void drainParentListeners() override;
-  int duplicateParentListenSocket(const std::string& address) override;
+  int duplicateParentListenSocket(const std::string& address, uint32_t worker_index,
+                                  bool reuse_port) override;
   void getParentStats(GetParentStatsInfo& info) override;
   void initialize(Event::Dispatcher& dispatcher, Server::Instance& server) override;
   void shutdownParentAdmin(ShutdownParentAdminInfo& info) override;
@@ -132,6 +136,7 @@ public:
   Thread::BasicLockable& logLock() override { return log_lock_; }
   Thread::BasicLockable& accessLogLock() override { return access_log_lock_; }
   Stats::StatDataAllocator& statsAllocator() override { return *this; }
+  Ssl::SessionCache& sslSessionCache() override { return ssl_session_cache_; }
 
   /**
    * envoy --hot_restart_version doesn't initialize Envoy, but computes the version string
@@ -168,12 +173,15 @@ private:
     RpcGetListenSocketRequest() : RpcBase(RpcMessageType::GetListenSocketRequest, sizeof(*this)) {}
 
     char address_[256]{0};
+    uint32_t worker_index_{0};
   } __attribute__((packed));
 
   struct RpcGetListenSocketReply : public RpcBase {
     RpcGetListenSocketReply() : RpcBase(RpcMessageType::GetListenSocketReply, sizeof(*this)) {}
 
     int fd_{0};
+    // Whether the parent's listener has a SO_REUSEPORT socket per worker.
+    bool reuse_port_{false};
   } __attribute__((packed));
 
   struct RpcShutdownAdminReply : public RpcBase {
@@ -215,6 +223,8 @@ private:
   ProcessSharedMutex access_log_lock_;
   ProcessSharedMutex stat_lock_;
   ProcessSharedMutex init_lock_;
+  ProcessSharedMutex ssl_session_cache_lock_;
+  Ssl::SessionCacheImpl ssl_session_cache_;
   int my_domain_socket_{-1};
   sockaddr_un parent_address_;
   sockaddr_un child_address_;
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "envoy/server/hot_restart.h"
 
 #include "common/common/thread.h"
+#include "common/common/utility.h"
+#include "common/ssl/session_cache_impl.h"
 
 namespace Envoy {
 namespace Server {
@@ -14,11 +17,14 @@ namespace Server {
  */
 class HotRestartNopImpl : public Server::HotRestart {
 public:
-  HotRestartNopImpl() {}
+  HotRestartNopImpl()
+      : ssl_session_cache_state_(new Ssl::SessionCacheImpl::State()),
+        ssl_session_cache_(*ssl_session_cache_state_, ssl_session_cache_lock_,
+                           ProdSystemTimeSource::instance_) {}
 
   // Server::HotRestart
   void drainParentListeners() override {}
-  int duplicateParentListenSocket(const std::string&) override { return -1; }
+  int duplicateParentListenSocket(const std::string&, uint32_t, bool) override { return -1; }
   void getParentStats(GetParentStatsInfo& info) override { memset(&info, 0, sizeof(info)); }
   void initialize(Event::Dispatcher&, Server::Instance&) override {}
   void shutdownParentAdmin(ShutdownParentAdminInfo&) override {}
@@ -28,11 +34,15 @@ public:
   Thread::BasicLockable& logLock() override { return log_lock_; }
   Thread::BasicLockable& accessLogLock() override { return access_log_lock_; }
   Stats::StatDataAllocator& statsAllocator() override { return stats_allocator_; }
+  Ssl::SessionCache& sslSessionCache() override { return ssl_session_cache_; }
 
 private:
   Thread::MutexBasicLockable log_lock_;
   Thread::MutexBasicLockable access_log_lock_;
   Stats::HeapStatDataAllocator stats_allocator_;
+  Thread::MutexBasicLockable ssl_session_cache_lock_;
+  std::unique_ptr<Ssl::SessionCacheImpl::State> ssl_session_cache_state_;
+  Ssl::SessionCacheImpl ssl_session_cache_;
 };
 
 } // namespace Server
@@ -27,6 +27,7 @@
 #include "common/common/assert.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
+#include "common/common/regex.h"
 #include "common/common/utility.h"
 #include "common/common/version.h"
 #include "common/html/utility.h"
@@ -44,6 +45,7 @@
 
 #include "extensions/access_loggers/file/file_access_log_impl.h"
 
+#include "absl/strings/match.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
@@ -56,6 +58,7 @@
 #include "rapidjson/schema.h"
 #include "rapidjson/stream.h"
 #include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 #include "spdlog/spdlog.h"
 
 using namespace rapidjson;
@@ -145,6 +148,58 @@ void populateFallbackResponseHeaders(Http::Code code, Http::HeaderMap& header_ma
   header_map.addReference(headers.XContentTypeOptions, headers.XContentTypeOptionValues.Nosniff);
 }
 
+// Formats the quantiles that are computed for every histogram, as percentages.
+rapidjson::Value supportedQuantilesAsJson(rapidjson::Document::AllocatorType& allocator) {
+  // It is not possible for the supported quantiles to differ across histograms, so they are
+  // taken from an empty histogram.
+  Stats::HistogramStatisticsImpl empty_statistics;
+  rapidjson::Value supported_quantile_array(rapidjson::kArrayType);
+  for (double quantile : empty_statistics.supportedQuantiles()) {
+    Value quantile_type;
+    quantile_type.SetDouble(quantile * 100);
+    supported_quantile_array.PushBack(quantile_type, allocator);
+  }
+  return supported_quantile_array;
+}
+
+// Formats the name and the interval and cumulative quantile values of a histogram.
+rapidjson::Value histogramAsJson(const Stats::ParentHistogram& histogram,
+                                 rapidjson::Document::AllocatorType& allocator) {
+  Value histogram_obj;
+  histogram_obj.SetObject();
+  Value histogram_name;
+  histogram_name.SetString(histogram.name().c_str(), allocator);
+  histogram_obj.AddMember("name", histogram_name, allocator);
+
+  rapidjson::Value computed_quantile_array(rapidjson::kArrayType);
+
+  for (size_t i = 0; i < histogram.intervalStatistics().supportedQuantiles().size(); ++i) {
+    Value quantile_obj;
+    quantile_obj.SetObject();
+    Value interval_value;
+    if (!std::isnan(histogram.intervalStatistics().computedQuantiles()[i])) {
+      interval_value.SetDouble(histogram.intervalStatistics().computedQuantiles()[i]);
+    }
+    quantile_obj.AddMember("interval", interval_value, allocator);
+    Value cumulative_value;
+    // We skip nan entries to put in the {null, null} entry to keep other data aligned.
+    if (!std::isnan(histogram.cumulativeStatistics().computedQuantiles()[i])) {
+      cumulative_value.SetDouble(histogram.cumulativeStatistics().computedQuantiles()[i]);
+    }
+    quantile_obj.AddMember("cumulative", cumulative_value, allocator);
+    computed_quantile_array.PushBack(quantile_obj, allocator);
+  }
+  histogram_obj.AddMember("values", computed_quantile_array, allocator);
+  return histogram_obj;
+}
+
+void addJson(const rapidjson::Value& value, Buffer::Instance& response) {
+  rapidjson::StringBuffer strbuf;
+  rapidjson::Writer<StringBuffer> writer(strbuf);
+  value.Accept(writer);
+  response.add(strbuf.GetString(), strbuf.GetSize());
+}
+
 } // namespace
 
 AdminFilter::AdminFilter(AdminImpl& parent) : parent_(parent) {}
@@ -175,6 +230,46 @@ void AdminFilter::onDestroy() {
   for (const auto& callback : on_destroy_callbacks_) {
     callback();
   }
+
+  if (chunk_timer_ != nullptr) {
+    chunk_timer_.reset();
+    callbacks_->removeDownstreamWatermarkCallbacks(*this);
+  }
+  chunked_response_.reset();
+}
+
+void AdminFilter::onAboveWriteBufferHighWatermark() { ++high_watermark_count_; }
+
+void AdminFilter::onBelowWriteBufferLowWatermark() {
+  ASSERT(high_watermark_count_ > 0);
+  if (--high_watermark_count_ == 0 && chunked_response_ != nullptr) {
+    chunk_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
+}
+
+void AdminFilter::drainChunkedResponse(Buffer::Instance& response) {
+  if (chunked_response_ == nullptr) {
+    return;
+  }
+
+  while (chunked_response_->nextChunk(response)) {
+  }
+  chunked_response_.reset();
+}
+
+void AdminFilter::writeNextChunk() {
+  Buffer::OwnedImpl chunk;
+  const bool more = chunked_response_->nextChunk(chunk);
+  if (!more) {
+    chunked_response_.reset();
+  }
+
+  // Writing the chunk may take the downstream over its high watermark, in which case the next
+  // chunk is written once it drains below the low watermark.
+  callbacks_->encodeData(chunk, !more);
+  if (more && high_watermark_count_ == 0) {
+    chunk_timer_->enableTimer(std::chrono::milliseconds(0));
+  }
 }
 
 void AdminFilter::addOnDestroyCallback(std::function<void()> cb) {
@@ -495,65 +590,331 @@ Http::Code AdminImpl::handlerServerInfo(absl::string_view, Http::HeaderMap&,
   return Http::Code::OK;
 }
 
+bool AdminImpl::selectStats(const Http::Utility::QueryParams& params,
+                            std::vector<Stats::CounterSharedPtr>& counters,
+                            std::vector<Stats::GaugeSharedPtr>& gauges,
+                            std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+                            Buffer::Instance& response) {
+  absl::optional<StatsFilter> filter;
+  try {
+    filter.emplace(params);
+  } catch (const EnvoyException& e) {
+    response.add(fmt::format("invalid filter: {}\n", e.what()));
+    return false;
+  }
+
+  // Only the matching stats are held on to, and only as pointers. Their names and values are
+  // formatted as the response is streamed.
+  counters = server_.stats().counters();
+  filter->apply(counters);
+  gauges = server_.stats().gauges();
+  filter->apply(gauges);
+  histograms = server_.stats().histograms();
+  filter->apply(histograms);
+  return true;
+}
+
 Http::Code AdminImpl::handlerStats(absl::string_view url, Http::HeaderMap& response_headers,
                                    Buffer::Instance& response, AdminStream& admin_stream) {
-  Http::Code rc = Http::Code::OK;
   const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
 
-  const bool show_all = params.find("usedonly") == params.end();
-  const bool has_format = !(params.find("format") == params.end());
+  const auto format = params.find("format");
+  const bool json = format != params.end() && format->second == "json";
+  if (format != params.end() && !json) {
+    if (format->second == "prometheus") {
+      return handlerPrometheusStats(url, response_headers, response, admin_stream);
+    }
+    response.add("usage: /stats?format=json  or /stats?format=prometheus \n");
+    response.add("\n");
+    return Http::Code::NotFound;
+  }
 
-  std::map<std::string, uint64_t> all_stats;
-  for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
-    if (show_all || counter->used()) {
-      all_stats.emplace(counter->name(), counter->value());
+  std::vector<Stats::CounterSharedPtr> counters;
+  std::vector<Stats::GaugeSharedPtr> gauges;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms;
+  if (!selectStats(params, counters, gauges, histograms, response)) {
+    return Http::Code::BadRequest;
+  }
+
+  if (json) {
+    response_headers.insertContentType().value().setReference(
+        Http::Headers::get().ContentTypeValues.Json);
+    admin_stream.setChunkedResponse(std::make_unique<StatsJsonChunkedResponse>(
+        std::move(counters), std::move(gauges), std::move(histograms)));
+  } else { // Display plain stats if format query param is not there.
+    admin_stream.setChunkedResponse(std::make_unique<StatsTextChunkedResponse>(
+        std::move(counters), std::move(gauges), std::move(histograms)));
+  }
+  return Http::Code::OK;
+}
+
+Http::Code AdminImpl::handlerPrometheusStats(absl::string_view url, Http::HeaderMap&,
+                                             Buffer::Instance& response,
+                                             AdminStream& admin_stream) {
+  const Http::Utility::QueryParams params = Http::Utility::parseQueryString(url);
+  std::vector<Stats::CounterSharedPtr> counters;
+  std::vector<Stats::GaugeSharedPtr> gauges;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms;
+  if (!selectStats(params, counters, gauges, histograms, response)) {
+    return Http::Code::BadRequest;
+  }
+
+  admin_stream.setChunkedResponse(
+      std::make_unique<PrometheusStatsChunkedResponse>(counters, gauges, histograms));
+  return Http::Code::OK;
+}
+
+StatsFilter::StatsFilter(const Http::Utility::QueryParams& params)
+    : used_only_(params.find("usedonly") != params.end()) {
+  const auto prefix = params.find("prefix");
+  if (prefix != params.end()) {
+    prefix_ = prefix->second;
+  }
+
+  const auto filter = params.find("filter");
+  if (filter != params.end()) {
+    // Matchers match whole names, while the filter only needs to match part of one. The pattern
+    // is compiled on its own first so that it can't escape the group it is wrapped in.
+    Regex::Utility::parseRegex(filter->second);
+    regex_ = Regex::Utility::parseRegex(fmt::format(".*(?:{}).*", filter->second));
+  }
+}
+
+bool StatsFilter::matches(const Stats::Metric& metric) const {
+  if (used_only_ && !metric.used()) {
+    return false;
+  }
+
+  const std::string& name = metric.name();
+  return absl::StartsWith(name, prefix_) && (regex_ == nullptr || regex_->match(name));
+}
+
+bool StatsChunkedResponse::nextChunk(Buffer::Instance& response) {
+  const uint64_t start_length = response.length();
+  while (response.length() - start_length < chunk_size_bytes_) {
+    if (!addNext(response)) {
+      return false;
     }
   }
+  return true;
+}
 
-  for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
-    if (show_all || gauge->used()) {
-      all_stats.emplace(gauge->name(), gauge->value());
+SortedStatsChunkedResponse::SortedStatsChunkedResponse(
+    std::vector<Stats::CounterSharedPtr>&& counters, std::vector<Stats::GaugeSharedPtr>&& gauges,
+    std::vector<Stats::ParentHistogramSharedPtr>&& histograms, uint64_t chunk_size_bytes)
+    : StatsChunkedResponse(chunk_size_bytes), counters_(std::move(counters)),
+      gauges_(std::move(gauges)), histograms_(std::move(histograms)) {
+  const auto by_name = [](const auto& lhs, const auto& rhs) -> bool {
+    return lhs->name() < rhs->name();
+  };
+  std::sort(counters_.begin(), counters_.end(), by_name);
+  std::sort(gauges_.begin(), gauges_.end(), by_name);
+  std::sort(histograms_.begin(), histograms_.end(), by_name);
+}
+
+const Stats::Metric* SortedStatsChunkedResponse::nextCounterOrGauge(uint64_t& value) {
+  const bool has_counter = counter_index_ < counters_.size();
+  const bool has_gauge = gauge_index_ < gauges_.size();
+  if (has_counter &&
+      (!has_gauge || counters_[counter_index_]->name() <= gauges_[gauge_index_]->name())) {
+    const Stats::Counter& counter = *counters_[counter_index_++];
+    if (has_gauge && counter.name() == gauges_[gauge_index_]->name()) {
+      ++gauge_index_;
     }
+    value = counter.value();
+    return &counter;
   }
 
-  if (has_format) {
-    const std::string format_value = params.at("format");
-    if (format_value == "json") {
-      response_headers.insertContentType().value().setReference(
-          Http::Headers::get().ContentTypeValues.Json);
-      response.add(AdminImpl::statsAsJson(all_stats, server_.stats().histograms(), show_all));
-    } else if (format_value == "prometheus") {
-      return handlerPrometheusStats(url, response_headers, response, admin_stream);
-    } else {
-      response.add("usage: /stats?format=json  or /stats?format=prometheus \n");
-      response.add("\n");
-      rc = Http::Code::NotFound;
+  if (has_gauge) {
+    const Stats::Gauge& gauge = *gauges_[gauge_index_++];
+    value = gauge.value();
+    return &gauge;
+  }
+  return nullptr;
+}
+
+const Stats::ParentHistogram* SortedStatsChunkedResponse::nextHistogram() {
+  if (histogram_index_ < histograms_.size()) {
+    return histograms_[histogram_index_++].get();
+  }
+  return nullptr;
+}
+
+bool StatsTextChunkedResponse::addNext(Buffer::Instance& response) {
+  uint64_t value;
+  const Stats::Metric* metric = nextCounterOrGauge(value);
+  if (metric != nullptr) {
+    response.add(fmt::format("{}: {}\n", metric->name(), value));
+    return true;
+  }
+
+  const Stats::ParentHistogram* histogram = nextHistogram();
+  if (histogram != nullptr) {
+    response.add(fmt::format("{}: {}\n", histogram->name(), histogram->summary()));
+    return true;
+  }
+  return false;
+}
+
+bool StatsJsonChunkedResponse::addNext(Buffer::Instance& response) {
+  switch (state_) {
+  case State::Start:
+    response.add("{\"stats\":[");
+    state_ = State::Stats;
+    return true;
+  case State::Stats: {
+    uint64_t value;
+    const Stats::Metric* metric = nextCounterOrGauge(value);
+    if (metric != nullptr) {
+      if (!first_entry_) {
+        response.add(",");
+      }
+      first_entry_ = false;
+      rapidjson::StringBuffer strbuf;
+      rapidjson::Writer<StringBuffer> writer(strbuf);
+      writer.StartObject();
+      const std::string name = metric->name();
+      writer.Key("name");
+      writer.String(name.c_str(), name.size());
+      writer.Key("value");
+      writer.Uint64(value);
+      writer.EndObject();
+      response.add(strbuf.GetString(), strbuf.GetSize());
+      return true;
     }
-  } else { // Display plain stats if format query param is not there.
-    for (auto stat : all_stats) {
-      response.add(fmt::format("{}: {}\n", stat.first, stat.second));
+
+    const Stats::ParentHistogram* histogram = nextHistogram();
+    if (histogram == nullptr) {
+      response.add("]}");
+      state_ = State::Done;
+      return true;
     }
-    // TOOD(ramaraochavali): See the comment in ThreadLocalStoreImpl::histograms() for why we use a
-    // multimap here. This makes sure that duplicate histograms get output. When shared storage is
-    // implemented this can be switched back to a normal map.
-    std::multimap<std::string, std::string> all_histograms;
-    for (const Stats::ParentHistogramSharedPtr& histogram : server_.stats().histograms()) {
-      if (show_all || histogram->used()) {
-        all_histograms.emplace(histogram->name(), histogram->summary());
+
+    // All histograms go in a single final element of the stats array.
+    rapidjson::Document document;
+    response.add(first_entry_ ? "{\"histograms\":{\"supported_quantiles\":"
+                              : ",{\"histograms\":{\"supported_quantiles\":");
+    addJson(supportedQuantilesAsJson(document.GetAllocator()), response);
+    response.add(",\"computed_quantiles\":[");
+    addJson(histogramAsJson(*histogram, document.GetAllocator()), response);
+    state_ = State::Histograms;
+    return true;
+  }
+  case State::Histograms: {
+    const Stats::ParentHistogram* histogram = nextHistogram();
+    if (histogram == nullptr) {
+      response.add("]}}]}");
+      state_ = State::Done;
+      return true;
+    }
+
+    rapidjson::Document document;
+    response.add(",");
+    addJson(histogramAsJson(*histogram, document.GetAllocator()), response);
+    return true;
+  }
+  case State::Done:
+    return false;
+  }
+
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+PrometheusStatsChunkedResponse::PrometheusStatsChunkedResponse(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms, uint64_t chunk_size_bytes)
+    : StatsChunkedResponse(chunk_size_bytes) {
+  for (const Stats::CounterSharedPtr& counter : counters) {
+    families_[PrometheusStatsFormatter::metricName(counter->tagExtractedName())]
+        .counters_.push_back(counter);
+  }
+  for (const Stats::GaugeSharedPtr& gauge : gauges) {
+    families_[PrometheusStatsFormatter::metricName(gauge->tagExtractedName())]
+        .gauges_.push_back(gauge);
+  }
+  for (const Stats::ParentHistogramSharedPtr& histogram : histograms) {
+    families_[PrometheusStatsFormatter::metricName(histogram->tagExtractedName())]
+        .histograms_.push_back(histogram);
+  }
+  current_family_ = families_.begin();
+}
+
+bool PrometheusStatsChunkedResponse::addNext(Buffer::Instance& response) {
+  while (current_family_ != families_.end()) {
+    const std::string& metric_name = current_family_->first;
+    const MetricFamily& family = current_family_->second;
+    if (!in_histograms_) {
+      if (index_ < family.counters_.size() + family.gauges_.size()) {
+        if (!type_written_) {
+          response.add(fmt::format("# TYPE {0} {1}\n", metric_name,
+                                   family.counters_.empty() ? "gauge" : "counter"));
+          type_written_ = true;
+          return true;
+        }
+
+        const size_t index = index_++;
+        if (index < family.counters_.size()) {
+          const Stats::Counter& counter = *family.counters_[index];
+          response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name,
+                                   PrometheusStatsFormatter::formattedTags(counter.tags()),
+                                   counter.value()));
+        } else {
+          const Stats::Gauge& gauge = *family.gauges_[index - family.counters_.size()];
+          response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name,
+                                   PrometheusStatsFormatter::formattedTags(gauge.tags()),
+                                   gauge.value()));
+        }
+        return true;
       }
+
+      in_histograms_ = true;
+      type_written_ = false;
+      index_ = 0;
     }
-    for (auto histogram : all_histograms) {
-      response.add(fmt::format("{}: {}\n", histogram.first, histogram.second));
+
+    // Histograms are written with a TYPE line of their own, even if counters or gauges have the
+    // same name, as their samples are only parsed as buckets under the histogram type.
+    if (index_ < family.histograms_.size()) {
+      if (!type_written_) {
+        response.add(fmt::format("# TYPE {0} histogram\n", metric_name));
+        type_written_ = true;
+        return true;
+      }
+
+      addHistogram(metric_name, *family.histograms_[index_++], response);
+      return true;
     }
+
+    ++current_family_;
+    in_histograms_ = false;
+    type_written_ = false;
+    index_ = 0;
   }
-  return rc;
+  return false;
 }
 
-Http::Code AdminImpl::handlerPrometheusStats(absl::string_view, Http::HeaderMap&,
-                                             Buffer::Instance& response, AdminStream&) {
-  PrometheusStatsFormatter::statsAsPrometheus(server_.stats().counters(), server_.stats().gauges(),
-                                              response);
-  return Http::Code::OK;
+void PrometheusStatsChunkedResponse::addHistogram(const std::string& metric_name,
+                                                  const Stats::ParentHistogram& histogram,
+                                                  Buffer::Instance& response) {
+  const std::string tags = PrometheusStatsFormatter::formattedTags(histogram.tags());
+  const std::string bucket_tags = tags.empty() ? "" : tags + ",";
+  // Prometheus histograms count every value since the process started.
+  const Stats::HistogramStatistics& statistics = histogram.cumulativeStatistics();
+  const std::vector<double>& supported_buckets = statistics.supportedBuckets();
+  const std::vector<uint64_t>& computed_buckets = statistics.computedBuckets();
+  // The bucket bounds and the sum are formatted with enough digits to be read back exactly, as
+  // the default only keeps 6 significant digits.
+  for (size_t i = 0; i < supported_buckets.size(); ++i) {
+    response.add(fmt::format("{0}_bucket{{{1}le=\"{2:.17g}\"}} {3}\n", metric_name, bucket_tags,
+                             supported_buckets[i], computed_buckets[i]));
+  }
+  response.add(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", metric_name, bucket_tags,
+                           statistics.sampleCount()));
+  response.add(
+      fmt::format("{0}_sum{{{1}}} {2:.17g}\n", metric_name, tags, statistics.sampleSum()));
+  response.add(
+      fmt::format("{0}_count{{{1}}} {2}\n", metric_name, tags, statistics.sampleCount()));
 }
 
 std::string PrometheusStatsFormatter::sanitizeName(const std::string& name) {
@@ -578,121 +939,14 @@ std::string PrometheusStatsFormatter::metricName(const std::string& extractedNam
   return fmt::format("envoy_{0}", sanitizeName(extractedName));
 }
 
-// TODO(ramaraochavali): Add summary histogram output for Prometheus.
-uint64_t
-PrometheusStatsFormatter::statsAsPrometheus(const std::vector<Stats::CounterSharedPtr>& counters,
-                                            const std::vector<Stats::GaugeSharedPtr>& gauges,
-                                            Buffer::Instance& response) {
-  std::unordered_set<std::string> metric_type_tracker;
-  for (const auto& counter : counters) {
-    const std::string tags = formattedTags(counter->tags());
-    const std::string metric_name = metricName(counter->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} counter\n", metric_name));
-    }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, counter->value()));
-  }
-
-  for (const auto& gauge : gauges) {
-    const std::string tags = formattedTags(gauge->tags());
-    const std::string metric_name = metricName(gauge->tagExtractedName());
-    if (metric_type_tracker.find(metric_name) == metric_type_tracker.end()) {
-      metric_type_tracker.insert(metric_name);
-      response.add(fmt::format("# TYPE {0} gauge\n", metric_name));
-    }
-    response.add(fmt::format("{0}{{{1}}} {2}\n", metric_name, tags, gauge->value()));
-  }
-  return metric_type_tracker.size();
-}
-
-std::string
-AdminImpl::statsAsJson(const std::map<std::string, uint64_t>& all_stats,
-                       const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
-                       const bool show_all, const bool pretty_print) {
-  rapidjson::Document document;
-  document.SetObject();
-  rapidjson::Value stats_array(rapidjson::kArrayType);
-  rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
-  for (auto stat : all_stats) {
-    Value stat_obj;
-    stat_obj.SetObject();
-    Value stat_name;
-    stat_name.SetString(stat.first.c_str(), allocator);
-    stat_obj.AddMember("name", stat_name, allocator);
-    Value stat_value;
-    stat_value.SetInt(stat.second);
-    stat_obj.AddMember("value", stat_value, allocator);
-    stats_array.PushBack(stat_obj, allocator);
-  }
-
-  Value histograms_container_obj;
-  histograms_container_obj.SetObject();
-
-  Value histograms_obj;
-  histograms_obj.SetObject();
-
-  bool found_used_histogram = false;
-  rapidjson::Value histogram_array(rapidjson::kArrayType);
-
-  for (const Stats::ParentHistogramSharedPtr& histogram : all_histograms) {
-    if (show_all || histogram->used()) {
-      if (!found_used_histogram) {
-        // It is not possible for the supported quantiles to differ across histograms, so it is ok
-        // to send them once.
-        Stats::HistogramStatisticsImpl empty_statistics;
-        rapidjson::Value supported_quantile_array(rapidjson::kArrayType);
-        for (double quantile : empty_statistics.supportedQuantiles()) {
-          Value quantile_type;
-          quantile_type.SetDouble(quantile * 100);
-          supported_quantile_array.PushBack(quantile_type, allocator);
-        }
-        histograms_obj.AddMember("supported_quantiles", supported_quantile_array, allocator);
-        found_used_histogram = true;
-      }
-      Value histogram_obj;
-      histogram_obj.SetObject();
-      Value histogram_name;
-      histogram_name.SetString(histogram->name().c_str(), allocator);
-      histogram_obj.AddMember("name", histogram_name, allocator);
-
-      rapidjson::Value computed_quantile_array(rapidjson::kArrayType);
-
-      for (size_t i = 0; i < histogram->intervalStatistics().supportedQuantiles().size(); ++i) {
-        Value quantile_obj;
-        quantile_obj.SetObject();
-        Value interval_value;
-        if (!std::isnan(histogram->intervalStatistics().computedQuantiles()[i])) {
-          interval_value.SetDouble(histogram->intervalStatistics().computedQuantiles()[i]);
-        }
-        quantile_obj.AddMember("interval", interval_value, allocator);
-        Value cumulative_value;
-        // We skip nan entries to put in the {null, null} entry to keep other data aligned.
-        if (!std::isnan(histogram->cumulativeStatistics().computedQuantiles()[i])) {
-          cumulative_value.SetDouble(histogram->cumulativeStatistics().computedQuantiles()[i]);
-        }
-        quantile_obj.AddMember("cumulative", cumulative_value, allocator);
-        computed_quantile_array.PushBack(quantile_obj, allocator);
-      }
-      histogram_obj.AddMember("values", computed_quantile_array, allocator);
-      histogram_array.PushBack(histogram_obj, allocator);
-    }
-  }
-  if (found_used_histogram) {
-    histograms_obj.AddMember("computed_quantiles", histogram_array, allocator);
-    histograms_container_obj.AddMember("histograms", histograms_obj, allocator);
-    stats_array.PushBack(histograms_container_obj, allocator);
-  }
-  document.AddMember("stats", stats_array, allocator);
-  rapidjson::StringBuffer strbuf;
-  if (pretty_print) {
-    rapidjson::PrettyWriter<StringBuffer> writer(strbuf);
-    document.Accept(writer);
-  } else {
-    rapidjson::Writer<StringBuffer> writer(strbuf);
-    document.Accept(writer);
+uint64_t PrometheusStatsFormatter::statsAsPrometheus(
+    const std::vector<Stats::CounterSharedPtr>& counters,
+    const std::vector<Stats::GaugeSharedPtr>& gauges,
+    const std::vector<Stats::ParentHistogramSharedPtr>& histograms, Buffer::Instance& response) {
+  PrometheusStatsChunkedResponse prometheus_response(counters, gauges, histograms);
+  while (prometheus_response.nextChunk(response)) {
   }
-  return strbuf.GetString();
+  return prometheus_response.familyCount();
 }
 
 Http::Code AdminImpl::handlerQuitQuitQuit(absl::string_view, Http::HeaderMap&,
@@ -847,11 +1101,20 @@ void AdminFilter::onComplete() {
   RELEASE_ASSERT(request_headers_, "");
   Http::Code code = parent_.runCallback(path, *header_map, response, *this);
   populateFallbackResponseHeaders(code, *header_map);
-  callbacks_->encodeHeaders(std::move(header_map),
-                            end_stream_on_complete_ && response.length() == 0);
+  // A chunked response ends the stream with its last chunk.
+  const bool end_stream = end_stream_on_complete_ && chunked_response_ == nullptr;
+  callbacks_->encodeHeaders(std::move(header_map), end_stream && response.length() == 0);
 
   if (response.length() > 0) {
-    callbacks_->encodeData(response, end_stream_on_complete_);
+    callbacks_->encodeData(response, end_stream);
+  }
+
+  if (chunked_response_ != nullptr) {
+    chunk_timer_ = callbacks_->dispatcher().createTimer([this]() -> void { writeNextChunk(); });
+    callbacks_->addDownstreamWatermarkCallbacks(*this);
+    if (high_watermark_count_ == 0) {
+      writeNextChunk();
+    }
   }
 }
 
@@ -1101,6 +1364,7 @@ Http::Code AdminImpl::request(absl::string_view path_and_query, absl::string_vie
 
   Http::Code code = runCallback(path_and_query, response_headers, response, filter);
   populateFallbackResponseHeaders(code, response_headers);
+  filter.drainChunkedResponse(response);
   body = response.toString();
   return code;
 }
@@ -1,13 +1,18 @@
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <list>
+#include <map>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "envoy/admin/v2alpha/clusters.pb.h"
+#include "envoy/common/regex.h"
+#include "envoy/event/timer.h"
+#include "envoy/http/codec.h"
 #include "envoy/http/filter.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
@@ -15,7 +20,9 @@
 #include "envoy/server/admin.h"
 #include "envoy/server/instance.h"
 #include "envoy/server/listener_manager.h"
+#include "envoy/stats/histogram.h"
 #include "envoy/stats/scope.h"
+#include "envoy/stats/stats.h"
 #include "envoy/upstream/outlier_detection.h"
 #include "envoy/upstream/resource_manager.h"
 
@@ -26,12 +33,14 @@
 #include "common/http/date_provider_impl.h"
 #include "common/http/default_server_string.h"
 #include "common/http/utility.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/stats/isolated_store_impl.h"
 
 #include "server/http/config_tracker_impl.h"
 
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Server {
@@ -165,9 +174,16 @@ private:
   void writeClustersAsJson(Buffer::Instance& response);
   void writeClustersAsText(Buffer::Instance& response);
 
-  static std::string statsAsJson(const std::map<std::string, uint64_t>& all_stats,
-                                 const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
-                                 bool show_all, bool pretty_print = false);
+  /**
+   * Collects the stats selected by the query params of a /stats request.
+   * @return bool false if the query params are invalid, in which case the reason is added to the
+   *         response.
+   */
+  bool selectStats(const Http::Utility::QueryParams& params,
+                   std::vector<Stats::CounterSharedPtr>& counters,
+                   std::vector<Stats::GaugeSharedPtr>& gauges,
+                   std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+                   Buffer::Instance& response);
   static std::string
   runtimeAsJson(const std::vector<std::pair<std::string, Runtime::Snapshot::Entry>>& entries);
   std::vector<const UrlHandler*> sortedHandlers() const;
@@ -233,15 +249,21 @@ private:
     Network::FilterChainManager& filterChainManager() override { return parent_; }
     Network::FilterChainFactory& filterChainFactory() override { return parent_; }
     Network::Socket& socket() override { return parent_.mutable_socket(); }
+    Network::Socket& workerSocket(uint32_t) override { return socket(); }
+    bool reusePort() const override { return false; }
     bool bindToPort() override { return true; }
     bool handOffRestoredDestinationConnections() const override { return false; }
-    uint32_t perConnectionBufferLimitBytes() override { return 0; }
+    // Bounds the data buffered for slow clients, so that chunked responses such as /stats are
+    // only produced as fast as they are read.
+    uint32_t perConnectionBufferLimitBytes() override { return 1024 * 1024; }
     Stats::Scope& listenerScope() override { return *scope_; }
     uint64_t listenerTag() const override { return 0; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
 
     AdminImpl& parent_;
     const std::string name_;
+    Network::NopConnectionBalancerImpl connection_balancer_;
     Stats::ScopePtr scope_;
     Http::ConnectionManagerListenerStats stats_;
   };
@@ -289,6 +311,7 @@ private:
  * A terminal HTTP filter that implements server admin functionality.
  */
 class AdminFilter : public Http::StreamDecoderFilter,
+                    public Http::DownstreamWatermarkCallbacks,
                     public AdminStream,
                     Logger::Loggable<Logger::Id::admin> {
 public:
@@ -305,18 +328,38 @@ public:
     callbacks_ = &callbacks;
   }
 
+  // Http::DownstreamWatermarkCallbacks
+  void onAboveWriteBufferHighWatermark() override;
+  void onBelowWriteBufferLowWatermark() override;
+
   // AdminStream
   void setEndStreamOnComplete(bool end_stream) override { end_stream_on_complete_ = end_stream; }
+  void setChunkedResponse(AdminChunkedResponsePtr&& response) override {
+    chunked_response_ = std::move(response);
+  }
   void addOnDestroyCallback(std::function<void()> cb) override;
   Http::StreamDecoderFilterCallbacks& getDecoderFilterCallbacks() const override;
   const Http::HeaderMap& getRequestHeaders() const override;
 
+  /**
+   * Append all remaining chunks of a chunked response set by the handler to the buffer. This is
+   * used when a request is run without a downstream stream to write the chunks to.
+   * @param response supplies the buffer to append to.
+   */
+  void drainChunkedResponse(Buffer::Instance& response);
+
 private:
   /**
    * Called when an admin request has been completely received.
    */
   void onComplete();
 
+  /**
+   * Write the next chunk of the chunked response, and schedule the one after it unless the
+   * downstream is backed up.
+   */
+  void writeNextChunk();
+
   AdminImpl& parent_;
   // Handlers relying on the reference should use addOnDestroyCallback()
   // to add a callback that will notify them when the reference is no
@@ -325,6 +368,192 @@ private:
   Http::HeaderMap* request_headers_{};
   std::list<std::function<void()>> on_destroy_callbacks_;
   bool end_stream_on_complete_ = true;
+  AdminChunkedResponsePtr chunked_response_;
+  // Each chunk is written from its own event loop iteration, so that streaming a large response
+  // does not hold up the other work of the main thread.
+  Event::TimerPtr chunk_timer_;
+  uint32_t high_watermark_count_{};
+};
+
+/**
+ * Selects the stats to include in a /stats response, from the query params of the request:
+ *   usedonly: only stats that have been updated since the server was started.
+ *   filter=<regex>: only stats whose name contains a match of the regex.
+ *   prefix=<prefix>: only stats whose name starts with the prefix.
+ */
+class StatsFilter {
+public:
+  /**
+   * @param params supplies the query params of the request.
+   * @throw EnvoyException if the filter param is not a valid regex.
+   */
+  StatsFilter(const Http::Utility::QueryParams& params);
+
+  /**
+   * @return bool whether the metric is to be included in the response.
+   */
+  bool matches(const Stats::Metric& metric) const;
+
+  /**
+   * Remove the stats that are not to be included in the response.
+   * @param stats supplies the stats to filter in place.
+   */
+  template <class StatType> void apply(std::vector<std::shared_ptr<StatType>>& stats) const {
+    stats.erase(std::remove_if(stats.begin(), stats.end(),
+                               [this](const std::shared_ptr<StatType>& stat) {
+                                 return !matches(*stat);
+                               }),
+                stats.end());
+  }
+
+private:
+  const bool used_only_;
+  std::string prefix_;
+  Regex::CompiledMatcherSharedPtr regex_;
+};
+
+/**
+ * Base class for the chunked /stats responses. The stats to include are selected when the
+ * response is created and are held as shared pointers, which keeps them alive while the response
+ * is streamed. Stats are formatted one at a time until a chunk is full, so the formatted output
+ * is never held in memory all at once.
+ */
+class StatsChunkedResponse : public AdminChunkedResponse {
+public:
+  static constexpr uint64_t DEFAULT_CHUNK_SIZE_BYTES = 64 * 1024;
+
+  // Server::AdminChunkedResponse
+  bool nextChunk(Buffer::Instance& response) override;
+
+protected:
+  StatsChunkedResponse(uint64_t chunk_size_bytes) : chunk_size_bytes_(chunk_size_bytes) {}
+
+  /**
+   * Append the next piece of the output, usually a single stat.
+   * @param response supplies the buffer to append to.
+   * @return bool false if the output is complete and nothing was appended.
+   */
+  virtual bool addNext(Buffer::Instance& response) PURE;
+
+private:
+  const uint64_t chunk_size_bytes_;
+};
+
+/**
+ * Base class for the /stats responses that list the counters and gauges merged in name order,
+ * followed by the histograms in name order.
+ */
+class SortedStatsChunkedResponse : public StatsChunkedResponse {
+protected:
+  SortedStatsChunkedResponse(std::vector<Stats::CounterSharedPtr>&& counters,
+                             std::vector<Stats::GaugeSharedPtr>&& gauges,
+                             std::vector<Stats::ParentHistogramSharedPtr>&& histograms,
+                             uint64_t chunk_size_bytes);
+
+  /**
+   * @param value supplies the value of the returned counter or gauge.
+   * @return const Stats::Metric* the next counter or gauge in name order, or nullptr once they
+   *         have all been returned. A gauge with the same name as a counter is skipped.
+   */
+  const Stats::Metric* nextCounterOrGauge(uint64_t& value);
+
+  /**
+   * @return const Stats::ParentHistogram* the next histogram in name order, or nullptr once they
+   *         have all been returned.
+   */
+  const Stats::ParentHistogram* nextHistogram();
+
+private:
+  std::vector<Stats::CounterSharedPtr> counters_;
+  std::vector<Stats::GaugeSharedPtr> gauges_;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms_;
+  size_t counter_index_{};
+  size_t gauge_index_{};
+  size_t histogram_index_{};
+};
+
+/**
+ * The plain text /stats response, with one "<name>: <value>" line per stat.
+ */
+class StatsTextChunkedResponse : public SortedStatsChunkedResponse {
+public:
+  StatsTextChunkedResponse(std::vector<Stats::CounterSharedPtr>&& counters,
+                           std::vector<Stats::GaugeSharedPtr>&& gauges,
+                           std::vector<Stats::ParentHistogramSharedPtr>&& histograms,
+                           uint64_t chunk_size_bytes = DEFAULT_CHUNK_SIZE_BYTES)
+      : SortedStatsChunkedResponse(std::move(counters), std::move(gauges), std::move(histograms),
+                                   chunk_size_bytes) {}
+
+protected:
+  // Server::StatsChunkedResponse
+  bool addNext(Buffer::Instance& response) override;
+};
+
+/**
+ * The /stats?format=json response, written one stat at a time.
+ */
+class StatsJsonChunkedResponse : public SortedStatsChunkedResponse {
+public:
+  StatsJsonChunkedResponse(std::vector<Stats::CounterSharedPtr>&& counters,
+                           std::vector<Stats::GaugeSharedPtr>&& gauges,
+                           std::vector<Stats::ParentHistogramSharedPtr>&& histograms,
+                           uint64_t chunk_size_bytes = DEFAULT_CHUNK_SIZE_BYTES)
+      : SortedStatsChunkedResponse(std::move(counters), std::move(gauges), std::move(histograms),
+                                   chunk_size_bytes) {}
+
+protected:
+  // Server::StatsChunkedResponse
+  bool addNext(Buffer::Instance& response) override;
+
+private:
+  enum class State { Start, Stats, Histograms, Done };
+
+  State state_{State::Start};
+  bool first_entry_{true};
+};
+
+/**
+ * The Prometheus text exposition format response for /stats/prometheus. Stats are grouped into
+ * metric families by their tag extracted name, so that all samples of a family follow its TYPE
+ * line. Histograms are exposed with cumulative buckets, a sum and a count.
+ *
+ * See: https://prometheus.io/docs/instrumenting/exposition_formats
+ */
+class PrometheusStatsChunkedResponse : public StatsChunkedResponse {
+public:
+  PrometheusStatsChunkedResponse(const std::vector<Stats::CounterSharedPtr>& counters,
+                                 const std::vector<Stats::GaugeSharedPtr>& gauges,
+                                 const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
+                                 uint64_t chunk_size_bytes = DEFAULT_CHUNK_SIZE_BYTES);
+
+  /**
+   * @return uint64_t the number of metric families, i.e. of unique metric names, in the response.
+   */
+  uint64_t familyCount() const { return families_.size(); }
+
+protected:
+  // Server::StatsChunkedResponse
+  bool addNext(Buffer::Instance& response) override;
+
+private:
+  struct MetricFamily {
+    std::vector<Stats::CounterSharedPtr> counters_;
+    std::vector<Stats::GaugeSharedPtr> gauges_;
+    std::vector<Stats::ParentHistogramSharedPtr> histograms_;
+  };
+
+  static void addHistogram(const std::string& metric_name, const Stats::ParentHistogram& histogram,
+                           Buffer::Instance& response);
+
+  // Keyed by the Prometheus metric name. Counters and gauges that map to the same name share a
+  // family, which is typed as a counter if it has any counters. Histograms that map to the name
+  // are written after them under a TYPE line of their own.
+  std::map<std::string, MetricFamily> families_;
+  std::map<std::string, MetricFamily>::const_iterator current_family_;
+  // Whether the histograms of the current family are being written.
+  bool in_histograms_{};
+  bool type_written_{};
+  size_t index_{};
 };
 
 /**
@@ -335,12 +564,13 @@ private:
 class PrometheusStatsFormatter {
 public:
   /**
-   * Extracts counters and gauges and relevant tags, appending them to
+   * Extracts counters, gauges and histograms and relevant tags, appending them to
    * the response buffer after sanitizing the metric / label names.
    * @return uint64_t total number of metric types inserted in response.
    */
   static uint64_t statsAsPrometheus(const std::vector<Stats::CounterSharedPtr>& counters,
                                     const std::vector<Stats::GaugeSharedPtr>& gauges,
+                                    const std::vector<Stats::ParentHistogramSharedPtr>& histograms,
                                     Buffer::Instance& response);
   /**
    * Format the given tags, returning a string as a comma-separated list
@@ -10,6 +10,7 @@
 #include "common/common/empty_string.h"
 #include "common/common/fmt.h"
 #include "common/config/utility.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/resolver_impl.h"
 #include "common/network/socket_option_factory.h"
@@ -86,15 +87,17 @@ ProdListenerComponentFactory::createListenerFilterFactoryList_(
 Network::SocketSharedPtr
 ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                                  const Network::Socket::OptionsSharedPtr& options,
-                                                 bool bind_to_port) {
+                                                 bool bind_to_port, bool reuse_port,
+                                                 uint32_t worker_index) {
   ASSERT(address->type() == Network::Address::Type::Ip ||
          address->type() == Network::Address::Type::Pipe);
 
-  // For each listener config we share a single socket among all threaded listeners.
-  // First we try to get the socket from our parent if applicable.
+  // Unless the listener has a socket per worker, we share a single socket among all threaded
+  // listeners. First we try to get the socket from our parent if applicable.
   if (address->type() == Network::Address::Type::Pipe) {
+    ASSERT(worker_index == 0);
     const std::string addr = fmt::format("unix://{}", address->asString());
-    const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+    const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index, false);
     if (fd != -1) {
       ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
       return std::make_shared<Network::UdsListenSocket>(fd, address);
@@ -103,9 +106,9 @@ ProdListenerComponentFactory::createListenSocket(Network::Address::InstanceConst
   }
 
   const std::string addr = fmt::format("tcp://{}", address->asString());
-  const int fd = server_.hotRestart().duplicateParentListenSocket(addr);
+  const int fd = server_.hotRestart().duplicateParentListenSocket(addr, worker_index, reuse_port);
   if (fd != -1) {
-    ENVOY_LOG(debug, "obtained socket for address {} from parent", addr);
+    ENVOY_LOG(debug, "obtained socket {} for address {} from parent", worker_index, addr);
     return std::make_shared<Network::TcpListenSocket>(fd, address, options);
   }
   return std::make_shared<Network::TcpListenSocket>(address, options, bind_to_port);
@@ -124,6 +127,7 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
       listener_scope_(
           parent_.server_.stats().createScope(fmt::format("listener.{}.", address_->asString()))),
       bind_to_port_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.deprecated_v1(), bind_to_port, true)),
+      reuse_port_(config.reuse_port()),
       hand_off_restored_destination_connections_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, use_original_dst, false)),
       per_connection_buffer_limit_bytes_(
@@ -138,6 +142,21 @@ ListenerImpl::ListenerImpl(const envoy::api::v2::Listener& config, const std::st
   if (config.has_freebind()) {
     addListenSocketOptions(Network::SocketOptionFactory::buildIpFreebindOptions());
   }
+  if (reuse_port_) {
+    if (address_->type() != Network::Address::Type::Ip) {
+      throw EnvoyException(fmt::format(
+          "error adding listener '{}': reuse_port is only supported for IP addresses",
+          address_->asString()));
+    }
+    addListenSocketOptions(Network::SocketOptionFactory::buildReusePortOptions());
+  }
+  if (config.has_connection_balance_config()) {
+    // exact_balance is the only balance type, and one is required by validation.
+    ASSERT(config.connection_balance_config().has_exact_balance());
+    connection_balancer_ = std::make_unique<Network::ExactConnectionBalancerImpl>();
+  } else {
+    connection_balancer_ = std::make_unique<Network::NopConnectionBalancerImpl>();
+  }
   if (config.has_tcp_fast_open_queue_length()) {
     addListenSocketOptions(Network::SocketOptionFactory::buildTcpFastOpenOptions(
         config.tcp_fast_open_queue_length().value()));
@@ -547,13 +566,20 @@ Init::Manager& ListenerImpl::initManager() {
   }
 }
 
-void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
-  ASSERT(!socket_);
-  socket_ = socket;
+void ListenerImpl::setSockets(const ListenSockets& sockets) {
+  ASSERT(sockets_.empty());
+  ASSERT(!sockets.empty());
+  sockets_ = sockets;
+  for (const Network::SocketSharedPtr& socket : sockets_) {
+    setSocketOptions(socket);
+  }
+}
+
+void ListenerImpl::setSocketOptions(const Network::SocketSharedPtr& socket) {
   // Server config validation sets nullptr sockets.
-  if (socket_ && listen_socket_options_) {
+  if (socket && listen_socket_options_) {
     // 'pre_bind = false' as bind() is never done after this.
-    bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket_,
+    bool ok = Network::Socket::applyOptions(listen_socket_options_, *socket,
                                             envoy::api::v2::core::SocketOption::STATE_BOUND);
     const std::string message =
         fmt::format("{}: Setting socket options {}", name_, ok ? "succeeded" : "failed");
@@ -564,9 +590,9 @@ void ListenerImpl::setSocket(const Network::SocketSharedPtr& socket) {
       ENVOY_LOG(debug, "{}", message);
     }
 
-    // Add the options to the socket_ so that STATE_LISTENING options can be
+    // Add the options to the socket so that STATE_LISTENING options can be
     // set in the worker after listen()/evconnlistener_new() is called.
-    socket_->addOptions(listen_socket_options_);
+    socket->addOptions(listen_socket_options_);
   }
 }
 
@@ -579,7 +605,7 @@ ListenerManagerImpl::ListenerManagerImpl(Instance& server,
       config_tracker_entry_(server.admin().getConfigTracker().add(
           "listeners", [this] { return dumpListenerConfigs(); })) {
   for (uint32_t i = 0; i < std::max(1U, server.options().concurrency()); i++) {
-    workers_.emplace_back(worker_factory.createWorker());
+    workers_.emplace_back(worker_factory.createWorker(i));
   }
 }
 
@@ -669,17 +695,30 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     throw EnvoyException(message);
   }
 
+  // The same goes for whether the listener has a socket per worker, as the sockets are handed over
+  // from the existing listener.
+  if ((existing_warming_listener != warming_listeners_.end() &&
+       (*existing_warming_listener)->reusePort() != new_listener->reusePort()) ||
+      (existing_active_listener != active_listeners_.end() &&
+       (*existing_active_listener)->reusePort() != new_listener->reusePort())) {
+    const std::string message = fmt::format(
+        "error updating listener: '{}' has a different reuse_port setting from existing listener",
+        name);
+    ENVOY_LOG(warn, "{}", message);
+    throw EnvoyException(message);
+  }
+
   bool added = false;
   if (existing_warming_listener != warming_listeners_.end()) {
     // In this case we can just replace inline.
     ASSERT(workers_started_);
     new_listener->debugLog("update warming listener");
-    new_listener->setSocket((*existing_warming_listener)->getSocket());
+    new_listener->setSockets((*existing_warming_listener)->getSockets());
     *existing_warming_listener = std::move(new_listener);
   } else if (existing_active_listener != active_listeners_.end()) {
     // In this case we have no warming listener, so what we do depends on whether workers
     // have been started or not. Either way we get the socket from the existing listener.
-    new_listener->setSocket((*existing_active_listener)->getSocket());
+    new_listener->setSockets((*existing_active_listener)->getSockets());
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -708,21 +747,18 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
     // to see if there is a listener that has a socket bound to the address we are configured for.
     // This is an edge case, but may happen if a listener is removed and then added back with a same
     // or different name and intended to listen on the same address. This should work and not fail.
-    Network::SocketSharedPtr draining_listener_socket;
+    // The draining listener's sockets can only be taken over if it has the same reuse_port
+    // setting.
     auto existing_draining_listener = std::find_if(
         draining_listeners_.cbegin(), draining_listeners_.cend(),
         [&new_listener](const DrainingListener& listener) {
-          return *new_listener->address() == *listener.listener_->socket().localAddress();
+          return *new_listener->address() == *listener.listener_->socket().localAddress() &&
+                 new_listener->reusePort() == listener.listener_->reusePort();
         });
-    if (existing_draining_listener != draining_listeners_.cend()) {
-      draining_listener_socket = existing_draining_listener->listener_->getSocket();
-    }
 
-    new_listener->setSocket(draining_listener_socket
-                                ? draining_listener_socket
-                                : factory_.createListenSocket(new_listener->address(),
-                                                              new_listener->listenSocketOptions(),
-                                                              new_listener->bindToPort()));
+    new_listener->setSockets(existing_draining_listener != draining_listeners_.cend()
+                                 ? existing_draining_listener->listener_->getSockets()
+                                 : createListenSockets(*new_listener));
     if (workers_started_) {
       new_listener->debugLog("add warming listener");
       warming_listeners_.emplace_back(std::move(new_listener));
@@ -745,6 +781,23 @@ bool ListenerManagerImpl::addOrUpdateListener(const envoy::api::v2::Listener& co
   return true;
 }
 
+ListenSockets ListenerManagerImpl::createListenSockets(ListenerImpl& listener) {
+  ListenSockets sockets;
+  sockets.push_back(factory_.createListenSocket(listener.address(), listener.listenSocketOptions(),
+                                                listener.bindToPort(), listener.reusePort(), 0));
+  if (listener.reusePort()) {
+    // The rest of the sockets bind to the address of the first one, so that they all end up on the
+    // same port if the listener binds to port 0. Server config validation creates nullptr sockets.
+    const Network::Address::InstanceConstSharedPtr address =
+        sockets[0] ? sockets[0]->localAddress() : listener.address();
+    for (uint32_t i = 1; i < workers_.size(); i++) {
+      sockets.push_back(factory_.createListenSocket(address, listener.listenSocketOptions(),
+                                                    listener.bindToPort(), true, i));
+    }
+  }
+  return sockets;
+}
+
 bool ListenerManagerImpl::hasListenerWithAddress(const ListenerList& list,
                                                  const Network::Address::Instance& address) {
   for (const auto& listener : list) {
@@ -62,7 +62,8 @@ public:
   }
   Network::SocketSharedPtr createListenSocket(Network::Address::InstanceConstSharedPtr address,
                                               const Network::Socket::OptionsSharedPtr& options,
-                                              bool bind_to_port) override;
+                                              bool bind_to_port, bool reuse_port,
+                                              uint32_t worker_index) override;
   DrainManagerPtr createDrainManager(envoy::api::v2::Listener::DrainType drain_type) override;
   uint64_t nextListenerTag() override { return next_listener_tag_++; }
 
@@ -74,6 +75,10 @@ private:
 class ListenerImpl;
 typedef std::unique_ptr<ListenerImpl> ListenerImplPtr;
 
+// The listen sockets of a listener. This is a single socket shared by all workers, or a
+// SO_REUSEPORT socket for each worker if the listener is configured with reuse_port.
+typedef std::vector<Network::SocketSharedPtr> ListenSockets;
+
 /**
  * All listener manager stats. @see stats_macros.h
  */
@@ -136,6 +141,11 @@ private:
   };
 
   void addListenerToWorker(Worker& worker, ListenerImpl& listener);
+  /**
+   * Create the listen sockets for a new listener, which is a socket per worker if the listener is
+   * configured with reuse_port.
+   */
+  ListenSockets createListenSockets(ListenerImpl& listener);
   ProtobufTypes::MessagePtr dumpListenerConfigs();
   static ListenerManagerStats generateStats(Stats::Scope& scope);
   static bool hasListenerWithAddress(const ListenerList& list,
@@ -227,19 +237,26 @@ public:
 
   Network::Address::InstanceConstSharedPtr address() const { return address_; }
   const envoy::api::v2::Listener& config() { return config_; }
-  const Network::SocketSharedPtr& getSocket() const { return socket_; }
+  const ListenSockets& getSockets() const { return sockets_; }
   void debugLog(const std::string& message);
   void initialize();
   DrainManager& localDrainManager() const { return *local_drain_manager_; }
-  void setSocket(const Network::SocketSharedPtr& socket);
-  void setSocketAndOptions(const Network::SocketSharedPtr& socket);
+  void setSockets(const ListenSockets& sockets);
   const Network::Socket::OptionsSharedPtr& listenSocketOptions() { return listen_socket_options_; }
   const std::string& versionInfo() { return version_info_; }
 
   // Network::ListenerConfig
   Network::FilterChainManager& filterChainManager() override { return *this; }
   Network::FilterChainFactory& filterChainFactory() override { return *this; }
-  Network::Socket& socket() override { return *socket_; }
+  Network::Socket& socket() override { return *sockets_[0]; }
+  Network::Socket& workerSocket(uint32_t worker_index) override {
+    if (sockets_.size() == 1) {
+      return *sockets_[0];
+    }
+    ASSERT(worker_index < sockets_.size());
+    return *sockets_[worker_index];
+  }
+  bool reusePort() const override { return reuse_port_; }
   bool bindToPort() override { return bind_to_port_; }
   bool handOffRestoredDestinationConnections() const override {
     return hand_off_restored_destination_connections_;
@@ -248,6 +265,7 @@ public:
   Stats::Scope& listenerScope() override { return *listener_scope_; }
   uint64_t listenerTag() const override { return listener_tag_; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
 
   // Server::Configuration::ListenerFactoryContext
   AccessLog::AccessLogManager& accessLogManager() override {
@@ -361,6 +379,7 @@ private:
                                          const Network::ConnectionSocket& socket) const;
 
   static bool isWildcardServerName(const std::string& name);
+  void setSocketOptions(const Network::SocketSharedPtr& socket);
 
   // Mapping of FilterChain's configured destination ports, IPs, server names, transport protocols
   // and application protocols, using structures defined above.
@@ -368,10 +387,11 @@ private:
 
   ListenerManagerImpl& parent_;
   Network::Address::InstanceConstSharedPtr address_;
-  Network::SocketSharedPtr socket_;
+  ListenSockets sockets_;
   Stats::ScopePtr global_scope_;   // Stats with global named scope, but needed for LDS cleanup.
   Stats::ScopePtr listener_scope_; // Stats with listener named scope.
   const bool bind_to_port_;
+  const bool reuse_port_;
   const bool hand_off_restored_destination_connections_;
   const uint32_t per_connection_buffer_limit_bytes_;
   const uint64_t listener_tag_;
@@ -387,6 +407,7 @@ private:
   const envoy::api::v2::Listener config_;
   const std::string version_info_;
   Network::Socket::OptionsSharedPtr listen_socket_options_;
+  Network::ConnectionBalancerPtr connection_balancer_;
 };
 
 class FilterChainImpl : public Network::FilterChain {
@@ -14,11 +14,11 @@
 namespace Envoy {
 namespace Server {
 
-WorkerPtr ProdWorkerFactory::createWorker() {
+WorkerPtr ProdWorkerFactory::createWorker(uint32_t index) {
   Event::DispatcherPtr dispatcher(api_.allocateDispatcher());
-  return WorkerPtr{new WorkerImpl(
-      tls_, hooks_, std::move(dispatcher),
-      Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(ENVOY_LOGGER(), *dispatcher)})};
+  return WorkerPtr{new WorkerImpl(tls_, hooks_, std::move(dispatcher),
+                                  Network::ConnectionHandlerPtr{new ConnectionHandlerImpl(
+                                      ENVOY_LOGGER(), *dispatcher, index)})};
 }
 
 WorkerImpl::WorkerImpl(ThreadLocal::Instance& tls, TestHooks& hooks,
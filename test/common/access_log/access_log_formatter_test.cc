@@ -468,6 +468,53 @@ TEST(AccessLogFormatterTest, CompositeFormatterSuccess) {
   }
 }
 
+TEST(AccessLogFormatterTest, CompositeFormatterAppends) {
+  NiceMock<RequestInfo::MockRequestInfo> request_info;
+  Http::TestHeaderMapImpl request_header{{":method", "GET"}, {":path", "/"}};
+  Http::TestHeaderMapImpl response_header;
+  Http::TestHeaderMapImpl response_trailer;
+  FormatterImpl formatter("%REQ(:METHOD)% %REQ(:PATH)% %DURATION%\n");
+
+  std::string output = "prefix ";
+  formatter.formatInto(output, request_header, response_header, response_trailer, request_info);
+  EXPECT_EQ("prefix GET / -\n", output);
+}
+
+TEST(AccessLogFormatterTest, JsonFormatter) {
+  NiceMock<RequestInfo::MockRequestInfo> request_info;
+  Http::TestHeaderMapImpl request_header{{":method", "GET"},
+                                         {":path", "/a\"b\\c"},
+                                         {"user-agent", "line1\nline2\x01"}};
+  Http::TestHeaderMapImpl response_header;
+  Http::TestHeaderMapImpl response_trailer;
+
+  {
+    JsonFormatterImpl formatter({{"method", "%REQ(:METHOD)%"},
+                                 {"path", "%REQ(:PATH)%"},
+                                 {"request", "%REQ(:METHOD)% %REQ(:PATH)%"},
+                                 {"user_agent", "%REQ(USER-AGENT)%"},
+                                 {"missing", "%REQ(X-MISSING)%"}});
+
+    EXPECT_EQ("{\"method\":\"GET\",\"missing\":\"-\",\"path\":\"/a\\\"b\\\\c\","
+              "\"request\":\"GET /a\\\"b\\\\c\",\"user_agent\":\"line1\\nline2\\u0001\"}\n",
+              formatter.format(request_header, response_header, response_trailer, request_info));
+  }
+
+  {
+    JsonFormatterImpl formatter({{"quoted\"key", "plain"}});
+    EXPECT_EQ("{\"quoted\\\"key\":\"plain\"}\n",
+              formatter.format(request_header, response_header, response_trailer, request_info));
+  }
+
+  {
+    JsonFormatterImpl formatter({});
+    EXPECT_EQ("{}\n",
+              formatter.format(request_header, response_header, response_trailer, request_info));
+  }
+
+  EXPECT_THROW(JsonFormatterImpl({{"bad", "%NOT_VALID%"}}), EnvoyException);
+}
+
 TEST(AccessLogFormatterTest, ParserFailures) {
   AccessLogFormatParser parser;
 
@@ -0,0 +1,158 @@
+#include "common/buffer/buffer_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+
+// The first argument of each benchmark selects the buffer implementation: 0 for the evbuffer-based
+// implementation and 1 for the native slice-based implementation.
+static void useImplementation(const benchmark::State& state) {
+  Buffer::OwnedImpl::useOldImpl(state.range(0) == 0);
+}
+
+// Test the creation of an empty OwnedImpl.
+static void BM_BufferCreate(benchmark::State& state) {
+  useImplementation(state);
+  uint64_t length = 0;
+  for (auto _ : state) {
+    Buffer::OwnedImpl buffer;
+    length += buffer.length();
+  }
+  benchmark::DoNotOptimize(length);
+}
+BENCHMARK(BM_BufferCreate)->Arg(0)->Arg(1);
+
+// Test the appending of small strings to a buffer, which should hit the in-place fast path of the
+// native implementation. The second argument is the size of each write.
+static void BM_AddSmallWrites(benchmark::State& state) {
+  useImplementation(state);
+  const std::string data(state.range(1), 'a');
+  for (auto _ : state) {
+    Buffer::OwnedImpl buffer;
+    for (int i = 0; i < 64; i++) {
+      buffer.add(data.data(), data.size());
+    }
+    benchmark::DoNotOptimize(buffer.length());
+  }
+}
+BENCHMARK(BM_AddSmallWrites)->Args({0, 1})->Args({1, 1})->Args({0, 64})->Args({1, 64});
+
+// Test the appending of reads of typical socket read sizes via reserve()/commit(). The second
+// argument is the read size.
+static void BM_ReserveCommit(benchmark::State& state) {
+  useImplementation(state);
+  const uint64_t read_size = state.range(1);
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    Buffer::RawSlice slices[2];
+    const uint64_t num_slices = buffer.reserve(read_size, slices, 2);
+    uint64_t remaining = read_size;
+    for (uint64_t i = 0; i < num_slices; i++) {
+      slices[i].len_ = std::min(static_cast<uint64_t>(slices[i].len_), remaining);
+      remaining -= slices[i].len_;
+    }
+    buffer.commit(slices, num_slices);
+    buffer.drain(buffer.length());
+  }
+}
+BENCHMARK(BM_ReserveCommit)
+    ->Args({0, 16384})
+    ->Args({1, 16384})
+    ->Args({0, 65536})
+    ->Args({1, 65536});
+
+// Test moving the full content of one buffer into another. The second argument is the size of
+// the data being moved.
+static void BM_MoveFull(benchmark::State& state) {
+  useImplementation(state);
+  const std::string data(state.range(1), 'a');
+  Buffer::OwnedImpl buffer1(data);
+  Buffer::OwnedImpl buffer2;
+  for (auto _ : state) {
+    buffer2.move(buffer1);
+    buffer1.move(buffer2);
+  }
+  benchmark::DoNotOptimize(buffer1.length());
+}
+BENCHMARK(BM_MoveFull)->Args({0, 1})->Args({1, 1})->Args({0, 16384})->Args({1, 16384});
+
+// Test moving part of one buffer into another. The second argument is the number of bytes moved
+// per iteration out of a 64 KiB buffer.
+static void BM_MovePartial(benchmark::State& state) {
+  useImplementation(state);
+  const std::string data(65536, 'a');
+  const uint64_t move_size = state.range(1);
+  Buffer::OwnedImpl buffer1(data);
+  Buffer::OwnedImpl buffer2;
+  for (auto _ : state) {
+    buffer2.move(buffer1, move_size);
+    buffer1.move(buffer2);
+  }
+  benchmark::DoNotOptimize(buffer1.length());
+}
+BENCHMARK(BM_MovePartial)->Args({0, 1})->Args({1, 1})->Args({0, 4096})->Args({1, 4096});
+
+// Test draining a buffer in chunks. The second argument is the drain size.
+static void BM_Drain(benchmark::State& state) {
+  useImplementation(state);
+  const std::string data(65536, 'a');
+  const uint64_t drain_size = state.range(1);
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    buffer.add(data);
+    while (buffer.length() != 0) {
+      buffer.drain(std::min(drain_size, buffer.length()));
+    }
+  }
+  benchmark::DoNotOptimize(buffer.length());
+}
+BENCHMARK(BM_Drain)->Args({0, 1024})->Args({1, 1024})->Args({0, 16384})->Args({1, 16384});
+
+// Test searching for a pattern that is split across slices, which is the common case for
+// HTTP/1 header and chunk parsing. The second argument is the number of slices.
+static void BM_Search(benchmark::State& state) {
+  useImplementation(state);
+  const std::string slice_data(4096, 'a');
+  const std::string pattern("\r\n\r\n");
+  Buffer::OwnedImpl buffer;
+  for (int64_t i = 0; i < state.range(1); i++) {
+    Buffer::OwnedImpl slice(slice_data);
+    buffer.move(slice);
+  }
+  Buffer::OwnedImpl suffix(pattern);
+  buffer.move(suffix);
+  ssize_t result = 0;
+  for (auto _ : state) {
+    result += buffer.search(pattern.data(), pattern.size(), 0);
+  }
+  benchmark::DoNotOptimize(result);
+}
+BENCHMARK(BM_Search)->Args({0, 1})->Args({1, 1})->Args({0, 16})->Args({1, 16});
+
+// Test linearizing the beginning of a buffer consisting of many small slices.
+static void BM_Linearize(benchmark::State& state) {
+  useImplementation(state);
+  const std::string slice_data(state.range(1), 'a');
+  for (auto _ : state) {
+    state.PauseTiming();
+    Buffer::OwnedImpl buffer;
+    for (int i = 0; i < 16; i++) {
+      Buffer::OwnedImpl slice(slice_data);
+      buffer.move(slice);
+    }
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(buffer.linearize(buffer.length()));
+  }
+}
+BENCHMARK(BM_Linearize)->Args({0, 1024})->Args({1, 1024})->Args({0, 8192})->Args({1, 8192});
+
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
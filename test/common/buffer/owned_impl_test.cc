@@ -1,6 +1,7 @@
 #include "common/api/os_sys_calls_impl.h"
 #include "common/buffer/buffer_impl.h"
 
+#include "test/common/buffer/utility.h"
 #include "test/mocks/api/mocks.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 
@@ -15,14 +16,15 @@ namespace Envoy {
 namespace Buffer {
 namespace {
 
-class OwnedImplTest : public testing::Test {
+class OwnedImplTest : public BufferImplementationParamTest {
 public:
-  OwnedImplTest() {}
-
   bool release_callback_called_ = false;
 };
 
-TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
+INSTANTIATE_TEST_CASE_P(OwnedImplTest, OwnedImplTest,
+                        testing::ValuesIn({BufferImplementation::Old, BufferImplementation::New}));
+
+TEST_P(OwnedImplTest, AddBufferFragmentNoCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, nullptr);
   Buffer::OwnedImpl buffer;
@@ -33,7 +35,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentNoCleanup) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, AddBufferFragmentWithCleanup) {
+TEST_P(OwnedImplTest, AddBufferFragmentWithCleanup) {
   char input[] = "hello world";
   BufferFragmentImpl frag(input, 11, [this](const void*, size_t, const BufferFragmentImpl*) {
     release_callback_called_ = true;
@@ -51,7 +53,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentWithCleanup) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
+TEST_P(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   char input_stack[] = "hello world";
   char* input = new char[11];
   std::copy(input_stack, input_stack + 11, input);
@@ -76,7 +78,7 @@ TEST_F(OwnedImplTest, AddBufferFragmentDynamicAllocation) {
   EXPECT_TRUE(release_callback_called_);
 }
 
-TEST_F(OwnedImplTest, Write) {
+TEST_P(OwnedImplTest, Write) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -114,7 +116,7 @@ TEST_F(OwnedImplTest, Write) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, Read) {
+TEST_P(OwnedImplTest, Read) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
 
@@ -135,7 +137,7 @@ TEST_F(OwnedImplTest, Read) {
   EXPECT_EQ(0, buffer.length());
 }
 
-TEST_F(OwnedImplTest, ToString) {
+TEST_P(OwnedImplTest, ToString) {
   Buffer::OwnedImpl buffer;
   EXPECT_EQ("", buffer.toString());
   auto append = [&buffer](absl::string_view str) { buffer.add(str.data(), str.size()); };
@@ -150,6 +152,211 @@ TEST_F(OwnedImplTest, ToString) {
   EXPECT_EQ(absl::StrCat("Hello, world!" + long_string), buffer.toString());
 }
 
+TEST_P(OwnedImplTest, AddSmallWritesInPlace) {
+  Buffer::OwnedImpl buffer;
+  verifyImplementation(buffer);
+  for (int i = 0; i < 100; i++) {
+    buffer.add("0123456789");
+  }
+  EXPECT_EQ(1000, buffer.length());
+  if (GetParam() == BufferImplementation::New) {
+    // All the writes were copied into the first slice.
+    EXPECT_EQ(1, buffer.getRawSlices(nullptr, 0));
+  }
+  std::string expected;
+  for (int i = 0; i < 100; i++) {
+    expected += "0123456789";
+  }
+  EXPECT_EQ(expected, buffer.toString());
+}
+
+TEST_P(OwnedImplTest, CopyOutAcrossSlices) {
+  char first[] = "hello ";
+  char second[] = "world";
+  BufferFragmentImpl frag1(first, 6, nullptr);
+  BufferFragmentImpl frag2(second, 5, nullptr);
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(frag1);
+  buffer.addBufferFragment(frag2);
+  EXPECT_EQ(2, buffer.getRawSlices(nullptr, 0));
+
+  char out[7];
+  buffer.copyOut(3, 7, out);
+  EXPECT_EQ("lo worl", std::string(out, 7));
+
+  // Copy out zero bytes.
+  buffer.copyOut(11, 0, out);
+}
+
+TEST_P(OwnedImplTest, MoveAll) {
+  Buffer::OwnedImpl buffer1;
+  Buffer::OwnedImpl buffer2;
+  buffer1.add(std::string(8000, 'a'));
+  buffer2.add("hello");
+  buffer2.move(buffer1);
+  EXPECT_EQ(0, buffer1.length());
+  EXPECT_EQ(8005, buffer2.length());
+  EXPECT_EQ("hello" + std::string(8000, 'a'), buffer2.toString());
+
+  // Moving an empty buffer is a no-op.
+  buffer2.move(buffer1);
+  EXPECT_EQ(8005, buffer2.length());
+}
+
+TEST_P(OwnedImplTest, MoveLargeSliceWithoutCopy) {
+  Buffer::OwnedImpl buffer1;
+  Buffer::OwnedImpl buffer2;
+  buffer1.add(std::string(8000, 'a'));
+  RawSlice slice;
+  ASSERT_EQ(1, buffer1.getRawSlices(&slice, 1));
+  const void* data = slice.mem_;
+
+  buffer2.move(buffer1);
+  ASSERT_EQ(1, buffer2.getRawSlices(&slice, 1));
+  EXPECT_EQ(data, slice.mem_);
+  EXPECT_EQ(8000, slice.len_);
+}
+
+TEST_P(OwnedImplTest, MovePartial) {
+  Buffer::OwnedImpl buffer1;
+  Buffer::OwnedImpl buffer2;
+  buffer1.add(std::string(5000, 'a'));
+  buffer1.add(std::string(5000, 'b'));
+
+  buffer2.move(buffer1, 1);
+  EXPECT_EQ("a", buffer2.toString());
+  EXPECT_EQ(9999, buffer1.length());
+
+  buffer2.move(buffer1, 5999);
+  EXPECT_EQ(std::string(5000, 'a') + std::string(1000, 'b'), buffer2.toString());
+  EXPECT_EQ(std::string(4000, 'b'), buffer1.toString());
+
+  buffer2.move(buffer1, 4000);
+  EXPECT_EQ(0, buffer1.length());
+  EXPECT_EQ(10000, buffer2.length());
+}
+
+TEST_P(OwnedImplTest, MoveFragmentReleasedWhenDrained) {
+  char input[] = "hello world";
+  BufferFragmentImpl frag(input, 11, [this](const void*, size_t, const BufferFragmentImpl*) {
+    release_callback_called_ = true;
+  });
+  Buffer::OwnedImpl buffer1;
+  Buffer::OwnedImpl buffer2;
+  buffer1.addBufferFragment(frag);
+  buffer2.move(buffer1);
+  EXPECT_EQ(0, buffer1.length());
+  EXPECT_EQ("hello world", buffer2.toString());
+
+  buffer2.drain(11);
+  EXPECT_TRUE(release_callback_called_);
+}
+
+TEST_P(OwnedImplTest, Drain) {
+  Buffer::OwnedImpl buffer;
+  buffer.add(std::string(5000, 'a'));
+  buffer.add(std::string(5000, 'b'));
+  buffer.drain(4999);
+  EXPECT_EQ(5001, buffer.length());
+  buffer.drain(2);
+  EXPECT_EQ(std::string(4999, 'b'), buffer.toString());
+  buffer.drain(4999);
+  EXPECT_EQ(0, buffer.length());
+  EXPECT_EQ("", buffer.toString());
+
+  // The buffer is still usable after being fully drained.
+  buffer.add("hello");
+  EXPECT_EQ("hello", buffer.toString());
+}
+
+TEST_P(OwnedImplTest, Linearize) {
+  char first[] = "hello ";
+  char second[] = "world";
+  BufferFragmentImpl frag1(first, 6, nullptr);
+  BufferFragmentImpl frag2(second, 5, nullptr);
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(frag1);
+  buffer.addBufferFragment(frag2);
+
+  EXPECT_EQ("hello", std::string(static_cast<const char*>(buffer.linearize(5)), 5));
+  EXPECT_EQ("hello world", std::string(static_cast<const char*>(buffer.linearize(11)), 11));
+  EXPECT_EQ(11, buffer.length());
+  EXPECT_EQ("hello world", buffer.toString());
+}
+
+TEST_P(OwnedImplTest, ReserveCommit) {
+  Buffer::OwnedImpl buffer;
+  buffer.add("hello");
+
+  RawSlice iovecs[2];
+  uint64_t num_reserved = buffer.reserve(16384, iovecs, 2);
+  ASSERT_GE(num_reserved, 1);
+  uint64_t reserved = 0;
+  for (uint64_t i = 0; i < num_reserved; i++) {
+    reserved += iovecs[i].len_;
+  }
+  EXPECT_GE(reserved, 16384);
+
+  // Commit only part of the reservation.
+  memcpy(iovecs[0].mem_, " world", 6);
+  iovecs[0].len_ = 6;
+  buffer.commit(iovecs, 1);
+  EXPECT_EQ("hello world", buffer.toString());
+
+  // Reserve again after the commit and commit nothing.
+  num_reserved = buffer.reserve(100, iovecs, 2);
+  ASSERT_GE(num_reserved, 1);
+  buffer.commit(iovecs, 0);
+  EXPECT_EQ("hello world", buffer.toString());
+
+  // Commit a reservation that spans a new slice.
+  num_reserved = buffer.reserve(100000, iovecs, 2);
+  ASSERT_GE(num_reserved, 1);
+  uint64_t committed = 0;
+  for (uint64_t i = 0; i < num_reserved; i++) {
+    memset(iovecs[i].mem_, 'x', iovecs[i].len_);
+    committed += iovecs[i].len_;
+  }
+  buffer.commit(iovecs, num_reserved);
+  EXPECT_EQ(11 + committed, buffer.length());
+  EXPECT_EQ("hello world" + std::string(committed, 'x'), buffer.toString());
+}
+
+TEST_P(OwnedImplTest, Search) {
+  char first[] = "abcab";
+  char second[] = "cdabcd";
+  BufferFragmentImpl frag1(first, 5, nullptr);
+  BufferFragmentImpl frag2(second, 6, nullptr);
+  Buffer::OwnedImpl buffer;
+  buffer.addBufferFragment(frag1);
+  buffer.addBufferFragment(frag2);
+
+  EXPECT_EQ(0, buffer.search("abc", 3, 0));
+  // Match spanning the two slices.
+  EXPECT_EQ(3, buffer.search("abcd", 4, 0));
+  EXPECT_EQ(7, buffer.search("abcd", 4, 4));
+  EXPECT_EQ(-1, buffer.search("abcd", 4, 8));
+  EXPECT_EQ(-1, buffer.search("abcde", 5, 0));
+  EXPECT_EQ(-1, buffer.search("x", 1, 0));
+  EXPECT_EQ(6, buffer.search("d", 1, 6));
+  EXPECT_EQ(10, buffer.search("d", 1, 7));
+}
+
+TEST_P(OwnedImplTest, MoveBetweenImplementations) {
+  Buffer::OwnedImpl buffer1;
+  buffer1.add("hello world");
+  OwnedImpl::useOldImpl(GetParam() != BufferImplementation::Old);
+  Buffer::OwnedImpl buffer2;
+  EXPECT_NE(buffer1.usesOldImpl(), buffer2.usesOldImpl());
+
+  buffer2.move(buffer1, 6);
+  EXPECT_EQ("hello ", buffer2.toString());
+  EXPECT_EQ("world", buffer1.toString());
+  buffer2.move(buffer1);
+  EXPECT_EQ("hello world", buffer2.toString());
+  EXPECT_EQ(0, buffer1.length());
+}
+
 } // namespace
 } // namespace Buffer
 } // namespace Envoy
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common/buffer/buffer_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Buffer {
+
+enum class BufferImplementation {
+  Old, // evbuffer-based
+  New, // native slice-based
+};
+
+/**
+ * Base class for tests that are parameterized over the buffer implementation. The implementation
+ * is selected before any member buffers of the derived fixture are constructed, and the previous
+ * process-wide selection is restored afterwards.
+ */
+class BufferImplementationParamTest : public testing::TestWithParam<BufferImplementation> {
+protected:
+  BufferImplementationParamTest() : saved_use_old_impl_(OwnedImpl::newBuffersUseOldImpl()) {
+    OwnedImpl::useOldImpl(GetParam() == BufferImplementation::Old);
+  }
+
+  ~BufferImplementationParamTest() { OwnedImpl::useOldImpl(saved_use_old_impl_); }
+
+  // Verify that the buffer was constructed with the implementation under test.
+  void verifyImplementation(const OwnedImpl& buffer) {
+    EXPECT_EQ(GetParam() == BufferImplementation::Old, buffer.usesOldImpl());
+  }
+
+private:
+  const bool saved_use_old_impl_;
+};
+
+} // namespace Buffer
+} // namespace Envoy
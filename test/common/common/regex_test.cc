@@ -0,0 +1,70 @@
+#include <string>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/regex.h"
+
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Regex {
+namespace {
+
+TEST(RegexTest, Match) {
+  CompiledMatcherSharedPtr matcher = Utility::parseRegex("/api/v[0-9]+/.*");
+  EXPECT_EQ("/api/v[0-9]+/.*", matcher->pattern());
+  EXPECT_TRUE(matcher->match("/api/v1/users"));
+  EXPECT_TRUE(matcher->match("/api/v12/"));
+  EXPECT_FALSE(matcher->match("/api/v/users"));
+  // Matches must cover the whole value.
+  EXPECT_FALSE(matcher->match("/prefix/api/v1/users"));
+  EXPECT_FALSE(Utility::parseRegex("foo")->match("foobar"));
+  EXPECT_TRUE(Utility::parseRegex("")->match(""));
+}
+
+TEST(RegexTest, MatchesBytes) {
+  CompiledMatcherSharedPtr matcher = Utility::parseRegex("a.b");
+  EXPECT_TRUE(matcher->match("a\xff" "b"));
+  EXPECT_FALSE(matcher->match("a\xc3\xa9" "b"));
+  EXPECT_TRUE(matcher->match(absl::string_view("a\0b", 3)));
+}
+
+TEST(RegexTest, LongInput) {
+  // Patterns like this recurse once per character with std::regex.
+  const std::string value(1024 * 1024, 'a');
+  EXPECT_TRUE(Utility::parseRegex("(a|b)*")->match(value));
+  EXPECT_FALSE(Utility::parseRegex("(a|b)*c")->match(value));
+}
+
+TEST(RegexTest, StdRegexFallback) {
+  // Backreferences aren't supported by RE2.
+  CompiledMatcherSharedPtr matcher = Utility::parseRegex("(a+)-\\1");
+  EXPECT_EQ("(a+)-\\1", matcher->pattern());
+  EXPECT_TRUE(matcher->match("aa-aa"));
+  EXPECT_FALSE(matcher->match("aa-a"));
+}
+
+TEST(RegexTest, InvalidRegex) {
+  EXPECT_THROW_WITH_REGEX(Utility::parseRegex("(+invalid)"), EnvoyException,
+                          "Invalid regex '\\(\\+invalid\\)': .+");
+  // A failed parse must not leave anything behind that a later parse could pick up.
+  EXPECT_THROW(Utility::parseRegex("(+invalid)"), EnvoyException);
+}
+
+TEST(RegexTest, Cache) {
+  CompiledMatcherSharedPtr matcher = Utility::parseRegex("cached.*");
+  EXPECT_EQ(matcher, Utility::parseRegex("cached.*"));
+  EXPECT_NE(matcher, Utility::parseRegex("cached.+"));
+
+  // The matcher is compiled again once all references are gone.
+  matcher.reset();
+  matcher = Utility::parseRegex("cached.*");
+  EXPECT_TRUE(matcher->match("cached"));
+  EXPECT_EQ(matcher, Utility::parseRegex("cached.*"));
+}
+
+} // namespace
+} // namespace Regex
+} // namespace Envoy
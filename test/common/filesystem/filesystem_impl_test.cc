@@ -1,7 +1,10 @@
 #include <chrono>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "common/api/os_sys_calls_impl.h"
+#include "common/common/fmt.h"
 #include "common/common/lock_guard.h"
 #include "common/common/thread.h"
 #include "common/event/dispatcher_impl.h"
@@ -14,6 +17,7 @@
 #include "test/test_common/environment.h"
 #include "test/test_common/threadsafe_singleton_injector.h"
 
+#include "absl/strings/str_split.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -23,6 +27,7 @@ using testing::NiceMock;
 using testing::Return;
 using testing::SaveArg;
 using testing::Sequence;
+using testing::SetErrnoAndReturn;
 using testing::Throw;
 using testing::_;
 
@@ -33,7 +38,8 @@ TEST(FileSystemImpl, BadFile) {
   Thread::MutexBasicLockable lock;
   Stats::IsolatedStoreImpl store;
   EXPECT_CALL(dispatcher, createTimer_(_));
-  EXPECT_THROW(Filesystem::FileImpl("", dispatcher, lock, store, std::chrono::milliseconds(10000)),
+  EXPECT_THROW(Filesystem::FileImpl("", dispatcher, lock, store, std::chrono::milliseconds(10000),
+                                    std::make_shared<Filesystem::FileFlushThread>()),
                EnvoyException);
 }
 
@@ -104,6 +110,39 @@ TEST(FilesystemImpl, IllegalPath) {
   EXPECT_TRUE(Filesystem::illegalPath("/_some_non_existant_file"));
 }
 
+namespace {
+
+std::string iovecsToString(const iovec* iov, int num_iov) {
+  std::string written;
+  for (int i = 0; i < num_iov; i++) {
+    written.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+  }
+  return written;
+}
+
+// Expect a writev() of the given data to the given file descriptor.
+void expectWrite(Api::MockOsSysCalls& os_sys_calls, int expected_fd,
+                 const std::string& expected_data) {
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillOnce(Invoke([expected_fd, expected_data](int fd, const iovec* iov,
+                                                    int num_iov) -> ssize_t {
+        const std::string written = iovecsToString(iov, num_iov);
+        EXPECT_EQ(expected_data, written);
+        EXPECT_EQ(expected_fd, fd);
+
+        return written.size();
+      }));
+}
+
+void waitForWrites(Api::MockOsSysCalls& os_sys_calls, uint32_t num_writes) {
+  Thread::LockGuard lock(os_sys_calls.write_mutex_);
+  while (os_sys_calls.num_writes_ != num_writes) {
+    os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
+  }
+}
+
+} // namespace
+
 TEST(FileSystemImpl, flushToLogFilePeriodically) {
   NiceMock<Event::MockDispatcher> dispatcher;
   NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher);
@@ -112,49 +151,30 @@ TEST(FileSystemImpl, flushToLogFilePeriodically) {
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  auto flush_thread = std::make_shared<Filesystem::FileFlushThread>();
 
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            flush_thread);
 
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
-        EXPECT_EQ("test", written);
-        EXPECT_EQ(5, fd);
-
-        return num_bytes;
-      }));
-
+  expectWrite(os_sys_calls, 5, "test");
   file.write("test");
 
-  {
-    Thread::LockGuard lock(os_sys_calls.write_mutex_);
-    while (os_sys_calls.num_writes_ != 1) {
-      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
-    }
-  }
-
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
-        EXPECT_EQ("test2", written);
-        EXPECT_EQ(5, fd);
-
-        return num_bytes;
-      }));
-
   // make sure timer is re-enabled on callback call
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
+  timer->callback_();
+  waitForWrites(os_sys_calls, 1);
+
+  expectWrite(os_sys_calls, 5, "test2");
   file.write("test2");
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
   timer->callback_();
+  waitForWrites(os_sys_calls, 2);
 
-  {
-    Thread::LockGuard lock(os_sys_calls.write_mutex_);
-    while (os_sys_calls.num_writes_ != 2) {
-      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
-    }
-  }
+  EXPECT_EQ(2UL, stats_store.counter("filesystem.flushed_by_timer").value());
+  EXPECT_EQ(2UL, stats_store.counter("filesystem.write_completed").value());
+  EXPECT_EQ(0UL, stats_store.gauge("filesystem.write_total_buffered").value());
 }
 
 TEST(FileSystemImpl, flushToLogFileOnDemand) {
@@ -165,40 +185,23 @@ TEST(FileSystemImpl, flushToLogFileOnDemand) {
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  auto flush_thread = std::make_shared<Filesystem::FileFlushThread>();
 
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            flush_thread);
 
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
 
-  // The first write to a given file will start the flush thread, which can flush
-  // immediately (race on whether it will or not). So do a write and flush to
-  // get that state out of the way, then test that small writes don't trigger a flush.
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int, const void*, size_t num_bytes) -> ssize_t { return num_bytes; }));
-  file.write("prime-it");
-  file.flush();
-  uint32_t expected_writes = 1;
-  {
-    Thread::LockGuard lock(os_sys_calls.write_mutex_);
-    EXPECT_EQ(expected_writes, os_sys_calls.num_writes_);
-  }
-
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
-        EXPECT_EQ("test", written);
-        EXPECT_EQ(5, fd);
-
-        return num_bytes;
-      }));
-
+  // Small writes are only staged until a flush.
+  expectWrite(os_sys_calls, 5, "test");
   file.write("test");
-
+  uint32_t expected_writes = 0;
   {
     Thread::LockGuard lock(os_sys_calls.write_mutex_);
     EXPECT_EQ(expected_writes, os_sys_calls.num_writes_);
   }
+  EXPECT_EQ(4UL, stats_store.gauge("filesystem.write_total_buffered").value());
 
   file.flush();
   expected_writes++;
@@ -206,28 +209,93 @@ TEST(FileSystemImpl, flushToLogFileOnDemand) {
     Thread::LockGuard lock(os_sys_calls.write_mutex_);
     EXPECT_EQ(expected_writes, os_sys_calls.num_writes_);
   }
+  EXPECT_EQ(0UL, stats_store.gauge("filesystem.write_total_buffered").value());
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
-        EXPECT_EQ("test2", written);
-        EXPECT_EQ(5, fd);
-
-        return num_bytes;
-      }));
+  expectWrite(os_sys_calls, 5, "test2");
 
   // make sure timer is re-enabled on callback call
   file.write("test2");
   EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(40)));
   timer->callback_();
   expected_writes++;
+  waitForWrites(os_sys_calls, expected_writes);
+}
 
-  {
-    Thread::LockGuard lock(os_sys_calls.write_mutex_);
-    while (os_sys_calls.num_writes_ != expected_writes) {
-      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
-    }
+// Writes from several threads are all flushed, with the writes of each thread kept in order.
+TEST(FileSystemImpl, writesFromSeveralThreads) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  Thread::MutexBasicLockable mutex;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  auto flush_thread = std::make_shared<Filesystem::FileFlushThread>();
+
+  EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            flush_thread);
+
+  std::string written;
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillRepeatedly(Invoke([&written](int, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string data = iovecsToString(iov, num_iov);
+        written += data;
+        return data.size();
+      }));
+
+  const uint32_t num_threads = 4;
+  const uint32_t num_lines = 100;
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(new Thread::Thread([&file, i]() -> void {
+      for (uint32_t line = 0; line < num_lines; line++) {
+        file.write(fmt::format("{}:{}\n", i, line));
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
   }
+  file.flush();
+
+  std::vector<uint32_t> next_line(num_threads, 0);
+  for (absl::string_view line : absl::StrSplit(written, '\n', absl::SkipEmpty())) {
+    const std::vector<absl::string_view> parts = absl::StrSplit(line, ':');
+    ASSERT_EQ(2U, parts.size());
+    const uint32_t thread_index = std::stoul(std::string(parts[0]));
+    EXPECT_EQ(std::to_string(next_line[thread_index]++), parts[1]);
+  }
+  for (uint32_t i = 0; i < num_threads; i++) {
+    EXPECT_EQ(num_lines, next_line[i]);
+  }
+}
+
+// A single flush thread writes the data of several files.
+TEST(FileSystemImpl, sharedFlushThread) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  NiceMock<Event::MockTimer>* timer1 = new NiceMock<Event::MockTimer>(&dispatcher);
+  NiceMock<Event::MockTimer>* timer2 = new NiceMock<Event::MockTimer>(&dispatcher);
+
+  Thread::MutexBasicLockable mutex;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  auto flush_thread = std::make_shared<Filesystem::FileFlushThread>();
+
+  EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5)).WillOnce(Return(6));
+  Filesystem::FileImpl file1("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                             flush_thread);
+  Filesystem::FileImpl file2("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                             flush_thread);
+
+  expectWrite(os_sys_calls, 5, "file1");
+  file1.write("file1");
+  timer1->callback_();
+  waitForWrites(os_sys_calls, 1);
+
+  expectWrite(os_sys_calls, 6, "file2");
+  file2.write("file2");
+  timer2->callback_();
+  waitForWrites(os_sys_calls, 2);
 }
 
 TEST(FileSystemImpl, reopenFile) {
@@ -238,42 +306,38 @@ TEST(FileSystemImpl, reopenFile) {
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  auto flush_thread = std::make_shared<Filesystem::FileFlushThread>();
 
   Sequence sq;
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(5));
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            flush_thread);
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .InSequence(sq)
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = iovecsToString(iov, num_iov);
         EXPECT_EQ("before", written);
         EXPECT_EQ(5, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   file.write("before");
   timer->callback_();
-
-  {
-    Thread::LockGuard lock(os_sys_calls.write_mutex_);
-    while (os_sys_calls.num_writes_ != 1) {
-      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
-    }
-  }
+  waitForWrites(os_sys_calls, 1);
 
   EXPECT_CALL(os_sys_calls, close(5)).InSequence(sq);
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(10));
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .InSequence(sq)
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
+      .WillOnce(Invoke([](int fd, const iovec* iov, int num_iov) -> ssize_t {
+        const std::string written = iovecsToString(iov, num_iov);
         EXPECT_EQ("reopened", written);
         EXPECT_EQ(10, fd);
 
-        return num_bytes;
+        return written.size();
       }));
 
   EXPECT_CALL(os_sys_calls, close(10)).InSequence(sq);
@@ -281,13 +345,7 @@ TEST(FileSystemImpl, reopenFile) {
   file.reopen();
   file.write("reopened");
   timer->callback_();
-
-  {
-    Thread::LockGuard lock(os_sys_calls.write_mutex_);
-    while (os_sys_calls.num_writes_ != 2) {
-      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
-    }
-  }
+  waitForWrites(os_sys_calls, 2);
 }
 
 TEST(FilesystemImpl, reopenThrows) {
@@ -298,30 +356,24 @@ TEST(FilesystemImpl, reopenThrows) {
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  auto flush_thread = std::make_shared<Filesystem::FileFlushThread>();
 
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillRepeatedly(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        UNREFERENCED_PARAMETER(fd);
-        UNREFERENCED_PARAMETER(buffer);
-
-        return num_bytes;
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
+      .WillRepeatedly(Invoke([](int, const iovec* iov, int num_iov) -> ssize_t {
+        return iovecsToString(iov, num_iov).size();
       }));
 
   Sequence sq;
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(5));
 
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            flush_thread);
   EXPECT_CALL(os_sys_calls, close(5)).InSequence(sq);
   EXPECT_CALL(os_sys_calls, open_(_, _, _)).InSequence(sq).WillOnce(Return(-1));
 
   file.write("test write");
   timer->callback_();
-  {
-    Thread::LockGuard lock(os_sys_calls.write_mutex_);
-    while (os_sys_calls.num_writes_ != 1) {
-      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
-    }
-  }
+  waitForWrites(os_sys_calls, 1);
   file.reopen();
 
   file.write("this is to force reopen");
@@ -345,50 +397,35 @@ TEST(FilesystemImpl, bigDataChunkShouldBeFlushedWithoutTimer) {
   Stats::IsolatedStoreImpl stats_store;
   NiceMock<Api::MockOsSysCalls> os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  auto flush_thread = std::make_shared<Filesystem::FileFlushThread>();
 
-  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40));
-
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        UNREFERENCED_PARAMETER(fd);
-
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
-        std::string expected("a");
-        EXPECT_EQ(expected, written);
-
-        return num_bytes;
-      }));
-
-  file.write("a");
-
-  {
-    Thread::LockGuard lock(os_sys_calls.write_mutex_);
-    while (os_sys_calls.num_writes_ != 1) {
-      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
-    }
-  }
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            flush_thread);
 
-  // First write happens without waiting on thread_flush_. Now make a big string and it should be
-  // flushed even when timer is not enabled
-  EXPECT_CALL(os_sys_calls, write_(_, _, _))
-      .WillOnce(Invoke([](int fd, const void* buffer, size_t num_bytes) -> ssize_t {
-        UNREFERENCED_PARAMETER(fd);
+  // A big string should be flushed even when the timer does not fire.
+  std::string big_string(1024 * 64 + 1, 'b');
+  expectWrite(os_sys_calls, 0, big_string);
+  file.write(big_string);
+  waitForWrites(os_sys_calls, 1);
+}
 
-        std::string written = std::string(reinterpret_cast<const char*>(buffer), num_bytes);
-        std::string expected(1024 * 64 + 1, 'b');
-        EXPECT_EQ(expected, written);
+TEST(FilesystemImpl, writeFailure) {
+  NiceMock<Event::MockDispatcher> dispatcher;
+  Thread::MutexBasicLockable mutex;
+  Stats::IsolatedStoreImpl stats_store;
+  NiceMock<Api::MockOsSysCalls> os_sys_calls;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
+  auto flush_thread = std::make_shared<Filesystem::FileFlushThread>();
 
-        return num_bytes;
-      }));
+  EXPECT_CALL(os_sys_calls, open_(_, _, _)).WillOnce(Return(5));
+  Filesystem::FileImpl file("", dispatcher, mutex, stats_store, std::chrono::milliseconds(40),
+                            flush_thread);
 
-  std::string big_string(1024 * 64 + 1, 'b');
-  file.write(big_string);
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _)).WillOnce(SetErrnoAndReturn(EIO, -1));
+  file.write("lost");
+  file.flush();
 
-  {
-    Thread::LockGuard lock(os_sys_calls.write_mutex_);
-    while (os_sys_calls.num_writes_ != 2) {
-      os_sys_calls.write_event_.wait(os_sys_calls.write_mutex_);
-    }
-  }
+  EXPECT_EQ(1UL, stats_store.counter("filesystem.write_failed").value());
+  EXPECT_EQ(0UL, stats_store.gauge("filesystem.write_total_buffered").value());
 }
 } // namespace Envoy
@@ -860,8 +860,14 @@ TEST_F(AsyncClientImplTest, WatermarkCallbacks) {
   stream->sendHeaders(headers, false);
   Http::StreamDecoderFilterCallbacks* filter_callbacks =
       static_cast<Http::AsyncStreamImpl*>(stream);
+  EXPECT_FALSE(stream->isAboveWriteBufferHighWatermark());
   filter_callbacks->onDecoderFilterAboveWriteBufferHighWatermark();
+  EXPECT_TRUE(stream->isAboveWriteBufferHighWatermark());
+  filter_callbacks->onDecoderFilterAboveWriteBufferHighWatermark();
+  filter_callbacks->onDecoderFilterBelowWriteBufferLowWatermark();
+  EXPECT_TRUE(stream->isAboveWriteBufferHighWatermark());
   filter_callbacks->onDecoderFilterBelowWriteBufferLowWatermark();
+  EXPECT_FALSE(stream->isAboveWriteBufferHighWatermark());
   EXPECT_CALL(stream_callbacks_, onReset());
 }
 
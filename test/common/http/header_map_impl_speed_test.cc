@@ -0,0 +1,122 @@
+#include "common/common/fmt.h"
+#include "common/http/header_map_impl.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+
+// Builds the header names and values of a typical request with the given number of headers: the
+// HTTP/2 pseudo headers, a few common O(1) headers and then custom headers.
+static std::vector<std::pair<std::string, std::string>> requestHeaders(int64_t num_headers) {
+  std::vector<std::pair<std::string, std::string>> headers = {
+      {":method", "GET"},
+      {":path", "/api/v1/resource?query=value"},
+      {":authority", "service.example.com"},
+      {":scheme", "https"},
+      {"user-agent", "benchmark/1.0"},
+      {"accept-encoding", "gzip, deflate"},
+      {"content-type", "application/json"},
+      {"x-request-id", "d3a2f2b4-5e0c-4a59-a0c5-4c1a0e0b3c61"},
+  };
+  for (int64_t i = headers.size(); i < num_headers; i++) {
+    headers.emplace_back(fmt::format("x-custom-header-{}", i), fmt::format("custom-value-{}", i));
+  }
+  headers.resize(num_headers);
+  return headers;
+}
+
+// Adds the headers as a codec does when decoding a request.
+static void decodeHeaders(const std::vector<std::pair<std::string, std::string>>& input,
+                          HeaderMapImpl& headers) {
+  for (const auto& header : input) {
+    HeaderString key;
+    key.setCopy(header.first.data(), header.first.size());
+    HeaderString value;
+    value.setCopy(header.second.data(), header.second.size());
+    headers.addViaMove(std::move(key), std::move(value));
+  }
+}
+
+// Test the creation of a header map and decoding of a request into it. The argument is the number
+// of headers.
+static void BM_HeaderMapDecode(benchmark::State& state) {
+  const auto input = requestHeaders(state.range(0));
+  for (auto _ : state) {
+    HeaderMapImpl headers;
+    decodeHeaders(input, headers);
+    benchmark::DoNotOptimize(headers.size());
+  }
+}
+BENCHMARK(BM_HeaderMapDecode)->Arg(15)->Arg(30);
+
+// Test iterating over a header map the way a codec does when encoding a request.
+static void BM_HeaderMapEncode(benchmark::State& state) {
+  const auto input = requestHeaders(state.range(0));
+  HeaderMapImpl headers;
+  decodeHeaders(input, headers);
+  for (auto _ : state) {
+    uint64_t encoded_size = 0;
+    headers.iterate(
+        [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+          *static_cast<uint64_t*>(context) += header.key().size() + header.value().size() + 4;
+          return HeaderMap::Iterate::Continue;
+        },
+        &encoded_size);
+    benchmark::DoNotOptimize(encoded_size);
+  }
+}
+BENCHMARK(BM_HeaderMapEncode)->Arg(15)->Arg(30);
+
+// Test copying a header map, as is done when a request is shadowed or retried.
+static void BM_HeaderMapCopy(benchmark::State& state) {
+  const auto input = requestHeaders(state.range(0));
+  HeaderMapImpl headers;
+  decodeHeaders(input, headers);
+  for (auto _ : state) {
+    HeaderMapImpl copy(static_cast<const HeaderMap&>(headers));
+    benchmark::DoNotOptimize(copy.size());
+  }
+}
+BENCHMARK(BM_HeaderMapCopy)->Arg(15)->Arg(30);
+
+// Test the lookup of a header that isn't one of the O(1) headers, which iterates the map.
+static void BM_HeaderMapGet(benchmark::State& state) {
+  const auto input = requestHeaders(state.range(0));
+  HeaderMapImpl headers;
+  decodeHeaders(input, headers);
+  const LowerCaseString missing("x-not-present");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(headers.get(missing));
+  }
+}
+BENCHMARK(BM_HeaderMapGet)->Arg(15)->Arg(30);
+
+// Test the add/remove churn done by filters and the router on every request.
+static void BM_HeaderMapAddRemove(benchmark::State& state) {
+  const auto input = requestHeaders(state.range(0));
+  HeaderMapImpl headers;
+  decodeHeaders(input, headers);
+  const LowerCaseString key("x-envoy-added");
+  const std::string value("value");
+  for (auto _ : state) {
+    headers.addReference(key, value);
+    headers.insertEnvoyUpstreamServiceTime().value(uint64_t(10));
+    headers.remove(key);
+    headers.removeEnvoyUpstreamServiceTime();
+  }
+  benchmark::DoNotOptimize(headers.size());
+}
+BENCHMARK(BM_HeaderMapAddRemove)->Arg(15)->Arg(30);
+
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -853,5 +853,83 @@ TEST(HeaderMapImplTest, PseudoHeaderOrder) {
   }
 }
 
+// Make sure that header entries stay valid and in order when the map grows beyond its inline
+// storage, and that the storage of removed entries is reused.
+TEST(HeaderMapImplTest, ManyHeaders) {
+  Http::TestHeaderMapImpl headers;
+  headers.insertMethod().value(std::string("GET"));
+  const HeaderEntry* method = headers.Method();
+  std::vector<const HeaderEntry*> entries;
+  for (int i = 0; i < 100; i++) {
+    headers.addCopy(fmt::format("x-header-{}", i), fmt::format("value-{}", i));
+    entries.push_back(headers.get(LowerCaseString(fmt::format("x-header-{}", i))));
+  }
+  headers.insertPath().value(std::string("/"));
+  EXPECT_EQ(102UL, headers.size());
+  EXPECT_EQ(method, headers.Method());
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(entries[i], headers.get(LowerCaseString(fmt::format("x-header-{}", i))));
+    EXPECT_EQ(fmt::format("value-{}", i), entries[i]->value().c_str());
+  }
+
+  // Remove every other header, then add them back.
+  for (int i = 0; i < 100; i += 2) {
+    headers.remove(LowerCaseString(fmt::format("x-header-{}", i)));
+  }
+  EXPECT_EQ(52UL, headers.size());
+  for (int i = 0; i < 100; i += 2) {
+    headers.addCopy(fmt::format("x-header-{}", i), fmt::format("new-value-{}", i));
+  }
+  EXPECT_EQ(102UL, headers.size());
+  EXPECT_STREQ("GET", headers.Method()->value().c_str());
+  EXPECT_STREQ("/", headers.Path()->value().c_str());
+
+  std::vector<std::string> keys;
+  headers.iterate(
+      [](const Http::HeaderEntry& header, void* context) -> HeaderMap::Iterate {
+        static_cast<std::vector<std::string>*>(context)->push_back(header.key().c_str());
+        return HeaderMap::Iterate::Continue;
+      },
+      &keys);
+  ASSERT_EQ(102UL, keys.size());
+  EXPECT_EQ(":method", keys[0]);
+  EXPECT_EQ(":path", keys[1]);
+  // The odd headers keep their original order, followed by the re-added even headers.
+  for (int i = 0; i < 50; i++) {
+    EXPECT_EQ(fmt::format("x-header-{}", 2 * i + 1), keys[2 + i]);
+    EXPECT_EQ(fmt::format("x-header-{}", 2 * i), keys[52 + i]);
+  }
+
+  headers.removePrefix(LowerCaseString("x-header-"));
+  EXPECT_EQ(2UL, headers.size());
+  EXPECT_STREQ("GET", headers.Method()->value().c_str());
+  EXPECT_STREQ("/", headers.Path()->value().c_str());
+}
+
+// Copies must point their O(1) headers at their own entries.
+TEST(HeaderMapImplTest, CopyAndAssign) {
+  TestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {"foo", "bar"}};
+
+  TestHeaderMapImpl copy(headers);
+  EXPECT_EQ(headers, copy);
+  copy.Path()->value(std::string("/copy"));
+  EXPECT_STREQ("/", headers.Path()->value().c_str());
+  EXPECT_STREQ("/copy", copy.Path()->value().c_str());
+
+  TestHeaderMapImpl assigned{{":path", "/assigned"}, {":authority", "host"}};
+  assigned = headers;
+  EXPECT_EQ(headers, assigned);
+  EXPECT_EQ(nullptr, assigned.Host());
+  assigned.Method()->value(std::string("POST"));
+  EXPECT_STREQ("GET", headers.Method()->value().c_str());
+  EXPECT_STREQ("POST", assigned.Method()->value().c_str());
+}
+
+// The map only embeds storage for a few entries, so maps with few headers stay small. The bound
+// allows for the O(1) header table and bookkeeping plus 8 entries of two HeaderStrings each.
+TEST(HeaderMapImplTest, Size) {
+  EXPECT_LT(sizeof(HeaderMapImpl), 1024 + 8 * 2 * sizeof(HeaderString));
+}
+
 } // namespace Http
 } // namespace Envoy
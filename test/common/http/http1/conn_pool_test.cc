@@ -715,6 +715,55 @@ TEST_F(Http1ConnPoolImplTest, RemoteCloseToCompleteResponse) {
   dispatcher_.clearDeferredDeleteList();
 }
 
+/**
+ * Test that connections are prefetched ahead of demand according to the prefetch ratio.
+ */
+TEST_F(Http1ConnPoolImplTest, Prefetch) {
+  cluster_->per_upstream_prefetch_ratio_ = 1.5;
+
+  // An idle pool keeps one connection ready.
+  conn_pool_.expectClientCreate();
+  conn_pool_.prefetch();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+  EXPECT_CALL(*conn_pool_.test_clients_[0].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+
+  // Prefetching again doesn't open more connections without more demand.
+  conn_pool_.prefetch();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // The request uses the prefetched connection, and another one is opened for the next request.
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Immediate);
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_prefetch_.value());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_total_.value());
+  r1.startRequest();
+  r1.completeResponse(false);
+
+  EXPECT_CALL(conn_pool_, onClientDestroy()).Times(2);
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that prefetching respects the connection circuit breaker.
+ */
+TEST_F(Http1ConnPoolImplTest, PrefetchMaxConnections) {
+  cluster_->per_upstream_prefetch_ratio_ = 3;
+  cluster_->resource_manager_.reset(
+      new Upstream::ResourceManagerImpl(runtime_, "fake_key", 1, 1024, 1024, 1));
+
+  conn_pool_.expectClientCreate();
+  conn_pool_.prefetch();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+  EXPECT_EQ(1U, conn_pool_.test_clients_.size());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
 } // namespace Http1
 } // namespace Http
 } // namespace Envoy
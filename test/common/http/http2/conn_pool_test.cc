@@ -146,12 +146,19 @@ TEST_F(Http2ConnPoolImplTest, DrainConnections) {
   r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
   expectClientConnect(1);
 
-  // This will move primary to draining and destroy draining.
+  // This will move the active client to draining. Both clients have an active request, so
+  // neither is closed yet.
   pool_.drainConnections();
+
+  // Completing the request on the first draining client closes it.
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
   EXPECT_CALL(*this, onClientDestroy());
   dispatcher_.clearDeferredDeleteList();
 
-  // This will destroy draining.
+  // This will destroy the second draining client.
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
   test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
   EXPECT_CALL(*this, onClientDestroy());
   dispatcher_.clearDeferredDeleteList();
@@ -163,6 +170,12 @@ TEST_F(Http2ConnPoolImplTest, VerifyConnectionTimingStats) {
               deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_cx_connect_ms"), _));
   EXPECT_CALL(cluster_->stats_store_,
               deliverHistogramToSinks(Property(&Stats::Metric::name, "upstream_cx_length_ms"), _));
+  EXPECT_CALL(cluster_->stats_store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "upstream_cx_http2_active_streams"), 0));
+  EXPECT_CALL(cluster_->stats_store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "upstream_cx_http2_streams"), 1));
 
   ActiveTestRequest r1(*this, 0);
   EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
@@ -448,6 +461,152 @@ TEST_F(Http2ConnPoolImplTest, GoAway) {
   EXPECT_EQ(1U, cluster_->stats_.upstream_cx_close_notify_.value());
 }
 
+/**
+ * Verify that streams are spread over up to max_connections_per_host connections, each going to the
+ * connection with the fewest active streams.
+ */
+TEST_F(Http2ConnPoolImplTest, MultipleConnectionsLeastActiveStreams) {
+  InSequence s;
+  cluster_->http2_settings_.max_connections_per_host_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+
+  // The first connection is busy, so a second one is opened.
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
+  r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(1);
+
+  // Both connections are equally busy and the pool is full, so the first one is reused.
+  ActiveTestRequest r3(*this, 0);
+  EXPECT_CALL(r3.inner_encoder_, encodeHeaders(_, true));
+  r3.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+
+  // Once the second connection is idle it has the fewest active streams.
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  ActiveTestRequest r4(*this, 1);
+  EXPECT_CALL(r4.inner_encoder_, encodeHeaders(_, true));
+  r4.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(r3.decoder_, decodeHeaders_(_, true));
+  r3.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(r4.decoder_, decodeHeaders_(_, true));
+  r4.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy()).Times(2);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_http2_total_.value());
+  EXPECT_EQ(4U, cluster_->stats_.upstream_rq_total_.value());
+}
+
+/**
+ * Verify that an idle connection is reused rather than opening another one, even when the pool
+ * has room for more.
+ */
+TEST_F(Http2ConnPoolImplTest, MultipleConnectionsReuseIdle) {
+  InSequence s;
+  cluster_->http2_settings_.max_connections_per_host_ = 4;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  ActiveTestRequest r2(*this, 0);
+  EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
+  r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_http2_total_.value());
+}
+
+/**
+ * Verify that draining several busy connections only invokes the drained callbacks once every one
+ * of them has completed its streams.
+ */
+TEST_F(Http2ConnPoolImplTest, DrainMultipleConnections) {
+  InSequence s;
+  cluster_->http2_settings_.max_connections_per_host_ = 2;
+
+  expectClientCreate();
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(0);
+
+  expectClientCreate();
+  ActiveTestRequest r2(*this, 1);
+  EXPECT_CALL(r2.inner_encoder_, encodeHeaders(_, true));
+  r2.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  expectClientConnect(1);
+
+  pool_.drainConnections();
+
+  ReadyWatcher drained;
+  pool_.addDrainedCallback([&]() -> void { drained.ready(); });
+
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_CALL(dispatcher_, deferredDelete_(_));
+  EXPECT_CALL(drained, ready());
+  EXPECT_CALL(r2.decoder_, decodeHeaders_(_, true));
+  r2.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Verify that prefetching opens a single connection that the first stream then uses.
+ */
+TEST_F(Http2ConnPoolImplTest, Prefetch) {
+  InSequence s;
+  cluster_->per_upstream_prefetch_ratio_ = 1.5;
+
+  expectClientCreate();
+  pool_.prefetch();
+  expectClientConnect(0);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  // A connection is already open, so there is nothing more to prefetch.
+  pool_.prefetch();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_prefetch_.value());
+
+  ActiveTestRequest r1(*this, 0);
+  EXPECT_CALL(r1.inner_encoder_, encodeHeaders(_, true));
+  r1.callbacks_.outer_encoder_->encodeHeaders(HeaderMapImpl{}, true);
+  EXPECT_CALL(r1.decoder_, decodeHeaders_(_, true));
+  r1.inner_decoder_->decodeHeaders(HeaderMapPtr{new HeaderMapImpl{}}, true);
+
+  test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_CALL(*this, onClientDestroy());
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_http2_total_.value());
+}
+
 } // namespace Http2
 } // namespace Http
 } // namespace Envoy
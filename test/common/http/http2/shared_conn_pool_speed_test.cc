@@ -0,0 +1,219 @@
+// Usage: bazel run -c opt //test/common/http/http2:shared_conn_pool_speed_test -- \
+//            --benchmark_counters_tabular=true
+//
+// Compares the round trip of a header only request on a worker's own pool with one forwarded to a
+// pool shared across workers. Each benchmark thread is a worker with its own dispatcher, and the
+// upstream answers right away, so the difference in latency is the cost of the two extra
+// dispatcher hops. The "connections" counter is the number of upstream connections the workers
+// hold to a host in each mode.
+
+#include <chrono>
+#include <memory>
+
+#include "envoy/http/conn_pool.h"
+
+#include "common/common/thread.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/http/codec_helper.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/shared_conn_pool.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/upstream/mocks.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+// A stream that answers a header only request with a header only response, standing in for an
+// upstream connection.
+class LoopbackStream : public Event::DeferredDeletable,
+                       public StreamEncoder,
+                       public Stream,
+                       public StreamCallbackHelper {
+public:
+  LoopbackStream(Event::Dispatcher& dispatcher, StreamDecoder& response_decoder)
+      : dispatcher_(dispatcher), response_decoder_(response_decoder) {}
+
+  // Http::StreamEncoder
+  void encode100ContinueHeaders(const HeaderMap&) override {}
+  void encodeHeaders(const HeaderMap&, bool end_stream) override {
+    if (end_stream) {
+      HeaderMapPtr response_headers{new HeaderMapImpl{{Headers::get().Status, "200"}}};
+      response_decoder_.decodeHeaders(std::move(response_headers), true);
+      dispatcher_.deferredDelete(Event::DeferredDeletablePtr{this});
+    }
+  }
+  void encodeData(Buffer::Instance&, bool) override {}
+  void encodeTrailers(const HeaderMap&) override {}
+  Stream& getStream() override { return *this; }
+
+  // Http::Stream
+  void addCallbacks(StreamCallbacks& callbacks) override { addCallbacks_(callbacks); }
+  void removeCallbacks(StreamCallbacks& callbacks) override { removeCallbacks_(callbacks); }
+  void resetStream(StreamResetReason) override {
+    dispatcher_.deferredDelete(Event::DeferredDeletablePtr{this});
+  }
+  void readDisable(bool) override {}
+  uint32_t bufferLimit() override { return 65536; }
+
+private:
+  Event::Dispatcher& dispatcher_;
+  StreamDecoder& response_decoder_;
+};
+
+// A pool with a single always ready connection made of loopback streams.
+class LoopbackConnPool : public ConnectionPool::Instance {
+public:
+  LoopbackConnPool(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  // Http::ConnectionPool::Instance
+  Http::Protocol protocol() const override { return Protocol::Http2; }
+  void addDrainedCallback(DrainedCb cb) override { cb(); }
+  void drainConnections() override {}
+  void prefetch() override {}
+  ConnectionPool::Cancellable* newStream(StreamDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override {
+    callbacks.onPoolReady(*new LoopbackStream(dispatcher_, response_decoder), nullptr);
+    return nullptr;
+  }
+
+private:
+  Event::Dispatcher& dispatcher_;
+};
+
+// The worker that owns the shared pool, running its dispatcher on a thread of its own. It is set
+// up once and shared by all benchmark threads.
+class OwnerWorker {
+public:
+  OwnerWorker()
+      : owner_(dispatcher_, ConnectionPool::InstancePtr{new LoopbackConnPool(dispatcher_)},
+               []() -> void {}) {
+    thread_ = std::make_unique<Thread::Thread>([this]() -> void {
+      // Keep the dispatcher from exiting while there is nothing posted to it.
+      keepalive_timer_ = dispatcher_.createTimer([]() -> void {});
+      keepalive_timer_->enableTimer(std::chrono::hours(1));
+      dispatcher_.run(Event::Dispatcher::RunType::Block);
+      keepalive_timer_.reset();
+    });
+  }
+
+  ~OwnerWorker() {
+    dispatcher_.exit();
+    thread_->join();
+  }
+
+  static OwnerWorker& get() {
+    static OwnerWorker owner_worker;
+    return owner_worker;
+  }
+
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_{
+      new testing::NiceMock<Upstream::MockClusterInfo>()};
+  Upstream::HostSharedPtr host_{Upstream::makeTestHost(cluster_, "tcp://127.0.0.1:80")};
+  Event::DispatcherImpl dispatcher_;
+  OwnerConnPoolImpl owner_;
+
+private:
+  Event::TimerPtr keepalive_timer_;
+  Thread::ThreadPtr thread_;
+};
+
+// A header only request and response, run on the dispatcher of the calling worker until the
+// response is complete.
+class RoundTrip : public StreamDecoder, public ConnectionPool::Callbacks {
+public:
+  RoundTrip(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {
+    // Keep the dispatcher from exiting while waiting for posts from the owner.
+    keepalive_timer_ = dispatcher_.createTimer([]() -> void {});
+    keepalive_timer_->enableTimer(std::chrono::hours(1));
+  }
+
+  void run(ConnectionPool::Instance& pool) {
+    complete_ = false;
+    pool.newStream(*this, *this);
+    if (!complete_) {
+      running_ = true;
+      dispatcher_.run(Event::Dispatcher::RunType::Block);
+      running_ = false;
+    }
+    dispatcher_.clearDeferredDeleteList();
+  }
+
+  // Http::StreamDecoder
+  void decode100ContinueHeaders(HeaderMapPtr&&) override {}
+  void decodeHeaders(HeaderMapPtr&&, bool end_stream) override {
+    if (end_stream) {
+      onComplete();
+    }
+  }
+  void decodeData(Buffer::Instance&, bool) override {}
+  void decodeTrailers(HeaderMapPtr&&) override {}
+
+  // Http::ConnectionPool::Callbacks
+  void onPoolFailure(ConnectionPool::PoolFailureReason,
+                     Upstream::HostDescriptionConstSharedPtr) override {
+    onComplete();
+  }
+  void onPoolReady(StreamEncoder& encoder, Upstream::HostDescriptionConstSharedPtr) override {
+    encoder.encodeHeaders(request_headers_, true);
+  }
+
+private:
+  void onComplete() {
+    complete_ = true;
+    if (running_) {
+      dispatcher_.exit();
+    }
+  }
+
+  Event::Dispatcher& dispatcher_;
+  Event::TimerPtr keepalive_timer_;
+  HeaderMapImpl request_headers_{{Headers::get().Method, "GET"},
+                                 {Headers::get().Path, "/"},
+                                 {Headers::get().Host, "host"}};
+  bool complete_{};
+  bool running_{};
+};
+
+// Each worker uses a pool of its own, so there is a connection per worker.
+static void BM_WorkerConnPool(benchmark::State& state) {
+  Event::DispatcherImpl dispatcher;
+  LoopbackConnPool pool(dispatcher);
+  RoundTrip round_trip(dispatcher);
+  for (auto _ : state) {
+    round_trip.run(pool);
+  }
+  state.counters["connections"] = 1;
+}
+BENCHMARK(BM_WorkerConnPool)->ThreadRange(1, 16)->UseRealTime();
+
+// Each worker forwards to the one pool owned by another worker, so there is a single connection.
+static void BM_SharedConnPool(benchmark::State& state) {
+  OwnerWorker& owner_worker = OwnerWorker::get();
+  Event::DispatcherImpl dispatcher;
+  // The owner never drains, so no local pool is needed.
+  ForwardingConnPoolImpl pool(dispatcher, owner_worker.host_, Protocol::Http2,
+                              owner_worker.owner_.shared(), nullptr);
+  RoundTrip round_trip(dispatcher);
+  for (auto _ : state) {
+    round_trip.run(pool);
+  }
+  state.counters["connections"] = state.thread_index == 0 ? 1 : 0;
+}
+BENCHMARK(BM_SharedConnPool)->ThreadRange(1, 16)->UseRealTime();
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,337 @@
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/shared_conn_pool.h"
+
+#include "test/common/http/common.h"
+#include "test/common/upstream/utility.h"
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Ref;
+using testing::Return;
+using testing::SaveArg;
+using testing::_;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+class SharedConnPoolTest : public testing::Test {
+public:
+  SharedConnPoolTest()
+      : pool_(new NiceMock<ConnectionPool::MockInstance>()),
+        owner_(owner_dispatcher_, ConnectionPool::InstancePtr{pool_},
+               [this]() -> void { unregistered_++; }),
+        forwarding_(new ForwardingConnPoolImpl(
+            worker_dispatcher_, host_, Protocol::Http2, owner_.shared(),
+            [this]() -> ConnectionPool::InstancePtr { return std::move(local_pool_ptr_); })) {}
+
+  // Start a stream on the forwarding pool and capture the decoder and callbacks it is created
+  // with on the owner's pool.
+  ConnectionPool::Cancellable* newStream(ConnectionPool::Cancellable* owner_handle) {
+    EXPECT_CALL(*pool_, newStream(_, _))
+        .WillOnce(Invoke([this, owner_handle](StreamDecoder& decoder,
+                                              ConnectionPool::Callbacks& callbacks)
+                             -> ConnectionPool::Cancellable* {
+          owner_decoder_ = &decoder;
+          owner_callbacks_ = &callbacks;
+          return owner_handle;
+        }));
+    return forwarding_->newStream(decoder_, callbacks_);
+  }
+
+  // Start a stream and bind it to the upstream encoder.
+  void newReadyStream() {
+    EXPECT_NE(nullptr, newStream(&owner_handle_));
+    EXPECT_CALL(upstream_encoder_.stream_, bufferLimit()).WillOnce(Return(1024));
+    EXPECT_CALL(callbacks_.pool_ready_, ready());
+    owner_callbacks_->onPoolReady(upstream_encoder_, host_);
+    EXPECT_EQ(host_, callbacks_.host_);
+    ASSERT_NE(nullptr, callbacks_.outer_encoder_);
+    EXPECT_NE(&upstream_encoder_, callbacks_.outer_encoder_);
+  }
+
+  NiceMock<Event::MockDispatcher> owner_dispatcher_;
+  NiceMock<Event::MockDispatcher> worker_dispatcher_;
+  std::shared_ptr<Upstream::MockClusterInfo> cluster_{new NiceMock<Upstream::MockClusterInfo>()};
+  Upstream::HostSharedPtr host_{Upstream::makeTestHost(cluster_, "tcp://127.0.0.1:80")};
+  ConnectionPool::MockInstance* pool_;
+  uint32_t unregistered_{};
+  OwnerConnPoolImpl owner_;
+  NiceMock<MockStreamDecoder> decoder_;
+  ConnPoolCallbacks callbacks_;
+  ConnectionPool::MockCancellable owner_handle_;
+  StreamDecoder* owner_decoder_{};
+  ConnectionPool::Callbacks* owner_callbacks_{};
+  NiceMock<MockStreamEncoder> upstream_encoder_;
+  ConnectionPool::MockInstance* local_pool_{new NiceMock<ConnectionPool::MockInstance>()};
+  ConnectionPool::InstancePtr local_pool_ptr_{local_pool_};
+  std::unique_ptr<ForwardingConnPoolImpl> forwarding_;
+};
+
+/**
+ * Test a request and response forwarded through the owner's pool.
+ */
+TEST_F(SharedConnPoolTest, ForwardRequestResponse) {
+  newReadyStream();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_forwarded_.value());
+  EXPECT_EQ(1024U, callbacks_.outer_encoder_->getStream().bufferLimit());
+
+  TestHeaderMapImpl request_headers{{":method", "POST"}, {":path", "/"}};
+  EXPECT_CALL(upstream_encoder_, encodeHeaders(HeaderMapEqualRef(&request_headers), false));
+  callbacks_.outer_encoder_->encodeHeaders(request_headers, false);
+
+  Buffer::OwnedImpl request_body("hello");
+  EXPECT_CALL(upstream_encoder_, encodeData(BufferStringEqual("hello"), true));
+  callbacks_.outer_encoder_->encodeData(request_body, true);
+  EXPECT_EQ(0U, request_body.length());
+
+  EXPECT_CALL(decoder_, decodeHeaders_(_, false));
+  owner_decoder_->decodeHeaders(HeaderMapPtr{new TestHeaderMapImpl{{":status", "200"}}}, false);
+
+  Buffer::OwnedImpl response_body("world");
+  EXPECT_CALL(decoder_, decodeData(BufferStringEqual("world"), false));
+  owner_decoder_->decodeData(response_body, false);
+
+  // The owner lets go of the upstream stream once it is complete.
+  EXPECT_CALL(decoder_, decodeTrailers_(_));
+  EXPECT_CALL(upstream_encoder_.stream_, removeCallbacks(_));
+  owner_decoder_->decodeTrailers(HeaderMapPtr{new TestHeaderMapImpl{{"grpc-status", "0"}}});
+
+  ReadyWatcher drained;
+  EXPECT_CALL(drained, ready());
+  forwarding_->addDrainedCallback([&drained]() -> void { drained.ready(); });
+}
+
+/**
+ * Test that a stream that is pending on the owner's pool can be cancelled from the worker.
+ */
+TEST_F(SharedConnPoolTest, CancelPending) {
+  ConnectionPool::Cancellable* handle = newStream(&owner_handle_);
+  ASSERT_NE(nullptr, handle);
+
+  EXPECT_CALL(owner_handle_, cancel());
+  handle->cancel();
+
+  ReadyWatcher drained;
+  EXPECT_CALL(drained, ready());
+  forwarding_->addDrainedCallback([&drained]() -> void { drained.ready(); });
+}
+
+/**
+ * Test that a pool failure on the owner is passed back to the worker.
+ */
+TEST_F(SharedConnPoolTest, PoolFailure) {
+  EXPECT_NE(nullptr, newStream(&owner_handle_));
+
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  owner_callbacks_->onPoolFailure(ConnectionPool::PoolFailureReason::ConnectionFailure, host_);
+  EXPECT_EQ(host_, callbacks_.host_);
+}
+
+/**
+ * Test that a pool that fails synchronously on the owner is handled.
+ */
+TEST_F(SharedConnPoolTest, ImmediatePoolFailure) {
+  EXPECT_CALL(*pool_, newStream(_, _))
+      .WillOnce(Invoke([](StreamDecoder&, ConnectionPool::Callbacks& callbacks)
+                           -> ConnectionPool::Cancellable* {
+        callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, nullptr);
+        return nullptr;
+      }));
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  EXPECT_NE(nullptr, forwarding_->newStream(decoder_, callbacks_));
+}
+
+/**
+ * Test that an upstream reset is passed back to the worker.
+ */
+TEST_F(SharedConnPoolTest, RemoteReset) {
+  newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::RemoteReset));
+  upstream_encoder_.stream_.resetStream(StreamResetReason::RemoteReset);
+}
+
+/**
+ * Test that a local reset on the worker resets the upstream stream and runs the reset callbacks.
+ */
+TEST_F(SharedConnPoolTest, LocalReset) {
+  newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(upstream_encoder_.stream_, removeCallbacks(_));
+  EXPECT_CALL(upstream_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::LocalReset));
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+}
+
+/**
+ * Test that flow control is passed across in both directions.
+ */
+TEST_F(SharedConnPoolTest, FlowControl) {
+  newReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(upstream_encoder_.stream_, readDisable(true));
+  callbacks_.outer_encoder_->getStream().readDisable(true);
+  EXPECT_CALL(upstream_encoder_.stream_, readDisable(false));
+  callbacks_.outer_encoder_->getStream().readDisable(false);
+
+  EXPECT_CALL(stream_callbacks, onAboveWriteBufferHighWatermark());
+  upstream_encoder_.stream_.runHighWatermarkCallbacks();
+  EXPECT_CALL(stream_callbacks, onBelowWriteBufferLowWatermark());
+  upstream_encoder_.stream_.runLowWatermarkCallbacks();
+
+  EXPECT_CALL(upstream_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+}
+
+/**
+ * Test that events the owner posted before the worker reset the stream are dropped.
+ */
+TEST_F(SharedConnPoolTest, EventsAfterLocalResetDropped) {
+  newReadyStream();
+
+  std::vector<Event::PostCb> posted;
+  ON_CALL(worker_dispatcher_, post(_))
+      .WillByDefault(Invoke([&posted](Event::PostCb cb) -> void { posted.push_back(cb); }));
+  owner_decoder_->decodeHeaders(HeaderMapPtr{new TestHeaderMapImpl{{":status", "200"}}}, false);
+
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  EXPECT_CALL(decoder_, decodeHeaders_(_, _)).Times(0);
+  for (const Event::PostCb& cb : posted) {
+    cb();
+  }
+}
+
+/**
+ * Test that once the owner's pool drains, the owner unregisters and new streams use a local pool,
+ * which the forwarding pool waits for when it drains.
+ */
+TEST_F(SharedConnPoolTest, OwnerDraining) {
+  EXPECT_CALL(*pool_, addDrainedCallback(_));
+  owner_.addDrainedCallback([]() -> void {});
+  EXPECT_EQ(1U, unregistered_);
+
+  ConnectionPool::MockCancellable local_handle;
+  EXPECT_CALL(*pool_, newStream(_, _)).Times(0);
+  EXPECT_CALL(*local_pool_, newStream(Ref(decoder_), Ref(callbacks_)))
+      .Times(2)
+      .WillRepeatedly(Return(&local_handle));
+  EXPECT_EQ(&local_handle, forwarding_->newStream(decoder_, callbacks_));
+  EXPECT_EQ(&local_handle, forwarding_->newStream(decoder_, callbacks_));
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_forwarded_.value());
+
+  EXPECT_CALL(*local_pool_, drainConnections());
+  forwarding_->drainConnections();
+
+  ConnectionPool::Instance::DrainedCb local_drained;
+  EXPECT_CALL(*local_pool_, addDrainedCallback(_)).WillOnce(SaveArg<0>(&local_drained));
+  ReadyWatcher drained;
+  forwarding_->addDrainedCallback([&drained]() -> void { drained.ready(); });
+
+  EXPECT_CALL(drained, ready());
+  local_drained();
+}
+
+/**
+ * Test that a stream that reaches the owner after it unregistered is moved to the worker's local
+ * pool instead of failing, and that the forwarding pool waits for it when it drains.
+ */
+TEST_F(SharedConnPoolTest, OwnerDrainingWithQueuedStream) {
+  std::function<void()> queued;
+  EXPECT_CALL(owner_dispatcher_, post(_)).WillOnce(SaveArg<0>(&queued));
+  ConnectionPool::Cancellable* handle = forwarding_->newStream(decoder_, callbacks_);
+  ASSERT_NE(nullptr, handle);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_forwarded_.value());
+
+  EXPECT_CALL(*pool_, addDrainedCallback(_));
+  owner_.addDrainedCallback([]() -> void {});
+  EXPECT_EQ(1U, unregistered_);
+
+  ConnectionPool::MockCancellable local_handle;
+  ConnectionPool::Callbacks* local_callbacks{};
+  EXPECT_CALL(*pool_, newStream(_, _)).Times(0);
+  EXPECT_CALL(*local_pool_, newStream(Ref(decoder_), _))
+      .WillOnce(Invoke([&](StreamDecoder&, ConnectionPool::Callbacks& callbacks)
+                           -> ConnectionPool::Cancellable* {
+        local_callbacks = &callbacks;
+        return &local_handle;
+      }));
+  queued();
+  ASSERT_NE(nullptr, local_callbacks);
+
+  // The forwarding pool doesn't drain while the moved stream is pending on the local pool.
+  ConnectionPool::Instance::DrainedCb local_drained;
+  EXPECT_CALL(*local_pool_, addDrainedCallback(_)).WillOnce(SaveArg<0>(&local_drained));
+  ReadyWatcher drained;
+  forwarding_->addDrainedCallback([&drained]() -> void { drained.ready(); });
+
+  // The caller gets the local pool's encoder directly.
+  EXPECT_CALL(callbacks_.pool_ready_, ready());
+  local_callbacks->onPoolReady(upstream_encoder_, host_);
+  EXPECT_EQ(&upstream_encoder_, callbacks_.outer_encoder_);
+  EXPECT_EQ(host_, callbacks_.host_);
+
+  EXPECT_CALL(drained, ready());
+  local_drained();
+}
+
+/**
+ * Test that a stream moved to the local pool can be cancelled while it is pending there.
+ */
+TEST_F(SharedConnPoolTest, CancelQueuedStreamOnLocalPool) {
+  std::function<void()> queued;
+  EXPECT_CALL(owner_dispatcher_, post(_)).WillOnce(SaveArg<0>(&queued));
+  ConnectionPool::Cancellable* handle = forwarding_->newStream(decoder_, callbacks_);
+  ASSERT_NE(nullptr, handle);
+
+  EXPECT_CALL(*pool_, addDrainedCallback(_));
+  owner_.addDrainedCallback([]() -> void {});
+
+  ConnectionPool::MockCancellable local_handle;
+  EXPECT_CALL(*local_pool_, newStream(Ref(decoder_), _)).WillOnce(Return(&local_handle));
+  queued();
+
+  EXPECT_CALL(local_handle, cancel());
+  handle->cancel();
+
+  ReadyWatcher drained;
+  EXPECT_CALL(*local_pool_, addDrainedCallback(_))
+      .WillOnce(Invoke([](ConnectionPool::Instance::DrainedCb cb) -> void { cb(); }));
+  EXPECT_CALL(drained, ready());
+  forwarding_->addDrainedCallback([&drained]() -> void { drained.ready(); });
+}
+
+/**
+ * Test that destroying the forwarding pool resets its streams on the owner.
+ */
+TEST_F(SharedConnPoolTest, DestroyWithActiveStream) {
+  newReadyStream();
+
+  EXPECT_CALL(upstream_encoder_.stream_, resetStream(StreamResetReason::LocalReset));
+  forwarding_.reset();
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,71 @@
+#include "common/network/connection_balancer_impl.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class TestBalancedConnectionHandler : public BalancedConnectionHandler {
+public:
+  TestBalancedConnectionHandler(uint64_t num_connections) : num_connections_(num_connections) {}
+
+  // Network::BalancedConnectionHandler
+  uint64_t numConnections() const override { return num_connections_; }
+  void incNumConnections() override { num_connections_++; }
+  void post(ConnectionSocketPtr&&) override {}
+
+  uint64_t num_connections_;
+};
+
+TEST(NopConnectionBalancerImplTest, KeepOnCurrentHandler) {
+  NopConnectionBalancerImpl balancer;
+  TestBalancedConnectionHandler handler1(5);
+  TestBalancedConnectionHandler handler2(0);
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+
+  EXPECT_EQ(&handler1, &balancer.pickTargetHandler(handler1));
+  EXPECT_EQ(6U, handler1.num_connections_);
+  EXPECT_EQ(0U, handler2.num_connections_);
+}
+
+TEST(ExactConnectionBalancerImplTest, PickLeastLoaded) {
+  ExactConnectionBalancerImpl balancer;
+  TestBalancedConnectionHandler handler1(2);
+  TestBalancedConnectionHandler handler2(0);
+  TestBalancedConnectionHandler handler3(1);
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  balancer.registerHandler(handler3);
+
+  EXPECT_EQ(&handler2, &balancer.pickTargetHandler(handler1));
+  EXPECT_EQ(1U, handler2.num_connections_);
+
+  // handler2 and handler3 are tied now, and the accepting handler wins a tie.
+  EXPECT_EQ(&handler3, &balancer.pickTargetHandler(handler3));
+  EXPECT_EQ(2U, handler3.num_connections_);
+  EXPECT_EQ(&handler2, &balancer.pickTargetHandler(handler3));
+  EXPECT_EQ(2U, handler2.num_connections_);
+
+  // All handlers are tied.
+  EXPECT_EQ(&handler1, &balancer.pickTargetHandler(handler1));
+  EXPECT_EQ(3U, handler1.num_connections_);
+}
+
+TEST(ExactConnectionBalancerImplTest, UnregisterHandler) {
+  ExactConnectionBalancerImpl balancer;
+  TestBalancedConnectionHandler handler1(2);
+  TestBalancedConnectionHandler handler2(0);
+  balancer.registerHandler(handler1);
+  balancer.registerHandler(handler2);
+  balancer.unregisterHandler(handler2);
+
+  EXPECT_EQ(&handler1, &balancer.pickTargetHandler(handler1));
+  EXPECT_EQ(3U, handler1.num_connections_);
+  EXPECT_EQ(0U, handler2.num_connections_);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
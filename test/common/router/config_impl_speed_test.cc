@@ -0,0 +1,145 @@
+// Usage: bazel run //test/common/router:config_impl_speed_test
+
+#include "envoy/api/v2/rds.pb.h"
+
+#include "common/common/fmt.h"
+#include "common/router/config_impl.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "testing/base/public/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+// Builds a virtual host with num_routes routes, alternating between exact path and prefix routes,
+// followed by a catch-all prefix route.
+envoy::api::v2::RouteConfiguration genRouteConfig(int64_t num_routes) {
+  envoy::api::v2::RouteConfiguration route_config;
+  auto* virtual_host = route_config.add_virtual_hosts();
+  virtual_host->set_name("benchmark");
+  virtual_host->add_domains("*");
+  for (int64_t i = 0; i < num_routes; i++) {
+    auto* route = virtual_host->add_routes();
+    if (i % 2 == 0) {
+      route->mutable_match()->set_path(fmt::format("/service/{}/method", i));
+    } else {
+      route->mutable_match()->set_prefix(fmt::format("/service/{}/", i));
+    }
+    route->mutable_route()->set_cluster(fmt::format("cluster_{}", i));
+  }
+  auto* route = virtual_host->add_routes();
+  route->mutable_match()->set_prefix("/");
+  route->mutable_route()->set_cluster("default");
+  return route_config;
+}
+
+// Test the route lookup for a request matching the last exact path route, which is the worst case
+// for a linear scan. The argument is the number of routes.
+static void BM_RouteMatchLastPath(benchmark::State& state) {
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  const int64_t num_routes = state.range(0);
+  ConfigImpl config(genRouteConfig(num_routes), factory_context, false);
+  const int64_t last_path = (num_routes - 1) & ~1;
+  Http::TestHeaderMapImpl headers{{":authority", "example.com"},
+                                  {":path", fmt::format("/service/{}/method", last_path)},
+                                  {":method", "GET"}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config.route(headers, 0));
+  }
+}
+BENCHMARK(BM_RouteMatchLastPath)->Arg(10)->Arg(100)->Arg(1000)->Arg(3000);
+
+// Test the route lookup for a request matching the last prefix route.
+static void BM_RouteMatchLastPrefix(benchmark::State& state) {
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  const int64_t num_routes = state.range(0);
+  ConfigImpl config(genRouteConfig(num_routes), factory_context, false);
+  const int64_t last_prefix = (num_routes - 1) | 1;
+  Http::TestHeaderMapImpl headers{{":authority", "example.com"},
+                                  {":path", fmt::format("/service/{}/foo?bar=baz", last_prefix)},
+                                  {":method", "GET"}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config.route(headers, 0));
+  }
+}
+BENCHMARK(BM_RouteMatchLastPrefix)->Arg(10)->Arg(100)->Arg(1000)->Arg(3000);
+
+// Test the route lookup for a request that only matches the catch-all route.
+static void BM_RouteMatchDefault(benchmark::State& state) {
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigImpl config(genRouteConfig(state.range(0)), factory_context, false);
+  Http::TestHeaderMapImpl headers{
+      {":authority", "example.com"}, {":path", "/unknown/path"}, {":method", "GET"}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config.route(headers, 0));
+  }
+}
+BENCHMARK(BM_RouteMatchDefault)->Arg(10)->Arg(100)->Arg(1000)->Arg(3000);
+
+// Builds num_hosts virtual hosts with one route each. Every host has an exact domain and a wildcard
+// domain, and the wildcard suffixes come in a range of lengths.
+envoy::api::v2::RouteConfiguration genVirtualHostConfig(int64_t num_hosts) {
+  envoy::api::v2::RouteConfiguration route_config;
+  for (int64_t i = 0; i < num_hosts; i++) {
+    auto* virtual_host = route_config.add_virtual_hosts();
+    virtual_host->set_name(fmt::format("tenant{}", i));
+    virtual_host->add_domains(fmt::format("tenant{}.example.com", i));
+    virtual_host->add_domains(fmt::format("*.{}tenant{}.example.com", std::string(i % 16, 'x'), i));
+    auto* route = virtual_host->add_routes();
+    route->mutable_match()->set_prefix("/");
+    route->mutable_route()->set_cluster(fmt::format("cluster_{}", i));
+  }
+  return route_config;
+}
+
+// Test the route lookup for a request to an exact domain. The argument is the number of virtual
+// hosts.
+static void BM_VirtualHostMatchExact(benchmark::State& state) {
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  const int64_t num_hosts = state.range(0);
+  ConfigImpl config(genVirtualHostConfig(num_hosts), factory_context, false);
+  Http::TestHeaderMapImpl headers{
+      {":authority", fmt::format("Tenant{}.example.com", num_hosts / 2)},
+      {":path", "/"},
+      {":method", "GET"}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config.route(headers, 0));
+  }
+}
+BENCHMARK(BM_VirtualHostMatchExact)->Arg(10)->Arg(1000)->Arg(20000);
+
+// Test the route lookup for a request to a wildcard domain, which is the worst case as every
+// wildcard suffix length has to be considered.
+static void BM_VirtualHostMatchWildcard(benchmark::State& state) {
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  const int64_t num_hosts = state.range(0);
+  ConfigImpl config(genVirtualHostConfig(num_hosts), factory_context, false);
+  const int64_t host = num_hosts / 2;
+  Http::TestHeaderMapImpl headers{
+      {":authority",
+       fmt::format("api.{}tenant{}.example.com", std::string(host % 16, 'x'), host)},
+      {":path", "/"},
+      {":method", "GET"}};
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(config.route(headers, 0));
+  }
+}
+BENCHMARK(BM_VirtualHostMatchWildcard)->Arg(10)->Arg(1000)->Arg(20000);
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -1795,6 +1795,69 @@ TEST(RouteMatcherTest, Runtime) {
             config.route(genHeaders("www.lyft.com", "/", "GET"), 20)->routeEntry()->clusterName());
 }
 
+// Routes of different match types are indexed separately; make sure the first route in config
+// order that matches still wins.
+TEST(RouteMatcherTest, FirstMatchAcrossMatchTypes) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: www2
+    domains: ["*"]
+    routes:
+      - match:
+          prefix: "/api"
+          headers:
+            - name: x-canary
+              exact_match: "true"
+        route:
+          cluster: canary
+      - match:
+          path: "/API/v1/users"
+          case_sensitive: false
+        route:
+          cluster: users
+      - match:
+          regex: "/api/v[0-9]+/.*"
+        route:
+          cluster: versioned
+      - match:
+          prefix: "/api/v1"
+        route:
+          cluster: v1
+      - match:
+          path: "/api/v1/users"
+        route:
+          cluster: unreachable
+      - match:
+          prefix: "/API"
+          case_sensitive: false
+        route:
+          cluster: api
+      - match:
+          prefix: "/"
+        route:
+          cluster: default
+  )EOF";
+
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ConfigImpl config(parseRouteConfigurationFromV2Yaml(yaml), factory_context, true);
+
+  auto cluster = [&config](Http::TestHeaderMapImpl&& headers) -> std::string {
+    return config.route(headers, 0)->routeEntry()->clusterName();
+  };
+
+  EXPECT_EQ("users", cluster(genHeaders("www.lyft.com", "/api/v1/users", "GET")));
+  EXPECT_EQ("users", cluster(genHeaders("www.lyft.com", "/api/V1/Users?limit=10", "GET")));
+  EXPECT_EQ("versioned", cluster(genHeaders("www.lyft.com", "/api/v1/users/1", "GET")));
+  EXPECT_EQ("v1", cluster(genHeaders("www.lyft.com", "/api/v1", "GET")));
+  EXPECT_EQ("api", cluster(genHeaders("www.lyft.com", "/api/v2", "GET")));
+  EXPECT_EQ("api", cluster(genHeaders("www.lyft.com", "/Api/v2/foo", "GET")));
+  EXPECT_EQ("default", cluster(genHeaders("www.lyft.com", "/ap", "GET")));
+
+  Http::TestHeaderMapImpl canary_headers = genHeaders("www.lyft.com", "/api/v1/users", "GET");
+  canary_headers.addCopy("x-canary", "true");
+  EXPECT_EQ("canary", cluster(std::move(canary_headers)));
+}
+
 TEST(RouteMatcherTest, ShadowClusterNotFound) {
   std::string json = R"EOF(
 {
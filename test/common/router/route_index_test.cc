@@ -0,0 +1,102 @@
+#include "common/router/route_index.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+RouteIndex::Candidates candidates(const RouteIndex& index, const std::string& path) {
+  RouteIndex::Candidates result;
+  index.candidates(path, result);
+  return result;
+}
+
+TEST(RouteIndexTest, Empty) {
+  RouteIndex index;
+  EXPECT_THAT(candidates(index, "/"), IsEmpty());
+  EXPECT_THAT(candidates(index, ""), IsEmpty());
+}
+
+TEST(RouteIndexTest, Prefix) {
+  RouteIndex index;
+  index.addPrefix("/foo/bar", true, 0);
+  index.addPrefix("/foo", true, 1);
+  index.addPrefix("/fo", true, 2);
+  index.addPrefix("/baz", true, 3);
+  index.addPrefix("", true, 4);
+  index.addPrefix("/foo", true, 5);
+
+  EXPECT_THAT(candidates(index, "/foo/bar/baz"), ElementsAre(0, 1, 2, 4, 5));
+  EXPECT_THAT(candidates(index, "/foo"), ElementsAre(1, 2, 4, 5));
+  EXPECT_THAT(candidates(index, "/fo"), ElementsAre(2, 4));
+  EXPECT_THAT(candidates(index, "/f"), ElementsAre(4));
+  EXPECT_THAT(candidates(index, "/FOO"), ElementsAre(4));
+  EXPECT_THAT(candidates(index, "/baz?foo=bar"), ElementsAre(3, 4));
+  EXPECT_THAT(candidates(index, ""), ElementsAre(4));
+}
+
+TEST(RouteIndexTest, PrefixIncludesQueryString) {
+  RouteIndex index;
+  index.addPrefix("/foo?bar", true, 0);
+
+  EXPECT_THAT(candidates(index, "/foo?bar=baz"), ElementsAre(0));
+  EXPECT_THAT(candidates(index, "/foo"), IsEmpty());
+}
+
+TEST(RouteIndexTest, CaseInsensitivePrefix) {
+  RouteIndex index;
+  index.addPrefix("/Foo", false, 0);
+  index.addPrefix("/foo", true, 1);
+
+  EXPECT_THAT(candidates(index, "/FOO/bar"), ElementsAre(0));
+  EXPECT_THAT(candidates(index, "/foo/bar"), ElementsAre(0, 1));
+}
+
+TEST(RouteIndexTest, Path) {
+  RouteIndex index;
+  index.addPath("/foo", true, 0);
+  index.addPath("/Foo", false, 1);
+  index.addPath("/foo/bar", true, 2);
+  index.addPath("/foo", true, 3);
+
+  EXPECT_THAT(candidates(index, "/foo"), ElementsAre(0, 1, 3));
+  EXPECT_THAT(candidates(index, "/foo?bar=baz"), ElementsAre(0, 1, 3));
+  EXPECT_THAT(candidates(index, "/FOO"), ElementsAre(1));
+  EXPECT_THAT(candidates(index, "/foo/bar"), ElementsAre(2));
+  EXPECT_THAT(candidates(index, "/foo/"), IsEmpty());
+  EXPECT_THAT(candidates(index, "/fo"), IsEmpty());
+}
+
+TEST(RouteIndexTest, Mixed) {
+  RouteIndex index;
+  index.addPath("/", true, 0);
+  index.addAlways(1);
+  index.addPrefix("/api", true, 2);
+  index.addPath("/api/v1", false, 3);
+  index.addAlways(4);
+  index.addPrefix("/", true, 5);
+
+  EXPECT_THAT(candidates(index, "/"), ElementsAre(0, 1, 4, 5));
+  EXPECT_THAT(candidates(index, "/api/V1"), ElementsAre(1, 2, 3, 4, 5));
+  EXPECT_THAT(candidates(index, "/other"), ElementsAre(1, 4, 5));
+  EXPECT_THAT(candidates(index, "other"), ElementsAre(1, 4));
+}
+
+TEST(RouteIndexTest, AppendsToExistingCandidates) {
+  RouteIndex index;
+  index.addPrefix("/", true, 1);
+  index.addAlways(0);
+
+  RouteIndex::Candidates result{7};
+  index.candidates("/", result);
+  EXPECT_THAT(result, ElementsAre(7, 0, 1));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,75 @@
+#include "common/router/virtual_host_index.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+TEST(VirtualHostIndexTest, Empty) {
+  VirtualHostIndex index;
+  EXPECT_FALSE(index.hasExact());
+  EXPECT_FALSE(index.find("foo.com"));
+  EXPECT_FALSE(index.find(""));
+}
+
+TEST(VirtualHostIndexTest, Exact) {
+  VirtualHostIndex index;
+  EXPECT_TRUE(index.addExact("foo.com", 0));
+  EXPECT_TRUE(index.addExact("bar.foo.com", 1));
+  EXPECT_TRUE(index.addExact("foo.com:8080", 2));
+  EXPECT_FALSE(index.addExact("foo.com", 3));
+  EXPECT_TRUE(index.hasExact());
+
+  EXPECT_EQ(0, index.find("foo.com").value());
+  EXPECT_EQ(0, index.find("FOO.Com").value());
+  EXPECT_EQ(1, index.find("bar.foo.com").value());
+  EXPECT_EQ(2, index.find("foo.com:8080").value());
+  EXPECT_FALSE(index.find("oo.com"));
+  EXPECT_FALSE(index.find("baz.foo.com"));
+  EXPECT_FALSE(index.find("foo.co"));
+  EXPECT_FALSE(index.find(""));
+}
+
+TEST(VirtualHostIndexTest, Wildcard) {
+  VirtualHostIndex index;
+  index.addWildcard(".foo.com", 0);
+  index.addWildcard("-bar.foo.com", 1);
+  index.addWildcard(".foo.com", 2);
+  EXPECT_FALSE(index.hasExact());
+
+  EXPECT_EQ(0, index.find("bar.foo.com").value());
+  EXPECT_EQ(0, index.find("a.b.FOO.com").value());
+  EXPECT_EQ(1, index.find("baz-bar.foo.com").value());
+  EXPECT_EQ(0, index.find("baz.bar.foo.com").value());
+  // The wildcard must match at least one character.
+  EXPECT_FALSE(index.find(".foo.com"));
+  EXPECT_EQ(0, index.find("-bar.foo.com").value());
+  EXPECT_FALSE(index.find("foo.com"));
+  EXPECT_FALSE(index.find("bar.foo.co"));
+}
+
+TEST(VirtualHostIndexTest, ExactBeforeWildcard) {
+  VirtualHostIndex index;
+  index.addWildcard(".foo.com", 0);
+  index.addExact("bar.foo.com", 1);
+  index.addWildcard("r.foo.com", 2);
+
+  EXPECT_EQ(1, index.find("bar.foo.com").value());
+  EXPECT_EQ(2, index.find("baar.foo.com").value());
+  EXPECT_EQ(2, index.find("ar.foo.com").value());
+  EXPECT_EQ(0, index.find("baz.foo.com").value());
+}
+
+TEST(VirtualHostIndexTest, EmptyExactDomain) {
+  VirtualHostIndex index;
+  index.addExact("", 0);
+  index.addWildcard("", 1);
+
+  EXPECT_EQ(0, index.find("").value());
+  EXPECT_EQ(1, index.find("foo").value());
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,158 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/thread.h"
+#include "common/ssl/session_cache_impl.h"
+
+#include "test/mocks/common.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Ssl {
+
+class SessionCacheImplTest : public testing::Test {
+public:
+  SessionCacheImplTest()
+      : state_(new SessionCacheImpl::State()), cache_(*state_, lock_, time_source_) {
+    ON_CALL(time_source_, currentTime()).WillByDefault(Return(SystemTime()));
+  }
+
+  void advanceTime(std::chrono::seconds interval) {
+    now_ += interval;
+    ON_CALL(time_source_, currentTime()).WillByDefault(Return(now_));
+  }
+
+  std::vector<ServerContextConfig::SessionTicketKey> ticketKeys() {
+    std::vector<ServerContextConfig::SessionTicketKey> keys;
+    cache_.ticketKeys(keys);
+    return keys;
+  }
+
+  static bool sameKey(const ServerContextConfig::SessionTicketKey& a,
+                      const ServerContextConfig::SessionTicketKey& b) {
+    return a.name_ == b.name_ && a.hmac_key_ == b.hmac_key_ && a.aes_key_ == b.aes_key_;
+  }
+
+  SystemTime now_;
+  NiceMock<MockSystemTimeSource> time_source_;
+  Thread::MutexBasicLockable lock_;
+  std::unique_ptr<SessionCacheImpl::State> state_;
+  SessionCacheImpl cache_;
+};
+
+TEST_F(SessionCacheImplTest, TicketKeysRotate) {
+  std::vector<ServerContextConfig::SessionTicketKey> keys1 = ticketKeys();
+  ASSERT_EQ(1U, keys1.size());
+
+  // Keys are stable within the rotation interval.
+  advanceTime(SessionCacheImpl::TICKET_KEY_ROTATION_INTERVAL - std::chrono::seconds(1));
+  std::vector<ServerContextConfig::SessionTicketKey> keys = ticketKeys();
+  ASSERT_EQ(1U, keys.size());
+  EXPECT_TRUE(sameKey(keys1[0], keys[0]));
+
+  // A new key is used for encryption, and the previous key is kept for decryption.
+  advanceTime(std::chrono::seconds(1));
+  std::vector<ServerContextConfig::SessionTicketKey> keys2 = ticketKeys();
+  ASSERT_EQ(2U, keys2.size());
+  EXPECT_FALSE(sameKey(keys1[0], keys2[0]));
+  EXPECT_TRUE(sameKey(keys1[0], keys2[1]));
+
+  advanceTime(SessionCacheImpl::TICKET_KEY_ROTATION_INTERVAL);
+  keys = ticketKeys();
+  ASSERT_EQ(3U, keys.size());
+  EXPECT_TRUE(sameKey(keys2[0], keys[1]));
+  EXPECT_TRUE(sameKey(keys1[0], keys[2]));
+
+  // The oldest key is dropped.
+  advanceTime(SessionCacheImpl::TICKET_KEY_ROTATION_INTERVAL);
+  std::vector<ServerContextConfig::SessionTicketKey> keys4 = ticketKeys();
+  ASSERT_EQ(3U, keys4.size());
+  EXPECT_TRUE(sameKey(keys[0], keys4[1]));
+  EXPECT_TRUE(sameKey(keys2[0], keys4[2]));
+}
+
+// The generation only changes when the keys are rotated, and rotates the keys when they are due.
+TEST_F(SessionCacheImplTest, TicketKeysGeneration) {
+  const uint64_t generation = cache_.ticketKeysGeneration();
+  EXPECT_NE(0U, generation);
+  std::vector<ServerContextConfig::SessionTicketKey> keys1;
+  EXPECT_EQ(generation, cache_.ticketKeys(keys1));
+
+  advanceTime(SessionCacheImpl::TICKET_KEY_ROTATION_INTERVAL - std::chrono::seconds(1));
+  EXPECT_EQ(generation, cache_.ticketKeysGeneration());
+
+  advanceTime(std::chrono::seconds(1));
+  const uint64_t next_generation = cache_.ticketKeysGeneration();
+  EXPECT_NE(generation, next_generation);
+  std::vector<ServerContextConfig::SessionTicketKey> keys2;
+  EXPECT_EQ(next_generation, cache_.ticketKeys(keys2));
+  ASSERT_EQ(2U, keys2.size());
+  EXPECT_FALSE(sameKey(keys1[0], keys2[0]));
+  EXPECT_TRUE(sameKey(keys1[0], keys2[1]));
+}
+
+// A second cache over the same state, as in a hot restarted process, uses the same keys and
+// sessions.
+TEST_F(SessionCacheImplTest, SharedState) {
+  SessionCacheImpl other_cache(*state_, lock_, time_source_);
+  EXPECT_TRUE(cache_.insertSession("id", "session"));
+
+  std::vector<ServerContextConfig::SessionTicketKey> keys = ticketKeys();
+  std::vector<ServerContextConfig::SessionTicketKey> other_keys;
+  other_cache.ticketKeys(other_keys);
+  ASSERT_EQ(1U, other_keys.size());
+  EXPECT_TRUE(sameKey(keys[0], other_keys[0]));
+
+  std::string session;
+  EXPECT_TRUE(other_cache.lookupSession("id", session));
+  EXPECT_EQ("session", session);
+}
+
+TEST_F(SessionCacheImplTest, Sessions) {
+  std::string session;
+  EXPECT_FALSE(cache_.lookupSession("id1", session));
+
+  EXPECT_TRUE(cache_.insertSession("id1", "session1"));
+  EXPECT_TRUE(cache_.insertSession("id2", "session2"));
+  EXPECT_TRUE(cache_.lookupSession("id1", session));
+  EXPECT_EQ("session1", session);
+  EXPECT_TRUE(cache_.lookupSession("id2", session));
+  EXPECT_EQ("session2", session);
+
+  // Sessions are replaced.
+  EXPECT_TRUE(cache_.insertSession("id1", "session3"));
+  EXPECT_TRUE(cache_.lookupSession("id1", session));
+  EXPECT_EQ("session3", session);
+
+  cache_.removeSession("id1");
+  EXPECT_FALSE(cache_.lookupSession("id1", session));
+  EXPECT_TRUE(cache_.lookupSession("id2", session));
+
+  // Removing a missing session is a no-op.
+  cache_.removeSession("id1");
+  cache_.removeSession("id3");
+  EXPECT_TRUE(cache_.lookupSession("id2", session));
+}
+
+TEST_F(SessionCacheImplTest, SessionTooLarge) {
+  std::string session;
+  EXPECT_FALSE(
+      cache_.insertSession("id", std::string(SessionCacheImpl::MAX_SESSION_SIZE + 1, 'a')));
+  EXPECT_FALSE(cache_.lookupSession("id", session));
+  EXPECT_FALSE(
+      cache_.insertSession(std::string(SessionCacheImpl::MAX_SESSION_ID_SIZE + 1, 'a'), "session"));
+  EXPECT_FALSE(cache_.insertSession("", "session"));
+
+  EXPECT_TRUE(cache_.insertSession("id", std::string(SessionCacheImpl::MAX_SESSION_SIZE, 'a')));
+  EXPECT_TRUE(cache_.lookupSession("id", session));
+  EXPECT_EQ(std::string(SessionCacheImpl::MAX_SESSION_SIZE, 'a'), session);
+}
+
+} // namespace Ssl
+} // namespace Envoy
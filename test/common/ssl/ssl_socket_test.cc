@@ -4,6 +4,8 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/common/empty_string.h"
+#include "common/common/thread.h"
+#include "common/common/utility.h"
 #include "common/event/dispatcher_impl.h"
 #include "common/json/json_loader.h"
 #include "common/network/address_impl.h"
@@ -11,6 +13,7 @@
 #include "common/network/utility.h"
 #include "common/ssl/context_config_impl.h"
 #include "common/ssl/context_impl.h"
+#include "common/ssl/session_cache_impl.h"
 #include "common/ssl/ssl_socket.h"
 
 #include "extensions/filters/listener/tls_inspector/tls_inspector.h"
@@ -1746,17 +1749,21 @@ TEST_P(SslSocketTest, ClientAuthMultipleCAs) {
 
 namespace {
 
-// Test connecting with a client to server1, then trying to reuse the session on server2
+// Test connecting with a client to server1, then trying to reuse the session on server2. With
+// client_no_tickets, the client doesn't accept session tickets, so the session can only be resumed
+// by its session ID.
 void testTicketSessionResumption(const std::string& server_ctx_json1,
                                  const std::vector<std::string>& server_names1,
                                  const std::string& server_ctx_json2,
                                  const std::vector<std::string>& server_names2,
                                  const std::string& client_ctx_json, bool expect_reuse,
-                                 const Network::Address::IpVersion ip_version) {
+                                 const Network::Address::IpVersion ip_version,
+                                 SessionCache* session_cache = nullptr,
+                                 bool client_no_tickets = false) {
   Stats::IsolatedStoreImpl stats_store;
   Runtime::MockLoader runtime;
   Secret::MockSecretManager secret_manager;
-  ContextManagerImpl manager(runtime);
+  ContextManagerImpl manager(runtime, session_cache);
 
   Json::ObjectSharedPtr server_ctx_loader1 = TestEnvironment::jsonLoadFromString(server_ctx_json1);
   Json::ObjectSharedPtr server_ctx_loader2 = TestEnvironment::jsonLoadFromString(server_ctx_json2);
@@ -1783,6 +1790,10 @@ void testTicketSessionResumption(const std::string& server_ctx_json1,
   Network::ClientConnectionPtr client_connection = dispatcher.createClientConnection(
       socket1.localAddress(), Network::Address::InstanceConstSharedPtr(),
       ssl_socket_factory.createTransportSocket(), nullptr);
+  if (client_no_tickets) {
+    SSL_set_options(dynamic_cast<Ssl::SslSocket*>(client_connection->ssl())->rawSslForTest(),
+                    SSL_OP_NO_TICKET);
+  }
 
   Network::MockConnectionCallbacks client_connection_callbacks;
   client_connection->addConnectionCallbacks(client_connection_callbacks);
@@ -1823,6 +1834,9 @@ void testTicketSessionResumption(const std::string& server_ctx_json1,
       ssl_socket_factory.createTransportSocket(), nullptr);
   client_connection->addConnectionCallbacks(client_connection_callbacks);
   Ssl::SslSocket* ssl_socket = dynamic_cast<Ssl::SslSocket*>(client_connection->ssl());
+  if (client_no_tickets) {
+    SSL_set_options(ssl_socket->rawSslForTest(), SSL_OP_NO_TICKET);
+  }
   SSL_set_session(ssl_socket->rawSslForTest(), ssl_session);
   SSL_SESSION_free(ssl_session);
 
@@ -1931,6 +1945,85 @@ TEST_P(SslSocketTest, TicketSessionResumptionRotateKey) {
                               GetParam());
 }
 
+// Without configured keys, each context has its own ticket key.
+TEST_P(SslSocketTest, TicketSessionResumptionInternalKey) {
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+
+  std::string client_ctx_json = R"EOF(
+  {
+  }
+  )EOF";
+
+  testTicketSessionResumption(server_ctx_json, {}, server_ctx_json, {}, client_ctx_json, false,
+                              GetParam());
+}
+
+// Without configured keys, contexts share the ticket keys of the session cache.
+TEST_P(SslSocketTest, TicketSessionResumptionSessionCacheKey) {
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+
+  std::string client_ctx_json = R"EOF(
+  {
+  }
+  )EOF";
+
+  Thread::MutexBasicLockable lock;
+  std::unique_ptr<SessionCacheImpl::State> state(new SessionCacheImpl::State());
+  SessionCacheImpl session_cache(*state, lock, ProdSystemTimeSource::instance_);
+  testTicketSessionResumption(server_ctx_json, {}, server_ctx_json, {}, client_ctx_json, true,
+                              GetParam(), &session_cache);
+}
+
+// Sessions created by one context are resumed by session ID on another context through the
+// session cache.
+TEST_P(SslSocketTest, SessionIdResumptionSessionCache) {
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+
+  std::string client_ctx_json = R"EOF(
+  {
+  }
+  )EOF";
+
+  Thread::MutexBasicLockable lock;
+  std::unique_ptr<SessionCacheImpl::State> state(new SessionCacheImpl::State());
+  SessionCacheImpl session_cache(*state, lock, ProdSystemTimeSource::instance_);
+  testTicketSessionResumption(server_ctx_json, {}, server_ctx_json, {}, client_ctx_json, true,
+                              GetParam(), &session_cache, true);
+}
+
+// Without the session cache, sessions are only cached by the context that created them.
+TEST_P(SslSocketTest, SessionIdResumptionWithoutSessionCache) {
+  std::string server_ctx_json = R"EOF(
+  {
+    "cert_chain_file": "{{ test_tmpdir }}/unittestcert.pem",
+    "private_key_file": "{{ test_tmpdir }}/unittestkey.pem"
+  }
+  )EOF";
+
+  std::string client_ctx_json = R"EOF(
+  {
+  }
+  )EOF";
+
+  testTicketSessionResumption(server_ctx_json, {}, server_ctx_json, {}, client_ctx_json, false,
+                              GetParam(), nullptr, true);
+}
+
 TEST_P(SslSocketTest, TicketSessionResumptionWrongKey) {
   std::string server_ctx_json1 = R"EOF(
   {
@@ -2366,6 +2459,39 @@ TEST_P(SslSocketTest, ProtocolVersions) {
   testUtilV2(listener, client, "", true, "TLSv1.3", "", "", "", "", "ssl.handshake", 2, GetParam());
 }
 
+// Private key operations performed on the thread pool complete the handshake, both for signing
+// and for RSA key exchange decryption.
+TEST_P(SslSocketTest, ThreadPoolPrivateKeyProvider) {
+  envoy::api::v2::Listener listener;
+  envoy::api::v2::listener::FilterChain* filter_chain = listener.add_filter_chains();
+  envoy::api::v2::auth::TlsCertificate* server_cert =
+      filter_chain->mutable_tls_context()->mutable_common_tls_context()->add_tls_certificates();
+  server_cert->mutable_certificate_chain()->set_filename(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/ssl/test_data/san_dns_cert.pem"));
+  server_cert->mutable_private_key()->set_filename(
+      TestEnvironment::substitute("{{ test_rundir }}/test/common/ssl/test_data/san_dns_key.pem"));
+  server_cert->mutable_private_key_provider()->mutable_thread_pool()->mutable_threads()->set_value(
+      2);
+
+  envoy::api::v2::auth::UpstreamTlsContext client;
+  envoy::api::v2::auth::TlsParameters* client_params =
+      client.mutable_common_tls_context()->mutable_tls_params();
+
+  // ssl.handshake logged by both: client & server.
+  testUtilV2(listener, client, "", true, "TLSv1.2", "", "", "", "", "ssl.handshake", 2, GetParam());
+
+  client_params->add_cipher_suites("AES128-SHA");
+  testUtilV2(listener, client, "", true, "TLSv1.2", "", "", "", "", "ssl.handshake", 2, GetParam());
+
+  client_params->clear_cipher_suites();
+  client_params->set_tls_minimum_protocol_version(envoy::api::v2::auth::TlsParameters::TLSv1_3);
+  client_params->set_tls_maximum_protocol_version(envoy::api::v2::auth::TlsParameters::TLSv1_3);
+  envoy::api::v2::auth::TlsParameters* server_params =
+      filter_chain->mutable_tls_context()->mutable_common_tls_context()->mutable_tls_params();
+  server_params->set_tls_maximum_protocol_version(envoy::api::v2::auth::TlsParameters::TLSv1_3);
+  testUtilV2(listener, client, "", true, "TLSv1.3", "", "", "", "", "ssl.handshake", 2, GetParam());
+}
+
 TEST_P(SslSocketTest, ALPN) {
   envoy::api::v2::Listener listener;
   envoy::api::v2::listener::FilterChain* filter_chain = listener.add_filter_chains();
@@ -0,0 +1,172 @@
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/ssl/thread_pool_private_key_method_provider.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/test_common/environment.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::_;
+
+namespace Envoy {
+namespace Ssl {
+
+class ThreadPoolPrivateKeyMethodProviderTest : public testing::Test {
+public:
+  ThreadPoolPrivateKeyMethodProviderTest()
+      : ssl_ctx_(SSL_CTX_new(TLS_method())), ssl_(SSL_new(ssl_ctx_.get())),
+        thread_pool_(std::make_shared<PrivateKeyThreadPool>(1)) {
+    const std::string key = TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+        "{{ test_rundir }}/test/common/ssl/test_data/san_dns_key.pem"));
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(key.data(), key.size()));
+    pkey_.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+    RELEASE_ASSERT(pkey_ != nullptr, "");
+    EVP_PKEY_up_ref(pkey_.get());
+    provider_ = std::make_unique<ThreadPoolPrivateKeyMethodProvider>(
+        bssl::UniquePtr<EVP_PKEY>(pkey_.get()), thread_pool_);
+
+    ON_CALL(dispatcher_, post(_)).WillByDefault(Invoke([this](std::function<void()> callback) {
+      Thread::LockGuard lock(lock_);
+      posted_ = callback;
+      posted_cond_.notifyAll();
+    }));
+    provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, dispatcher_);
+  }
+
+  ~ThreadPoolPrivateKeyMethodProviderTest() { provider_->unregisterPrivateKeyMethod(ssl_.get()); }
+
+  ssl_private_key_result_t sign() {
+    uint8_t out[1];
+    size_t out_len;
+    return provider_->getBoringSslPrivateKeyMethod()->sign(
+        ssl_.get(), out, &out_len, sizeof(out), SSL_SIGN_RSA_PKCS1_SHA256,
+        reinterpret_cast<const uint8_t*>(input_.data()), input_.size());
+  }
+
+  ssl_private_key_result_t complete(std::vector<uint8_t>& out) {
+    out.resize(1024);
+    size_t out_len;
+    ssl_private_key_result_t result = provider_->getBoringSslPrivateKeyMethod()->complete(
+        ssl_.get(), out.data(), &out_len, out.size());
+    out.resize(result == ssl_private_key_success ? out_len : 0);
+    return result;
+  }
+
+  // Waits for the pool to post the completion of an operation to the connection's dispatcher.
+  std::function<void()> waitForPost() {
+    Thread::LockGuard lock(lock_);
+    while (posted_ == nullptr) {
+      posted_cond_.wait(lock_);
+    }
+    return posted_;
+  }
+
+  // Waits until the single thread of the pool has run everything that is queued.
+  void drainThreadPool() {
+    Thread::MutexBasicLockable lock;
+    Thread::CondVar cond;
+    bool done = false;
+    thread_pool_->post([&]() -> void {
+      Thread::LockGuard guard(lock);
+      done = true;
+      cond.notifyAll();
+    });
+    Thread::LockGuard guard(lock);
+    while (!done) {
+      cond.wait(lock);
+    }
+  }
+
+  const std::string input_{"hello"};
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  MockPrivateKeyConnectionCallbacks callbacks_;
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar posted_cond_;
+  std::function<void()> posted_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  bssl::UniquePtr<SSL> ssl_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  PrivateKeyThreadPoolSharedPtr thread_pool_;
+  std::unique_ptr<ThreadPoolPrivateKeyMethodProvider> provider_;
+};
+
+// A completed operation resumes the connection on its dispatcher and returns the signature.
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, Sign) {
+  EXPECT_EQ(ssl_private_key_retry, sign());
+  // Only one operation can be pending per connection.
+  EXPECT_EQ(ssl_private_key_failure, sign());
+
+  std::function<void()> posted = waitForPost();
+  EXPECT_CALL(callbacks_, onPrivateKeyMethodComplete());
+  posted();
+
+  std::vector<uint8_t> signature;
+  EXPECT_EQ(ssl_private_key_success, complete(signature));
+  bssl::ScopedEVP_MD_CTX ctx;
+  ASSERT_EQ(1, EVP_DigestVerifyInit(ctx.get(), nullptr, EVP_sha256(), nullptr, pkey_.get()));
+  EXPECT_EQ(1, EVP_DigestVerify(ctx.get(), signature.data(), signature.size(),
+                                reinterpret_cast<const uint8_t*>(input_.data()), input_.size()));
+
+  // The next operation can be started once the previous one has completed.
+  EXPECT_EQ(ssl_private_key_retry, sign());
+}
+
+// Closing a connection after its operation has completed, but before the completion has run on
+// its dispatcher, must not call back into the connection.
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, UnregisterWithPostedCompletion) {
+  EXPECT_EQ(ssl_private_key_retry, sign());
+  std::function<void()> posted = waitForPost();
+
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+  EXPECT_CALL(callbacks_, onPrivateKeyMethodComplete()).Times(0);
+  posted();
+
+  std::vector<uint8_t> signature;
+  EXPECT_EQ(ssl_private_key_failure, complete(signature));
+}
+
+// Closing a connection before its operation has run means the completion is never posted.
+TEST_F(ThreadPoolPrivateKeyMethodProviderTest, UnregisterWithQueuedOperation) {
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
+  EXPECT_CALL(callbacks_, onPrivateKeyMethodComplete()).Times(0);
+
+  // Keep the pool busy until the connection is unregistered, so that the operation is still
+  // queued when it is cancelled.
+  Thread::MutexBasicLockable lock;
+  Thread::CondVar cond;
+  bool unregistered = false;
+  thread_pool_->post([&]() -> void {
+    Thread::LockGuard guard(lock);
+    while (!unregistered) {
+      cond.wait(lock);
+    }
+  });
+
+  EXPECT_EQ(ssl_private_key_retry, sign());
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+  {
+    Thread::LockGuard guard(lock);
+    unregistered = true;
+    cond.notifyAll();
+  }
+
+  // The operation runs, but doesn't post its completion.
+  drainThreadPool();
+}
+
+} // namespace Ssl
+} // namespace Envoy
@@ -17,7 +17,7 @@ TEST(HeapStatDataTest, HeapNoTruncate) {
   const std::string long_string(stats_options.maxNameLength() + 1, 'A');
   HeapStatData* stat{};
   EXPECT_NO_LOGS(stat = alloc.alloc(long_string));
-  EXPECT_EQ(stat->key(), long_string);
+  EXPECT_EQ(alloc.name(*stat), long_string);
   alloc.free(*stat);
 }
 
@@ -38,5 +38,22 @@ TEST(HeapStatDataTest, HeapAlloc) {
   alloc.free(*stat_3);
 }
 
+// Names are stored in the allocator's symbol table, sharing their common tokens.
+TEST(HeapStatDataTest, HeapAllocSymbols) {
+  HeapStatDataAllocator alloc;
+  HeapStatData* stat_1 = alloc.alloc("cluster.foo.upstream_rq_200");
+  HeapStatData* stat_2 = alloc.alloc("cluster.bar.upstream_rq_200");
+  HeapStatData* stat_3 = alloc.alloc("cluster.foo.upstream_rq_200");
+  EXPECT_EQ(stat_1, stat_3);
+  EXPECT_EQ(4, alloc.symbolTable().numSymbols());
+  EXPECT_EQ("cluster.foo.upstream_rq_200", alloc.name(*stat_1));
+  EXPECT_EQ("cluster.bar.upstream_rq_200", alloc.name(*stat_2));
+  alloc.free(*stat_1);
+  alloc.free(*stat_2);
+  EXPECT_EQ(3, alloc.symbolTable().numSymbols());
+  alloc.free(*stat_3);
+  EXPECT_EQ(0, alloc.symbolTable().numSymbols());
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -6,8 +6,10 @@
 
 #include "gtest/gtest.h"
 
+using testing::Invoke;
 using testing::NiceMock;
 using testing::ReturnPointee;
+using testing::_;
 
 namespace Envoy {
 namespace Stats {
@@ -47,5 +49,36 @@ TEST(SourceImplTest, Caching) {
   EXPECT_EQ(source.cachedHistograms(), stored_histograms);
 }
 
+TEST(SourceImplTest, ChangedStats) {
+  NiceMock<MockStore> store;
+  CounterSharedPtr counter = std::make_shared<MockCounter>();
+  GaugeSharedPtr gauge = std::make_shared<MockGauge>();
+  SourceImpl source(store);
+
+  // The changed counters and gauges are latched from the store together, once per interval.
+  EXPECT_CALL(store, latchChanged(_, _))
+      .WillOnce(Invoke([&](std::vector<CounterSharedPtr>& counters,
+                           std::vector<GaugeSharedPtr>& gauges) {
+        counters.push_back(counter);
+        gauges.push_back(gauge);
+      }));
+  EXPECT_EQ(std::vector<CounterSharedPtr>{counter}, source.cachedChangedCounters());
+  EXPECT_EQ(std::vector<GaugeSharedPtr>{gauge}, source.cachedChangedGauges());
+  EXPECT_EQ(std::vector<CounterSharedPtr>{counter}, source.cachedChangedCounters());
+  source.clearCache();
+
+  // An interval whose changes nobody asked for is still latched, so that they aren't reported
+  // in the next interval.
+  EXPECT_CALL(store, latchChanged(_, _))
+      .WillOnce(Invoke([&](std::vector<CounterSharedPtr>& counters, std::vector<GaugeSharedPtr>&) {
+        counters.push_back(counter);
+      }));
+  source.clearCache();
+
+  EXPECT_CALL(store, latchChanged(_, _));
+  EXPECT_TRUE(source.cachedChangedGauges().empty());
+  EXPECT_TRUE(source.cachedChangedCounters().empty());
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -0,0 +1,122 @@
+#include <string>
+#include <vector>
+
+#include "common/common/fmt.h"
+#include "common/stats/symbol_table_impl.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::ElementsAre;
+
+namespace Envoy {
+namespace Stats {
+
+class SymbolTableTest : public testing::Test {
+public:
+  ~SymbolTableTest() {
+    for (StatName& stat_name : stat_names_) {
+      table_.free(stat_name);
+    }
+  }
+
+  const StatName& encode(absl::string_view name) {
+    stat_names_.push_back(table_.encode(name));
+    return stat_names_.back();
+  }
+
+  SymbolTable table_;
+  std::vector<StatName> stat_names_;
+};
+
+TEST_F(SymbolTableTest, RoundTrip) {
+  stat_names_.reserve(16);
+  for (const std::string name :
+       {"cluster.foo.upstream_rq_200", "foo", "", ".", "foo.", ".foo", "a..b", "cluster.foo"}) {
+    EXPECT_EQ(name, table_.decode(encode(name)));
+  }
+}
+
+TEST_F(SymbolTableTest, SharedTokens) {
+  stat_names_.reserve(16);
+  const StatName& foo_rq = encode("cluster.foo.upstream_rq_200");
+  EXPECT_EQ(3, table_.numSymbols());
+  const StatName& bar_rq = encode("cluster.bar.upstream_rq_200");
+  EXPECT_EQ(4, table_.numSymbols());
+  const StatName& foo_rq_2 = encode("cluster.foo.upstream_rq_200");
+  EXPECT_EQ(4, table_.numSymbols());
+
+  EXPECT_EQ(foo_rq, foo_rq_2);
+  EXPECT_EQ(foo_rq.hash(), foo_rq_2.hash());
+  EXPECT_FALSE(foo_rq == bar_rq);
+  // One byte per token.
+  EXPECT_EQ(3, foo_rq.bytes().size());
+}
+
+TEST_F(SymbolTableTest, Tokens) {
+  StatName tags = table_.encodeTokens({"envoy.cluster_name", "foo.bar", "", "x"});
+  EXPECT_EQ(4, table_.numSymbols());
+  EXPECT_THAT(table_.decodeTokens(tags), ElementsAre("envoy.cluster_name", "foo.bar", "", "x"));
+  table_.free(tags);
+
+  StatName empty = table_.encodeTokens({});
+  EXPECT_FALSE(empty.empty());
+  EXPECT_TRUE(table_.decodeTokens(empty).empty());
+  table_.free(empty);
+}
+
+// Names of interned tokens are encoded without taking references, and others aren't encoded.
+TEST_F(SymbolTableTest, EncodeExisting) {
+  const StatName& foo_rq = encode("cluster.foo.upstream_rq_200");
+  std::string bytes;
+  EXPECT_TRUE(table_.encodeExisting("cluster.foo.upstream_rq_200", bytes));
+  EXPECT_EQ(foo_rq.bytes(), bytes);
+  EXPECT_TRUE(table_.encodeExisting("cluster.upstream_rq_200", bytes));
+  EXPECT_EQ(3, table_.numSymbols());
+
+  EXPECT_FALSE(table_.encodeExisting("cluster.bar.upstream_rq_200", bytes));
+  EXPECT_EQ(3, table_.numSymbols());
+}
+
+TEST_F(SymbolTableTest, Free) {
+  StatName foo_rq = table_.encode("cluster.foo.upstream_rq_200");
+  StatName bar_rq = table_.encode("cluster.bar.upstream_rq_200");
+  EXPECT_EQ(4, table_.numSymbols());
+
+  table_.free(foo_rq);
+  EXPECT_TRUE(foo_rq.empty());
+  EXPECT_EQ(3, table_.numSymbols());
+  EXPECT_EQ("cluster.bar.upstream_rq_200", table_.decode(bar_rq));
+
+  // Freeing an empty name does nothing.
+  table_.free(foo_rq);
+  EXPECT_EQ(3, table_.numSymbols());
+
+  // The freed symbol is reused.
+  StatName baz_rq = table_.encode("cluster.baz.upstream_rq_200");
+  EXPECT_EQ(4, table_.numSymbols());
+  EXPECT_EQ(3, baz_rq.bytes().size());
+  EXPECT_EQ("cluster.baz.upstream_rq_200", table_.decode(baz_rq));
+
+  table_.free(bar_rq);
+  table_.free(baz_rq);
+  EXPECT_EQ(0, table_.numSymbols());
+}
+
+TEST_F(SymbolTableTest, ManySymbols) {
+  const uint64_t num_names = 1000;
+  stat_names_.reserve(num_names);
+  for (uint64_t i = 0; i < num_names; i++) {
+    encode(fmt::format("cluster.c{}.upstream_rq_total", i));
+  }
+  EXPECT_EQ(num_names + 2, table_.numSymbols());
+  for (uint64_t i = 0; i < num_names; i++) {
+    EXPECT_EQ(fmt::format("cluster.c{}.upstream_rq_total", i), table_.decode(stat_names_[i]));
+  }
+  // Symbols of 128 and above take two bytes.
+  EXPECT_EQ(3, stat_names_[0].bytes().size());
+  EXPECT_EQ(4, stat_names_[num_names - 1].bytes().size());
+}
+
+} // namespace Stats
+} // namespace Envoy
@@ -0,0 +1,121 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+//
+// Usage: bazel run -c opt //test/common/stats:thread_local_store_speed_test
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/config/metrics/v2/stats.pb.h"
+
+#include "common/common/fmt.h"
+#include "common/stats/heap_stat_data.h"
+#include "common/stats/stats_options_impl.h"
+#include "common/stats/tag_producer_impl.h"
+#include "common/stats/thread_local_store.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Stats {
+namespace {
+
+// The store is shared by all benchmark threads. Thread 0 creates it before the timed loop and
+// destroys it afterwards; the benchmark library synchronizes the threads around the loop.
+// Threading isn't initialized on the store, so every lookup goes to the central cache, which is
+// the path taken on a TLS cache miss.
+class StoreContext {
+public:
+  void setUp() {
+    store_ = std::make_unique<ThreadLocalStoreImpl>(options_, alloc_);
+    store_->setTagProducer(
+        std::make_unique<TagProducerImpl>(envoy::config::metrics::v2::StatsConfig()));
+  }
+
+  void tearDown() {
+    store_->shutdownThreading();
+    store_.reset();
+  }
+
+  ThreadLocalStoreImpl& store() { return *store_; }
+
+private:
+  StatsOptionsImpl options_;
+  HeapStatDataAllocator alloc_;
+  std::unique_ptr<ThreadLocalStoreImpl> store_;
+};
+
+StoreContext& context() {
+  static StoreContext* context = new StoreContext();
+  return *context;
+}
+
+const std::vector<std::string>& clusterStatNames() {
+  static const std::vector<std::string>* names = new std::vector<std::string>{
+      "upstream_cx_total",   "upstream_cx_active",    "upstream_rq_total",
+      "upstream_rq_active",  "upstream_rq_2xx",       "upstream_rq_5xx",
+      "upstream_rq_timeout", "membership_healthy",    "membership_total",
+      "lb_healthy_panic",    "retry.upstream_rq_5xx", "update_success"};
+  return *names;
+}
+
+// Test looking up existing counters in a scope shared by all threads, e.g. the server scope. The
+// argument is the number of distinct counters.
+static void BM_LookupSharedScope(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    context().setUp();
+  }
+  const int64_t num_stats = state.range(0);
+  std::vector<std::string> names;
+  for (int64_t i = 0; i < num_stats; i++) {
+    names.push_back(fmt::format("cluster.service_{}.upstream_rq_total", i));
+  }
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(&context().store().counter(names[i++ % names.size()]));
+  }
+
+  if (state.thread_index == 0) {
+    context().tearDown();
+  }
+}
+BENCHMARK(BM_LookupSharedScope)->Arg(1000)->ThreadRange(1, 16)->UseRealTime();
+
+// Test creating a scope, populating it with a set of stats and destroying it, as happens for each
+// cluster during CDS churn and for short-lived per-request scopes. Each thread works on its own
+// clusters.
+static void BM_CreateScopedStats(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    context().setUp();
+  }
+
+  uint64_t i = 0;
+  for (auto _ : state) {
+    ScopePtr scope = context().store().createScope(
+        fmt::format("cluster.thread_{}_service_{}.", state.thread_index, i++ % 100));
+    for (const std::string& name : clusterStatNames()) {
+      scope->counter(name).inc();
+      scope->gauge(name).set(1);
+    }
+  }
+
+  if (state.thread_index == 0) {
+    context().tearDown();
+  }
+}
+BENCHMARK(BM_CreateScopedStats)->ThreadRange(1, 16)->UseRealTime();
+
+} // namespace
+} // namespace Stats
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -389,6 +389,68 @@ TEST_F(StatsThreadLocalStoreTest, OverlappingScopes) {
   EXPECT_CALL(*alloc_, free(_)).Times(3);
 }
 
+TEST_F(StatsThreadLocalStoreTest, ChangedStats) {
+  InSequence s;
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  ScopePtr scope1 = store_->createScope("scope1.");
+  ScopePtr scope2 = store_->createScope("scope1.");
+  EXPECT_CALL(*alloc_, alloc(_)).Times(4);
+  Counter& c1 = scope1->counter("c");
+  Counter& c2 = scope2->counter("c");
+  Gauge& g1 = scope1->gauge("g");
+  Gauge& g2 = scope2->gauge("g");
+
+  // Stats that haven't been written aren't changed.
+  std::vector<CounterSharedPtr> counters;
+  std::vector<GaugeSharedPtr> gauges;
+  store_->latchChanged(counters, gauges);
+  EXPECT_TRUE(counters.empty());
+  EXPECT_TRUE(gauges.empty());
+
+  // Writes through overlapping scopes are reported once.
+  c1.inc();
+  c2.inc();
+  g1.set(5);
+  g2.set(5);
+  store_->latchChanged(counters, gauges);
+  ASSERT_EQ(1UL, counters.size());
+  EXPECT_EQ("scope1.c", counters[0]->name());
+  EXPECT_EQ(2UL, counters[0]->latch());
+  ASSERT_EQ(1UL, gauges.size());
+  EXPECT_EQ("scope1.g", gauges[0]->name());
+  EXPECT_EQ(5UL, gauges[0]->value());
+
+  // Nothing has been written since the last latch.
+  counters.clear();
+  gauges.clear();
+  store_->latchChanged(counters, gauges);
+  EXPECT_TRUE(counters.empty());
+  EXPECT_TRUE(gauges.empty());
+
+  // The stats of a deleted scope are left out, but their backing data is shared with the
+  // overlapping scope.
+  c1.inc();
+  EXPECT_CALL(*alloc_, free(_)).Times(2);
+  scope1.reset();
+  c2.inc();
+  g2.dec();
+  store_->latchChanged(counters, gauges);
+  ASSERT_EQ(1UL, counters.size());
+  EXPECT_EQ(&c2, counters[0].get());
+  EXPECT_EQ(2UL, counters[0]->latch());
+  ASSERT_EQ(1UL, gauges.size());
+  EXPECT_EQ(&g2, gauges[0].get());
+  counters.clear();
+  gauges.clear();
+
+  store_->shutdownThreading();
+  tls_.shutdownThread();
+
+  // Includes overflow stat.
+  EXPECT_CALL(*alloc_, free(_)).Times(3);
+}
+
 TEST_F(StatsThreadLocalStoreTest, AllocFailed) {
   InSequence s;
   store_->initializeThreading(main_thread_dispatcher_, tls_);
@@ -646,6 +708,28 @@ TEST_F(HistogramTest, BasicHistogramMergeSummary) {
   EXPECT_EQ(expected_summary, name_histogram_map["h1"]->cumulativeStatistics().summary());
 }
 
+// Validates the cumulative bucket counts after known values are merged.
+TEST_F(HistogramTest, BasicHistogramMergeBuckets) {
+  Histogram& h1 = store_->histogram("h1");
+
+  for (size_t i = 0; i < 100; ++i) {
+    expectCallAndAccumulate(h1, i);
+  }
+  EXPECT_EQ(1, validateMerge());
+
+  NameHistogramMap name_histogram_map = makeHistogramMap(store_->histograms());
+  const HistogramStatistics& statistics = name_histogram_map["h1"]->cumulativeStatistics();
+  const std::vector<double> expected_bounds = {0.5,   1,      5,      10,      25,     50,   100,
+                                               250,   500,    1000,   2500,    5000,   10000, 30000,
+                                               60000, 300000, 600000, 1800000, 3600000};
+  const std::vector<uint64_t> expected_buckets = {1,   2,   6,   11,  26,  51,  100, 100, 100, 100,
+                                                  100, 100, 100, 100, 100, 100, 100, 100, 100};
+  EXPECT_EQ(expected_bounds, statistics.supportedBuckets());
+  EXPECT_EQ(expected_buckets, statistics.computedBuckets());
+  EXPECT_EQ(100U, statistics.sampleCount());
+  EXPECT_NEAR(4950, statistics.sampleSum(), 50);
+}
+
 TEST_F(HistogramTest, BasicHistogramUsed) {
   ScopePtr scope1 = store_->createScope("scope1.");
 
@@ -1414,6 +1414,125 @@ TEST_F(ClusterManagerImplTest, DoNotCloseTcpConnectionsOnHealthFailure) {
   EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
 }
 
+// Test that pools are created and prefetched on hosts added to a cluster with a prefetch ratio,
+// for each kind of pool the cluster has used so far.
+TEST_F(ClusterManagerImplTest, PrefetchOnHostAdd) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: some_cluster
+      connect_timeout: 0.250s
+      lb_policy: ROUND_ROBIN
+      prefetch_policy:
+        per_upstream_prefetch_ratio: 1.5
+  )EOF";
+  std::shared_ptr<MockCluster> cluster1(new NiceMock<MockCluster>());
+  cluster1->info_->name_ = "some_cluster";
+  cluster1->info_->per_upstream_prefetch_ratio_ = 1.5;
+  HostSharedPtr host1 = makeTestHost(cluster1->info_, "tcp://127.0.0.1:80");
+  cluster1->prioritySet().getMockHostSet(0)->hosts_ = {host1};
+  ON_CALL(*cluster1, initializePhase()).WillByDefault(Return(Cluster::InitializePhase::Primary));
+
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _, _)).WillOnce(Return(cluster1));
+  EXPECT_CALL(*cluster1, initialize(_))
+      .WillOnce(Invoke([cluster1](std::function<void()> initialize_callback) {
+        // Test inline init.
+        initialize_callback();
+      }));
+  create(parseBootstrapFromV2Yaml(yaml));
+
+  // No pools have been used yet, so there is nothing to prefetch.
+  EXPECT_CALL(factory_, allocateConnPool_(_)).Times(0);
+  EXPECT_CALL(factory_, allocateTcpConnPool_(_)).Times(0);
+  HostSharedPtr host2 = makeTestHost(cluster1->info_, "tcp://127.0.0.2:80");
+  cluster1->prioritySet().getMockHostSet(0)->hosts_.push_back(host2);
+  cluster1->prioritySet().getMockHostSet(0)->runCallbacks({host2}, {});
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(&factory_));
+
+  EXPECT_CALL(factory_, allocateConnPool_(_))
+      .WillOnce(Return(new Http::ConnectionPool::MockInstance()));
+  cluster_manager_->httpConnPoolForCluster("some_cluster", ResourcePriority::Default,
+                                           Http::Protocol::Http11, nullptr);
+  EXPECT_CALL(factory_, allocateTcpConnPool_(_))
+      .WillOnce(Return(new Tcp::ConnectionPool::MockInstance()));
+  cluster_manager_->tcpConnPoolForCluster("some_cluster", ResourcePriority::High, nullptr);
+
+  // The new host gets one pool of each kind, which is prefetched. The unhealthy one gets none.
+  HostSharedPtr host3 = makeTestHost(cluster1->info_, "tcp://127.0.0.3:80");
+  HostSharedPtr host4 = makeTestHost(cluster1->info_, "tcp://127.0.0.4:80");
+  host4->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+  Http::ConnectionPool::MockInstance* cp = new Http::ConnectionPool::MockInstance();
+  Tcp::ConnectionPool::MockInstance* tcp = new Tcp::ConnectionPool::MockInstance();
+  EXPECT_CALL(factory_, allocateConnPool_(HostConstSharedPtr(host3))).WillOnce(Return(cp));
+  EXPECT_CALL(*cp, prefetch());
+  EXPECT_CALL(factory_, allocateTcpConnPool_(HostConstSharedPtr(host3))).WillOnce(Return(tcp));
+  EXPECT_CALL(*tcp, prefetch());
+  cluster1->prioritySet().getMockHostSet(0)->hosts_.push_back(host3);
+  cluster1->prioritySet().getMockHostSet(0)->hosts_.push_back(host4);
+  cluster1->prioritySet().getMockHostSet(0)->runCallbacks({host3, host4}, {});
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+}
+
+// Test that HTTP/2 pools of a cluster that shares them are created once per host and wrap the
+// allocated pool, and that the shared pool unregisters once it drains.
+TEST_F(ClusterManagerImplTest, SharedHttp2ConnPool) {
+  const std::string yaml = R"EOF(
+  static_resources:
+    clusters:
+    - name: some_cluster
+      connect_timeout: 0.250s
+      lb_policy: ROUND_ROBIN
+      share_http2_connection_pools: true
+  )EOF";
+  std::shared_ptr<MockCluster> cluster1(new NiceMock<MockCluster>());
+  cluster1->info_->name_ = "some_cluster";
+  ON_CALL(*cluster1->info_, features())
+      .WillByDefault(Return(ClusterInfo::Features::SHARE_HTTP2_CONNECTION_POOLS));
+  HostSharedPtr host1 = makeTestHost(cluster1->info_, "tcp://127.0.0.1:80");
+  cluster1->prioritySet().getMockHostSet(0)->hosts_ = {host1};
+  ON_CALL(*cluster1, initializePhase()).WillByDefault(Return(Cluster::InitializePhase::Primary));
+
+  EXPECT_CALL(factory_, clusterFromProto_(_, _, _, _, _)).WillOnce(Return(cluster1));
+  EXPECT_CALL(*cluster1, initialize(_))
+      .WillOnce(Invoke([cluster1](std::function<void()> initialize_callback) {
+        // Test inline init.
+        initialize_callback();
+      }));
+  create(parseBootstrapFromV2Yaml(yaml));
+
+  Http::ConnectionPool::MockInstance* cp = new NiceMock<Http::ConnectionPool::MockInstance>();
+  EXPECT_CALL(factory_, allocateConnPool_(_)).WillOnce(Return(cp));
+  Http::ConnectionPool::Instance* pool = cluster_manager_->httpConnPoolForCluster(
+      "some_cluster", ResourcePriority::Default, Http::Protocol::Http2, nullptr);
+  EXPECT_NE(cp, pool);
+  EXPECT_EQ(pool, cluster_manager_->httpConnPoolForCluster(
+                      "some_cluster", ResourcePriority::Default, Http::Protocol::Http2, nullptr));
+
+  // The owning worker uses the allocated pool directly.
+  EXPECT_CALL(*cp, drainConnections());
+  pool->drainConnections();
+
+  // HTTP/1.1 pools are never shared.
+  Http::ConnectionPool::MockInstance* cp_http11 = new Http::ConnectionPool::MockInstance();
+  EXPECT_CALL(factory_, allocateConnPool_(_)).WillOnce(Return(cp_http11));
+  EXPECT_EQ(cp_http11, cluster_manager_->httpConnPoolForCluster(
+                           "some_cluster", ResourcePriority::Default, Http::Protocol::Http11,
+                           nullptr));
+
+  // Removing the host drains the pools.
+  Http::ConnectionPool::Instance::DrainedCb drained_cb;
+  EXPECT_CALL(*cp, addDrainedCallback(_)).WillOnce(SaveArg<0>(&drained_cb));
+  EXPECT_CALL(*cp_http11, addDrainedCallback(_))
+      .WillOnce(Invoke([](Http::ConnectionPool::Instance::DrainedCb cb) -> void { cb(); }));
+  cluster1->prioritySet().getMockHostSet(0)->hosts_ = {};
+  cluster1->prioritySet().getMockHostSet(0)->runCallbacks({}, {host1});
+  EXPECT_CALL(factory_.tls_.dispatcher_, deferredDelete_(_)).Times(2);
+  drained_cb();
+
+  EXPECT_TRUE(Mock::VerifyAndClearExpectations(cluster1.get()));
+}
+
 TEST_F(ClusterManagerImplTest, DynamicHostRemove) {
   const std::string json = R"EOF(
   {
@@ -449,6 +449,9 @@ TEST(StrictDnsClusterImplTest, LoadAssignmentBasic) {
 
     max_requests_per_connection: 3
 
+    prefetch_policy:
+      per_upstream_prefetch_ratio: 1.5
+
     http2_protocol_options:
       hpack_table_size: 0
 
@@ -501,6 +504,7 @@ TEST(StrictDnsClusterImplTest, LoadAssignmentBasic) {
   EXPECT_CALL(runtime.snapshot_, getInteger("circuit_breakers.name.high.max_retries", 4));
   EXPECT_EQ(4U, cluster.info()->resourceManager(ResourcePriority::High).retries().max());
   EXPECT_EQ(3U, cluster.info()->maxRequestsPerConnection());
+  EXPECT_EQ(1.5, cluster.info()->perUpstreamPrefetchRatio());
   EXPECT_EQ(0U, cluster.info()->http2Settings().hpack_table_size_);
 
   cluster.info()->stats().upstream_rq_total_.inc();
@@ -1248,6 +1252,7 @@ TEST(StaticClusterImplTest, UrlConfig) {
   EXPECT_EQ(1024U, cluster.info()->resourceManager(ResourcePriority::High).requests().max());
   EXPECT_EQ(3U, cluster.info()->resourceManager(ResourcePriority::High).retries().max());
   EXPECT_EQ(0U, cluster.info()->maxRequestsPerConnection());
+  EXPECT_EQ(1.0, cluster.info()->perUpstreamPrefetchRatio());
   EXPECT_EQ(Http::Http2Settings::DEFAULT_HPACK_TABLE_SIZE,
             cluster.info()->http2Settings().hpack_table_size_);
   EXPECT_EQ(LoadBalancerType::Random, cluster.info()->lbType());
@@ -73,6 +73,27 @@ TEST(FileAccessLogConfigTest, FileAccessLogTest) {
   EXPECT_NE(nullptr, dynamic_cast<FileAccessLog*>(instance.get()));
 }
 
+TEST(FileAccessLogConfigTest, JsonFormat) {
+  envoy::config::accesslog::v2::FileAccessLog file_access_log;
+  file_access_log.set_path("/dev/null");
+  auto* fields = file_access_log.mutable_json_format()->mutable_fields();
+  (*fields)["protocol"].set_string_value("%PROTOCOL%");
+  (*fields)["method"].set_string_value("%REQ(:METHOD)%");
+
+  AccessLog::FilterPtr filter;
+  NiceMock<Server::Configuration::MockFactoryContext> context;
+  AccessLog::InstanceSharedPtr instance =
+      FileAccessLogFactory().createAccessLogInstance(file_access_log, std::move(filter), context);
+  EXPECT_NE(nullptr, dynamic_cast<FileAccessLog*>(instance.get()));
+
+  (*fields)["bad"].set_number_value(1);
+  EXPECT_THROW_WITH_MESSAGE(
+      FileAccessLogFactory().createAccessLogInstance(file_access_log, nullptr, context),
+      EnvoyException,
+      "Only string values are supported in the JSON access log format, given a different value "
+      "for key: bad");
+}
+
 } // namespace File
 } // namespace AccessLoggers
 } // namespace Extensions
@@ -1,8 +1,10 @@
 #include "common/network/address_impl.h"
+#include "common/stats/isolated_store_impl.h"
 
 #include "extensions/access_loggers/http_grpc/grpc_access_log_impl.h"
 
 #include "test/mocks/access_log/mocks.h"
+#include "test/mocks/event/mocks.h"
 #include "test/mocks/grpc/mocks.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/request_info/mocks.h"
@@ -31,7 +33,7 @@ public:
       return Grpc::AsyncClientPtr{async_client_};
     }));
     streamer_ = std::make_unique<GrpcAccessLogStreamerImpl>(Grpc::AsyncClientFactoryPtr{factory_},
-                                                            tls_, local_info_);
+                                                            tls_, local_info_, stats_store_);
   }
 
   void expectStreamStart(MockAccessLogStream& stream, AccessLogCallbacks** callbacks_to_set) {
@@ -43,8 +45,28 @@ public:
         }));
   }
 
+  // A config that sends every log as soon as it is logged.
+  envoy::config::accesslog::v2::CommonGrpcAccessLogConfig unbufferedConfig(
+      const std::string& log_name) {
+    envoy::config::accesslog::v2::CommonGrpcAccessLogConfig config;
+    config.set_log_name(log_name);
+    config.mutable_buffer_size_bytes()->set_value(0);
+    return config;
+  }
+
+  envoy::service::accesslog::v2::StreamAccessLogsMessage logMessage() {
+    envoy::service::accesslog::v2::StreamAccessLogsMessage message;
+    message.mutable_http_logs()->add_log_entry()->mutable_request()->set_path("/foo");
+    return message;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return stats_store_.counter("access_logs.grpc_access_log." + name).value();
+  }
+
   NiceMock<ThreadLocal::MockInstance> tls_;
   LocalInfo::MockLocalInfo local_info_;
+  Stats::IsolatedStoreImpl stats_store_;
   Grpc::MockAsyncClient* async_client_{new Grpc::MockAsyncClient};
   Grpc::MockAsyncClientFactory* factory_{new Grpc::MockAsyncClientFactory};
   std::unique_ptr<GrpcAccessLogStreamerImpl> streamer_;
@@ -55,26 +77,29 @@ TEST_F(GrpcAccessLogStreamerImplTest, BasicFlow) {
   InSequence s;
 
   // Start a stream for the first log.
+  new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
   MockAccessLogStream stream1;
   AccessLogCallbacks* callbacks1;
   expectStreamStart(stream1, &callbacks1);
   EXPECT_CALL(local_info_, node());
   EXPECT_CALL(stream1, sendMessage(_, false));
-  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log1;
-  streamer_->send(message_log1, "log1");
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log1 = logMessage();
+  streamer_->send(message_log1, unbufferedConfig("log1"));
 
-  message_log1.Clear();
+  message_log1 = logMessage();
+  EXPECT_CALL(stream1, isAboveWriteBufferHighWatermark()).WillOnce(Return(false));
   EXPECT_CALL(stream1, sendMessage(_, false));
-  streamer_->send(message_log1, "log1");
+  streamer_->send(message_log1, unbufferedConfig("log1"));
 
   // Start a stream for the second log.
+  new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
   MockAccessLogStream stream2;
   AccessLogCallbacks* callbacks2;
   expectStreamStart(stream2, &callbacks2);
   EXPECT_CALL(local_info_, node());
   EXPECT_CALL(stream2, sendMessage(_, false));
-  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log2;
-  streamer_->send(message_log2, "log2");
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log2 = logMessage();
+  streamer_->send(message_log2, unbufferedConfig("log2"));
 
   // Verify that sending an empty response message doesn't do anything bad.
   callbacks1->onReceiveMessage(
@@ -85,29 +110,125 @@ TEST_F(GrpcAccessLogStreamerImplTest, BasicFlow) {
   expectStreamStart(stream2, &callbacks2);
   EXPECT_CALL(local_info_, node());
   EXPECT_CALL(stream2, sendMessage(_, false));
-  streamer_->send(message_log2, "log2");
+  message_log2 = logMessage();
+  streamer_->send(message_log2, unbufferedConfig("log2"));
+
+  EXPECT_EQ(4U, counter("logs_written"));
+  EXPECT_EQ(0U, counter("logs_dropped"));
 }
 
 // Test that stream failure is handled correctly.
 TEST_F(GrpcAccessLogStreamerImplTest, StreamFailure) {
   InSequence s;
 
+  new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
   EXPECT_CALL(*async_client_, start(_, _))
       .WillOnce(
           Invoke([](const Protobuf::MethodDescriptor&, Grpc::AsyncStreamCallbacks& callbacks) {
             callbacks.onRemoteClose(Grpc::Status::Internal, "bad");
             return nullptr;
           }));
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log1 = logMessage();
+  streamer_->send(message_log1, unbufferedConfig("log1"));
+
+  EXPECT_EQ(0U, counter("logs_written"));
+  EXPECT_EQ(1U, counter("logs_dropped"));
+}
+
+// Test that logs are sent in a single message once the batch has enough logs.
+TEST_F(GrpcAccessLogStreamerImplTest, BatchByLogCount) {
+  InSequence s;
+
+  envoy::config::accesslog::v2::CommonGrpcAccessLogConfig config;
+  config.set_log_name("log1");
+  config.mutable_buffer_size_logs()->set_value(2);
+
+  Event::MockTimer* timer = new Event::MockTimer(&tls_.dispatcher_);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(1000)));
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message = logMessage();
+  streamer_->send(message, config);
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(local_info_, node());
+  EXPECT_CALL(stream, sendMessage(_, false))
+      .WillOnce(Invoke([](const Protobuf::Message& message, bool) {
+        const auto& logs =
+            dynamic_cast<const envoy::service::accesslog::v2::StreamAccessLogsMessage&>(message);
+        EXPECT_EQ("log1", logs.identifier().log_name());
+        EXPECT_EQ(2, logs.http_logs().log_entry_size());
+      }));
+  EXPECT_CALL(*timer, disableTimer());
+  message = logMessage();
+  streamer_->send(message, config);
+
+  EXPECT_EQ(2U, counter("logs_written"));
+}
+
+// Test that a partial batch is sent when the flush timer fires.
+TEST_F(GrpcAccessLogStreamerImplTest, BatchFlushTimer) {
+  InSequence s;
+
+  envoy::config::accesslog::v2::CommonGrpcAccessLogConfig config;
+  config.set_log_name("log1");
+  config.mutable_buffer_flush_interval()->set_seconds(5);
+
+  Event::MockTimer* timer = new Event::MockTimer(&tls_.dispatcher_);
+  EXPECT_CALL(*timer, enableTimer(std::chrono::milliseconds(5000)));
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message = logMessage();
+  streamer_->send(message, config);
+
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
+  EXPECT_CALL(local_info_, node());
+  EXPECT_CALL(stream, sendMessage(_, false));
+  EXPECT_CALL(*timer, disableTimer());
+  timer->callback_();
+
+  EXPECT_EQ(1U, counter("logs_written"));
+}
+
+// Test that logs are held while the stream is backed up, and dropped past the pending limit.
+TEST_F(GrpcAccessLogStreamerImplTest, BackedUpStream) {
+  InSequence s;
+
+  envoy::config::accesslog::v2::CommonGrpcAccessLogConfig config = unbufferedConfig("log1");
+  config.mutable_max_pending_bytes()->set_value(1);
+
+  Event::MockTimer* timer = new NiceMock<Event::MockTimer>(&tls_.dispatcher_);
+  MockAccessLogStream stream;
+  AccessLogCallbacks* callbacks;
+  expectStreamStart(stream, &callbacks);
   EXPECT_CALL(local_info_, node());
-  envoy::service::accesslog::v2::StreamAccessLogsMessage message_log1;
-  streamer_->send(message_log1, "log1");
+  EXPECT_CALL(stream, sendMessage(_, false));
+  envoy::service::accesslog::v2::StreamAccessLogsMessage message = logMessage();
+  streamer_->send(message, config);
+
+  // The stream is backed up, so the log is kept and retried when the timer fires.
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillOnce(Return(true));
+  message = logMessage();
+  streamer_->send(message, config);
+
+  // The pending limit has been reached.
+  message = logMessage();
+  streamer_->send(message, config);
+  EXPECT_EQ(1U, counter("logs_dropped"));
+
+  EXPECT_CALL(stream, isAboveWriteBufferHighWatermark()).WillOnce(Return(false));
+  EXPECT_CALL(stream, sendMessage(_, false));
+  timer->callback_();
+
+  EXPECT_EQ(2U, counter("logs_written"));
+  EXPECT_EQ(1U, counter("logs_dropped"));
 }
 
 class MockGrpcAccessLogStreamer : public GrpcAccessLogStreamer {
 public:
   // GrpcAccessLogStreamer
   MOCK_METHOD2(send, void(envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-                          const std::string& log_name));
+                          const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config));
 };
 
 class HttpGrpcAccessLogTest : public testing::Test {
@@ -125,10 +246,12 @@ public:
 
     envoy::service::accesslog::v2::StreamAccessLogsMessage expected_request_msg;
     MessageUtil::loadFromYaml(expected_request_msg_yaml, expected_request_msg);
-    EXPECT_CALL(*streamer_, send(_, "hello_log"))
+    EXPECT_CALL(*streamer_, send(_, _))
         .WillOnce(Invoke(
-            [expected_request_msg](envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
-                                   const std::string&) {
+            [expected_request_msg](
+                envoy::service::accesslog::v2::StreamAccessLogsMessage& message,
+                const envoy::config::accesslog::v2::CommonGrpcAccessLogConfig& config) {
+              EXPECT_EQ("hello_log", config.log_name());
               EXPECT_EQ(message.DebugString(), expected_request_msg.DebugString());
             }));
   }
@@ -6,6 +6,7 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/event/dispatcher_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/listener_impl.h"
 #include "common/network/raw_buffer_socket.h"
@@ -50,7 +51,8 @@ class ProxyProtocolTest : public testing::TestWithParam<Network::Address::IpVers
 public:
   ProxyProtocolTest()
       : socket_(Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true),
-        connection_handler_(new Server::ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_)),
+        connection_handler_(
+            new Server::ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, absl::nullopt)),
         name_("proxy"), filter_chain_(Network::Test::createEmptyFilterChainWithRawBufferSockets()) {
 
     connection_handler_->addListener(*this);
@@ -64,12 +66,14 @@ public:
   Network::FilterChainManager& filterChainManager() override { return *this; }
   Network::FilterChainFactory& filterChainFactory() override { return factory_; }
   Network::Socket& socket() override { return socket_; }
+  Network::Socket& workerSocket(uint32_t) override { return socket_; }
   bool bindToPort() override { return true; }
   bool handOffRestoredDestinationConnections() const override { return false; }
   uint32_t perConnectionBufferLimitBytes() override { return 0; }
   Stats::Scope& listenerScope() override { return stats_store_; }
   uint64_t listenerTag() const override { return 1; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
 
   // Network::FilterChainManager
   const Network::FilterChain* findFilterChain(const Network::ConnectionSocket&) const override {
@@ -153,6 +157,7 @@ public:
   Network::MockConnectionCallbacks server_callbacks_;
   std::shared_ptr<Network::MockReadFilter> read_filter_;
   std::string name_;
+  Network::NopConnectionBalancerImpl connection_balancer_;
   const Network::FilterChainSharedPtr filter_chain_;
 };
 
@@ -263,7 +268,7 @@ TEST_P(ProxyProtocolTest, errorRecv_2) {
       .WillRepeatedly(Invoke([](int fd, unsigned long int request, void* argp) {
         return ::ioctl(fd, request, argp);
       }));
-  EXPECT_CALL(os_sys_calls, writev(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .Times(AnyNumber())
       .WillRepeatedly(Invoke(
           [](int fd, const struct iovec* iov, int iovcnt) { return ::writev(fd, iov, iovcnt); }));
@@ -288,7 +293,7 @@ TEST_P(ProxyProtocolTest, errorFIONREAD_1) {
   Api::MockOsSysCalls os_sys_calls;
   TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls(&os_sys_calls);
   EXPECT_CALL(os_sys_calls, ioctl(_, FIONREAD, _)).WillOnce(Return(-1));
-  EXPECT_CALL(os_sys_calls, writev(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .Times(AnyNumber())
       .WillRepeatedly(Invoke(
           [](int fd, const struct iovec* iov, int iovcnt) { return ::writev(fd, iov, iovcnt); }));
@@ -492,7 +497,7 @@ TEST_P(ProxyProtocolTest, v2ParseExtensionsIoctlError) {
       .WillRepeatedly(Invoke(
           [](int fd, void* buf, size_t len, int flags) { return ::recv(fd, buf, len, flags); }));
 
-  EXPECT_CALL(os_sys_calls, writev(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .Times(AnyNumber())
       .WillRepeatedly(Invoke(
           [](int fd, const struct iovec* iov, int iovcnt) { return ::writev(fd, iov, iovcnt); }));
@@ -612,7 +617,7 @@ TEST_P(ProxyProtocolTest, v2Fragmented3Error) {
       .WillRepeatedly(Invoke([](int fd, unsigned long int request, void* argp) {
         return ::ioctl(fd, request, argp);
       }));
-  EXPECT_CALL(os_sys_calls, writev(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .Times(AnyNumber())
       .WillRepeatedly(Invoke(
           [](int fd, const struct iovec* iov, int iovcnt) { return ::writev(fd, iov, iovcnt); }));
@@ -649,7 +654,7 @@ TEST_P(ProxyProtocolTest, v2Fragmented4Error) {
       .WillRepeatedly(Invoke([](int fd, unsigned long int request, void* argp) {
         return ::ioctl(fd, request, argp);
       }));
-  EXPECT_CALL(os_sys_calls, writev(_, _, _))
+  EXPECT_CALL(os_sys_calls, writev_(_, _, _))
       .Times(AnyNumber())
       .WillRepeatedly(Invoke(
           [](int fd, const struct iovec* iov, int iovcnt) { return ::writev(fd, iov, iovcnt); }));
@@ -829,7 +834,8 @@ public:
         local_dst_address_(Network::Utility::getAddressWithPort(
             *Network::Test::getCanonicalLoopbackAddress(GetParam()),
             socket_.localAddress()->ip()->port())),
-        connection_handler_(new Server::ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_)),
+        connection_handler_(
+            new Server::ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, absl::nullopt)),
         name_("proxy"), filter_chain_(Network::Test::createEmptyFilterChainWithRawBufferSockets()) {
     connection_handler_->addListener(*this);
     conn_ = dispatcher_.createClientConnection(local_dst_address_,
@@ -849,12 +855,14 @@ public:
   Network::FilterChainManager& filterChainManager() override { return *this; }
   Network::FilterChainFactory& filterChainFactory() override { return factory_; }
   Network::Socket& socket() override { return socket_; }
+  Network::Socket& workerSocket(uint32_t) override { return socket_; }
   bool bindToPort() override { return true; }
   bool handOffRestoredDestinationConnections() const override { return false; }
   uint32_t perConnectionBufferLimitBytes() override { return 0; }
   Stats::Scope& listenerScope() override { return stats_store_; }
   uint64_t listenerTag() const override { return 1; }
   const std::string& name() const override { return name_; }
+  Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
 
   // Network::FilterChainManager
   const Network::FilterChain* findFilterChain(const Network::ConnectionSocket&) const override {
@@ -916,6 +924,7 @@ public:
   Network::MockConnectionCallbacks server_callbacks_;
   std::shared_ptr<Network::MockReadFilter> read_filter_;
   std::string name_;
+  Network::NopConnectionBalancerImpl connection_balancer_;
   const Network::FilterChainSharedPtr filter_chain_;
 };
 
@@ -0,0 +1,148 @@
+#include <string>
+#include <vector>
+
+#include "extensions/filters/network/redis_proxy/cluster_slots.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace ConnPool {
+
+namespace {
+
+RespValue makeInteger(int64_t integer) {
+  RespValue value;
+  value.type(RespType::Integer);
+  value.asInteger() = integer;
+  return value;
+}
+
+RespValue makeBulkString(const std::string& string) {
+  RespValue value;
+  value.type(RespType::BulkString);
+  value.asString() = string;
+  return value;
+}
+
+RespValue makeArray(std::vector<RespValue> values) {
+  RespValue value;
+  value.type(RespType::Array);
+  value.asArray().swap(values);
+  return value;
+}
+
+RespValue makeError(const std::string& error) {
+  RespValue value;
+  value.type(RespType::Error);
+  value.asString() = error;
+  return value;
+}
+
+} // namespace
+
+TEST(RedisClusterSlotsTest, KeySlot) {
+  // Examples from the Redis Cluster specification.
+  EXPECT_EQ(12739, ClusterSlots::keySlot("123456789"));
+  EXPECT_EQ(12182, ClusterSlots::keySlot("foo"));
+  EXPECT_EQ(5061, ClusterSlots::keySlot("bar"));
+  EXPECT_EQ(0, ClusterSlots::keySlot(""));
+
+  // Only the hash tag is hashed.
+  EXPECT_EQ(ClusterSlots::keySlot("foo"), ClusterSlots::keySlot("{foo}bar"));
+  EXPECT_EQ(ClusterSlots::keySlot("foo"), ClusterSlots::keySlot("bar{foo}"));
+  EXPECT_EQ(ClusterSlots::keySlot("foo"), ClusterSlots::keySlot("{foo}{bar}"));
+  EXPECT_EQ(ClusterSlots::keySlot("{bar"), ClusterSlots::keySlot("foo{{bar}}zap"));
+
+  // Empty and unterminated hash tags hash the whole key.
+  EXPECT_NE(ClusterSlots::keySlot("bar"), ClusterSlots::keySlot("{}bar"));
+  EXPECT_NE(ClusterSlots::keySlot("foo"), ClusterSlots::keySlot("{foobar"));
+}
+
+TEST(RedisClusterSlotsTest, ParseClusterSlots) {
+  RespValue value = makeArray(
+      {makeArray({makeInteger(0), makeInteger(8191),
+                  makeArray({makeBulkString("10.0.0.1"), makeInteger(6379)}),
+                  makeArray({makeBulkString("10.0.0.3"), makeInteger(6379)})}),
+       makeArray({makeInteger(8192), makeInteger(16383),
+                  makeArray({makeBulkString("::1"), makeInteger(6380), makeBulkString("id")})})});
+
+  std::vector<ClusterSlot> slots;
+  EXPECT_TRUE(ClusterSlots::parseClusterSlots(value, slots));
+  ASSERT_EQ(2, slots.size());
+  EXPECT_EQ(0, slots[0].start_);
+  EXPECT_EQ(8191, slots[0].end_);
+  EXPECT_EQ("10.0.0.1:6379", slots[0].master_->asString());
+  EXPECT_EQ(8192, slots[1].start_);
+  EXPECT_EQ(16383, slots[1].end_);
+  EXPECT_EQ("[::1]:6380", slots[1].master_->asString());
+}
+
+TEST(RedisClusterSlotsTest, ParseInvalidClusterSlots) {
+  std::vector<ClusterSlot> slots;
+  EXPECT_FALSE(ClusterSlots::parseClusterSlots(makeError("ERR"), slots));
+
+  // Slot range out of bounds.
+  EXPECT_FALSE(ClusterSlots::parseClusterSlots(
+      makeArray({makeArray({makeInteger(0), makeInteger(16384),
+                            makeArray({makeBulkString("10.0.0.1"), makeInteger(6379)})})}),
+      slots));
+
+  // Inverted slot range.
+  EXPECT_FALSE(ClusterSlots::parseClusterSlots(
+      makeArray({makeArray({makeInteger(10), makeInteger(5),
+                            makeArray({makeBulkString("10.0.0.1"), makeInteger(6379)})})}),
+      slots));
+
+  // Missing master.
+  EXPECT_FALSE(ClusterSlots::parseClusterSlots(
+      makeArray({makeArray({makeInteger(0), makeInteger(16383)})}), slots));
+
+  // Invalid master address.
+  EXPECT_FALSE(ClusterSlots::parseClusterSlots(
+      makeArray({makeArray({makeInteger(0), makeInteger(16383),
+                            makeArray({makeBulkString("redis.local"), makeInteger(6379)})})}),
+      slots));
+
+  // Invalid master port.
+  EXPECT_FALSE(ClusterSlots::parseClusterSlots(
+      makeArray({makeArray({makeInteger(0), makeInteger(16383),
+                            makeArray({makeBulkString("10.0.0.1"), makeInteger(65536)})})}),
+      slots));
+}
+
+TEST(RedisClusterSlotsTest, ParseRedirection) {
+  ClusterRedirection redirection;
+  EXPECT_TRUE(ClusterSlots::parseRedirection(makeError("MOVED 3999 127.0.0.1:6381"), redirection));
+  EXPECT_FALSE(redirection.ask_);
+  EXPECT_EQ(3999, redirection.slot_);
+  EXPECT_EQ("127.0.0.1:6381", redirection.address_->asString());
+
+  EXPECT_TRUE(ClusterSlots::parseRedirection(makeError("ASK 3999 ::1:6381"), redirection));
+  EXPECT_TRUE(redirection.ask_);
+  EXPECT_EQ(3999, redirection.slot_);
+  EXPECT_EQ("[::1]:6381", redirection.address_->asString());
+}
+
+TEST(RedisClusterSlotsTest, ParseInvalidRedirection) {
+  ClusterRedirection redirection;
+  EXPECT_FALSE(
+      ClusterSlots::parseRedirection(makeBulkString("MOVED 3999 127.0.0.1:6381"), redirection));
+  EXPECT_FALSE(ClusterSlots::parseRedirection(makeError("ERR unknown command"), redirection));
+  EXPECT_FALSE(ClusterSlots::parseRedirection(makeError("MOVED 3999"), redirection));
+  EXPECT_FALSE(
+      ClusterSlots::parseRedirection(makeError("MOVED 16384 127.0.0.1:6381"), redirection));
+  EXPECT_FALSE(ClusterSlots::parseRedirection(makeError("MOVED 3999 127.0.0.1"), redirection));
+  EXPECT_FALSE(
+      ClusterSlots::parseRedirection(makeError("MOVED 3999 127.0.0.1:70000"), redirection));
+  EXPECT_FALSE(
+      ClusterSlots::parseRedirection(makeError("MOVED 3999 redis.local:6381"), redirection));
+}
+
+} // namespace ConnPool
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -188,6 +188,108 @@ TEST_F(RedisEncoderDecoderImplTest, InvalidBulkStringExpectLF) {
   EXPECT_THROW(decoder_.decode(buffer_), ProtocolError);
 }
 
+class RedisPassthroughDecoderImplTest : public RedisEncoderDecoderImplTest {
+public:
+  RedisPassthroughDecoderImplTest() : passthrough_decoder_(*this, 16) {}
+
+  DecoderImpl passthrough_decoder_;
+};
+
+TEST_F(RedisPassthroughDecoderImplTest, RawRetainedForLargeValues) {
+  // Non canonical encodings are forwarded as is.
+  const std::string small = "*1\r\n$3\r\nget\r\n";
+  const std::string large = "*2\r\n$3\r\nset\r\n$16\r\n0123456789abcdef\r\n";
+  const std::string null_array = "*-00000000000001\r\n";
+  buffer_.add(small + large + null_array);
+  passthrough_decoder_.decode(buffer_);
+  EXPECT_EQ(0UL, buffer_.length());
+  ASSERT_EQ(3UL, decoded_values_.size());
+  EXPECT_EQ(nullptr, decoded_values_[0]->raw());
+  ASSERT_NE(nullptr, decoded_values_[1]->raw());
+  EXPECT_EQ(large, decoded_values_[1]->raw()->toString());
+  EXPECT_EQ("[\"set\", \"0123456789abcdef\"]", decoded_values_[1]->toString());
+  ASSERT_NE(nullptr, decoded_values_[2]->raw());
+  EXPECT_EQ(RespType::Null, decoded_values_[2]->type());
+
+  Buffer::OwnedImpl out;
+  encoder_.encode(*decoded_values_[0], out);
+  encoder_.encode(*decoded_values_[1], out);
+  encoder_.encode(*decoded_values_[2], out);
+  EXPECT_EQ(small + large + null_array, out.toString());
+
+  // The encoded bytes stay valid after the value is gone.
+  decoded_values_.clear();
+  EXPECT_EQ(small + large + null_array, out.toString());
+}
+
+TEST_F(RedisPassthroughDecoderImplTest, RawDroppedOnChange) {
+  buffer_.add("*2\r\n$3\r\nset\r\n$16\r\n0123456789abcdef\r\n");
+  passthrough_decoder_.decode(buffer_);
+  ASSERT_EQ(1UL, decoded_values_.size());
+  ASSERT_NE(nullptr, decoded_values_[0]->raw());
+
+  decoded_values_[0]->asArray()[1].asString() = "value";
+  EXPECT_EQ(nullptr, decoded_values_[0]->raw());
+  encoder_.encode(*decoded_values_[0], buffer_);
+  EXPECT_EQ("*2\r\n$3\r\nset\r\n$5\r\nvalue\r\n", buffer_.toString());
+}
+
+TEST_F(RedisPassthroughDecoderImplTest, PartialDecode) {
+  const std::string encoded = "$20\r\n0123456789abcdefghij\r\n:1\r\n$20\r\n0123456789";
+  for (char c : encoded) {
+    Buffer::OwnedImpl temp_buffer(&c, 1);
+    passthrough_decoder_.decode(temp_buffer);
+    EXPECT_EQ(0UL, temp_buffer.length());
+  }
+
+  ASSERT_EQ(2UL, decoded_values_.size());
+  ASSERT_NE(nullptr, decoded_values_[0]->raw());
+  EXPECT_EQ("$20\r\n0123456789abcdefghij\r\n", decoded_values_[0]->raw()->toString());
+  EXPECT_EQ(nullptr, decoded_values_[1]->raw());
+  EXPECT_EQ(1, decoded_values_[1]->asInteger());
+
+  buffer_.add("abcdefghij\r\n");
+  passthrough_decoder_.decode(buffer_);
+  ASSERT_EQ(3UL, decoded_values_.size());
+  ASSERT_NE(nullptr, decoded_values_[2]->raw());
+  EXPECT_EQ("$20\r\n0123456789abcdefghij\r\n", decoded_values_[2]->raw()->toString());
+}
+
+TEST_F(RedisPassthroughDecoderImplTest, ValuesBeforeProtocolError) {
+  buffer_.add("$20\r\n0123456789abcdefghij\r\n^");
+  EXPECT_THROW(passthrough_decoder_.decode(buffer_), ProtocolError);
+  ASSERT_EQ(1UL, decoded_values_.size());
+  ASSERT_NE(nullptr, decoded_values_[0]->raw());
+  EXPECT_EQ("$20\r\n0123456789abcdefghij\r\n", decoded_values_[0]->raw()->toString());
+}
+
+TEST_F(RedisPassthroughDecoderImplTest, SkipLargeBulkStrings) {
+  DecoderImpl decoder(*this, 16, true);
+  const std::string large = "$16\r\n0123456789abcdef\r\n";
+  const std::string array = "*1\r\n$16\r\n0123456789abcdef\r\n";
+  for (char c : large + array + large) {
+    Buffer::OwnedImpl temp_buffer(&c, 1);
+    decoder.decode(temp_buffer);
+  }
+
+  ASSERT_EQ(3UL, decoded_values_.size());
+  // Only the bulk string at the top level is held as bytes.
+  ASSERT_NE(nullptr, decoded_values_[0]->raw());
+  EXPECT_EQ(large, decoded_values_[0]->raw()->toString());
+  ASSERT_NE(nullptr, decoded_values_[1]->raw());
+  EXPECT_EQ("0123456789abcdef", decoded_values_[1]->asArray()[0].asString());
+
+  // The contents are copied out when read, and kept when the value is copied.
+  const RespValue copy = *decoded_values_[0];
+  EXPECT_EQ("0123456789abcdef", copy.asString());
+  Buffer::OwnedImpl out;
+  encoder_.encode(*decoded_values_[0], out);
+  EXPECT_EQ(large, out.toString());
+  EXPECT_EQ("0123456789abcdef", decoded_values_[0]->asString());
+  EXPECT_EQ(nullptr, decoded_values_[0]->raw());
+  EXPECT_EQ("0123456789abcdef", decoded_values_[2]->asString());
+}
+
 } // namespace RedisProxy
 } // namespace NetworkFilters
 } // namespace Extensions
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/hash.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/network/redis_proxy/command_splitter_impl.h"
+
+#include "test/mocks/upstream/mocks.h"
+
+#include "testing/base/public/benchmark.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace CommandSplitter {
+
+// Connection pool that spreads keys over a fixed set of hosts and queues requests, so that their
+// responses can be sent after the whole command has been split.
+//
+// The hosts are simulated as serving their requests one after the other, each one taking a fixed
+// time, and in parallel with each other. The time the upstream would take to respond to the queued
+// requests is that of the host with the most requests.
+class FakeConnPool : public ConnPool::Instance {
+public:
+  FakeConnPool(uint32_t num_hosts) {
+    for (uint32_t i = 0; i < num_hosts; i++) {
+      hosts_.emplace_back(new NiceMock<Upstream::MockHost>());
+    }
+    requests_per_host_.resize(num_hosts);
+  }
+
+  // RedisProxy::ConnPool::Instance
+  ConnPool::PoolRequest* makeRequest(const std::string& hash_key, const RespValue& request,
+                                     ConnPool::PoolCallbacks& callbacks) override {
+    return makeRequestToHost(chooseHost(hash_key), request, callbacks);
+  }
+  Upstream::HostConstSharedPtr chooseHost(const std::string& hash_key) override {
+    return hosts_[HashUtil::xxHash64(hash_key) % hosts_.size()];
+  }
+  uint16_t keySlot(const std::string&) override { return 0; }
+  ConnPool::PoolRequest* makeRequestToHost(const Upstream::HostConstSharedPtr& host,
+                                           const RespValue& request,
+                                           ConnPool::PoolCallbacks& callbacks) override {
+    requests_per_host_[std::find(hosts_.begin(), hosts_.end(), host) - hosts_.begin()]++;
+    pending_.push_back({request.asArray()[0].asString() == "mget", request.asArray().size() - 1,
+                        &callbacks});
+    return &pool_request_;
+  }
+
+  // Responds to each queued request with one bulk string per key.
+  // @return the simulated time that the hosts took to serve the requests.
+  std::chrono::duration<double> respond(std::chrono::duration<double> time_per_request) {
+    for (const PendingRequest& pending : pending_) {
+      RespValuePtr response(new RespValue());
+      if (pending.mget_) {
+        response->type(RespType::Array);
+        std::vector<RespValue> values(pending.num_keys_);
+        for (RespValue& value : values) {
+          value.type(RespType::BulkString);
+          value.asString() = "value";
+        }
+        response->asArray().swap(values);
+      } else {
+        response->type(RespType::BulkString);
+        response->asString() = "value";
+      }
+      pending.callbacks_->onResponse(std::move(response));
+    }
+    pending_.clear();
+
+    const uint64_t max_requests =
+        *std::max_element(requests_per_host_.begin(), requests_per_host_.end());
+    std::fill(requests_per_host_.begin(), requests_per_host_.end(), 0);
+    return max_requests * time_per_request;
+  }
+
+private:
+  struct FakePoolRequest : public ConnPool::PoolRequest {
+    void cancel() override {}
+  };
+
+  struct PendingRequest {
+    bool mget_;
+    uint64_t num_keys_;
+    ConnPool::PoolCallbacks* callbacks_;
+  };
+
+  std::vector<Upstream::HostConstSharedPtr> hosts_;
+  std::vector<uint64_t> requests_per_host_;
+  std::vector<PendingRequest> pending_;
+  FakePoolRequest pool_request_;
+};
+
+class CountingSplitCallbacks : public SplitCallbacks {
+public:
+  void onResponse(RespValuePtr&& value) override {
+    RELEASE_ASSERT(value->type() != RespType::Error, "");
+    responses_++;
+  }
+
+  uint64_t responses_{};
+};
+
+// Builds a command made of the given name followed by keys key1 to keyN.
+static RespValue makeCommand(const std::string& name, uint32_t first_key, uint32_t num_keys) {
+  RespValue request;
+  request.type(RespType::Array);
+  std::vector<RespValue> values(num_keys + 1);
+  for (uint32_t i = 0; i < values.size(); i++) {
+    values[i].type(RespType::BulkString);
+    values[i].asString() = i == 0 ? name : "key" + std::to_string(first_key + i - 1);
+  }
+  request.asArray().swap(values);
+  return request;
+}
+
+// Splits an MGET of state.range(0) keys over state.range(1) hosts, and reassembles the responses.
+// The upstream is answered immediately, so this only measures the time spent in the proxy; see
+// BM_MGETUpstreamLatency for the time the client waits.
+static void BM_MGETFanOut(benchmark::State& state) {
+  const uint32_t num_keys = state.range(0);
+  FakeConnPool* conn_pool = new FakeConnPool(state.range(1));
+  Stats::IsolatedStoreImpl store;
+  InstanceImpl splitter(ConnPool::InstancePtr{conn_pool}, store, "redis.foo.");
+  CountingSplitCallbacks callbacks;
+  const RespValue request = makeCommand("mget", 1, num_keys);
+
+  for (auto _ : state) {
+    SplitRequestPtr handle = splitter.makeRequest(request, callbacks);
+    conn_pool->respond(std::chrono::duration<double>::zero());
+  }
+  RELEASE_ASSERT(callbacks.responses_ == state.iterations(), "");
+}
+BENCHMARK(BM_MGETFanOut)
+    ->ArgPair(10, 1)
+    ->ArgPair(10, 4)
+    ->ArgPair(200, 1)
+    ->ArgPair(200, 4)
+    ->ArgPair(200, 16)
+    ->Unit(benchmark::kMicrosecond);
+
+// Fetches state.range(0) keys from state.range(1) hosts, where each upstream request takes 10us
+// to be served, and reports the time the client waits: the time spent in the proxy plus the
+// simulated upstream time. With state.range(2) set, the keys are fetched the way an MGET was split
+// before it was fanned out per host, with one GET per key, and otherwise with a single MGET.
+static void BM_MGETUpstreamLatency(benchmark::State& state) {
+  const uint32_t num_keys = state.range(0);
+  const bool per_key = state.range(2);
+  const std::chrono::duration<double> time_per_request = std::chrono::microseconds(10);
+  FakeConnPool* conn_pool = new FakeConnPool(state.range(1));
+  Stats::IsolatedStoreImpl store;
+  InstanceImpl splitter(ConnPool::InstancePtr{conn_pool}, store, "redis.foo.");
+  CountingSplitCallbacks callbacks;
+  std::vector<RespValue> requests;
+  if (per_key) {
+    for (uint32_t i = 1; i <= num_keys; i++) {
+      requests.push_back(makeCommand("get", i, 1));
+    }
+  } else {
+    requests.push_back(makeCommand("mget", 1, num_keys));
+  }
+
+  for (auto _ : state) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<SplitRequestPtr> handles;
+    for (const RespValue& request : requests) {
+      handles.push_back(splitter.makeRequest(request, callbacks));
+    }
+    const std::chrono::duration<double> upstream_time = conn_pool->respond(time_per_request);
+    const std::chrono::duration<double> proxy_time = std::chrono::steady_clock::now() - start;
+    state.SetIterationTime((proxy_time + upstream_time).count());
+  }
+  RELEASE_ASSERT(callbacks.responses_ == state.iterations() * requests.size(), "");
+}
+BENCHMARK(BM_MGETUpstreamLatency)
+    ->Args({10, 4, 1})
+    ->Args({10, 4, 0})
+    ->Args({200, 4, 1})
+    ->Args({200, 4, 0})
+    ->Args({200, 16, 1})
+    ->Args({200, 16, 0})
+    ->UseManualTime()
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace CommandSplitter
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -11,6 +11,7 @@
 
 #include "test/extensions/filters/network/redis_proxy/mocks.h"
 #include "test/mocks/common.h"
+#include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
 
 #include "gmock/gmock.h"
@@ -20,6 +21,7 @@ using testing::ByRef;
 using testing::DoAll;
 using testing::Eq;
 using testing::InSequence;
+using testing::NiceMock;
 using testing::Ref;
 using testing::Return;
 using testing::WithArg;
@@ -44,6 +46,24 @@ public:
     value.asArray().swap(values);
   }
 
+  Upstream::HostConstSharedPtr host(uint32_t index) {
+    while (hosts_.size() <= index) {
+      hosts_.emplace_back(new NiceMock<Upstream::MockHost>());
+    }
+    return hosts_[index];
+  }
+
+  // Expects the hosts of the keys of a fragmented request to be chosen. Key i is served by
+  // host(key_hosts[i]), or by host(i) if key_hosts is empty.
+  void expectChooseHosts(uint32_t num_keys, const std::vector<uint32_t>& key_hosts = {}) {
+    for (uint32_t i = 0; i < num_keys; i++) {
+      EXPECT_CALL(*conn_pool_, chooseHost(std::to_string(i)))
+          .WillOnce(Return(host(key_hosts.empty() ? i : key_hosts[i])));
+      EXPECT_CALL(*conn_pool_, keySlot(std::to_string(i))).WillOnce(Return(0));
+    }
+  }
+
+  std::vector<Upstream::HostConstSharedPtr> hosts_;
   ConnPool::MockInstance* conn_pool_{new ConnPool::MockInstance()};
   Stats::IsolatedStoreImpl store_;
   InstanceImpl splitter_{ConnPool::InstancePtr{conn_pool_}, store_, "redis.foo."};
@@ -301,14 +321,15 @@ public:
     pool_callbacks_.resize(num_gets);
     std::vector<ConnPool::MockPoolRequest> tmp_pool_requests(num_gets);
     pool_requests_.swap(tmp_pool_requests);
+    expectChooseHosts(num_gets);
     for (uint32_t i = 0; i < num_gets; i++) {
-      makeBulkStringArray(expected_requests_[i], {"get", std::to_string(i)});
+      makeBulkStringArray(expected_requests_[i], {"mget", std::to_string(i)});
       ConnPool::PoolRequest* request_to_use = nullptr;
       if (std::find(null_handle_indexes.begin(), null_handle_indexes.end(), i) ==
           null_handle_indexes.end()) {
         request_to_use = &pool_requests_[i];
       }
-      EXPECT_CALL(*conn_pool_, makeRequest(std::to_string(i), Eq(ByRef(expected_requests_[i])), _))
+      EXPECT_CALL(*conn_pool_, makeRequestToHost(host(i), Eq(ByRef(expected_requests_[i])), _))
           .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_[i])), Return(request_to_use)));
     }
 
@@ -467,6 +488,146 @@ TEST_F(RedisMGETCommandHandlerTest, Cancel) {
   handle_->cancel();
 };
 
+// Keys served by the same host are sent in one MGET, and the results are returned in the order of
+// the keys in the request.
+TEST_F(RedisMGETCommandHandlerTest, KeysGroupedByHost) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {"mget", "0", "1", "2", "3"});
+  expectChooseHosts(4, {0, 1, 0, 1});
+  RespValue expected_request1;
+  makeBulkStringArray(expected_request1, {"mget", "0", "2"});
+  RespValue expected_request2;
+  makeBulkStringArray(expected_request2, {"mget", "1", "3"});
+  ConnPool::PoolCallbacks* pool_callbacks1;
+  ConnPool::PoolCallbacks* pool_callbacks2;
+  ConnPool::MockPoolRequest pool_request1;
+  ConnPool::MockPoolRequest pool_request2;
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(0), Eq(ByRef(expected_request1)), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks1)), Return(&pool_request1)));
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(1), Eq(ByRef(expected_request2)), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks2)), Return(&pool_request2)));
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  RespValue expected_response;
+  makeBulkStringArray(expected_response, {"a0", "b1", "a2", ""});
+  expected_response.asArray()[3].type(RespType::Null);
+
+  RespValuePtr response2(new RespValue());
+  makeBulkStringArray(*response2, {"b1", ""});
+  response2->asArray()[1].type(RespType::Null);
+  pool_callbacks2->onResponse(std::move(response2));
+
+  RespValuePtr response1(new RespValue());
+  makeBulkStringArray(*response1, {"a0", "a2"});
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks1->onResponse(std::move(response1));
+};
+
+// Keys of different hash slots are sent in different commands, even to the same host.
+TEST_F(RedisMGETCommandHandlerTest, KeysGroupedBySlot) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {"mget", "0", "1", "2"});
+  const std::vector<uint16_t> key_slots{5, 7, 5};
+  for (uint32_t i = 0; i < key_slots.size(); i++) {
+    EXPECT_CALL(*conn_pool_, chooseHost(std::to_string(i))).WillOnce(Return(host(0)));
+    EXPECT_CALL(*conn_pool_, keySlot(std::to_string(i))).WillOnce(Return(key_slots[i]));
+  }
+  RespValue expected_request1;
+  makeBulkStringArray(expected_request1, {"mget", "0", "2"});
+  RespValue expected_request2;
+  makeBulkStringArray(expected_request2, {"mget", "1"});
+  ConnPool::PoolCallbacks* pool_callbacks1;
+  ConnPool::PoolCallbacks* pool_callbacks2;
+  ConnPool::MockPoolRequest pool_request1;
+  ConnPool::MockPoolRequest pool_request2;
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(0), Eq(ByRef(expected_request1)), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks1)), Return(&pool_request1)));
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(0), Eq(ByRef(expected_request2)), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks2)), Return(&pool_request2)));
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  RespValue expected_response;
+  makeBulkStringArray(expected_response, {"a0", "b1", "a2"});
+
+  RespValuePtr response1(new RespValue());
+  makeBulkStringArray(*response1, {"a0", "a2"});
+  pool_callbacks1->onResponse(std::move(response1));
+
+  RespValuePtr response2(new RespValue());
+  makeBulkStringArray(*response2, {"b1"});
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks2->onResponse(std::move(response2));
+};
+
+// A failed fragment or a fragment response with the wrong number of results fails all its keys.
+TEST_F(RedisMGETCommandHandlerTest, GroupedKeysFailure) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {"mget", "0", "1", "2", "3"});
+  expectChooseHosts(4, {0, 1, 0, 1});
+  ConnPool::PoolCallbacks* pool_callbacks1;
+  ConnPool::PoolCallbacks* pool_callbacks2;
+  ConnPool::MockPoolRequest pool_request1;
+  ConnPool::MockPoolRequest pool_request2;
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(0), _, _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks1)), Return(&pool_request1)));
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(1), _, _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks2)), Return(&pool_request2)));
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  RespValue expected_response;
+  makeBulkStringArray(expected_response, {"", "", "", ""});
+  for (RespValue& value : expected_response.asArray()) {
+    value.type(RespType::Error);
+  }
+  expected_response.asArray()[0].asString() = "upstream protocol error";
+  expected_response.asArray()[1].asString() = "upstream failure";
+  expected_response.asArray()[2].asString() = "upstream protocol error";
+  expected_response.asArray()[3].asString() = "upstream failure";
+
+  pool_callbacks2->onFailure();
+
+  RespValuePtr response1(new RespValue());
+  makeBulkStringArray(*response1, {"a0"});
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks1->onResponse(std::move(response1));
+};
+
+TEST_F(RedisMGETCommandHandlerTest, NoHostForKey) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {"mget", "0", "1"});
+  EXPECT_CALL(*conn_pool_, chooseHost("0")).WillOnce(Return(nullptr));
+  EXPECT_CALL(*conn_pool_, keySlot("0")).WillOnce(Return(0));
+  EXPECT_CALL(*conn_pool_, chooseHost("1")).WillOnce(Return(host(1)));
+  EXPECT_CALL(*conn_pool_, keySlot("1")).WillOnce(Return(0));
+  ConnPool::PoolCallbacks* pool_callbacks;
+  ConnPool::MockPoolRequest pool_request;
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(1), _, _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks)), Return(&pool_request)));
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  RespValue expected_response;
+  makeBulkStringArray(expected_response, {"no upstream host", "response"});
+  expected_response.asArray()[0].type(RespType::Error);
+  expected_response.asArray()[0].asString() = "no upstream host";
+
+  RespValuePtr response(new RespValue());
+  makeBulkStringArray(*response, {"response"});
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks->onResponse(std::move(response));
+};
+
 class RedisMSETCommandHandlerTest : public RedisCommandSplitterImplTest {
 public:
   void setup(uint32_t num_sets, const std::list<uint64_t>& null_handle_indexes) {
@@ -486,14 +647,15 @@ public:
     pool_callbacks_.resize(num_sets);
     std::vector<ConnPool::MockPoolRequest> tmp_pool_requests(num_sets);
     pool_requests_.swap(tmp_pool_requests);
+    expectChooseHosts(num_sets);
     for (uint32_t i = 0; i < num_sets; i++) {
-      makeBulkStringArray(expected_requests_[i], {"set", std::to_string(i), std::to_string(i)});
+      makeBulkStringArray(expected_requests_[i], {"mset", std::to_string(i), std::to_string(i)});
       ConnPool::PoolRequest* request_to_use = nullptr;
       if (std::find(null_handle_indexes.begin(), null_handle_indexes.end(), i) ==
           null_handle_indexes.end()) {
         request_to_use = &pool_requests_[i];
       }
-      EXPECT_CALL(*conn_pool_, makeRequest(std::to_string(i), Eq(ByRef(expected_requests_[i])), _))
+      EXPECT_CALL(*conn_pool_, makeRequestToHost(host(i), Eq(ByRef(expected_requests_[i])), _))
           .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_[i])), Return(request_to_use)));
     }
 
@@ -581,6 +743,41 @@ TEST_F(RedisMSETCommandHandlerTest, WrongNumberOfArgs) {
   EXPECT_EQ(nullptr, splitter_.makeRequest(request, callbacks_));
 };
 
+TEST_F(RedisMSETCommandHandlerTest, KeysGroupedByHost) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {"mset", "0", "a", "1", "b", "2", "c"});
+  expectChooseHosts(3, {0, 1, 0});
+  RespValue expected_request1;
+  makeBulkStringArray(expected_request1, {"mset", "0", "a", "2", "c"});
+  RespValue expected_request2;
+  makeBulkStringArray(expected_request2, {"mset", "1", "b"});
+  ConnPool::PoolCallbacks* pool_callbacks1;
+  ConnPool::PoolCallbacks* pool_callbacks2;
+  ConnPool::MockPoolRequest pool_request1;
+  ConnPool::MockPoolRequest pool_request2;
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(0), Eq(ByRef(expected_request1)), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks1)), Return(&pool_request1)));
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(1), Eq(ByRef(expected_request2)), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks2)), Return(&pool_request2)));
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  // Errors are counted per key.
+  RespValue expected_response;
+  expected_response.type(RespType::Error);
+  expected_response.asString() = "finished with 2 error(s)";
+
+  RespValuePtr response2(new RespValue());
+  response2->type(RespType::SimpleString);
+  response2->asString() = "OK";
+  pool_callbacks2->onResponse(std::move(response2));
+
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks1->onFailure();
+};
+
 class RedisSplitKeysSumResultHandlerTest : public RedisCommandSplitterImplTest,
                                            public testing::WithParamInterface<std::string> {
 public:
@@ -598,6 +795,7 @@ public:
     pool_callbacks_.resize(num_commands);
     std::vector<ConnPool::MockPoolRequest> tmp_pool_requests(num_commands);
     pool_requests_.swap(tmp_pool_requests);
+    expectChooseHosts(num_commands);
     for (uint32_t i = 0; i < num_commands; i++) {
       makeBulkStringArray(expected_requests_[i], {GetParam(), std::to_string(i)});
       ConnPool::PoolRequest* request_to_use = nullptr;
@@ -605,7 +803,7 @@ public:
           null_handle_indexes.end()) {
         request_to_use = &pool_requests_[i];
       }
-      EXPECT_CALL(*conn_pool_, makeRequest(std::to_string(i), Eq(ByRef(expected_requests_[i])), _))
+      EXPECT_CALL(*conn_pool_, makeRequestToHost(host(i), Eq(ByRef(expected_requests_[i])), _))
           .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks_[i])), Return(request_to_use)));
     }
 
@@ -677,6 +875,43 @@ TEST_P(RedisSplitKeysSumResultHandlerTest, NoUpstreamHostForAll) {
   EXPECT_EQ(nullptr, handle_);
 };
 
+TEST_P(RedisSplitKeysSumResultHandlerTest, KeysGroupedByHost) {
+  InSequence s;
+
+  RespValue request;
+  makeBulkStringArray(request, {GetParam(), "0", "1", "2"});
+  expectChooseHosts(3, {0, 1, 0});
+  RespValue expected_request1;
+  makeBulkStringArray(expected_request1, {GetParam(), "0", "2"});
+  RespValue expected_request2;
+  makeBulkStringArray(expected_request2, {GetParam(), "1"});
+  ConnPool::PoolCallbacks* pool_callbacks1;
+  ConnPool::PoolCallbacks* pool_callbacks2;
+  ConnPool::MockPoolRequest pool_request1;
+  ConnPool::MockPoolRequest pool_request2;
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(0), Eq(ByRef(expected_request1)), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks1)), Return(&pool_request1)));
+  EXPECT_CALL(*conn_pool_, makeRequestToHost(host(1), Eq(ByRef(expected_request2)), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks2)), Return(&pool_request2)));
+  handle_ = splitter_.makeRequest(request, callbacks_);
+  EXPECT_NE(nullptr, handle_);
+
+  RespValue expected_response;
+  expected_response.type(RespType::Integer);
+  expected_response.asInteger() = 3;
+
+  RespValuePtr response2(new RespValue());
+  response2->type(RespType::Integer);
+  response2->asInteger() = 1;
+  pool_callbacks2->onResponse(std::move(response2));
+
+  RespValuePtr response1(new RespValue());
+  response1->type(RespType::Integer);
+  response1->asInteger() = 2;
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks1->onResponse(std::move(response1));
+};
+
 INSTANTIATE_TEST_CASE_P(RedisSplitKeysSumResultHandlerTest, RedisSplitKeysSumResultHandlerTest,
                         testing::ValuesIn(SupportedCommands::hashMultipleSumResultCommands()));
 
@@ -1,27 +1,37 @@
 #include <memory>
 #include <string>
 
+#include "common/common/fmt.h"
 #include "common/network/utility.h"
 #include "common/upstream/upstream_impl.h"
 
 #include "extensions/filters/network/redis_proxy/conn_pool_impl.h"
 
 #include "test/extensions/filters/network/redis_proxy/mocks.h"
+#include "test/mocks/common.h"
 #include "test/mocks/network/mocks.h"
 #include "test/mocks/thread_local/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+using testing::ByRef;
+using testing::DoAll;
 using testing::Eq;
 using testing::InSequence;
 using testing::Invoke;
+using testing::IsNull;
+using testing::NiceMock;
+using testing::Pointee;
+using testing::Property;
 using testing::Ref;
 using testing::Return;
 using testing::ReturnRef;
 using testing::SaveArg;
+using testing::WithArg;
 using testing::_;
 
 namespace Envoy {
@@ -96,6 +106,7 @@ public:
   std::shared_ptr<Upstream::MockHost> host_{new NiceMock<Upstream::MockHost>()};
   Event::MockDispatcher dispatcher_;
   Event::MockTimer* connect_or_op_timer_{new Event::MockTimer(&dispatcher_)};
+  Event::MockTimer* flush_timer_{};
   MockEncoder* encoder_{new MockEncoder()};
   MockDecoder* decoder_{new MockDecoder()};
   DecoderCallbacks* callbacks_{};
@@ -146,6 +157,9 @@ TEST_F(RedisClientImplTest, Basic) {
   }));
   upstream_read_filter_->onData(fake_data, false);
 
+  // Without buffering, writes aren't counted as flushes.
+  EXPECT_EQ(0UL, host_->cluster_.stats_store_.counter("redis.upstream_flush_total").value());
+
   EXPECT_CALL(*upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
   EXPECT_CALL(*connect_or_op_timer_, disableTimer());
   client_->close();
@@ -300,6 +314,10 @@ TEST_F(RedisClientImplTest, ConnectFail) {
 class ConfigOutlierDisabled : public Config {
   bool disableOutlierEvents() const override { return true; }
   std::chrono::milliseconds opTimeout() const override { return std::chrono::milliseconds(25); }
+  uint32_t maxBufferSizeBeforeFlush() const override { return 0; }
+  std::chrono::milliseconds bufferFlushTimeoutInMs() const override {
+    return std::chrono::milliseconds(0);
+  }
 };
 
 TEST_F(RedisClientImplTest, OutlierDisabled) {
@@ -322,6 +340,80 @@ TEST_F(RedisClientImplTest, OutlierDisabled) {
   EXPECT_EQ(1UL, host_->stats_.cx_connect_fail_.value());
 }
 
+TEST_F(RedisClientImplTest, BufferedRequests) {
+  InSequence s;
+
+  envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings settings =
+      createConnPoolSettings();
+  settings.set_max_buffer_size_before_flush(4);
+  settings.mutable_buffer_flush_timeout()->CopyFrom(
+      Protobuf::util::TimeUtil::MillisecondsToDuration(3));
+  flush_timer_ = new Event::MockTimer(&dispatcher_);
+  setup(std::make_unique<ConfigImpl>(settings));
+
+  // The first request arms the flush timer, and the second one shares its write.
+  RespValue request1;
+  MockPoolCallbacks callbacks1;
+  EXPECT_CALL(*encoder_, encode(Ref(request1), _))
+      .WillOnce(Invoke([](const RespValue&, Buffer::Instance& out) -> void { out.add("a"); }));
+  EXPECT_CALL(*flush_timer_, enableTimer(std::chrono::milliseconds(3)));
+  EXPECT_NE(nullptr, client_->makeRequest(request1, callbacks1));
+
+  RespValue request2;
+  MockPoolCallbacks callbacks2;
+  EXPECT_CALL(*encoder_, encode(Ref(request2), _))
+      .WillOnce(Invoke([](const RespValue&, Buffer::Instance& out) -> void { out.add("b"); }));
+  EXPECT_NE(nullptr, client_->makeRequest(request2, callbacks2));
+
+  EXPECT_CALL(*flush_timer_, disableTimer());
+  EXPECT_CALL(host_->cluster_.stats_store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "redis.upstream_flush_batch_size"), 2));
+  EXPECT_CALL(*upstream_connection_, write(_, false))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ("ab", data.toString());
+        data.drain(data.length());
+      }));
+  flush_timer_->callback_();
+
+  // A request that fills the buffer is written right away.
+  RespValue request3;
+  MockPoolCallbacks callbacks3;
+  EXPECT_CALL(*encoder_, encode(Ref(request3), _))
+      .WillOnce(Invoke([](const RespValue&, Buffer::Instance& out) -> void { out.add("cdef"); }));
+  EXPECT_CALL(*flush_timer_, disableTimer());
+  EXPECT_CALL(host_->cluster_.stats_store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "redis.upstream_flush_batch_size"), 1));
+  EXPECT_CALL(*upstream_connection_, write(_, false))
+      .WillOnce(Invoke([](Buffer::Instance& data, bool) -> void {
+        EXPECT_EQ("cdef", data.toString());
+        data.drain(data.length());
+      }));
+  EXPECT_NE(nullptr, client_->makeRequest(request3, callbacks3));
+
+  EXPECT_EQ(2UL, host_->cluster_.stats_store_.counter("redis.upstream_flush_total").value());
+
+  // Requests that are still buffered fail with the connection.
+  RespValue request4;
+  MockPoolCallbacks callbacks4;
+  EXPECT_CALL(*encoder_, encode(Ref(request4), _))
+      .WillOnce(Invoke([](const RespValue&, Buffer::Instance& out) -> void { out.add("g"); }));
+  EXPECT_CALL(*flush_timer_, enableTimer(std::chrono::milliseconds(3)));
+  EXPECT_NE(nullptr, client_->makeRequest(request4, callbacks4));
+
+  EXPECT_CALL(*upstream_connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(callbacks1, onFailure());
+  EXPECT_CALL(callbacks2, onFailure());
+  EXPECT_CALL(callbacks3, onFailure());
+  EXPECT_CALL(callbacks4, onFailure());
+  EXPECT_CALL(*flush_timer_, disableTimer());
+  EXPECT_CALL(*connect_or_op_timer_, disableTimer());
+  client_->close();
+
+  EXPECT_EQ(2UL, host_->cluster_.stats_store_.counter("redis.upstream_flush_total").value());
+}
+
 TEST_F(RedisClientImplTest, ConnectTimeout) {
   InSequence s;
 
@@ -421,6 +513,36 @@ TEST_F(RedisConnPoolImplTest, Basic) {
   tls_.shutdownThread();
 };
 
+// A request made to a chosen host uses the same client as requests hashed to that host.
+TEST_F(RedisConnPoolImplTest, MakeRequestToHost) {
+  InSequence s;
+
+  RespValue value;
+  MockPoolRequest active_request1;
+  MockPoolRequest active_request2;
+  MockPoolCallbacks callbacks;
+  MockClient* client = new NiceMock<MockClient>();
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_))
+      .WillOnce(Invoke([&](Upstream::LoadBalancerContext* context) -> Upstream::HostConstSharedPtr {
+        EXPECT_EQ(context->computeHashKey().value(), std::hash<std::string>()("foo"));
+        return cm_.thread_local_cluster_.lb_.host_;
+      }));
+  Upstream::HostConstSharedPtr host = conn_pool_->chooseHost("foo");
+  EXPECT_EQ(cm_.thread_local_cluster_.lb_.host_, host);
+
+  EXPECT_CALL(*this, create_(Eq(host))).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(Ref(value), Ref(callbacks))).WillOnce(Return(&active_request1));
+  EXPECT_EQ(&active_request1, conn_pool_->makeRequestToHost(host, value, callbacks));
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_)).WillOnce(Return(host));
+  EXPECT_CALL(*client, makeRequest(Ref(value), Ref(callbacks))).WillOnce(Return(&active_request2));
+  EXPECT_EQ(&active_request2, conn_pool_->makeRequest("bar", value, callbacks));
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+};
+
 TEST_F(RedisConnPoolImplTest, HostRemove) {
   InSequence s;
   MockPoolCallbacks callbacks;
@@ -494,6 +616,272 @@ TEST_F(RedisConnPoolImplTest, RemoteClose) {
   tls_.shutdownThread();
 }
 
+// Matches a request that is sent as the bytes which the given value encodes to.
+MATCHER_P(EncodedAs, value, "") {
+  EncoderImpl encoder;
+  Buffer::OwnedImpl expected;
+  Buffer::OwnedImpl actual;
+  encoder.encode(value, expected);
+  encoder.encode(arg, actual);
+  return TestUtility::buffersEqual(expected, actual);
+}
+
+class RedisClusterConnPoolImplTest : public RedisConnPoolImplTest {
+public:
+  RedisClusterConnPoolImplTest() {
+    std::vector<RespValue> cluster_slots(2);
+    cluster_slots[0].type(RespType::BulkString);
+    cluster_slots[0].asString() = "cluster";
+    cluster_slots[1].type(RespType::BulkString);
+    cluster_slots[1].asString() = "slots";
+    cluster_slots_request_.type(RespType::Array);
+    cluster_slots_request_.asArray().swap(cluster_slots);
+  }
+
+  // Creates a pool in Redis Cluster mode, which asks seed_client_ for the slot map.
+  void setup() {
+    EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(IsNull())).WillOnce(Return(seed_host_));
+    EXPECT_CALL(*this, create_(Eq(seed_host_))).WillOnce(Return(seed_client_));
+    expectClusterSlotsRequest();
+
+    envoy::config::filter::network::redis_proxy::v2::RedisProxy::ConnPoolSettings settings =
+        createConnPoolSettings();
+    settings.set_enable_redis_cluster(true);
+    conn_pool_.reset(new InstanceImpl(cluster_name_, cm_, *this, tls_, settings));
+  }
+
+  void expectClusterSlotsRequest() {
+    EXPECT_CALL(*seed_client_, makeRequest(Eq(ByRef(cluster_slots_request_)), _))
+        .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&cluster_slots_callbacks_)),
+                        Return(&cluster_slots_request_handle_)));
+  }
+
+  // Replies to CLUSTER SLOTS with slots 0-8191 on 10.0.0.<first_node>:6379 and 8192-16383 on
+  // 10.0.0.<first_node + 1>:6379.
+  void respondClusterSlots(uint32_t first_node = 1) {
+    RespValuePtr response(new RespValue());
+    response->type(RespType::Array);
+    std::vector<RespValue> ranges(2);
+    for (uint32_t i = 0; i < ranges.size(); i++) {
+      std::vector<RespValue> range(3);
+      range[0].type(RespType::Integer);
+      range[0].asInteger() = i * 8192;
+      range[1].type(RespType::Integer);
+      range[1].asInteger() = i * 8192 + 8191;
+      std::vector<RespValue> master(2);
+      master[0].type(RespType::BulkString);
+      master[0].asString() = fmt::format("10.0.0.{}", i + first_node);
+      master[1].type(RespType::Integer);
+      master[1].asInteger() = 6379;
+      range[2].type(RespType::Array);
+      range[2].asArray().swap(master);
+      ranges[i].type(RespType::Array);
+      ranges[i].asArray().swap(range);
+    }
+    response->asArray().swap(ranges);
+    cluster_slots_callbacks_->onResponse(std::move(response));
+  }
+
+  RespValuePtr makeError(const std::string& error) {
+    RespValuePtr value(new RespValue());
+    value->type(RespType::Error);
+    value->asString() = error;
+    return value;
+  }
+
+  RespValue cluster_slots_request_;
+  Upstream::HostSharedPtr seed_host_{new NiceMock<Upstream::MockHost>()};
+  MockClient* seed_client_{new NiceMock<MockClient>()};
+  PoolCallbacks* cluster_slots_callbacks_{};
+  MockPoolRequest cluster_slots_request_handle_;
+};
+
+TEST_F(RedisClusterConnPoolImplTest, SlotRouting) {
+  InSequence s;
+  setup();
+  respondClusterSlots();
+
+  // "foo" hashes to slot 12182, "{foo}bar" to the same slot through its hash tag, and "bar" to
+  // slot 5061.
+  EXPECT_EQ(12182, conn_pool_->keySlot("foo"));
+  EXPECT_EQ(12182, conn_pool_->keySlot("{foo}bar"));
+  EXPECT_EQ(5061, conn_pool_->keySlot("bar"));
+  Upstream::HostConstSharedPtr host1 = conn_pool_->chooseHost("foo");
+  EXPECT_EQ("10.0.0.2:6379", host1->address()->asString());
+  EXPECT_EQ(host1, conn_pool_->chooseHost("{foo}bar"));
+  Upstream::HostConstSharedPtr host2 = conn_pool_->chooseHost("bar");
+  EXPECT_EQ("10.0.0.1:6379", host2->address()->asString());
+
+  RespValue value;
+  MockPoolCallbacks callbacks;
+  MockClient* client = new NiceMock<MockClient>();
+  MockPoolRequest active_request;
+  EXPECT_CALL(*this, create_(Eq(host1))).WillOnce(Return(client));
+  PoolCallbacks* request_callbacks;
+  EXPECT_CALL(*client, makeRequest(EncodedAs(value), _))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks)), Return(&active_request)));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+
+  RespValuePtr response(new RespValue());
+  EXPECT_CALL(callbacks, onResponse_(Pointee(Eq(ByRef(value)))));
+  request_callbacks->onResponse(std::move(response));
+
+  tls_.shutdownThread();
+}
+
+// MOVED updates the slot, refreshes the slot map and sends the request again.
+TEST_F(RedisClusterConnPoolImplTest, MovedRedirection) {
+  InSequence s;
+  setup();
+  cluster_slots_callbacks_->onFailure();
+
+  // Without a slot map, the load balancer chooses the host.
+  RespValue value;
+  MockPoolCallbacks callbacks;
+  MockPoolRequest active_request1;
+  PoolCallbacks* request_callbacks;
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(_)).WillOnce(Return(seed_host_));
+  EXPECT_CALL(*seed_client_, makeRequest(EncodedAs(value), _))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks)), Return(&active_request1)));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(IsNull())).WillOnce(Return(seed_host_));
+  expectClusterSlotsRequest();
+  MockClient* client = new NiceMock<MockClient>();
+  MockPoolRequest active_request2;
+  Upstream::HostConstSharedPtr redirected_host;
+  EXPECT_CALL(*this, create_(_)).WillOnce(DoAll(SaveArg<0>(&redirected_host), Return(client)));
+  EXPECT_CALL(*client, makeRequest(EncodedAs(value), _))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks)), Return(&active_request2)));
+  request_callbacks->onResponse(makeError("MOVED 12182 10.0.0.3:6380"));
+  EXPECT_EQ("10.0.0.3:6380", redirected_host->address()->asString());
+
+  RespValuePtr response(new RespValue());
+  EXPECT_CALL(callbacks, onResponse_(Pointee(Eq(ByRef(value)))));
+  request_callbacks->onResponse(std::move(response));
+
+  tls_.shutdownThread();
+}
+
+// ASK sends ASKING and the request to the given host, until too many redirections were followed.
+TEST_F(RedisClusterConnPoolImplTest, AskRedirection) {
+  InSequence s;
+  setup();
+  respondClusterSlots();
+
+  RespValue asking;
+  asking.type(RespType::Array);
+  std::vector<RespValue> asking_values(1);
+  asking_values[0].type(RespType::BulkString);
+  asking_values[0].asString() = "asking";
+  asking.asArray().swap(asking_values);
+
+  RespValue value;
+  MockPoolCallbacks callbacks;
+  MockClient* client1 = new NiceMock<MockClient>();
+  MockPoolRequest active_request;
+  PoolCallbacks* request_callbacks;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client1));
+  EXPECT_CALL(*client1, makeRequest(EncodedAs(value), _))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks)), Return(&active_request)));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+
+  MockClient* client2 = new NiceMock<MockClient>();
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client2));
+  for (uint32_t i = 0; i < InstanceImpl::MAX_REDIRECTIONS; i++) {
+    EXPECT_CALL(*client2, makeRequest(Eq(ByRef(asking)), _)).WillOnce(Return(nullptr));
+    EXPECT_CALL(*client2, makeRequest(EncodedAs(value), _))
+        .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks)), Return(&active_request)));
+    request_callbacks->onResponse(makeError("ASK 12182 10.0.0.3:6380"));
+  }
+
+  RespValuePtr ask_error = makeError("ASK 12182 10.0.0.3:6380");
+  EXPECT_CALL(callbacks, onResponse_(Pointee(Eq(ByRef(*ask_error)))));
+  request_callbacks->onResponse(makeError("ASK 12182 10.0.0.3:6380"));
+
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisClusterConnPoolImplTest, CancelAndFailure) {
+  InSequence s;
+  setup();
+  respondClusterSlots();
+
+  RespValue value;
+  MockPoolCallbacks callbacks;
+  MockClient* client = new NiceMock<MockClient>();
+  MockPoolRequest active_request;
+  PoolCallbacks* request_callbacks;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(EncodedAs(value), _))
+      .WillOnce(Return(&active_request))
+      .WillOnce(DoAll(WithArg<1>(SaveArgAddress(&request_callbacks)), Return(&active_request)));
+  PoolRequest* request = conn_pool_->makeRequest("foo", value, callbacks);
+  EXPECT_CALL(active_request, cancel());
+  request->cancel();
+
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+  EXPECT_CALL(callbacks, onFailure());
+  request_callbacks->onFailure();
+
+  tls_.shutdownThread();
+}
+
+// A change of the cluster's hosts refreshes the slot map.
+TEST_F(RedisClusterConnPoolImplTest, HostsChanged) {
+  InSequence s;
+  setup();
+  respondClusterSlots();
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(IsNull())).WillOnce(Return(seed_host_));
+  expectClusterSlotsRequest();
+  std::shared_ptr<Upstream::Host> host(new NiceMock<Upstream::MockHost>());
+  cm_.thread_local_cluster_.cluster_.prioritySet().getMockHostSet(0)->runCallbacks({host}, {});
+
+  // Only one refresh is in flight at a time.
+  cm_.thread_local_cluster_.cluster_.prioritySet().getMockHostSet(0)->runCallbacks({host}, {});
+
+  tls_.shutdownThread();
+}
+
+// Refreshes keep the connections to the hosts which still serve slots and close the others.
+TEST_F(RedisClusterConnPoolImplTest, HostsChangedKeepsSlotHosts) {
+  InSequence s;
+  setup();
+  respondClusterSlots();
+
+  RespValue value;
+  MockPoolCallbacks callbacks;
+  MockClient* client = new NiceMock<MockClient>();
+  MockPoolRequest active_request;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest(EncodedAs(value), _)).WillOnce(Return(&active_request));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+
+  std::shared_ptr<Upstream::Host> host(new NiceMock<Upstream::MockHost>());
+  for (uint32_t i = 0; i < 2; i++) {
+    EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(IsNull())).WillOnce(Return(seed_host_));
+    expectClusterSlotsRequest();
+    cm_.thread_local_cluster_.cluster_.prioritySet().getMockHostSet(0)->runCallbacks({host}, {});
+    respondClusterSlots();
+  }
+
+  // Health changes don't refresh the slot map.
+  cm_.thread_local_cluster_.cluster_.prioritySet().getMockHostSet(0)->runCallbacks({}, {});
+
+  EXPECT_CALL(*client, makeRequest(EncodedAs(value), _)).WillOnce(Return(&active_request));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", value, callbacks));
+
+  EXPECT_CALL(cm_.thread_local_cluster_.lb_, chooseHost(IsNull())).WillOnce(Return(seed_host_));
+  expectClusterSlotsRequest();
+  cm_.thread_local_cluster_.cluster_.prioritySet().getMockHostSet(0)->runCallbacks({host}, {});
+  EXPECT_CALL(*client, close());
+  respondClusterSlots(3);
+  EXPECT_EQ("10.0.0.4:6379", conn_pool_->chooseHost("foo")->address()->asString());
+
+  tls_.shutdownThread();
+}
+
 } // namespace ConnPool
 } // namespace RedisProxy
 } // namespace NetworkFilters
@@ -102,6 +102,11 @@ public:
 
   MOCK_METHOD3(makeRequest, PoolRequest*(const std::string& hash_key, const RespValue& request,
                                          PoolCallbacks& callbacks));
+  MOCK_METHOD1(chooseHost, Upstream::HostConstSharedPtr(const std::string& hash_key));
+  MOCK_METHOD1(keySlot, uint16_t(const std::string& hash_key));
+  MOCK_METHOD3(makeRequestToHost,
+               PoolRequest*(const Upstream::HostConstSharedPtr& host, const RespValue& request,
+                            PoolCallbacks& callbacks));
 };
 
 } // namespace ConnPool
@@ -580,6 +580,54 @@ TEST_F(ThriftConnectionManagerTest, RequestAndResponse) {
   EXPECT_EQ(0U, store_.counter("test.response_error").value());
 }
 
+TEST_F(ThriftConnectionManagerTest, RequestPassthroughAndResponse) {
+  const std::string yaml = R"EOF(
+transport: FRAMED
+protocol: BINARY
+stat_prefix: test
+payload_passthrough: true
+)EOF";
+
+  initializeFilter(yaml);
+  writeComplexFramedBinaryMessage(buffer_, MessageType::Call, 0x0F);
+
+  // The body follows the frame size and the message header: version and message type, method
+  // name and sequence id.
+  const std::string expected_body = buffer_.toString().substr(4 + 4 + 4 + 4 + 4);
+
+  ThriftFilters::DecoderFilterCallbacks* callbacks{};
+  EXPECT_CALL(*decoder_filter_, setDecoderFilterCallbacks(_))
+      .WillOnce(
+          Invoke([&](ThriftFilters::DecoderFilterCallbacks& cb) -> void { callbacks = &cb; }));
+  EXPECT_CALL(*decoder_filter_, passthroughEnabled()).WillOnce(Return(true));
+  EXPECT_CALL(*decoder_filter_, messageBegin(_));
+  EXPECT_CALL(*decoder_filter_, structBegin(_)).Times(0);
+  EXPECT_CALL(*decoder_filter_, passthroughData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> ThriftFilters::FilterStatus {
+        EXPECT_EQ(expected_body, data.toString());
+        return ThriftFilters::FilterStatus::Continue;
+      }));
+  EXPECT_CALL(*decoder_filter_, messageEnd());
+
+  EXPECT_EQ(filter_->onData(buffer_, false), Network::FilterStatus::StopIteration);
+  EXPECT_EQ(0, buffer_.length());
+  EXPECT_EQ(1U, store_.counter("test.request_call").value());
+  EXPECT_EQ(0U, store_.counter("test.request_decoding_error").value());
+
+  // Responses are still decoded.
+  writeComplexFramedBinaryMessage(write_buffer_, MessageType::Reply, 0x0F);
+
+  callbacks->startUpstreamResponse(TransportType::Framed, ProtocolType::Binary);
+
+  EXPECT_CALL(filter_callbacks_.connection_.dispatcher_, deferredDelete_(_)).Times(1);
+  EXPECT_EQ(true, callbacks->upstreamData(write_buffer_));
+
+  filter_callbacks_.connection_.dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, store_.counter("test.response_reply").value());
+  EXPECT_EQ(1U, store_.counter("test.response_success").value());
+}
+
 TEST_F(ThriftConnectionManagerTest, RequestAndExceptionResponse) {
   initializeFilter();
   writeFramedBinaryMessage(buffer_, MessageType::Call, 0x0F);
@@ -0,0 +1,134 @@
+#include <memory>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+
+#include "extensions/filters/network/thrift_proxy/binary_protocol_impl.h"
+#include "extensions/filters/network/thrift_proxy/decoder.h"
+#include "extensions/filters/network/thrift_proxy/framed_transport_impl.h"
+#include "extensions/filters/network/thrift_proxy/protocol_converter.h"
+
+#include "testing/base/public/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace ThriftProxy {
+
+// Encodes decoded requests again with the binary protocol, as the router does on their way
+// upstream, and discards them.
+class EncodingFilter : public DecoderCallbacks, public ProtocolConverter {
+public:
+  EncodingFilter(bool passthrough) : passthrough_(passthrough) {
+    initProtocolConverter(std::make_unique<BinaryProtocolImpl>(), output_);
+  }
+
+  // ProtocolConverter
+  ThriftFilters::FilterStatus transportBegin(MessageMetadataSharedPtr) override {
+    return ThriftFilters::FilterStatus::Continue;
+  }
+  ThriftFilters::FilterStatus transportEnd() override {
+    messages_++;
+    output_.drain(output_.length());
+    return ThriftFilters::FilterStatus::Continue;
+  }
+  bool passthroughEnabled() const override { return passthrough_; }
+
+  // DecoderCallbacks
+  ThriftFilters::DecoderFilter& newDecoderFilter() override { return *this; }
+
+  const bool passthrough_;
+  Buffer::OwnedImpl output_;
+  uint64_t messages_{};
+};
+
+// The encoded size of a record: three field headers, an i64, a 16 byte string, a double and a stop
+// field.
+static const uint32_t RecordSize = 3 * 3 + 8 + (4 + 16) + 8 + 1;
+
+// Writes a framed binary call whose argument is a list of about payload_size / RecordSize records.
+static void writeRequest(Buffer::Instance& buffer, uint32_t payload_size) {
+  BinaryProtocolImpl proto;
+  MessageMetadata metadata;
+  metadata.setMethodName("method");
+  metadata.setMessageType(MessageType::Call);
+  metadata.setSequenceId(1);
+
+  Buffer::OwnedImpl message;
+  proto.writeMessageBegin(message, metadata);
+  proto.writeStructBegin(message, "");
+  proto.writeFieldBegin(message, "", FieldType::List, 1);
+  const uint32_t num_records = payload_size / RecordSize;
+  proto.writeListBegin(message, FieldType::Struct, num_records);
+  for (uint32_t i = 0; i < num_records; i++) {
+    proto.writeStructBegin(message, "");
+    proto.writeFieldBegin(message, "", FieldType::I64, 1);
+    proto.writeInt64(message, i);
+    proto.writeFieldEnd(message);
+    proto.writeFieldBegin(message, "", FieldType::String, 2);
+    proto.writeString(message, "0123456789abcdef");
+    proto.writeFieldEnd(message);
+    proto.writeFieldBegin(message, "", FieldType::Double, 3);
+    proto.writeDouble(message, 0.5);
+    proto.writeFieldEnd(message);
+    proto.writeFieldBegin(message, "", FieldType::Stop, 0);
+    proto.writeStructEnd(message);
+  }
+  proto.writeListEnd(message);
+  proto.writeFieldEnd(message);
+  proto.writeFieldBegin(message, "", FieldType::Stop, 0);
+  proto.writeStructEnd(message);
+  proto.writeMessageEnd(message);
+
+  FramedTransportImpl transport;
+  transport.encodeFrame(buffer, metadata, message);
+}
+
+// Decodes framed binary requests of about state.range(0) bytes, either fully (state.range(1) == 0)
+// or only up to the end of their message header (state.range(1) == 1), and encodes them again.
+static void BM_DecodeFramedBinary(benchmark::State& state) {
+  Buffer::OwnedImpl request;
+  writeRequest(request, state.range(0));
+  const std::string request_data = request.toString();
+
+  EncodingFilter filter(state.range(1) != 0);
+  Decoder decoder(std::make_unique<FramedTransportImpl>(), std::make_unique<BinaryProtocolImpl>(),
+                  filter);
+
+  Buffer::OwnedImpl buffer;
+  for (auto _ : state) {
+    state.PauseTiming();
+    buffer.add(request_data);
+    state.ResumeTiming();
+
+    bool underflow = false;
+    decoder.onData(buffer, underflow);
+  }
+  RELEASE_ASSERT(filter.messages_ == static_cast<uint64_t>(state.iterations()), "");
+  state.SetBytesProcessed(state.iterations() * request_data.size());
+}
+BENCHMARK(BM_DecodeFramedBinary)
+    ->ArgPair(1024, 0)
+    ->ArgPair(1024, 1)
+    ->ArgPair(10 * 1024, 0)
+    ->ArgPair(10 * 1024, 1)
+    ->ArgPair(100 * 1024, 0)
+    ->ArgPair(100 * 1024, 1)
+    ->ArgPair(500 * 1024, 0)
+    ->ArgPair(500 * 1024, 1)
+    ->Unit(benchmark::kMicrosecond);
+
+} // namespace ThriftProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
+
+// Boilerplate main(), which discovers benchmarks in the same file and runs them.
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+}
@@ -720,6 +720,70 @@ TEST_P(DecoderStateMachineNestingTest, NestedTypes) {
   EXPECT_EQ(dsm.currentState(), ProtocolState::Done);
 }
 
+TEST_F(DecoderStateMachineTest, PassthroughData) {
+  metadata_->setFrameSize(15);
+  Buffer::OwnedImpl buffer("head");
+
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _))
+      .WillOnce(Invoke([&](Buffer::Instance& data, MessageMetadata&) -> bool {
+        data.drain(4);
+        return true;
+      }));
+  EXPECT_CALL(filter_, passthroughEnabled()).WillOnce(Return(true));
+  EXPECT_CALL(filter_, messageBegin(_));
+  EXPECT_CALL(proto_, readStructBegin(_, _)).Times(0);
+
+  DecoderStateMachine dsm(proto_, metadata_, filter_);
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::WaitForData);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::PassthroughData);
+
+  // The body is only passed on once all of it is available.
+  buffer.add("body");
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::WaitForData);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::PassthroughData);
+
+  buffer.add("contentnext");
+  EXPECT_CALL(filter_, passthroughData(_))
+      .WillOnce(Invoke([&](Buffer::Instance& data) -> ThriftFilters::FilterStatus {
+        EXPECT_EQ("bodycontent", data.toString());
+        return ThriftFilters::FilterStatus::Continue;
+      }));
+  EXPECT_CALL(proto_, readMessageEnd(Ref(buffer))).WillOnce(Return(true));
+  EXPECT_CALL(filter_, messageEnd());
+
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::Done);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::Done);
+  EXPECT_EQ("next", buffer.toString());
+}
+
+TEST_F(DecoderStateMachineTest, PassthroughDataRequiresFrameSize) {
+  Buffer::OwnedImpl buffer;
+
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _)).WillOnce(Return(true));
+  EXPECT_CALL(filter_, passthroughEnabled()).Times(0);
+  EXPECT_CALL(proto_, readStructBegin(Ref(buffer), _)).WillOnce(Return(false));
+
+  DecoderStateMachine dsm(proto_, metadata_, filter_);
+  EXPECT_EQ(dsm.run(buffer), ProtocolState::WaitForData);
+  EXPECT_EQ(dsm.currentState(), ProtocolState::StructBegin);
+}
+
+TEST_F(DecoderStateMachineTest, PassthroughDataHeaderExceedsFrameSize) {
+  metadata_->setFrameSize(2);
+  Buffer::OwnedImpl buffer("head");
+
+  EXPECT_CALL(proto_, readMessageBegin(Ref(buffer), _))
+      .WillOnce(Invoke([&](Buffer::Instance& data, MessageMetadata&) -> bool {
+        data.drain(4);
+        return true;
+      }));
+  EXPECT_CALL(filter_, passthroughEnabled()).WillOnce(Return(true));
+
+  DecoderStateMachine dsm(proto_, metadata_, filter_);
+  EXPECT_THROW_WITH_MESSAGE(dsm.run(buffer), EnvoyException,
+                            "thrift message header (4 bytes) exceeds frame size 2");
+}
+
 TEST(DecoderTest, OnData) {
   NiceMock<MockTransport>* transport = new NiceMock<MockTransport>();
   NiceMock<MockProtocol>* proto = new NiceMock<MockProtocol>();
@@ -750,6 +814,7 @@ TEST(DecoderTest, OnData) {
         metadata.setSequenceId(100);
         return true;
       }));
+  EXPECT_CALL(filter, passthroughEnabled()).WillOnce(Return(false));
   EXPECT_CALL(filter, messageBegin(_))
       .WillOnce(Invoke([&](MessageMetadataSharedPtr metadata) -> ThriftFilters::FilterStatus {
         EXPECT_TRUE(metadata->hasMethodName());
@@ -951,6 +1016,7 @@ TEST(DecoderTest, OnDataHandlesStopIterationAndResumes) {
         metadata.setSequenceId(100);
         return true;
       }));
+  EXPECT_CALL(filter, passthroughEnabled()).WillOnce(Return(false));
   EXPECT_CALL(filter, messageBegin(_))
       .WillOnce(Invoke([&](MessageMetadataSharedPtr metadata) -> ThriftFilters::FilterStatus {
         EXPECT_TRUE(metadata->hasMethodName());
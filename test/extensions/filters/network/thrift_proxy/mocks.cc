@@ -40,6 +40,7 @@ MockDecoderFilter::MockDecoderFilter() {
   ON_CALL(*this, transportEnd()).WillByDefault(Return(FilterStatus::Continue));
   ON_CALL(*this, messageBegin(_)).WillByDefault(Return(FilterStatus::Continue));
   ON_CALL(*this, messageEnd()).WillByDefault(Return(FilterStatus::Continue));
+  ON_CALL(*this, passthroughData(_)).WillByDefault(Return(FilterStatus::Continue));
   ON_CALL(*this, structBegin(_)).WillByDefault(Return(FilterStatus::Continue));
   ON_CALL(*this, structEnd()).WillByDefault(Return(FilterStatus::Continue));
   ON_CALL(*this, fieldBegin(_, _, _)).WillByDefault(Return(FilterStatus::Continue));
@@ -130,6 +130,8 @@ public:
   MOCK_METHOD0(transportEnd, FilterStatus());
   MOCK_METHOD1(messageBegin, FilterStatus(MessageMetadataSharedPtr metadata));
   MOCK_METHOD0(messageEnd, FilterStatus());
+  MOCK_CONST_METHOD0(passthroughEnabled, bool());
+  MOCK_METHOD1(passthroughData, FilterStatus(Buffer::Instance& data));
   MOCK_METHOD1(structBegin, FilterStatus(const absl::string_view name));
   MOCK_METHOD0(structEnd, FilterStatus());
   MOCK_METHOD3(fieldBegin,
@@ -499,6 +499,30 @@ TEST_F(ThriftRouterTest, UnexpectedRouterDestroy) {
   destroyRouter();
 }
 
+TEST_F(ThriftRouterTest, PassthroughData) {
+  initializeRouter();
+  startRequest(MessageType::Call);
+  connectUpstream();
+
+  EXPECT_TRUE(router_->passthroughEnabled());
+  Buffer::OwnedImpl body("payload");
+  EXPECT_EQ(ThriftFilters::FilterStatus::Continue, router_->passthroughData(body));
+  EXPECT_EQ(0, body.length());
+
+  EXPECT_CALL(*protocol_, writeMessageEnd(_));
+  EXPECT_CALL(*transport_, encodeFrame(_, _, _))
+      .WillOnce(Invoke(
+          [&](Buffer::Instance&, const MessageMetadata&, Buffer::Instance& message) -> void {
+            EXPECT_EQ("payload", message.toString());
+          }));
+  EXPECT_CALL(conn_data_.connection_, write(_, false));
+  EXPECT_EQ(ThriftFilters::FilterStatus::Continue, router_->messageEnd());
+  EXPECT_EQ(ThriftFilters::FilterStatus::Continue, router_->transportEnd());
+
+  returnResponse();
+  destroyRouter();
+}
+
 TEST_P(ThriftRouterFieldTypeTest, OneWay) {
   FieldType field_type = GetParam();
 
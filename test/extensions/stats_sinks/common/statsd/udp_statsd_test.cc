@@ -15,7 +15,11 @@
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
 
+using testing::ElementsAre;
+using testing::InSequence;
 using testing::NiceMock;
+using testing::SizeIs;
+using testing::_;
 
 namespace Envoy {
 namespace Extensions {
@@ -26,6 +30,7 @@ namespace Statsd {
 class MockWriter : public Writer {
 public:
   MOCK_METHOD1(write, void(const std::string& message));
+  MOCK_METHOD1(writeBatch, void(const std::vector<std::string>& messages));
 };
 
 class UdpStatsdSinkTest : public testing::TestWithParam<Network::Address::IpVersion> {};
@@ -134,7 +139,7 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   source.counters_.push_back(counter);
 
   EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_counter:1|c"));
+              writeBatch(ElementsAre("envoy.test_counter:1|c")));
   sink.flush(source);
   counter->used_ = false;
 
@@ -145,7 +150,7 @@ TEST(UdpStatsdSinkTest, CheckActualStats) {
   source.gauges_.push_back(gauge);
 
   EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_gauge:1|g"));
+              writeBatch(ElementsAre("envoy.test_gauge:1|g")));
   sink.flush(source);
 
   NiceMock<Stats::MockHistogram> timer;
@@ -172,7 +177,7 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   source.counters_.push_back(counter);
 
   EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_counter:1|c|#key1:value1,key2:value2"));
+              writeBatch(ElementsAre("envoy.test_counter:1|c|#key1:value1,key2:value2")));
   sink.flush(source);
   counter->used_ = false;
 
@@ -184,7 +189,7 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   source.gauges_.push_back(gauge);
 
   EXPECT_CALL(*std::dynamic_pointer_cast<NiceMock<MockWriter>>(writer_ptr),
-              write("envoy.test_gauge:1|g|#key1:value1,key2:value2"));
+              writeBatch(ElementsAre("envoy.test_gauge:1|g|#key1:value1,key2:value2")));
   sink.flush(source);
 
   NiceMock<Stats::MockHistogram> timer;
@@ -197,6 +202,121 @@ TEST(UdpStatsdSinkWithTagsTest, CheckActualStats) {
   tls_.shutdownThread();
 }
 
+TEST(UdpStatsdSinkTest, PackMetricsIntoDatagrams) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  // Room for two of the metrics below, with the newline between them.
+  UdpStatsdSink sink(tls_, writer_ptr, false, getDefaultPrefix(), 45);
+
+  for (const std::string& name : {"counter_a", "counter_b", "counter_c"}) {
+    auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+    counter->name_ = name;
+    counter->used_ = true;
+    counter->latch_ = 1;
+    source.counters_.push_back(counter);
+  }
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "a_gauge_whose_name_does_not_fit_in_a_datagram";
+  gauge->value_ = 1;
+  gauge->used_ = true;
+  source.gauges_.push_back(gauge);
+
+  EXPECT_CALL(*writer_ptr, writeBatch(ElementsAre(
+                               "envoy.counter_a:1|c\nenvoy.counter_b:1|c", "envoy.counter_c:1|c",
+                               "envoy.a_gauge_whose_name_does_not_fit_in_a_datagram:1|g")));
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
+TEST(UdpStatsdSinkTest, OneMetricPerDatagram) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, false, getDefaultPrefix(), 0);
+
+  auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  counter->name_ = "test_counter";
+  counter->used_ = true;
+  counter->latch_ = 1;
+  source.counters_.push_back(counter);
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge";
+  gauge->value_ = 1;
+  gauge->used_ = true;
+  source.gauges_.push_back(gauge);
+
+  EXPECT_CALL(*writer_ptr,
+              writeBatch(ElementsAre("envoy.test_counter:1|c", "envoy.test_gauge:1|g")));
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
+TEST(UdpStatsdSinkTest, SendDatagramsInBatches) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, false, getDefaultPrefix(), 0);
+
+  for (uint32_t i = 0; i < 100; i++) {
+    auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+    counter->name_ = fmt::format("counter_{}", i);
+    counter->used_ = true;
+    counter->latch_ = 1;
+    source.counters_.push_back(counter);
+  }
+
+  InSequence s;
+  EXPECT_CALL(*writer_ptr, writeBatch(SizeIs(64)));
+  EXPECT_CALL(*writer_ptr, writeBatch(SizeIs(36)));
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
+TEST(UdpStatsdSinkTest, SkipUnchangedMetrics) {
+  NiceMock<Stats::MockSource> source;
+  auto writer_ptr = std::make_shared<NiceMock<MockWriter>>();
+  NiceMock<ThreadLocal::MockInstance> tls_;
+  UdpStatsdSink sink(tls_, writer_ptr, false, getDefaultPrefix(), 0, true);
+
+  auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  counter->name_ = "test_counter";
+  counter->used_ = true;
+  counter->latch_ = 1;
+  auto zero_counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  zero_counter->name_ = "zero_counter";
+  zero_counter->used_ = true;
+  zero_counter->latch_ = 0;
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge";
+  gauge->value_ = 1;
+  gauge->used_ = true;
+  source.counters_ = {counter, zero_counter};
+  source.gauges_ = {gauge};
+
+  // Only the changed stats are walked, and counters without increments are left out.
+  source.changed_counters_ = {counter, zero_counter};
+  EXPECT_CALL(source, cachedCounters()).Times(0);
+  EXPECT_CALL(source, cachedGauges()).Times(0);
+  EXPECT_CALL(*writer_ptr, writeBatch(ElementsAre("envoy.test_counter:1|c")));
+  sink.flush(source);
+
+  source.changed_counters_.clear();
+  source.changed_gauges_ = {gauge};
+  EXPECT_CALL(*writer_ptr, writeBatch(ElementsAre("envoy.test_gauge:1|g")));
+  sink.flush(source);
+
+  // Nothing changed, so nothing is sent.
+  source.changed_gauges_.clear();
+  EXPECT_CALL(*writer_ptr, writeBatch(_)).Times(0);
+  sink.flush(source);
+
+  tls_.shutdownThread();
+}
+
 } // namespace Statsd
 } // namespace Common
 } // namespace StatSinks
@@ -150,6 +150,36 @@ TEST(MetricsServiceSinkTest, CheckStatsCount) {
   EXPECT_EQ(1, (*streamer_).metric_count);
 }
 
+TEST(MetricsServiceSinkTest, SkipUnchangedMetrics) {
+  NiceMock<Stats::MockSource> source;
+  std::shared_ptr<TestGrpcMetricsStreamer> streamer_{new TestGrpcMetricsStreamer()};
+
+  MetricsServiceSink sink(streamer_, true);
+
+  auto counter = std::make_shared<NiceMock<Stats::MockCounter>>();
+  counter->name_ = "test_counter";
+  counter->latch_ = 1;
+  counter->used_ = true;
+  source.counters_.push_back(counter);
+
+  auto gauge = std::make_shared<NiceMock<Stats::MockGauge>>();
+  gauge->name_ = "test_gauge";
+  gauge->value_ = 1;
+  gauge->used_ = true;
+  source.gauges_.push_back(gauge);
+
+  // Only the changed stats are walked.
+  EXPECT_CALL(source, cachedCounters()).Times(0);
+  EXPECT_CALL(source, cachedGauges()).Times(0);
+  source.changed_counters_.push_back(counter);
+  sink.flush(source);
+  EXPECT_EQ(1, (*streamer_).metric_count);
+
+  source.changed_counters_.clear();
+  sink.flush(source);
+  EXPECT_EQ(0, (*streamer_).metric_count);
+}
+
 } // namespace MetricsService
 } // namespace StatSinks
 } // namespace Extensions
@@ -23,6 +23,7 @@
 #include "common/common/thread.h"
 #include "common/grpc/codec.h"
 #include "common/grpc/common.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/filter_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/stats/isolated_store_impl.h"
@@ -552,15 +553,19 @@ private:
     Network::FilterChainManager& filterChainManager() override { return parent_; }
     Network::FilterChainFactory& filterChainFactory() override { return parent_; }
     Network::Socket& socket() override { return *parent_.socket_; }
+    Network::Socket& workerSocket(uint32_t) override { return *parent_.socket_; }
+    bool reusePort() const override { return false; }
     bool bindToPort() override { return true; }
     bool handOffRestoredDestinationConnections() const override { return false; }
     uint32_t perConnectionBufferLimitBytes() override { return 0; }
     Stats::Scope& listenerScope() override { return parent_.stats_store_; }
     uint64_t listenerTag() const override { return 0; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return connection_balancer_; }
 
     FakeUpstream& parent_;
     std::string name_;
+    Network::NopConnectionBalancerImpl connection_balancer_;
   };
 
   void threadRoutine();
@@ -217,6 +217,18 @@ TEST_P(IntegrationAdminTest, Admin) {
       response->body(),
       testing::HasSubstr("envoy_cluster_upstream_cx_active{envoy_cluster_name=\"cluster_0\"} 0\n"));
 
+  response = IntegrationUtil::makeSingleRequest(
+      lookupPort("admin"), "GET", "/stats?prefix=cluster.cluster_0.&filter=_cx_active$", "",
+      downstreamProtocol(), version_);
+  EXPECT_TRUE(response->complete());
+  EXPECT_STREQ("200", response->headers().Status()->value().c_str());
+  EXPECT_EQ("cluster.cluster_0.upstream_cx_active: 0\n", response->body());
+
+  response = IntegrationUtil::makeSingleRequest(lookupPort("admin"), "GET", "/stats?filter=(", "",
+                                                downstreamProtocol(), version_);
+  EXPECT_TRUE(response->complete());
+  EXPECT_STREQ("400", response->headers().Status()->value().c_str());
+
   response = IntegrationUtil::makeSingleRequest(lookupPort("admin"), "GET", "/clusters", "",
                                                 downstreamProtocol(), version_);
   EXPECT_TRUE(response->complete());
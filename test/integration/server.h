@@ -65,6 +65,7 @@ public:
   uint64_t maxStats() const override { return 16384; }
   const Stats::StatsOptions& statsOptions() const override { return stats_options_; }
   bool hotRestartDisabled() const override { return false; }
+  bool libeventBufferEnabled() const override { return true; }
 
   // asConfigYaml returns a new config that empties the configPath() and populates configYaml()
   Server::TestOptionsImpl asConfigYaml();
@@ -189,6 +190,11 @@ public:
     Thread::LockGuard lock(lock_);
     return store_.histograms();
   }
+  void latchChanged(std::vector<CounterSharedPtr>& counters,
+                    std::vector<GaugeSharedPtr>& gauges) override {
+    Thread::LockGuard lock(lock_);
+    store_.latchChanged(counters, gauges);
+  }
 
   // Stats::StoreRoot
   void addSink(Sink&) override {}
@@ -44,6 +44,7 @@ public:
 
   // Api::OsSysCalls
   ssize_t write(int fd, const void* buffer, size_t num_bytes) override;
+  ssize_t writev(int fd, const iovec* iovec, int num_iovec) override;
   int open(const std::string& full_path, int flags, int mode) override;
   int setsockopt(int sockfd, int level, int optname, const void* optval, socklen_t optlen) override;
   int getsockopt(int sockfd, int level, int optname, void* optval, socklen_t* optlen) override;
@@ -53,7 +54,7 @@ public:
   MOCK_METHOD1(close, int(int));
   MOCK_METHOD3(open_, int(const std::string& full_path, int flags, int mode));
   MOCK_METHOD3(write_, ssize_t(int, const void*, size_t));
-  MOCK_METHOD3(writev, ssize_t(int, const iovec*, int));
+  MOCK_METHOD3(writev_, ssize_t(int, const iovec*, int));
   MOCK_METHOD3(readv, ssize_t(int, const iovec*, int));
   MOCK_METHOD4(recv, ssize_t(int socket, void* buffer, size_t length, int flags));
 
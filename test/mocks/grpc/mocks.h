@@ -25,6 +25,7 @@ public:
   MOCK_METHOD2_T(sendMessage, void(const Protobuf::Message& request, bool end_stream));
   MOCK_METHOD0_T(closeStream, void());
   MOCK_METHOD0_T(resetStream, void());
+  MOCK_CONST_METHOD0_T(isAboveWriteBufferHighWatermark, bool());
 };
 
 template <class ResponseType>
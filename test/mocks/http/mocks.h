@@ -399,6 +399,7 @@ public:
   MOCK_METHOD2(sendData, void(Buffer::Instance& data, bool end_stream));
   MOCK_METHOD1(sendTrailers, void(HeaderMap& trailers));
   MOCK_METHOD0(reset, void());
+  MOCK_CONST_METHOD0(isAboveWriteBufferHighWatermark, bool());
 };
 
 class MockFilterChainFactoryCallbacks : public Http::FilterChainFactoryCallbacks {
@@ -441,6 +442,7 @@ public:
   MOCK_CONST_METHOD0(protocol, Http::Protocol());
   MOCK_METHOD1(addDrainedCallback, void(DrainedCb cb));
   MOCK_METHOD0(drainConnections, void());
+  MOCK_METHOD0(prefetch, void());
   MOCK_METHOD2(newStream, Cancellable*(Http::StreamDecoder& response_decoder,
                                        Http::ConnectionPool::Callbacks& callbacks));
 
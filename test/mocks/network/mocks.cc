@@ -26,8 +26,10 @@ namespace Network {
 MockListenerConfig::MockListenerConfig() {
   ON_CALL(*this, filterChainFactory()).WillByDefault(ReturnRef(filter_chain_factory_));
   ON_CALL(*this, socket()).WillByDefault(ReturnRef(socket_));
+  ON_CALL(*this, workerSocket(_)).WillByDefault(ReturnRef(socket_));
   ON_CALL(*this, listenerScope()).WillByDefault(ReturnRef(scope_));
   ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
+  ON_CALL(*this, connectionBalancer()).WillByDefault(ReturnRef(connection_balancer_));
 }
 MockListenerConfig::~MockListenerConfig() {}
 
@@ -45,7 +45,9 @@ class TestCorsPolicy : public CorsPolicy {
 public:
   // Router::CorsPolicy
   const std::list<std::string>& allowOrigins() const override { return allow_origin_; };
-  const std::list<std::regex>& allowOriginRegexes() const override { return allow_origin_regex_; };
+  const std::list<Regex::CompiledMatcherSharedPtr>& allowOriginRegexes() const override {
+    return allow_origin_regex_;
+  };
   const std::string& allowMethods() const override { return allow_methods_; };
   const std::string& allowHeaders() const override { return allow_headers_; };
   const std::string& exposeHeaders() const override { return expose_headers_; };
@@ -54,7 +56,7 @@ public:
   bool enabled() const override { return enabled_; };
 
   std::list<std::string> allow_origin_{};
-  std::list<std::regex> allow_origin_regex_{};
+  std::list<Regex::CompiledMatcherSharedPtr> allow_origin_regex_{};
   std::string allow_methods_{};
   std::string allow_headers_{};
   std::string expose_headers_{};
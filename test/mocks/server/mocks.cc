@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include "common/common/utility.h"
 #include "common/singleton/manager_impl.h"
 
 #include "gmock/gmock.h"
@@ -30,6 +31,7 @@ MockOptions::MockOptions(const std::string& config_path) : config_path_(config_p
   ON_CALL(*this, maxStats()).WillByDefault(Return(1000));
   ON_CALL(*this, statsOptions()).WillByDefault(ReturnRef(stats_options_));
   ON_CALL(*this, hotRestartDisabled()).WillByDefault(ReturnPointee(&hot_restart_disabled_));
+  ON_CALL(*this, libeventBufferEnabled()).WillByDefault(ReturnPointee(&libevent_buffer_enabled_));
 }
 MockOptions::~MockOptions() {}
 
@@ -61,19 +63,23 @@ MockGuardDog::MockGuardDog() : watch_dog_(new NiceMock<MockWatchDog>()) {
 }
 MockGuardDog::~MockGuardDog() {}
 
-MockHotRestart::MockHotRestart() {
+MockHotRestart::MockHotRestart()
+    : ssl_session_cache_state_(new Ssl::SessionCacheImpl::State()),
+      ssl_session_cache_(*ssl_session_cache_state_, ssl_session_cache_lock_,
+                         ProdSystemTimeSource::instance_) {
   ON_CALL(*this, logLock()).WillByDefault(ReturnRef(log_lock_));
   ON_CALL(*this, accessLogLock()).WillByDefault(ReturnRef(access_log_lock_));
   ON_CALL(*this, statsAllocator()).WillByDefault(ReturnRef(stats_allocator_));
+  ON_CALL(*this, sslSessionCache()).WillByDefault(ReturnRef(ssl_session_cache_));
 }
 MockHotRestart::~MockHotRestart() {}
 
 MockListenerComponentFactory::MockListenerComponentFactory()
     : socket_(std::make_shared<NiceMock<Network::MockListenSocket>>()) {
-  ON_CALL(*this, createListenSocket(_, _, _))
+  ON_CALL(*this, createListenSocket(_, _, _, _, _))
       .WillByDefault(Invoke([&](Network::Address::InstanceConstSharedPtr,
-                                const Network::Socket::OptionsSharedPtr& options,
-                                bool) -> Network::SocketSharedPtr {
+                                const Network::Socket::OptionsSharedPtr& options, bool, bool,
+                                uint32_t) -> Network::SocketSharedPtr {
         if (!Network::Socket::applyOptions(options, *socket_,
                                            envoy::api::v2::core::SocketOption::STATE_PREBIND)) {
           throw EnvoyException("MockListenerComponentFactory: Setting socket options failed");
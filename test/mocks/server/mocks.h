@@ -22,6 +22,7 @@
 
 #include "common/secret/secret_manager_impl.h"
 #include "common/ssl/context_manager_impl.h"
+#include "common/ssl/session_cache_impl.h"
 
 #include "test/mocks/access_log/mocks.h"
 #include "test/mocks/api/mocks.h"
@@ -72,6 +73,7 @@ public:
   MOCK_CONST_METHOD0(maxStats, uint64_t());
   MOCK_CONST_METHOD0(statsOptions, const Stats::StatsOptions&());
   MOCK_CONST_METHOD0(hotRestartDisabled, bool());
+  MOCK_CONST_METHOD0(libeventBufferEnabled, bool());
 
   std::string config_path_;
   std::string config_yaml_;
@@ -83,6 +85,7 @@ public:
   std::string log_path_;
   Stats::StatsOptionsImpl stats_options_;
   bool hot_restart_disabled_{};
+  bool libevent_buffer_enabled_{true};
 };
 
 class MockConfigTracker : public ConfigTracker {
@@ -164,7 +167,8 @@ public:
 
   // Server::HotRestart
   MOCK_METHOD0(drainParentListeners, void());
-  MOCK_METHOD1(duplicateParentListenSocket, int(const std::string& address));
+  MOCK_METHOD3(duplicateParentListenSocket,
+               int(const std::string& address, uint32_t worker_index, bool reuse_port));
   MOCK_METHOD1(getParentStats, void(GetParentStatsInfo& info));
   MOCK_METHOD2(initialize, void(Event::Dispatcher& dispatcher, Server::Instance& server));
   MOCK_METHOD1(shutdownParentAdmin, void(ShutdownParentAdminInfo& info));
@@ -174,11 +178,15 @@ public:
   MOCK_METHOD0(logLock, Thread::BasicLockable&());
   MOCK_METHOD0(accessLogLock, Thread::BasicLockable&());
   MOCK_METHOD0(statsAllocator, Stats::StatDataAllocator&());
+  MOCK_METHOD0(sslSessionCache, Ssl::SessionCache&());
 
 private:
   Thread::MutexBasicLockable log_lock_;
   Thread::MutexBasicLockable access_log_lock_;
   Stats::HeapStatDataAllocator stats_allocator_;
+  Thread::MutexBasicLockable ssl_session_cache_lock_;
+  std::unique_ptr<Ssl::SessionCacheImpl::State> ssl_session_cache_state_;
+  Ssl::SessionCacheImpl ssl_session_cache_;
 };
 
 class MockListenerComponentFactory : public ListenerComponentFactory {
@@ -202,10 +210,11 @@ public:
                std::vector<Network::ListenerFilterFactoryCb>(
                    const Protobuf::RepeatedPtrField<envoy::api::v2::listener::ListenerFilter>&,
                    Configuration::ListenerFactoryContext& context));
-  MOCK_METHOD3(createListenSocket,
+  MOCK_METHOD5(createListenSocket,
                Network::SocketSharedPtr(Network::Address::InstanceConstSharedPtr address,
                                         const Network::Socket::OptionsSharedPtr& options,
-                                        bool bind_to_port));
+                                        bool bind_to_port, bool reuse_port,
+                                        uint32_t worker_index));
   MOCK_METHOD1(createDrainManager_, DrainManager*(envoy::api::v2::Listener::DrainType drain_type));
   MOCK_METHOD0(nextListenerTag, uint64_t());
 
@@ -234,7 +243,7 @@ public:
   ~MockWorkerFactory();
 
   // Server::WorkerFactory
-  WorkerPtr createWorker() override { return WorkerPtr{createWorker_()}; }
+  WorkerPtr createWorker(uint32_t) override { return WorkerPtr{createWorker_()}; }
 
   MOCK_METHOD0(createWorker_, Worker*());
 };
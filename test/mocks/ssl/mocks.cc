@@ -12,5 +12,8 @@ MockConnection::~MockConnection() {}
 MockClientContext::MockClientContext() {}
 MockClientContext::~MockClientContext() {}
 
+MockPrivateKeyConnectionCallbacks::MockPrivateKeyConnectionCallbacks() {}
+MockPrivateKeyConnectionCallbacks::~MockPrivateKeyConnectionCallbacks() {}
+
 } // namespace Ssl
 } // namespace Envoy
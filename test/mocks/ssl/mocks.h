@@ -7,6 +7,7 @@
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
 #include "envoy/ssl/context_manager.h"
+#include "envoy/ssl/private_key_method.h"
 #include "envoy/stats/scope.h"
 
 #include "test/mocks/secret/mocks.h"
@@ -57,5 +58,13 @@ public:
   MOCK_CONST_METHOD0(getCertChainInformation, std::string());
 };
 
+class MockPrivateKeyConnectionCallbacks : public PrivateKeyConnectionCallbacks {
+public:
+  MockPrivateKeyConnectionCallbacks();
+  ~MockPrivateKeyConnectionCallbacks();
+
+  MOCK_METHOD0(onPrivateKeyMethodComplete, void());
+};
+
 } // namespace Ssl
 } // namespace Envoy
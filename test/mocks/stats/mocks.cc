@@ -14,9 +14,9 @@ namespace Envoy {
 namespace Stats {
 
 MockCounter::MockCounter() {
-  ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
+  ON_CALL(*this, name()).WillByDefault(ReturnPointee(&name_));
+  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnPointee(&name_));
+  ON_CALL(*this, tags()).WillByDefault(ReturnPointee(&tags_));
   ON_CALL(*this, used()).WillByDefault(ReturnPointee(&used_));
   ON_CALL(*this, value()).WillByDefault(ReturnPointee(&value_));
   ON_CALL(*this, latch()).WillByDefault(ReturnPointee(&latch_));
@@ -24,9 +24,9 @@ MockCounter::MockCounter() {
 MockCounter::~MockCounter() {}
 
 MockGauge::MockGauge() {
-  ON_CALL(*this, name()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
+  ON_CALL(*this, name()).WillByDefault(ReturnPointee(&name_));
+  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnPointee(&name_));
+  ON_CALL(*this, tags()).WillByDefault(ReturnPointee(&tags_));
   ON_CALL(*this, used()).WillByDefault(ReturnPointee(&used_));
   ON_CALL(*this, value()).WillByDefault(ReturnPointee(&value_));
 }
@@ -38,8 +38,8 @@ MockHistogram::MockHistogram() {
       store_->deliverHistogramToSinks(*this, value);
     }
   }));
-  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
+  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnPointee(&name_));
+  ON_CALL(*this, tags()).WillByDefault(ReturnPointee(&tags_));
 }
 
 MockHistogram::~MockHistogram() {}
@@ -50,8 +50,8 @@ MockParentHistogram::MockParentHistogram() {
       store_->deliverHistogramToSinks(*this, value);
     }
   }));
-  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnRef(name_));
-  ON_CALL(*this, tags()).WillByDefault(ReturnRef(tags_));
+  ON_CALL(*this, tagExtractedName()).WillByDefault(ReturnPointee(&name_));
+  ON_CALL(*this, tags()).WillByDefault(ReturnPointee(&tags_));
   ON_CALL(*this, intervalStatistics()).WillByDefault(ReturnRef(*histogram_stats_));
   ON_CALL(*this, cumulativeStatistics()).WillByDefault(ReturnRef(*histogram_stats_));
   ON_CALL(*this, used()).WillByDefault(ReturnPointee(&used_));
@@ -63,6 +63,8 @@ MockSource::MockSource() {
   ON_CALL(*this, cachedCounters()).WillByDefault(ReturnRef(counters_));
   ON_CALL(*this, cachedGauges()).WillByDefault(ReturnRef(gauges_));
   ON_CALL(*this, cachedHistograms()).WillByDefault(ReturnRef(histograms_));
+  ON_CALL(*this, cachedChangedCounters()).WillByDefault(ReturnRef(changed_counters_));
+  ON_CALL(*this, cachedChangedGauges()).WillByDefault(ReturnRef(changed_gauges_));
 }
 
 MockSource::~MockSource() {}
@@ -30,9 +30,9 @@ public:
   MOCK_METHOD1(add, void(uint64_t amount));
   MOCK_METHOD0(inc, void());
   MOCK_METHOD0(latch, uint64_t());
-  MOCK_CONST_METHOD0(name, const std::string&());
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
+  MOCK_CONST_METHOD0(name, std::string());
+  MOCK_CONST_METHOD0(tagExtractedName, std::string());
+  MOCK_CONST_METHOD0(tags, std::vector<Tag>());
   MOCK_METHOD0(reset, void());
   MOCK_CONST_METHOD0(used, bool());
   MOCK_CONST_METHOD0(value, uint64_t());
@@ -52,9 +52,9 @@ public:
   MOCK_METHOD1(add, void(uint64_t amount));
   MOCK_METHOD0(dec, void());
   MOCK_METHOD0(inc, void());
-  MOCK_CONST_METHOD0(name, const std::string&());
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
+  MOCK_CONST_METHOD0(name, std::string());
+  MOCK_CONST_METHOD0(tagExtractedName, std::string());
+  MOCK_CONST_METHOD0(tags, std::vector<Tag>());
   MOCK_METHOD1(set, void(uint64_t value));
   MOCK_METHOD1(sub, void(uint64_t amount));
   MOCK_CONST_METHOD0(used, bool());
@@ -73,10 +73,10 @@ public:
 
   // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
   // creates a deadlock in gmock and is an unintended use of mock functions.
-  const std::string& name() const override { return name_; };
+  std::string name() const override { return name_; };
 
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
+  MOCK_CONST_METHOD0(tagExtractedName, std::string());
+  MOCK_CONST_METHOD0(tags, std::vector<Tag>());
   MOCK_METHOD1(recordValue, void(uint64_t value));
   MOCK_CONST_METHOD0(used, bool());
 
@@ -92,13 +92,13 @@ public:
 
   // Note: cannot be mocked because it is accessed as a Property in a gmock EXPECT_CALL. This
   // creates a deadlock in gmock and is an unintended use of mock functions.
-  const std::string& name() const override { return name_; };
+  std::string name() const override { return name_; };
   void merge() override {}
   const std::string summary() const override { return ""; };
 
   MOCK_CONST_METHOD0(used, bool());
-  MOCK_CONST_METHOD0(tagExtractedName, const std::string&());
-  MOCK_CONST_METHOD0(tags, const std::vector<Tag>&());
+  MOCK_CONST_METHOD0(tagExtractedName, std::string());
+  MOCK_CONST_METHOD0(tags, std::vector<Tag>());
   MOCK_METHOD1(recordValue, void(uint64_t value));
   MOCK_CONST_METHOD0(cumulativeStatistics, const HistogramStatistics&());
   MOCK_CONST_METHOD0(intervalStatistics, const HistogramStatistics&());
@@ -119,11 +119,15 @@ public:
   MOCK_METHOD0(cachedCounters, const std::vector<CounterSharedPtr>&());
   MOCK_METHOD0(cachedGauges, const std::vector<GaugeSharedPtr>&());
   MOCK_METHOD0(cachedHistograms, const std::vector<ParentHistogramSharedPtr>&());
+  MOCK_METHOD0(cachedChangedCounters, const std::vector<CounterSharedPtr>&());
+  MOCK_METHOD0(cachedChangedGauges, const std::vector<GaugeSharedPtr>&());
   MOCK_METHOD0(clearCache, void());
 
   std::vector<CounterSharedPtr> counters_;
   std::vector<GaugeSharedPtr> gauges_;
   std::vector<ParentHistogramSharedPtr> histograms_;
+  std::vector<CounterSharedPtr> changed_counters_;
+  std::vector<GaugeSharedPtr> changed_gauges_;
 };
 
 class MockSink : public Sink {
@@ -150,6 +154,8 @@ public:
   MOCK_CONST_METHOD0(gauges, std::vector<GaugeSharedPtr>());
   MOCK_METHOD1(histogram, Histogram&(const std::string& name));
   MOCK_CONST_METHOD0(histograms, std::vector<ParentHistogramSharedPtr>());
+  MOCK_METHOD2(latchChanged,
+               void(std::vector<CounterSharedPtr>& counters, std::vector<GaugeSharedPtr>& gauges));
   MOCK_CONST_METHOD0(statsOptions, const StatsOptions&());
 
   testing::NiceMock<MockCounter> counter_;
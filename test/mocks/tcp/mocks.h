@@ -57,6 +57,7 @@ public:
   // Tcp::ConnectionPool::Instance
   MOCK_METHOD1(addDrainedCallback, void(DrainedCb cb));
   MOCK_METHOD0(drainConnections, void());
+  MOCK_METHOD0(prefetch, void());
   MOCK_METHOD1(newConnection, Cancellable*(Tcp::ConnectionPool::Callbacks& callbacks));
 
   MockCancellable* newConnectionImpl(Callbacks& cb);
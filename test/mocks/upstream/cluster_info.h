@@ -57,6 +57,7 @@ public:
                      const absl::optional<envoy::api::v2::Cluster::OriginalDstLbConfig>&());
   MOCK_CONST_METHOD0(maintenanceMode, bool());
   MOCK_CONST_METHOD0(maxRequestsPerConnection, uint64_t());
+  MOCK_CONST_METHOD0(perUpstreamPrefetchRatio, float());
   MOCK_CONST_METHOD0(name, const std::string&());
   MOCK_CONST_METHOD1(resourceManager, ResourceManager&(ResourcePriority priority));
   MOCK_CONST_METHOD0(transportSocketFactory, Network::TransportSocketFactory&());
@@ -72,6 +73,7 @@ public:
   std::string name_{"fake_cluster"};
   Http::Http2Settings http2_settings_{};
   uint64_t max_requests_per_connection_{};
+  float per_upstream_prefetch_ratio_{1.0};
   NiceMock<Stats::MockIsolatedStatsStore> stats_store_;
   ClusterStats stats_;
   Network::TransportSocketFactoryPtr transport_socket_factory_;
@@ -2,6 +2,7 @@
 
 #include "common/common/utility.h"
 #include "common/network/address_impl.h"
+#include "common/network/connection_balancer_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
 
@@ -17,6 +18,7 @@
 using testing::ByRef;
 using testing::InSequence;
 using testing::Invoke;
+using testing::Ref;
 using testing::NiceMock;
 using testing::Return;
 using testing::ReturnRef;
@@ -28,7 +30,7 @@ namespace Server {
 class ConnectionHandlerTest : public testing::Test, protected Logger::Loggable<Logger::Id::main> {
 public:
   ConnectionHandlerTest()
-      : handler_(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_)),
+      : handler_(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, absl::nullopt)),
         filter_chain_(Network::Test::createEmptyFilterChainWithRawBufferSockets()) {}
 
   // Listener
@@ -43,6 +45,7 @@ public:
     Network::FilterChainManager& filterChainManager() override { return parent_.manager_; }
     Network::FilterChainFactory& filterChainFactory() override { return parent_.factory_; }
     Network::Socket& socket() override { return socket_; }
+    Network::Socket& workerSocket(uint32_t) override { return worker_socket_; }
     bool bindToPort() override { return bind_to_port_; }
     bool handOffRestoredDestinationConnections() const override {
       return hand_off_restored_destination_connections_;
@@ -51,13 +54,16 @@ public:
     Stats::Scope& listenerScope() override { return parent_.stats_store_; }
     uint64_t listenerTag() const override { return tag_; }
     const std::string& name() const override { return name_; }
+    Network::ConnectionBalancer& connectionBalancer() override { return *connection_balancer_; }
 
     ConnectionHandlerTest& parent_;
     Network::MockListenSocket socket_;
+    Network::MockListenSocket worker_socket_;
     uint64_t tag_;
     bool bind_to_port_;
     const bool hand_off_restored_destination_connections_;
     const std::string name_;
+    Network::ConnectionBalancerPtr connection_balancer_{new Network::NopConnectionBalancerImpl()};
   };
 
   typedef std::unique_ptr<TestListener> TestListenerPtr;
@@ -143,6 +149,93 @@ TEST_F(ConnectionHandlerTest, DestroyCloseConnections) {
   handler_.reset();
 }
 
+TEST_F(ConnectionHandlerTest, WorkerSocketAndPerHandlerStats) {
+  handler_.reset(new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, 1));
+
+  Network::MockListener* listener = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks;
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  EXPECT_CALL(dispatcher_, createListener_(Ref(test_listener->worker_socket_), _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks = &cb;
+            return listener;
+          }));
+  EXPECT_CALL(test_listener->socket_, localAddress());
+  handler_->addListener(*test_listener);
+
+  Network::MockConnection* connection = new NiceMock<Network::MockConnection>();
+  listener_callbacks->onNewConnection(Network::ConnectionPtr{connection});
+  EXPECT_EQ(1UL, stats_store_.counter("worker_1.downstream_cx_total").value());
+  EXPECT_EQ(1UL, stats_store_.gauge("worker_1.downstream_cx_active").value());
+
+  connection->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(0UL, handler_->numConnections());
+  EXPECT_EQ(1UL, stats_store_.counter("worker_1.downstream_cx_total").value());
+  EXPECT_EQ(0UL, stats_store_.gauge("worker_1.downstream_cx_active").value());
+
+  EXPECT_CALL(*listener, onDestroy());
+  handler_.reset();
+}
+
+TEST_F(ConnectionHandlerTest, ExactConnectionBalancing) {
+  Network::ConnectionHandlerPtr handler2(
+      new ConnectionHandlerImpl(ENVOY_LOGGER(), dispatcher_, absl::nullopt));
+  TestListener* test_listener = addListener(1, true, false, "test_listener");
+  test_listener->connection_balancer_ = std::make_unique<Network::ExactConnectionBalancerImpl>();
+
+  Network::MockListener* listener1 = new NiceMock<Network::MockListener>();
+  Network::MockListener* listener2 = new NiceMock<Network::MockListener>();
+  Network::ListenerCallbacks* listener_callbacks1;
+  Network::ListenerCallbacks* listener_callbacks2;
+  EXPECT_CALL(dispatcher_, createListener_(_, _, _, _))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks1 = &cb;
+            return listener1;
+          }))
+      .WillOnce(Invoke(
+          [&](Network::Socket&, Network::ListenerCallbacks& cb, bool, bool) -> Network::Listener* {
+            listener_callbacks2 = &cb;
+            return listener2;
+          }));
+  EXPECT_CALL(test_listener->socket_, localAddress()).Times(2);
+  handler_->addListener(*test_listener);
+  handler2->addListener(*test_listener);
+
+  // The first handler already has a connection, so a socket it accepts is posted to the second.
+  listener_callbacks1->onNewConnection(
+      Network::ConnectionPtr{new NiceMock<Network::MockConnection>()});
+  EXPECT_EQ(1UL, handler_->numConnections());
+
+  EXPECT_CALL(dispatcher_, post(_));
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  Network::MockConnection* connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).WillOnce(Return(connection));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  listener_callbacks1->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  EXPECT_EQ(1UL, handler_->numConnections());
+  EXPECT_EQ(1UL, handler2->numConnections());
+
+  // Both handlers have a connection, so a socket stays on the handler that accepted it.
+  EXPECT_CALL(dispatcher_, post(_)).Times(0);
+  EXPECT_CALL(manager_, findFilterChain(_)).WillOnce(Return(filter_chain_.get()));
+  connection = new NiceMock<Network::MockConnection>();
+  EXPECT_CALL(dispatcher_, createServerConnection_(_, _)).WillOnce(Return(connection));
+  EXPECT_CALL(factory_, createNetworkFilterChain(_, _)).WillOnce(Return(true));
+  listener_callbacks2->onAccept(
+      Network::ConnectionSocketPtr{new NiceMock<Network::MockConnectionSocket>()}, true);
+  EXPECT_EQ(1UL, handler_->numConnections());
+  EXPECT_EQ(2UL, handler2->numConnections());
+
+  EXPECT_CALL(*listener1, onDestroy());
+  EXPECT_CALL(*listener2, onDestroy());
+  handler_.reset();
+  handler2.reset();
+}
+
 TEST_F(ConnectionHandlerTest, CloseDuringFilterChainCreate) {
   InSequence s;
 
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <unordered_map>
 
@@ -23,6 +25,7 @@
 #include "test/test_common/utility.h"
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_join.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -30,6 +33,7 @@ using testing::HasSubstr;
 using testing::InSequence;
 using testing::Invoke;
 using testing::NiceMock;
+using testing::Not;
 using testing::Ref;
 using testing::Return;
 using testing::ReturnPointee;
@@ -46,11 +50,27 @@ public:
     store_->addSink(sink_);
   }
 
-  static std::string
-  statsAsJsonHandler(std::map<std::string, uint64_t>& all_stats,
-                     const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
-                     const bool used_only) {
-    return AdminImpl::statsAsJson(all_stats, all_histograms, used_only, true);
+  // Returns the /stats?format=json response for the histograms.
+  static std::string statsAsJsonHandler(std::vector<Stats::ParentHistogramSharedPtr> histograms,
+                                        const bool used_only) {
+    if (used_only) {
+      histograms.erase(std::remove_if(histograms.begin(), histograms.end(),
+                                      [](const Stats::ParentHistogramSharedPtr& histogram) {
+                                        return !histogram->used();
+                                      }),
+                       histograms.end());
+    }
+    StatsJsonChunkedResponse json_response({}, {}, std::move(histograms));
+    Buffer::OwnedImpl response;
+    while (json_response.nextChunk(response)) {
+    }
+    return response.toString();
+  }
+
+  // The expected documents are pretty printed for readability, while the response isn't.
+  static std::string withoutWhitespace(std::string json) {
+    json.erase(std::remove_if(json.begin(), json.end(), ::isspace), json.end());
+    return json;
   }
 
   NiceMock<Event::MockDispatcher> main_thread_dispatcher_;
@@ -109,9 +129,7 @@ TEST_P(AdminStatsTest, StatsAsJson) {
 
   EXPECT_CALL(alloc_, free(_));
 
-  std::map<std::string, uint64_t> all_stats;
-
-  std::string actual_json = statsAsJsonHandler(all_stats, store_->histograms(), false);
+  std::string actual_json = statsAsJsonHandler(store_->histograms(), true);
 
   const std::string expected_json = R"EOF({
     "stats": [
@@ -217,7 +235,169 @@ TEST_P(AdminStatsTest, StatsAsJson) {
     ]
 })EOF";
 
-  EXPECT_EQ(expected_json, actual_json);
+  EXPECT_EQ(withoutWhitespace(expected_json), actual_json);
+  store_->shutdownThreading();
+}
+
+TEST_P(AdminStatsTest, StreamedJsonChunks) {
+  InSequence s;
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  Stats::Histogram& h1 = store_->histogram("h1");
+  Stats::Histogram& h2 = store_->histogram("h2");
+
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(h2), 200));
+  h2.recordValue(200);
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), 100));
+  h1.recordValue(100);
+
+  store_->mergeHistograms([]() -> void {});
+
+  Stats::HeapStatDataAllocator heap_alloc;
+  std::vector<Stats::CounterSharedPtr> counters{heap_alloc.makeCounter("c2", "c2", {}),
+                                                heap_alloc.makeCounter("c1", "c1", {})};
+  counters[0]->add(2);
+  std::vector<Stats::GaugeSharedPtr> gauges{heap_alloc.makeGauge("g1", "g1", {})};
+  gauges[0]->set(5);
+  std::vector<Stats::ParentHistogramSharedPtr> histograms = store_->histograms();
+
+  // The whole document fits in a single chunk of the default size.
+  StatsJsonChunkedResponse whole_response(std::vector<Stats::CounterSharedPtr>(counters),
+                                          std::vector<Stats::GaugeSharedPtr>(gauges),
+                                          std::vector<Stats::ParentHistogramSharedPtr>(histograms));
+  Buffer::OwnedImpl whole_chunk;
+  EXPECT_FALSE(whole_response.nextChunk(whole_chunk));
+  const std::string expected_json = whole_chunk.toString();
+  EXPECT_TRUE(absl::StartsWith(expected_json, "{\"stats\":[{\"name\":\"c1\",\"value\":0},"
+                                              "{\"name\":\"c2\",\"value\":2},"
+                                              "{\"name\":\"g1\",\"value\":5},"
+                                              "{\"histograms\":{\"supported_quantiles\":"))
+      << expected_json;
+  EXPECT_TRUE(absl::EndsWith(expected_json, "]}}]}")) << expected_json;
+
+  // With a chunk size of one byte every stat is written in its own chunk.
+  StatsJsonChunkedResponse json_response(std::move(counters), std::move(gauges),
+                                         std::move(histograms), 1);
+  std::vector<std::string> chunks;
+  bool more = true;
+  while (more) {
+    Buffer::OwnedImpl chunk;
+    more = json_response.nextChunk(chunk);
+    chunks.push_back(chunk.toString());
+  }
+
+  EXPECT_EQ(expected_json, absl::StrJoin(chunks, ""));
+  // The start of the document, three stats, two histograms, the end of the document and an empty
+  // last chunk.
+  EXPECT_EQ(8U, chunks.size());
+
+  EXPECT_CALL(alloc_, free(_));
+  store_->shutdownThreading();
+}
+
+TEST_P(AdminStatsTest, PrometheusHistogramBuckets) {
+  InSequence s;
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  Stats::Histogram& h1 = store_->histogram("h1");
+
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), 200));
+  h1.recordValue(200);
+
+  store_->mergeHistograms([]() -> void {});
+
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), 100));
+  h1.recordValue(100);
+
+  store_->mergeHistograms([]() -> void {});
+
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(1UL, PrometheusStatsFormatter::statsAsPrometheus({}, {}, store_->histograms(),
+                                                            response));
+
+  const std::string expected_buckets = R"EOF(# TYPE envoy_h1 histogram
+envoy_h1_bucket{le="0.5"} 0
+envoy_h1_bucket{le="1"} 0
+envoy_h1_bucket{le="5"} 0
+envoy_h1_bucket{le="10"} 0
+envoy_h1_bucket{le="25"} 0
+envoy_h1_bucket{le="50"} 0
+envoy_h1_bucket{le="100"} 1
+envoy_h1_bucket{le="250"} 2
+envoy_h1_bucket{le="500"} 2
+envoy_h1_bucket{le="1000"} 2
+envoy_h1_bucket{le="2500"} 2
+envoy_h1_bucket{le="5000"} 2
+envoy_h1_bucket{le="10000"} 2
+envoy_h1_bucket{le="30000"} 2
+envoy_h1_bucket{le="60000"} 2
+envoy_h1_bucket{le="300000"} 2
+envoy_h1_bucket{le="600000"} 2
+envoy_h1_bucket{le="1800000"} 2
+envoy_h1_bucket{le="3600000"} 2
+envoy_h1_bucket{le="+Inf"} 2
+envoy_h1_sum{} )EOF";
+  EXPECT_THAT(response.toString(), HasSubstr(expected_buckets));
+  EXPECT_THAT(response.toString(), HasSubstr("\nenvoy_h1_count{} 2\n"));
+
+  EXPECT_CALL(alloc_, free(_));
+  store_->shutdownThreading();
+}
+
+// Sums that need more than 6 significant digits are read back exactly.
+TEST_P(AdminStatsTest, PrometheusHistogramLargeSum) {
+  InSequence s;
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  Stats::Histogram& h1 = store_->histogram("h1");
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), 1234567));
+  h1.recordValue(1234567);
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), 15));
+  h1.recordValue(15);
+  store_->mergeHistograms([]() -> void {});
+
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(1UL, PrometheusStatsFormatter::statsAsPrometheus({}, {}, store_->histograms(),
+                                                            response));
+  const std::string output = response.toString();
+  const std::string sum_prefix = "\nenvoy_h1_sum{} ";
+  const size_t sum_start = output.find(sum_prefix);
+  ASSERT_NE(std::string::npos, sum_start) << output;
+  const size_t value_start = sum_start + sum_prefix.size();
+  const std::string sum = output.substr(value_start, output.find('\n', value_start) - value_start);
+  const double expected_sum = store_->histograms()[0]->cumulativeStatistics().sampleSum();
+  EXPECT_GT(expected_sum, 1e6);
+  EXPECT_EQ(expected_sum, std::stod(sum)) << sum;
+  EXPECT_THAT(sum, Not(HasSubstr("e+")));
+
+  EXPECT_CALL(alloc_, free(_));
+  store_->shutdownThreading();
+}
+
+TEST_P(AdminStatsTest, PrometheusHistogramSharingCounterName) {
+  InSequence s;
+  store_->initializeThreading(main_thread_dispatcher_, tls_);
+
+  Stats::Histogram& h1 = store_->histogram("h1");
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(h1), 200));
+  h1.recordValue(200);
+  store_->mergeHistograms([]() -> void {});
+
+  Stats::HeapStatDataAllocator heap_alloc;
+  std::vector<Stats::CounterSharedPtr> counters{heap_alloc.makeCounter("h1", "h1", {})};
+  counters[0]->add(3);
+
+  Buffer::OwnedImpl response;
+  EXPECT_EQ(1UL, PrometheusStatsFormatter::statsAsPrometheus(counters, {}, store_->histograms(),
+                                                            response));
+  // The histogram samples follow a TYPE line of their own instead of the counter's.
+  EXPECT_TRUE(absl::StartsWith(response.toString(), "# TYPE envoy_h1 counter\n"
+                                                    "envoy_h1{} 3\n"
+                                                    "# TYPE envoy_h1 histogram\n"
+                                                    "envoy_h1_bucket{le=\"0.5\"} 0\n"))
+      << response.toString();
+
+  EXPECT_CALL(alloc_, free(_));
   store_->shutdownThreading();
 }
 
@@ -245,9 +425,7 @@ TEST_P(AdminStatsTest, UsedOnlyStatsAsJson) {
 
   EXPECT_CALL(alloc_, free(_));
 
-  std::map<std::string, uint64_t> all_stats;
-
-  std::string actual_json = statsAsJsonHandler(all_stats, store_->histograms(), false);
+  std::string actual_json = statsAsJsonHandler(store_->histograms(), true);
 
   // Expected JSON should not have h2 values as it is not used.
   const std::string expected_json = R"EOF({
@@ -313,7 +491,7 @@ TEST_P(AdminStatsTest, UsedOnlyStatsAsJson) {
     ]
 })EOF";
 
-  EXPECT_EQ(expected_json, actual_json);
+  EXPECT_EQ(withoutWhitespace(expected_json), actual_json);
   store_->shutdownThreading();
 }
 
@@ -341,6 +519,35 @@ TEST_P(AdminFilterTest, Trailers) {
   filter_.decodeTrailers(request_headers_);
 }
 
+TEST_P(AdminFilterTest, ChunkedResponse) {
+  // Enough stats for the plain text output to take two chunks.
+  for (size_t i = 0; i < 2000; ++i) {
+    server_.stats_store_.counter(fmt::format("test.a_counter_with_a_rather_long_name_{}", i));
+  }
+  Http::TestHeaderMapImpl request_headers{{":path", "/stats"}};
+  Event::MockTimer* chunk_timer = new Event::MockTimer(&callbacks_.dispatcher_);
+
+  InSequence s;
+  EXPECT_CALL(callbacks_, encodeHeaders_(_, false));
+  EXPECT_CALL(callbacks_, addDownstreamWatermarkCallbacks(Ref(filter_)));
+  EXPECT_CALL(callbacks_, encodeData(_, false));
+  EXPECT_CALL(*chunk_timer, enableTimer(std::chrono::milliseconds(0)));
+  filter_.decodeHeaders(request_headers, true);
+
+  // The next chunk is not scheduled while the downstream is backed up.
+  filter_.onAboveWriteBufferHighWatermark();
+  filter_.onAboveWriteBufferHighWatermark();
+  filter_.onBelowWriteBufferLowWatermark();
+  EXPECT_CALL(*chunk_timer, enableTimer(std::chrono::milliseconds(0)));
+  filter_.onBelowWriteBufferLowWatermark();
+
+  EXPECT_CALL(callbacks_, encodeData(_, true));
+  chunk_timer->callback_();
+
+  EXPECT_CALL(callbacks_, removeDownstreamWatermarkCallbacks(Ref(filter_)));
+  filter_.onDestroy();
+}
+
 class AdminInstanceTest : public testing::TestWithParam<Network::Address::IpVersion> {
 public:
   AdminInstanceTest()
@@ -360,7 +567,10 @@ public:
                          Buffer::Instance& response, absl::string_view method) {
     request_headers_.insertMethod().value(method.data(), method.size());
     admin_filter_.decodeHeaders(request_headers_, false);
-    return admin_.runCallback(path_and_query, response_headers, response, admin_filter_);
+    const Http::Code code =
+        admin_.runCallback(path_and_query, response_headers, response, admin_filter_);
+    admin_filter_.drainChunkedResponse(response);
+    return code;
   }
 
   Http::Code getCallback(absl::string_view path_and_query, Http::HeaderMap& response_headers,
@@ -765,6 +975,50 @@ TEST_P(AdminInstanceTest, GetRequestJson) {
               HasSubstr("application/json"));
 }
 
+TEST_P(AdminInstanceTest, StatsFilters) {
+  server_.stats_store_.counter("foo.bar").inc();
+  server_.stats_store_.counter("foo.baz");
+  server_.stats_store_.gauge("other.bar").set(3);
+
+  {
+    Http::HeaderMapImpl header_map;
+    Buffer::OwnedImpl response;
+    EXPECT_EQ(Http::Code::OK, getCallback("/stats?filter=bar$", header_map, response));
+    EXPECT_EQ("foo.bar: 1\nother.bar: 3\n", response.toString());
+  }
+
+  {
+    Http::HeaderMapImpl header_map;
+    Buffer::OwnedImpl response;
+    EXPECT_EQ(Http::Code::OK, getCallback("/stats?prefix=foo.", header_map, response));
+    EXPECT_EQ("foo.bar: 1\nfoo.baz: 0\n", response.toString());
+  }
+
+  {
+    Http::HeaderMapImpl header_map;
+    Buffer::OwnedImpl response;
+    EXPECT_EQ(Http::Code::OK, getCallback("/stats?usedonly&prefix=foo.", header_map, response));
+    EXPECT_EQ("foo.bar: 1\n", response.toString());
+  }
+
+  {
+    Http::HeaderMapImpl header_map;
+    Buffer::OwnedImpl response;
+    EXPECT_EQ(Http::Code::OK,
+              getCallback("/stats/prometheus?filter=^foo\\.", header_map, response));
+    EXPECT_EQ("# TYPE envoy_foo_bar counter\nenvoy_foo_bar{} 1\n"
+              "# TYPE envoy_foo_baz counter\nenvoy_foo_baz{} 0\n",
+              response.toString());
+  }
+
+  {
+    Http::HeaderMapImpl header_map;
+    Buffer::OwnedImpl response;
+    EXPECT_EQ(Http::Code::BadRequest, getCallback("/stats?filter=(", header_map, response));
+    EXPECT_TRUE(absl::StartsWith(response.toString(), "invalid filter: ")) << response.toString();
+  }
+}
+
 TEST_P(AdminInstanceTest, PostRequest) {
   Http::HeaderMapImpl response_headers;
   std::string body;
@@ -792,6 +1046,7 @@ protected:
   Stats::HeapStatDataAllocator alloc_;
   std::vector<Stats::CounterSharedPtr> counters_;
   std::vector<Stats::GaugeSharedPtr> gauges_;
+  std::vector<Stats::ParentHistogramSharedPtr> histograms_;
 };
 
 TEST_F(PrometheusStatsFormatterTest, MetricName) {
@@ -827,7 +1082,8 @@ TEST_F(PrometheusStatsFormatterTest, MetricNameCollison) {
            {{"another_tag_name_4", "another_tag_4-value"}});
 
   Buffer::OwnedImpl response;
-  EXPECT_EQ(2UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, response));
+  EXPECT_EQ(2UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_,
+                                                            response));
 }
 
 TEST_F(PrometheusStatsFormatterTest, UniqueMetricName) {
@@ -845,7 +1101,8 @@ TEST_F(PrometheusStatsFormatterTest, UniqueMetricName) {
            {{"another_tag_name_4", "another_tag_4-value"}});
 
   Buffer::OwnedImpl response;
-  EXPECT_EQ(4UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, response));
+  EXPECT_EQ(4UL, PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_,
+                                                            response));
 }
 
 } // namespace Server
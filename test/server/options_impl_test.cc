@@ -102,6 +102,7 @@ TEST(OptionsImplTest, SetAll) {
   std::unique_ptr<OptionsImpl> options = createOptionsImpl("envoy -c hello");
   bool v2_config_only = options->v2ConfigOnly();
   bool hot_restart_disabled = options->hotRestartDisabled();
+  bool libevent_buffer_enabled = options->libeventBufferEnabled();
   Stats::StatsOptionsImpl stats_options;
   stats_options.max_obj_name_length_ = 54321;
   stats_options.max_stat_suffix_length_ = 1234;
@@ -127,6 +128,7 @@ TEST(OptionsImplTest, SetAll) {
   options->setMaxStats(12345);
   options->setStatsOptions(stats_options);
   options->setHotRestartDisabled(!options->hotRestartDisabled());
+  options->setLibeventBufferEnabled(!options->libeventBufferEnabled());
 
   EXPECT_EQ(109876, options->baseId());
   EXPECT_EQ(42U, options->concurrency());
@@ -150,6 +152,7 @@ TEST(OptionsImplTest, SetAll) {
   EXPECT_EQ(stats_options.max_obj_name_length_, options->statsOptions().maxObjNameLength());
   EXPECT_EQ(stats_options.max_stat_suffix_length_, options->statsOptions().maxStatSuffixLength());
   EXPECT_EQ(!hot_restart_disabled, options->hotRestartDisabled());
+  EXPECT_EQ(!libevent_buffer_enabled, options->libeventBufferEnabled());
 }
 
 TEST(OptionsImplTest, DefaultParams) {
@@ -160,6 +163,15 @@ TEST(OptionsImplTest, DefaultParams) {
   EXPECT_EQ(Network::Address::IpVersion::v4, options->localAddressIpVersion());
   EXPECT_EQ(Server::Mode::Serve, options->mode());
   EXPECT_EQ(false, options->hotRestartDisabled());
+  EXPECT_EQ(true, options->libeventBufferEnabled());
+}
+
+TEST(OptionsImplTest, LibeventBuffers) {
+  std::unique_ptr<OptionsImpl> options =
+      createOptionsImpl("envoy -c hello --use-libevent-buffers 0");
+  EXPECT_EQ(false, options->libeventBufferEnabled());
+  options = createOptionsImpl("envoy -c hello --use-libevent-buffers 1");
+  EXPECT_EQ(true, options->libeventBufferEnabled());
 }
 
 TEST(OptionsImplTest, BadCliOption) {